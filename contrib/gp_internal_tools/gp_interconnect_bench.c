@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2017 Pivotal Inc. All Rights Reserved
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Micro-benchmark of the per-packet CPU work of the UDP interconnect, to
+ * measure what gp_interconnect_full_crc costs per MB of motion data on this
+ * host.  The dynamically linked library created from this source can be
+ * reference by creating a function in psql that references it. For example,
+ *
+ * CREATE FUNCTION gp_interconnect_packet_bench(packet_size int4, mbytes int4)
+ *	RETURNS SETOF record
+ *	AS '$libdir/gp_interconnect_bench', 'gp_interconnect_packet_bench'
+ *	LANGUAGE C VOLATILE STRICT;
+ *
+ * SELECT * FROM gp_interconnect_packet_bench(8192, 1024)
+ *	AS b(step text, packets int8, mbytes float8, usecs int8,
+ *		 mb_per_sec float8, usecs_per_mb float8);
+ */
+
+#include "postgres.h"
+#include "funcapi.h"
+#include "cdb/ml_ipc.h"
+#include "utils/builtins.h"
+#include "miscadmin.h"
+
+/* The number of columns of the result */
+#define NUM_PACKET_BENCH_ELEM 6
+
+Datum gp_interconnect_packet_bench(PG_FUNCTION_ARGS);
+
+PG_MODULE_MAGIC;
+PG_FUNCTION_INFO_V1(gp_interconnect_packet_bench);
+
+static const char *stepNames[IC_BENCH_NUM_STEPS] = {
+	"fill",
+	"add_crc",
+	"check_crc"
+};
+
+/*
+ * State kept across calls: the timings of all steps.
+ */
+typedef struct PacketBenchContext
+{
+	uint64		usecs[IC_BENCH_NUM_STEPS];
+	int			numPackets;
+	int			packetSize;
+	int			next;
+} PacketBenchContext;
+
+/*
+ * Function returning the time each step of the packet path takes for the
+ * given amount of data
+ */
+Datum
+gp_interconnect_packet_bench(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcctx;
+	PacketBenchContext *ctx;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		int32		packetSize = PG_GETARG_INT32(0);
+		int32		mbytes = PG_GETARG_INT32(1);
+		int64		numPackets;
+		MemoryContext oldcontext;
+		TupleDesc	tupdesc;
+
+		if (packetSize <= (int) sizeof(icpkthdr) || packetSize > MAX_PACKET_SIZE)
+			ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+							errmsg("packet_size must be between %d and %d bytes",
+								   (int) sizeof(icpkthdr) + 1, MAX_PACKET_SIZE)));
+
+		if (mbytes <= 0 || mbytes > 1024 * 1024)
+			ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+							errmsg("mbytes must be between 1 and %d", 1024 * 1024)));
+
+		numPackets = ((int64) mbytes * 1024 * 1024) / packetSize;
+		if (numPackets > INT_MAX)
+			ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+							errmsg("%d MB in packets of %d bytes is more than %d packets",
+								   mbytes, packetSize, INT_MAX)));
+
+		/* create a function context for cross-call persistence */
+		funcctx = SRF_FIRSTCALL_INIT();
+
+		/* Switch to memory context appropriate for multiple function calls */
+		oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+		/* Build a tuple descriptor for our result type. */
+		tupdesc = CreateTemplateTupleDesc(NUM_PACKET_BENCH_ELEM, false /* hasoid */);
+
+		TupleDescInitEntry(tupdesc, (AttrNumber) 1, "step",
+				TEXTOID, -1 /* typmod */, 0 /* attdim */);
+
+		TupleDescInitEntry(tupdesc, (AttrNumber) 2, "packets",
+				INT8OID, -1 /* typmod */, 0 /* attdim */);
+
+		TupleDescInitEntry(tupdesc, (AttrNumber) 3, "mbytes",
+				FLOAT8OID, -1 /* typmod */, 0 /* attdim */);
+
+		TupleDescInitEntry(tupdesc, (AttrNumber) 4, "usecs",
+				INT8OID, -1 /* typmod */, 0 /* attdim */);
+
+		TupleDescInitEntry(tupdesc, (AttrNumber) 5, "mb_per_sec",
+				FLOAT8OID, -1 /* typmod */, 0 /* attdim */);
+
+		TupleDescInitEntry(tupdesc, (AttrNumber) 6, "usecs_per_mb",
+				FLOAT8OID, -1 /* typmod */, 0 /* attdim */);
+
+		Assert(NUM_PACKET_BENCH_ELEM == 6);
+
+		funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+		ctx = (PacketBenchContext *) palloc0(sizeof(PacketBenchContext));
+		ctx->packetSize = packetSize;
+		ctx->numPackets = (int) numPackets;
+
+		benchmarkICPacketPath(ctx->packetSize, ctx->numPackets, ctx->usecs);
+
+		funcctx->user_fctx = ctx;
+
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+	ctx = (PacketBenchContext *) funcctx->user_fctx;
+
+	if (ctx->next < IC_BENCH_NUM_STEPS)
+	{
+		int			step = ctx->next++;
+		double		mb = (double) ctx->numPackets * ctx->packetSize / (1024.0 * 1024.0);
+		double		usecs = (double) ctx->usecs[step];
+		Datum		values[NUM_PACKET_BENCH_ELEM];
+		bool		nulls[NUM_PACKET_BENCH_ELEM];
+		HeapTuple	tuple;
+		Datum		result;
+
+		MemSet(nulls, 0, sizeof(nulls));
+
+		values[0] = CStringGetTextDatum(stepNames[step]);
+		values[1] = Int64GetDatum((int64) ctx->numPackets);
+		values[2] = Float8GetDatum(mb);
+		values[3] = Int64GetDatum((int64) ctx->usecs[step]);
+		values[4] = Float8GetDatum(mb * 1000000.0 / usecs);
+		nulls[4] = (usecs == 0);
+		values[5] = Float8GetDatum(usecs / mb);
+
+		tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+		result = HeapTupleGetDatum(tuple);
+		SRF_RETURN_NEXT(funcctx, result);
+	}
+
+	SRF_RETURN_DONE(funcctx);
+}
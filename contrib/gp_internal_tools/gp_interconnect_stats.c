@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2017 Pivotal Inc. All Rights Reserved
+ *
+ * ---------------------------------------------------------------------
+ *
+ * The dynamically linked library created from this source can be reference by
+ * creating a function in psql that references it. For example,
+ *
+ * CREATE FUNCTION gp_interconnect_peer_stats_f()
+ *	RETURNS SETOF record
+ *	AS '$libdir/gp_interconnect_stats', 'gp_interconnect_peer_stats'
+ *	LANGUAGE C IMMUTABLE;
+ */
+
+#include "postgres.h"
+#include "funcapi.h"
+#include "cdb/cdbvars.h"
+#include "cdb/ml_ipc.h"
+#include "utils/builtins.h"
+#include "miscadmin.h"
+
+/* The number of columns as defined in gp_interconnect_peer_stats view */
+#define NUM_PEER_STATS_ELEM 13
+
+Datum gp_interconnect_peer_stats(PG_FUNCTION_ARGS);
+
+PG_MODULE_MAGIC;
+PG_FUNCTION_INFO_V1(gp_interconnect_peer_stats);
+
+/*
+ * State kept across calls: a snapshot of the per-peer statistics.
+ */
+typedef struct PeerStatsContext
+{
+	ICPeerStats *stats;
+	int			numStats;
+	int			next;
+} PeerStatsContext;
+
+/*
+ * Function returning the UDP interconnect statistics of the peers this
+ * segment has sent to
+ */
+Datum
+gp_interconnect_peer_stats(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcctx;
+	PeerStatsContext *ctx;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		/* create a function context for cross-call persistence */
+		funcctx = SRF_FIRSTCALL_INIT();
+
+		/* Switch to memory context appropriate for multiple function calls */
+		MemoryContext oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+		/* Build a tuple descriptor for our result type. */
+		TupleDesc tupdesc = CreateTemplateTupleDesc(NUM_PEER_STATS_ELEM, false /* hasoid */);
+
+		TupleDescInitEntry(tupdesc, (AttrNumber) 1, "segid",
+				INT4OID, -1 /* typmod */, 0 /* attdim */);
+
+		TupleDescInitEntry(tupdesc, (AttrNumber) 2, "peer_segid",
+				INT4OID, -1 /* typmod */, 0 /* attdim */);
+
+		TupleDescInitEntry(tupdesc, (AttrNumber) 3, "cwnd",
+				FLOAT4OID, -1 /* typmod */, 0 /* attdim */);
+
+		TupleDescInitEntry(tupdesc, (AttrNumber) 4, "ssthresh",
+				FLOAT4OID, -1 /* typmod */, 0 /* attdim */);
+
+		TupleDescInitEntry(tupdesc, (AttrNumber) 5, "rtt_us",
+				INT8OID, -1 /* typmod */, 0 /* attdim */);
+
+		TupleDescInitEntry(tupdesc, (AttrNumber) 6, "min_rtt_us",
+				INT8OID, -1 /* typmod */, 0 /* attdim */);
+
+		TupleDescInitEntry(tupdesc, (AttrNumber) 7, "conns",
+				INT8OID, -1 /* typmod */, 0 /* attdim */);
+
+		TupleDescInitEntry(tupdesc, (AttrNumber) 8, "pkts_sent",
+				INT8OID, -1 /* typmod */, 0 /* attdim */);
+
+		TupleDescInitEntry(tupdesc, (AttrNumber) 9, "acks",
+				INT8OID, -1 /* typmod */, 0 /* attdim */);
+
+		TupleDescInitEntry(tupdesc, (AttrNumber) 10, "resent",
+				INT8OID, -1 /* typmod */, 0 /* attdim */);
+
+		TupleDescInitEntry(tupdesc, (AttrNumber) 11, "losses",
+				INT8OID, -1 /* typmod */, 0 /* attdim */);
+
+		TupleDescInitEntry(tupdesc, (AttrNumber) 12, "cwnd_cuts",
+				INT8OID, -1 /* typmod */, 0 /* attdim */);
+
+		TupleDescInitEntry(tupdesc, (AttrNumber) 13, "last_update",
+				TIMESTAMPTZOID, -1 /* typmod */, 0 /* attdim */);
+
+		Assert(NUM_PEER_STATS_ELEM == 13);
+
+		funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+		ctx = (PeerStatsContext *) palloc(sizeof(PeerStatsContext));
+		ctx->stats = (ICPeerStats *) palloc(IC_PEER_STATS_SLOTS * sizeof(ICPeerStats));
+		ctx->numStats = getICPeerStats(ctx->stats, IC_PEER_STATS_SLOTS);
+		ctx->next = 0;
+
+		funcctx->user_fctx = ctx;
+
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+	ctx = (PeerStatsContext *) funcctx->user_fctx;
+
+	if (ctx->next < ctx->numStats)
+	{
+		ICPeerStats *peer = &ctx->stats[ctx->next++];
+		Datum		values[NUM_PEER_STATS_ELEM];
+		bool		nulls[NUM_PEER_STATS_ELEM];
+		MemSet(nulls, 0, sizeof(nulls));
+
+		values[0] = Int32GetDatum(Gp_segment);
+		values[1] = Int32GetDatum(peer->contentId);
+		values[2] = Float4GetDatum(peer->cwnd);
+		values[3] = Float4GetDatum(peer->ssthresh);
+		values[4] = Int64GetDatum((int64) peer->rtt);
+		values[5] = Int64GetDatum((int64) peer->minRtt);
+		nulls[5] = (peer->minRtt == ~((uint64) 0));
+		values[6] = Int64GetDatum((int64) peer->numConns);
+		values[7] = Int64GetDatum((int64) peer->pktsSent);
+		values[8] = Int64GetDatum((int64) peer->acks);
+		values[9] = Int64GetDatum((int64) peer->resent);
+		values[10] = Int64GetDatum((int64) peer->losses);
+		values[11] = Int64GetDatum((int64) peer->cwndCuts);
+		values[12] = TimestampTzGetDatum(peer->lastUpdate);
+
+		HeapTuple tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+		Datum result = HeapTupleGetDatum(tuple);
+		SRF_RETURN_NEXT(funcctx, result);
+	}
+
+	SRF_RETURN_DONE(funcctx);
+}
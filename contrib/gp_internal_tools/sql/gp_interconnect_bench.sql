@@ -0,0 +1,45 @@
+--
+-- gp_interconnect_packet_bench(), the per-packet CPU work of the UDP
+-- interconnect.  The timings vary from run to run, so only the amount of
+-- work done is shown.
+--
+CREATE FUNCTION gp_interconnect_packet_bench(packet_size int4, mbytes int4)
+	RETURNS SETOF record
+	AS '$libdir/gp_interconnect_bench', 'gp_interconnect_packet_bench'
+	LANGUAGE C VOLATILE STRICT;
+
+SELECT step, packets, mbytes, usecs >= 0 AS timed
+  FROM gp_interconnect_packet_bench(8192, 1)
+  AS b(step text, packets int8, mbytes float8, usecs int8,
+       mb_per_sec float8, usecs_per_mb float8);
+
+-- the smallest packet that has a payload
+SELECT step, packets, usecs >= 0 AS timed
+  FROM gp_interconnect_packet_bench(65, 1)
+  AS b(step text, packets int8, mbytes float8, usecs int8,
+       mb_per_sec float8, usecs_per_mb float8);
+
+-- out of range arguments
+SELECT count(*)
+  FROM gp_interconnect_packet_bench(64, 1)
+  AS b(step text, packets int8, mbytes float8, usecs int8,
+       mb_per_sec float8, usecs_per_mb float8);
+SELECT count(*)
+  FROM gp_interconnect_packet_bench(-1, 1)
+  AS b(step text, packets int8, mbytes float8, usecs int8,
+       mb_per_sec float8, usecs_per_mb float8);
+SELECT count(*)
+  FROM gp_interconnect_packet_bench(65508, 1)
+  AS b(step text, packets int8, mbytes float8, usecs int8,
+       mb_per_sec float8, usecs_per_mb float8);
+SELECT count(*)
+  FROM gp_interconnect_packet_bench(8192, 0)
+  AS b(step text, packets int8, mbytes float8, usecs int8,
+       mb_per_sec float8, usecs_per_mb float8);
+-- more packets than an int can count
+SELECT count(*)
+  FROM gp_interconnect_packet_bench(65, 1048576)
+  AS b(step text, packets int8, mbytes float8, usecs int8,
+       mb_per_sec float8, usecs_per_mb float8);
+
+DROP FUNCTION gp_interconnect_packet_bench(int4, int4);
@@ -7,6 +7,7 @@
 //---------------------------------------------------------------------------
 
 #include <sys/stat.h>
+#include "gpopt/utils/CBinaryDXL.h"
 #include "gpopt/utils/CCatalogUtils.h"
 #include "gpopt/utils/COptTasks.h"
 #include "gpopt/mdcache/CMDCache.h"
@@ -47,6 +48,10 @@ Datum DumpCatalogDXL(PG_FUNCTION_ARGS);
 Datum DumpRelStatsDXL(PG_FUNCTION_ARGS);
 Datum DumpMDCastDXL(PG_FUNCTION_ARGS);
 Datum DumpMDScCmpDXL(PG_FUNCTION_ARGS);
+Datum DumpMDObjBinaryDXL(PG_FUNCTION_ARGS);
+Datum DumpCatalogBinaryDXL(PG_FUNCTION_ARGS);
+Datum EncodeDXLFile(PG_FUNCTION_ARGS);
+Datum DecodeDXLFile(PG_FUNCTION_ARGS);
 
 PG_FUNCTION_INFO_V1(DumpPlan);
 PG_FUNCTION_INFO_V1(RestorePlan);
@@ -59,6 +64,10 @@ PG_FUNCTION_INFO_V1(DumpCatalogDXL);
 PG_FUNCTION_INFO_V1(DumpRelStatsDXL);
 PG_FUNCTION_INFO_V1(DumpMDCastDXL);
 PG_FUNCTION_INFO_V1(DumpMDScCmpDXL);
+PG_FUNCTION_INFO_V1(DumpMDObjBinaryDXL);
+PG_FUNCTION_INFO_V1(DumpCatalogBinaryDXL);
+PG_FUNCTION_INFO_V1(EncodeDXLFile);
+PG_FUNCTION_INFO_V1(DecodeDXLFile);
 
 Datum DumpQuery(PG_FUNCTION_ARGS);
 Datum RestoreQuery(PG_FUNCTION_ARGS);
@@ -770,6 +779,127 @@ DumpCatalogDXL(PG_FUNCTION_ARGS)
 }
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		DumpMDObjBinaryDXL
+//
+//	@doc:
+//		Dump relcache info about a catalog object in binary DXL
+// 		Input: object oid
+// 		Output: cache object in binary DXL
+//
+//---------------------------------------------------------------------------
+
+extern "C" {
+Datum
+DumpMDObjBinaryDXL(PG_FUNCTION_ARGS)
+{
+	Oid oid = gpdb::OidFromDatum(PG_GETARG_DATUM(0));
+
+	char *szDXL = COptTasks::SzMDObjs(ListMake1Oid(oid));
+
+	if (NULL == szDXL)
+	{
+		elog(ERROR, "Error dumping MD object");
+	}
+
+	uint32 ulLen = 0;
+	char *pcBinary = CBinaryDXL::PcEncode(szDXL, strlen(szDXL), &ulLen);
+	gpdb::GPDBFree(szDXL);
+
+	bytea *pbResult = (bytea *) palloc(VARHDRSZ + ulLen);
+	SET_VARSIZE(pbResult, VARHDRSZ + ulLen);
+	memcpy(VARDATA(pbResult), pcBinary, ulLen);
+	pfree(pcBinary);
+
+	PG_RETURN_BYTEA_P(pbResult);
+}
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		DumpCatalogBinaryDXL
+//
+//	@doc:
+//		Dump entire catalog into a binary DXL file
+//
+//---------------------------------------------------------------------------
+
+extern "C" {
+Datum
+DumpCatalogBinaryDXL(PG_FUNCTION_ARGS)
+{
+	char *szFilename = text_to_cstring(PG_GETARG_TEXT_P(0));
+	List *plAllOids = CCatalogUtils::PlAllOids();
+
+	COptTasks::DumpMDObjs(plAllOids, szFilename, true /*fBinary*/);
+
+	PG_RETURN_INT32(0);
+}
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		EncodeDXLFile
+//
+//	@doc:
+//		Convert a DXL file, such as a minidump, to binary DXL. Returns the
+//		size of the binary file.
+//		Input: source and destination file names
+//
+//---------------------------------------------------------------------------
+
+extern "C" {
+Datum
+EncodeDXLFile(PG_FUNCTION_ARGS)
+{
+	char *szSrcFilename = text_to_cstring(PG_GETARG_TEXT_P(0));
+	char *szDestFilename = text_to_cstring(PG_GETARG_TEXT_P(1));
+
+	uint32 ulXMLLen = 0;
+	char *szXML = CBinaryDXL::PcReadFile(szSrcFilename, &ulXMLLen);
+	if (CBinaryDXL::FBinaryDXL(szXML, ulXMLLen))
+	{
+		elog(ERROR, "File \"%s\" is already in binary DXL format", szSrcFilename);
+	}
+
+	uint32 ulLen = 0;
+	char *pcBinary = CBinaryDXL::PcEncode(szXML, ulXMLLen, &ulLen);
+	CBinaryDXL::WriteFile(szDestFilename, pcBinary, ulLen);
+
+	PG_RETURN_INT32((int32) ulLen);
+}
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		DecodeDXLFile
+//
+//	@doc:
+//		Convert a binary DXL file back to DXL. Returns the size of the DXL
+//		file.
+//		Input: source and destination file names
+//
+//---------------------------------------------------------------------------
+
+extern "C" {
+Datum
+DecodeDXLFile(PG_FUNCTION_ARGS)
+{
+	char *szSrcFilename = text_to_cstring(PG_GETARG_TEXT_P(0));
+	char *szDestFilename = text_to_cstring(PG_GETARG_TEXT_P(1));
+
+	uint32 ulLen = 0;
+	char *pcBinary = CBinaryDXL::PcReadFile(szSrcFilename, &ulLen);
+	char *szXML = CBinaryDXL::SzDecode(pcBinary, ulLen);
+
+	uint32 ulXMLLen = strlen(szXML);
+	CBinaryDXL::WriteFile(szDestFilename, szXML, ulXMLLen);
+
+	PG_RETURN_INT32((int32) ulXMLLen);
+}
+}
+
 //---------------------------------------------------------------------------
 //	@function:
 //		extractFrozenQueryPlanAndExecute
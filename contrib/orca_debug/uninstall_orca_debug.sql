@@ -18,6 +18,10 @@ drop function gpoptutils.DumpCatalogDXL(text);
 drop function gpoptutils.DumpRelStatsDXL(Oid);
 drop function gpoptutils.DumpMDCastDXL(Oid, Oid);
 drop function gpoptutils.DumpMDScCmpDXL(Oid, Oid, text);
+drop function gpoptutils.DumpMDObjBinaryDXL(Oid);
+drop function gpoptutils.DumpCatalogBinaryDXL(text);
+drop function gpoptutils.EncodeDXLFile(text, text);
+drop function gpoptutils.DecodeDXLFile(text, text);
 
 --drop function gpoptutils.EvalExprFromDXLFile(text) returns text as 'MODULE_PATHNAME', 'EvalExprFromDXLFile';
 --drop function gpoptutils.OptimizeMinidumpFromFile(text) returns text as 'MODULE_PATHNAME', 'OptimizeMinidumpFromFile';
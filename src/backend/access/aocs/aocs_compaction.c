@@ -269,14 +269,22 @@ AOCSMoveTuple(TupleTableSlot	*slot,
 /*
  * Assumes that the segment file lock is already held.
  * Assumes that the segment file should be compacted.
+ *
+ * If maxMovedTuples is not negative, at most that many live tuples are
+ * moved and hidden, and the segment file is kept (see
+ * AppendOnlyCompaction_GetMaxMovedTuples).
  */
 static bool
 AOCSSegmentFileFullCompaction(Relation aorel, 
 		AOCSInsertDesc insertDesc,
-		AOCSFileSegInfo* fsinfo)
+		AOCSFileSegInfo* fsinfo,
+		int64 maxMovedTuples)
 {
 	const char* relname;
 	AppendOnlyVisimap visiMap;
+	AppendOnlyVisimapDelete visiMapDelete;
+	bool isPartial = (maxMovedTuples >= 0);
+	int64 startRowNum = 0;
 	AOCSScanDesc scanDesc;
 	TupleDesc tupDesc;
 	TupleTableSlot	*slot;
@@ -312,6 +320,17 @@ AOCSSegmentFileFullCompaction(Relation aorel,
 			LOG, "Compact AO segfile %d, relation %sd", 
 			compact_segno, relname);
 
+	/*
+	 * The rows earlier partial compactions moved are all hidden; start
+	 * after them.
+	 */
+	if (isPartial)
+	{
+		startRowNum = AppendOnlyVisimap_GetFirstUnhiddenRowNum(&visiMap,
+				compact_segno);
+		AppendOnlyVisimapDelete_Init(&visiMapDelete, &visiMap);
+	}
+
 	proj = palloc0(sizeof(bool) * RelationGetNumberOfAttributes(aorel));
 	for(i=0; i< RelationGetNumberOfAttributes(aorel); ++i)
 	{
@@ -320,6 +339,7 @@ AOCSSegmentFileFullCompaction(Relation aorel,
 	scanDesc = aocs_beginrangescan(aorel,
 			SnapshotNow, SnapshotNow,
 			&compact_segno, 1, NULL, proj);
+	scanDesc->startRowNum = startRowNum;
 
 	tupDesc = RelationGetDescr(aorel);
 	slot = MakeSingleTupleTableSlot(tupDesc);
@@ -347,14 +367,23 @@ AOCSSegmentFileFullCompaction(Relation aorel,
 		aoTupleId = (AOTupleId*)slot_get_ctid(slot);
 		if (AppendOnlyVisimap_IsVisible(&scanDesc->visibilityMap, aoTupleId))
 		{
+			if (isPartial && movedTupleCount >= maxMovedTuples)
+				break;
+
 			AOCSMoveTuple(	
 				slot,	
 				insertDesc,
 				resultRelInfo,
 				estate);
 			movedTupleCount++;
+
+			if (isPartial &&
+				AppendOnlyVisimapDelete_Hide(&visiMapDelete, aoTupleId) != HeapTupleMayBeUpdated)
+				elog(ERROR, "could not hide moved tuple (%d," INT64_FORMAT ") of relation %s",
+					 AOTupleIdGet_segmentFileNum(aoTupleId),
+					 AOTupleIdGet_rowNum(aoTupleId), relname);
 		}
-		else
+		else if (!isPartial)
 		{
 			MemTuple tuple = TupGetMemTuple(slot);
 			/* Tuple is invisible and needs to be dropped */
@@ -377,25 +406,38 @@ AOCSSegmentFileFullCompaction(Relation aorel,
 
 	}
 
-	SetAOCSFileSegInfoState(aorel, compact_segno,
-			AOSEG_STATE_AWAITING_DROP);
-
-	AppendOnlyVisimap_DeleteSegmentFile(&visiMap,
-			compact_segno);
-
-	/* Delete all mini pages of the segment files if block directory exists */
-	if (OidIsValid(aorel->rd_appendonly->blkdirrelid))
+	if (isPartial)
 	{
-		AppendOnlyBlockDirectory_DeleteSegmentFile(aorel,
-			SnapshotNow,
-			compact_segno,
-			0);
+		/* The segment file stays; the next vacuum continues with it */
+		AppendOnlyVisimapDelete_Finish(&visiMapDelete);
+
+		elogif (Debug_appendonly_print_compaction, LOG, 
+			"Finished incremental compaction: "
+			"AO segfile %d, relation %s, moved tuple count " INT64_FORMAT, 
+			compact_segno, relname, movedTupleCount);
 	}
+	else
+	{
+		SetAOCSFileSegInfoState(aorel, compact_segno,
+				AOSEG_STATE_AWAITING_DROP);
 
-	elogif (Debug_appendonly_print_compaction, LOG, 
-		"Finished compaction: "
-		"AO segfile %d, relation %s, moved tuple count " INT64_FORMAT, 
-		compact_segno, relname, movedTupleCount);
+		AppendOnlyVisimap_DeleteSegmentFile(&visiMap,
+				compact_segno);
+
+		/* Delete all mini pages of the segment files if block directory exists */
+		if (OidIsValid(aorel->rd_appendonly->blkdirrelid))
+		{
+			AppendOnlyBlockDirectory_DeleteSegmentFile(aorel,
+				SnapshotNow,
+				compact_segno,
+				0);
+		}
+
+		elogif (Debug_appendonly_print_compaction, LOG, 
+			"Finished compaction: "
+			"AO segfile %d, relation %s, moved tuple count " INT64_FORMAT, 
+			compact_segno, relname, movedTupleCount);
+	}
  
 	AppendOnlyVisimap_Finish(&visiMap, NoLock);
 
@@ -584,7 +626,16 @@ AOCSCompact(Relation aorel,
 		if (AppendOnlyCompaction_ShouldCompact(aorel,
 				fsinfo->segno, fsinfo->total_tupcount,isFull))
 		{
-			AOCSSegmentFileFullCompaction(aorel, insertDesc, fsinfo);
+			int64		segmentTotalBytes = 0;
+			int			col;
+
+			for (col = 0; col < fsinfo->vpinfo.nEntry; col++)
+				segmentTotalBytes += fsinfo->vpinfo.entry[col].eof;
+
+			AOCSSegmentFileFullCompaction(aorel, insertDesc, fsinfo,
+				AppendOnlyCompaction_GetMaxMovedTuples(aorel,
+					fsinfo->segno, fsinfo->total_tupcount,
+					segmentTotalBytes, isFull));
 		} 
 		else
 		{
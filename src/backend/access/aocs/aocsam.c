@@ -8,6 +8,7 @@
 
 #include "access/aocssegfiles.h"
 #include "access/aomd.h"
+#include "access/appendonly_zonemap.h"
 #include "access/appendonlytid.h"
 #include "access/appendonlywriter.h"
 #include "access/heapam.h"
@@ -38,6 +39,7 @@
 #include "utils/datumstream.h"
 #include "utils/debugbreak.h"
 #include "utils/faultinjector.h"
+#include "utils/fmgroids.h"
 #include "utils/guc.h"
 #include "utils/inval.h"
 #include "utils/lsyscache.h"
@@ -340,6 +342,32 @@ open_next_scan_seg(AOCSScanDesc scan)
 												  scan->num_proj_atts,
 												  scan->blockDirectory);
 
+				/*
+				 * Check visibility against the segment file's hidden rows
+				 * in memory.
+				 */
+				if (gp_appendonly_visimap_preload &&
+					scan->snapshot != SnapshotAny)
+					AppendOnlyVisimap_LoadSegmentFile(&scan->visibilityMap,
+													  curSegInfo->segno);
+
+				/* Find the rows of the segment file the zones refute */
+				scan->zoneNextRowNum = 0;
+				if (scan->zoneFilter != NULL && scan->blockDirectory == NULL &&
+					scan->num_proj_atts > 0)
+				{
+					AppendOnlyZoneFilter_BeginSegment(scan->zoneFilter,
+													  scan->aos_rel,
+													  scan->appendOnlyMetaDataSnapshot,
+													  curSegInfo->segno,
+													  0,
+													  &curSegInfo->vpinfo);
+					scan->zoneNextRowNum = 1;
+				}
+				else if (scan->startRowNum > 1 && scan->blockDirectory == NULL &&
+						 scan->num_proj_atts > 0)
+					scan->zoneNextRowNum = 1;
+
 				return scan->cur_seg;
 			}
 		}
@@ -367,6 +395,73 @@ close_cur_scan_seg(AOCSScanDesc scan)
 		AppendOnlyBlockDirectory_End_forInsert(scan->blockDirectory);
 }
 
+/*
+ * Position the projected columns past the rows of the current segment file
+ * that come before startRowNum or that the zone filter refutes, if the next
+ * row is one.  Columns marked in lazy, if given, are left alone.
+ *
+ * Returns false if no rows are left in the segment file.
+ */
+static bool
+skip_refuted_rows(AOCSScanDesc scan, bool *lazy)
+{
+	int64		targetRowNum;
+	int64		reachedRowNum;
+	int64		blocksSkipped = 0;
+	int			i;
+
+	if (scan->zoneNextRowNum <= 0)
+		return true;
+
+	targetRowNum = Max(scan->zoneNextRowNum, scan->startRowNum);
+	if (scan->zoneFilter != NULL)
+	{
+		blocksSkipped = scan->zoneFilter->blocksSkipped;
+		targetRowNum = AppendOnlyZoneFilter_NextLiveRow(scan->zoneFilter,
+														targetRowNum);
+	}
+	if (targetRowNum == scan->zoneNextRowNum)
+		return true;
+
+	reachedRowNum = -1;
+	for (i = 0; i < scan->num_proj_atts; i++)
+	{
+		int			attno = scan->proj_atts[i];
+		int			skipped;
+		int64		rowNum;
+
+		if (lazy != NULL && lazy[attno])
+			continue;
+
+		skipped = datumstreamread_skip_to(scan->ds[attno], targetRowNum, &rowNum);
+		if (skipped < 0)
+			return false;
+
+		/* All columns must be at the same row */
+		if (reachedRowNum < 0)
+			reachedRowNum = rowNum;
+		else if (rowNum != reachedRowNum)
+			elog(ERROR, "column %d of segment file %d of relation \"%s\" is at row " INT64_FORMAT " instead of " INT64_FORMAT,
+				 attno + 1, scan->seginfo[scan->cur_seg]->segno,
+				 RelationGetRelationName(scan->aos_rel),
+				 rowNum, reachedRowNum);
+
+		/* Count the blocks of one column */
+		if (scan->zoneFilter != NULL &&
+			skipped > scan->zoneFilter->blocksSkipped - blocksSkipped)
+			scan->zoneFilter->blocksSkipped = blocksSkipped + skipped;
+	}
+
+	/* only lazy columns, which are positioned by row number later */
+	if (reachedRowNum < 0)
+		reachedRowNum = targetRowNum;
+
+	scan->cur_seg_row += reachedRowNum - scan->zoneNextRowNum;
+	scan->zoneNextRowNum = reachedRowNum;
+
+	return true;
+}
+
 /*
  * aocs_beginrangescan
  *
@@ -518,6 +613,14 @@ aocs_endscan(AOCSScanDesc scan)
 	pfree(scan->proj_atts);
 	pfree(scan->ds);
 
+	if (scan->eqFilters != NULL)
+	{
+		for (i = 0; i < scan->numEqFilters; i++)
+			pfree(scan->eqFilters[i].data);
+		pfree(scan->eqFilters);
+		pfree(scan->eqFilterCols);
+	}
+
 	for (i = 0; i < scan->total_seg; ++i)
 	{
 		if (scan->seginfo[i])
@@ -570,6 +673,14 @@ ReadNext:
 
 		Assert(scan->cur_seg >= 0);
 
+		/* Skip the rows whose zones refute a qual of the scan */
+		if (!skip_refuted_rows(scan, NULL))
+		{
+			close_cur_scan_seg(scan);
+			err = -1;
+			goto ReadNext;
+		}
+
 		/* Read from cur_seg */
 		for (i = 0; i < scan->num_proj_atts; i++)
 		{
@@ -613,6 +724,11 @@ ReadNext:
 									 scan->seginfo[scan->cur_seg]->segno);
 
 		scan->cur_seg_row++;
+
+		/* Without row numbers, the zones cannot be used for the segment file */
+		if (scan->zoneNextRowNum > 0)
+			scan->zoneNextRowNum = (rowNum == INT64CONST(-1) ? 0 : rowNum + 1);
+
 		if (rowNum == INT64CONST(-1))
 		{
 			AOTupleIdInit_rowNum(&aoTupleId, scan->cur_seg_row);
@@ -638,6 +754,567 @@ ReadNext:
 	return;
 }
 
+/*
+ * aocs_add_equality_filter
+ *
+ * Have aocs_getnextbatch check a clause of the scan's qual, if it is a
+ * "column = constant" clause that can be checked on the bytes of the
+ * values, and so on dictionary codes.  Rows for which the clause is not
+ * true are left out of the batches.
+ *
+ * Returns true if the scan checks the clause, which the caller then need
+ * not check.  Must be called before aocs_create_batch.
+ */
+bool
+aocs_add_equality_filter(AOCSScanDesc scan, Node *clause, Index scanrelid)
+{
+	TupleDesc	tupdesc = scan->relationTupleDesc;
+	OpExpr	   *opexpr;
+	Node	   *left;
+	Node	   *right;
+	Var		   *var;
+	Const	   *con;
+	Oid			opfuncid;
+	struct varlena *value;
+	AOCSEqualityFilter *filter;
+
+	if (!IsA(clause, OpExpr) ||
+		list_length(((OpExpr *) clause)->args) != 2)
+		return false;
+	opexpr = (OpExpr *) clause;
+
+	opfuncid = opexpr->opfuncid;
+	if (!OidIsValid(opfuncid))
+		opfuncid = get_opcode(opexpr->opno);
+	if (opfuncid != F_TEXTEQ && opfuncid != F_BYTEAEQ)
+		return false;
+
+	/* varchar columns are compared as text */
+	left = linitial(opexpr->args);
+	right = lsecond(opexpr->args);
+	if (IsA(left, RelabelType))
+		left = (Node *) ((RelabelType *) left)->arg;
+	if (IsA(right, RelabelType))
+		right = (Node *) ((RelabelType *) right)->arg;
+
+	if (IsA(left, Var) && IsA(right, Const))
+	{
+		var = (Var *) left;
+		con = (Const *) right;
+	}
+	else if (IsA(left, Const) && IsA(right, Var))
+	{
+		var = (Var *) right;
+		con = (Const *) left;
+	}
+	else
+		return false;
+
+	if (var->varno != scanrelid || var->varlevelsup != 0 ||
+		var->varattno <= 0 || var->varattno > tupdesc->natts ||
+		tupdesc->attrs[var->varattno - 1]->attlen != -1)
+		return false;
+
+	/* The clause is never true; leave that to the qual */
+	if (con->constisnull)
+		return false;
+
+	if (scan->eqFilters == NULL)
+	{
+		scan->eqFilters = palloc(sizeof(AOCSEqualityFilter));
+		scan->eqFilterCols = palloc0(tupdesc->natts * sizeof(bool));
+	}
+	else
+		scan->eqFilters = repalloc(scan->eqFilters,
+								   (scan->numEqFilters + 1) * sizeof(AOCSEqualityFilter));
+
+	value = pg_detoast_datum_packed((struct varlena *) DatumGetPointer(con->constvalue));
+
+	filter = &scan->eqFilters[scan->numEqFilters++];
+	filter->attno = var->varattno - 1;
+	filter->len = VARSIZE_ANY_EXHDR(value);
+	filter->data = palloc(filter->len + 1);
+	memcpy(filter->data, VARDATA_ANY(value), filter->len);
+	filter->blockSeg = -1;
+	filter->blockFileOffset = INT64CONST(-1);
+	filter->blockHasDict = false;
+	filter->blockCode = -1;
+
+	if ((Pointer) value != DatumGetPointer(con->constvalue))
+		pfree(value);
+
+	scan->eqFilterCols[filter->attno] = true;
+
+	return true;
+}
+
+/*
+ * Leave out of the batch the rows whose value of column attno, just
+ * decoded, is not equal to the constants of the equality filters on it.
+ */
+static void
+apply_equality_filters(AOCSScanDesc scan, AOCSBatch batch, int attno, int nrows)
+{
+	DatumStreamRead *ds = scan->ds[attno];
+	Datum	   *values = batch->values[attno];
+	bool	   *nulls = batch->nulls[attno];
+	int			f;
+	int			row;
+
+	for (f = 0; f < scan->numEqFilters; f++)
+	{
+		AOCSEqualityFilter *filter = &scan->eqFilters[f];
+
+		if (filter->attno != attno)
+			continue;
+
+		/*
+		 * A batch never extends past the current block of a column, so the
+		 * rows just decoded are all in it.  Look the constant up in its
+		 * dictionary, unless it was for the previous batch.
+		 */
+		if (filter->blockSeg != scan->cur_seg ||
+			filter->blockFileOffset != ds->blockFileOffset)
+		{
+			filter->blockSeg = scan->cur_seg;
+			filter->blockFileOffset = ds->blockFileOffset;
+			filter->blockHasDict = datumstreamread_dict_lookup(ds, filter->data,
+															   filter->len,
+															   &filter->blockCode);
+		}
+
+		if (filter->blockHasDict)
+		{
+			for (row = 0; row < nrows; row++)
+			{
+				if (nulls[row] || batch->codes[row] != filter->blockCode)
+					batch->refuted[row] = true;
+			}
+			continue;
+		}
+
+		for (row = 0; row < nrows; row++)
+		{
+			struct varlena *value;
+
+			if (batch->refuted[row])
+				continue;
+			if (nulls[row])
+			{
+				batch->refuted[row] = true;
+				continue;
+			}
+
+			value = pg_detoast_datum_packed((struct varlena *) DatumGetPointer(values[row]));
+			if (VARSIZE_ANY_EXHDR(value) != filter->len ||
+				memcmp(VARDATA_ANY(value), filter->data, filter->len) != 0)
+				batch->refuted[row] = true;
+
+			if ((Pointer) value != DatumGetPointer(values[row]))
+				pfree(value);
+		}
+	}
+}
+
+/*
+ * aocs_create_batch
+ *
+ * Allocate a batch of up to maxRows rows for the projected columns of the
+ * scan.
+ */
+AOCSBatch
+aocs_create_batch(AOCSScanDesc scan, int maxRows, bool *lazy)
+{
+	AOCSBatch	batch;
+	int			natts = scan->relationTupleDesc->natts;
+	int			i;
+
+	Assert(maxRows > 0);
+
+	batch = palloc0(sizeof(AOCSBatchData));
+	batch->maxRows = maxRows;
+	if (lazy != NULL)
+	{
+		batch->lazy = palloc(natts * sizeof(bool));
+		memcpy(batch->lazy, lazy, natts * sizeof(bool));
+		batch->lazyNext = palloc0(natts * sizeof(int));
+	}
+	batch->sel = palloc(maxRows * sizeof(int));
+	batch->rowNums = palloc(maxRows * sizeof(int64));
+	batch->values = palloc0(natts * sizeof(Datum *));
+	batch->nulls = palloc0(natts * sizeof(bool *));
+	if (scan->numEqFilters > 0)
+	{
+		batch->refuted = palloc(maxRows * sizeof(bool));
+		batch->codes = palloc(maxRows * sizeof(int));
+	}
+
+	for (i = 0; i < scan->num_proj_atts; i++)
+	{
+		int			attno = scan->proj_atts[i];
+
+		batch->values[attno] = palloc(maxRows * sizeof(Datum));
+		batch->nulls[attno] = palloc(maxRows * sizeof(bool));
+	}
+
+	return batch;
+}
+
+void
+aocs_destroy_batch(AOCSScanDesc scan, AOCSBatch batch)
+{
+	int			i;
+
+	for (i = 0; i < scan->num_proj_atts; i++)
+	{
+		int			attno = scan->proj_atts[i];
+
+		pfree(batch->values[attno]);
+		pfree(batch->nulls[attno]);
+	}
+
+	if (batch->lazy != NULL)
+	{
+		pfree(batch->lazy);
+		pfree(batch->lazyNext);
+	}
+	if (batch->refuted != NULL)
+	{
+		pfree(batch->refuted);
+		pfree(batch->codes);
+	}
+	pfree(batch->values);
+	pfree(batch->nulls);
+	pfree(batch->rowNums);
+	pfree(batch->sel);
+	pfree(batch);
+}
+
+/*
+ * aocs_getnextbatch
+ *
+ * Read the next batch of rows, one column at a time.  A batch never
+ * extends past the current block of any projected column, so that the
+ * values of each column are decoded in one tight loop over a block.
+ *
+ * Returns false at the end of the scan.
+ */
+bool
+aocs_getnextbatch(AOCSScanDesc scan, AOCSBatch batch)
+{
+	bool		isSnapshotAny = (scan->snapshot == SnapshotAny);
+	bool		needNextSeg = (scan->cur_seg < 0);
+
+	Assert(scan->num_proj_atts > 0);
+
+	batch->nrows = 0;
+	batch->nsel = 0;
+	batch->next = 0;
+	if (batch->lazy != NULL)
+		memset(batch->lazyNext, 0,
+			   scan->relationTupleDesc->natts * sizeof(int));
+
+	while (true)
+	{
+		int			nrows = batch->maxRows;
+		int64		firstRowNum = INT64CONST(-1);
+		int			row;
+		int			i;
+
+		bool	   *lazy;
+		bool		eof = false;
+		bool		allVisible;
+
+		if (needNextSeg)
+		{
+			if (open_next_scan_seg(scan) < 0)
+			{
+				/* No more seg, we are at the end */
+				scan->cur_seg = -1;
+				return false;
+			}
+			scan->cur_seg_row = 0;
+			batch->lazySeg = (batch->lazy != NULL);
+			needNextSeg = false;
+		}
+		lazy = (batch->lazySeg ? batch->lazy : NULL);
+
+		/* Skip the rows whose zones refute a qual of the scan */
+		if (!skip_refuted_rows(scan, lazy))
+		{
+			close_cur_scan_seg(scan);
+			needNextSeg = true;
+			continue;
+		}
+
+		/*
+		 * Make sure every column to decode has rows left in its current
+		 * block, and fit the batch in the fewest of them.
+		 */
+		for (i = 0; i < scan->num_proj_atts; i++)
+		{
+			int			attno = scan->proj_atts[i];
+			DatumStreamRead *ds = scan->ds[attno];
+			int			left;
+
+			if (lazy != NULL && lazy[attno])
+				continue;
+
+			left = datumstreamread_rows_left(ds);
+			if (left == 0)
+			{
+				if (datumstreamread_block(ds, scan->blockDirectory, attno) < 0)
+				{
+					eof = true;
+					break;
+				}
+				left = datumstreamread_rows_left(ds);
+			}
+
+			/*
+			 * Lazy columns are found by row number, which blocks written
+			 * before 4.0 do not have.  Such blocks come first in a segment
+			 * file, so no lazy column has been read yet.
+			 */
+			if (lazy != NULL && ds->getBlockInfo.firstRow < 0)
+			{
+				if (scan->cur_seg_row > 0)
+					elog(ERROR, "block without first row number after blocks with one in segment file %d of relation \"%s\"",
+						 scan->seginfo[scan->cur_seg]->segno,
+						 RelationGetRelationName(scan->aos_rel));
+				batch->lazySeg = false;
+				lazy = NULL;
+				nrows = batch->maxRows;
+				i = -1;
+				continue;
+			}
+
+			nrows = Min(nrows, left);
+		}
+
+		if (eof || nrows == 0)
+		{
+			close_cur_scan_seg(scan);
+			needNextSeg = true;
+			continue;
+		}
+
+		/* Decode the rows, column by column */
+		if (batch->refuted != NULL)
+			memset(batch->refuted, 0, nrows * sizeof(bool));
+
+		for (i = 0; i < scan->num_proj_atts; i++)
+		{
+			int			attno = scan->proj_atts[i];
+			DatumStreamRead *ds = scan->ds[attno];
+			Datum	   *values = batch->values[attno];
+			bool	   *nulls = batch->nulls[attno];
+
+			if (lazy != NULL && lazy[attno])
+				continue;
+
+			if (batch->refuted != NULL && scan->eqFilterCols[attno])
+			{
+				/* Keep the dictionary codes too, to filter the rows on */
+				for (row = 0; row < nrows; row++)
+				{
+					datumstreamread_advance(ds);
+					datumstreamread_get(ds, &values[row], &nulls[row]);
+					batch->codes[row] = datumstreamread_dict_code(ds);
+				}
+				apply_equality_filters(scan, batch, attno, nrows);
+			}
+			else
+			{
+				for (row = 0; row < nrows; row++)
+				{
+					datumstreamread_advance(ds);
+					datumstreamread_get(ds, &values[row], &nulls[row]);
+				}
+			}
+
+			if (firstRowNum == INT64CONST(-1) &&
+				ds->blockFirstRowNum != INT64CONST(-1))
+			{
+				Assert(ds->blockFirstRowNum > 0);
+				firstRowNum = ds->blockFirstRowNum +
+					datumstreamread_nth(ds) - (nrows - 1);
+			}
+		}
+
+		/* Number the rows, and select the visible ones */
+		batch->segno = scan->seginfo[scan->cur_seg]->segno;
+		batch->nrows = nrows;
+		allVisible = isSnapshotAny ||
+			AppendOnlyVisimap_IsRangeVisible(&scan->visibilityMap,
+											 batch->segno,
+											 (firstRowNum == INT64CONST(-1) ?
+											  scan->cur_seg_row + 1 : firstRowNum),
+											 nrows);
+		for (row = 0; row < nrows; row++)
+		{
+			int64		rowNum;
+
+			if (firstRowNum == INT64CONST(-1))
+				rowNum = scan->cur_seg_row + 1 + row;
+			else
+				rowNum = firstRowNum + row;
+			batch->rowNums[row] = rowNum;
+
+			if (batch->refuted != NULL && batch->refuted[row])
+				continue;
+
+			if (!allVisible)
+			{
+				AOTupleId	aoTupleId;
+
+				AOTupleIdInit_Init(&aoTupleId);
+				AOTupleIdInit_segmentFileNum(&aoTupleId, batch->segno);
+				AOTupleIdInit_rowNum(&aoTupleId, rowNum);
+
+				if (!AppendOnlyVisimap_IsVisible(&scan->visibilityMap, &aoTupleId))
+					continue;
+			}
+
+			batch->sel[batch->nsel++] = row;
+		}
+
+		scan->cur_seg_row += nrows;
+
+		/* Without row numbers, the zones cannot be used for the segment file */
+		if (scan->zoneNextRowNum > 0)
+			scan->zoneNextRowNum = (firstRowNum == INT64CONST(-1) ?
+									0 : firstRowNum + nrows);
+
+		if (batch->nsel > 0)
+			return true;
+	}
+}
+
+/*
+ * aocs_batch_next
+ *
+ * Store the next visible row of the batch in the slot.  Returns false if
+ * all rows of the batch have been returned.
+ */
+bool
+aocs_batch_next(AOCSScanDesc scan, AOCSBatch batch, TupleTableSlot *slot)
+{
+	Datum	   *d;
+	bool	   *null;
+	AOTupleId	aoTupleId;
+	int			row;
+	int			i;
+
+	if (batch->next >= batch->nsel)
+		return false;
+
+	row = batch->sel[batch->next++];
+	batch->current = row;
+
+	d = slot_get_values(slot);
+	null = slot_get_isnull(slot);
+	for (i = 0; i < scan->num_proj_atts; i++)
+	{
+		int			attno = scan->proj_atts[i];
+
+		if (batch->lazySeg && batch->lazy[attno])
+			continue;
+
+		d[attno] = batch->values[attno][row];
+		null[attno] = batch->nulls[attno][row];
+	}
+
+	AOTupleIdInit_Init(&aoTupleId);
+	AOTupleIdInit_segmentFileNum(&aoTupleId, batch->segno);
+	AOTupleIdInit_rowNum(&aoTupleId, batch->rowNums[row]);
+	scan->cdb_fake_ctid = *((ItemPointer) &aoTupleId);
+
+	TupSetVirtualTupleNValid(slot, slot->tts_tupleDescriptor->natts);
+	slot_set_ctid(slot, &(scan->cdb_fake_ctid));
+	return true;
+}
+
+/*
+ * Read the values of a lazy column for the selected rows of the batch,
+ * from entry 'first' of sel on, as far as they are in the block of the
+ * column that holds the first of them.  The values of the rows in later
+ * blocks are read when they are asked for, after the earlier rows have
+ * been returned.
+ */
+static void
+read_lazy_column(AOCSScanDesc scan, AOCSBatch batch, int attno, int first)
+{
+	DatumStreamRead *ds = scan->ds[attno];
+	Datum	   *values = batch->values[attno];
+	bool	   *nulls = batch->nulls[attno];
+	int64		rowNum = batch->rowNums[batch->sel[first]];
+	int64		reachedRowNum;
+	int			k;
+
+	if (datumstreamread_skip_to(ds, rowNum, &reachedRowNum) < 0 ||
+		reachedRowNum != rowNum ||
+		datumstreamread_advance(ds) == 0)
+		elog(ERROR, "could not find row " INT64_FORMAT " of column %d in segment file %d of relation \"%s\"",
+			 rowNum, attno + 1, batch->segno,
+			 RelationGetRelationName(scan->aos_rel));
+	datumstreamread_get(ds, &values[batch->sel[first]], &nulls[batch->sel[first]]);
+
+	for (k = first + 1; k < batch->nsel; k++)
+	{
+		int			row = batch->sel[k];
+
+		rowNum = batch->rowNums[row];
+		if (rowNum >= ds->blockFirstRowNum + ds->blockRowCount)
+			break;
+
+		datumstreamread_find(ds, rowNum - ds->blockFirstRowNum);
+		datumstreamread_get(ds, &values[row], &nulls[row]);
+	}
+
+	batch->lazyNext[attno] = k;
+}
+
+/*
+ * aocs_batch_materialize
+ *
+ * Store the values of the lazy columns of the row last returned by
+ * aocs_batch_next in the slot.  Each lazy column is read for the selected
+ * rows of the batch in its current block at once, in one pass over them,
+ * so that the caller must not change sel after the first call for a batch.
+ */
+void
+aocs_batch_materialize(AOCSScanDesc scan, AOCSBatch batch, TupleTableSlot *slot)
+{
+	Datum	   *d;
+	bool	   *null;
+	int			cur = batch->next - 1;
+	int			row = batch->current;
+	int			i;
+
+	if (!batch->lazySeg)
+		return;
+
+	Assert(cur >= 0 && batch->sel[cur] == row);
+
+	d = slot_get_values(slot);
+	null = slot_get_isnull(slot);
+
+	for (i = 0; i < scan->num_proj_atts; i++)
+	{
+		int			attno = scan->proj_atts[i];
+
+		if (!batch->lazy[attno])
+			continue;
+
+		if (cur >= batch->lazyNext[attno])
+			read_lazy_column(scan, batch, attno, cur);
+
+		d[attno] = batch->values[attno][row];
+		null[attno] = batch->nulls[attno][row];
+	}
+}
+
 
 /* Open next file segment for write.  See SetCurrentFileSegForWrite */
 /* XXX Right now, we put each column to different files */
@@ -821,10 +1498,99 @@ aocs_insert_init(Relation rel, int segno, bool update_mode)
 											(FileSegInfo *) desc->fsInfo, desc->lastSequence,
 											rel, segno, tupleDesc->natts, true);
 
+	/* Have the datum streams keep the zones the block directory wants */
+	if (desc->blockDirectory.numZoneColumns > 0)
+	{
+		int			i;
+
+		for (i = 0; i < tupleDesc->natts; i++)
+		{
+			FmgrInfo   *cmp;
+
+			if (AppendOnlyZone_ColumnWanted(tupleDesc->attrs[i], &cmp))
+				desc->ds[i]->zoneCmp = cmp;
+		}
+	}
+
 	return desc;
 }
 
 
+/*
+ * Appends one datum of row rowNum to the datum stream of column colno,
+ * starting a new block (or a large object block) when it does not fit.
+ */
+static void
+aocs_insert_datum(AOCSInsertDesc idesc, int colno, Datum datum, bool isnull,
+				  int64 rowNum)
+{
+	DatumStreamWrite *ds = idesc->ds[colno];
+	void	   *toFree1;
+	int			err = datumstreamwrite_put(ds, datum, isnull, &toFree1);
+
+	if (toFree1 != NULL)
+	{
+		/*
+		 * Use the de-toasted and/or de-compressed as datum instead.
+		 */
+		datum = PointerGetDatum(toFree1);
+	}
+	if (err < 0)
+	{
+		int			itemCount = datumstreamwrite_nth(ds);
+		void	   *toFree2;
+
+		/* write the block up to this one */
+		datumstreamwrite_block(ds, &idesc->blockDirectory, colno, false);
+		if (itemCount > 0)
+		{
+			/*
+			 * since we have written all up to the new tuple, the new
+			 * blockFirstRowNum is the inserted tuple's row number
+			 */
+			ds->blockFirstRowNum = rowNum;
+		}
+
+		Assert(ds->blockFirstRowNum == rowNum);
+
+
+		/* now write this new item to the new block */
+		err = datumstreamwrite_put(ds, datum, isnull, &toFree2);
+		Assert(toFree2 == NULL);
+		if (err < 0)
+		{
+			Assert(!isnull);
+
+			/*
+			 * rle_type is running on a block stream, if an object spans
+			 * multiple blocks then data will not be compressed (if
+			 * rle_type is set).
+			 */
+			if ((idesc->compType != NULL) && (pg_strcasecmp(idesc->compType, "rle_type") == 0))
+			{
+				ds->ao_write.storageAttributes.compress = FALSE;
+			}
+
+			err = datumstreamwrite_lob(ds,
+									   datum,
+									   &idesc->blockDirectory,
+									   colno,
+									   false);
+			Assert(err >= 0);
+
+			/*
+			 * A lob will live by itself in the block so this assignment
+			 * is for the block that contains tuples AFTER the one we are
+			 * inserting
+			 */
+			ds->blockFirstRowNum = rowNum + 1;
+		}
+	}
+
+	if (toFree1 != NULL)
+		pfree(toFree1);
+}
+
 Oid
 aocs_insert_values(AOCSInsertDesc idesc, Datum *d, bool *null, AOTupleId *aoTupleId)
 {
@@ -846,73 +1612,7 @@ aocs_insert_values(AOCSInsertDesc idesc, Datum *d, bool *null, AOTupleId *aoTupl
 
 	/* As usual, at this moment, we assume one col per vp */
 	for (i = 0; i < RelationGetNumberOfAttributes(rel); ++i)
-	{
-		void	   *toFree1;
-		Datum		datum = d[i];
-		int			err = datumstreamwrite_put(idesc->ds[i], datum, null[i], &toFree1);
-
-		if (toFree1 != NULL)
-		{
-			/*
-			 * Use the de-toasted and/or de-compressed as datum instead.
-			 */
-			datum = PointerGetDatum(toFree1);
-		}
-		if (err < 0)
-		{
-			int			itemCount = datumstreamwrite_nth(idesc->ds[i]);
-			void	   *toFree2;
-
-			/* write the block up to this one */
-			datumstreamwrite_block(idesc->ds[i], &idesc->blockDirectory, i, false);
-			if (itemCount > 0)
-			{
-				/*
-				 * since we have written all up to the new tuple, the new
-				 * blockFirstRowNum is the inserted tuple's row number
-				 */
-				idesc->ds[i]->blockFirstRowNum = idesc->lastSequence + 1;
-			}
-
-			Assert(idesc->ds[i]->blockFirstRowNum == idesc->lastSequence + 1);
-
-
-			/* now write this new item to the new block */
-			err = datumstreamwrite_put(idesc->ds[i], datum, null[i], &toFree2);
-			Assert(toFree2 == NULL);
-			if (err < 0)
-			{
-				Assert(!null[i]);
-
-				/*
-				 * rle_type is running on a block stream, if an object spans
-				 * multiple blocks then data will not be compressed (if
-				 * rle_type is set).
-				 */
-				if ((idesc->compType != NULL) && (pg_strcasecmp(idesc->compType, "rle_type") == 0))
-				{
-					idesc->ds[i]->ao_write.storageAttributes.compress = FALSE;
-				}
-
-				err = datumstreamwrite_lob(idesc->ds[i],
-										   datum,
-										   &idesc->blockDirectory,
-										   i,
-										   false);
-				Assert(err >= 0);
-
-				/*
-				 * A lob will live by itself in the block so this assignment
-				 * is for the block that contains tuples AFTER the one we are
-				 * inserting
-				 */
-				idesc->ds[i]->blockFirstRowNum = idesc->lastSequence + 2;
-			}
-		}
-
-		if (toFree1 != NULL)
-			pfree(toFree1);
-	}
+		aocs_insert_datum(idesc, i, d[i], null[i], idesc->lastSequence + 1);
 
 	idesc->insertCount++;
 	idesc->lastSequence++;
@@ -946,6 +1646,88 @@ aocs_insert_values(AOCSInsertDesc idesc, Datum *d, bool *null, AOTupleId *aoTupl
 	return InvalidOid;
 }
 
+/*
+ * Inserts nrows rows given column by column: values[i][r] and nulls[i][r]
+ * are the value of column i in row r.
+ *
+ * Each column's datum stream is filled for the whole batch before moving on
+ * to the next column, so its block buffer and compressor stay hot while
+ * the blocks of that column are written.  The row numbers of the batch are
+ * reserved up front.  If aoTupleIds is not NULL, it receives the tuple ids
+ * of the inserted rows.
+ */
+void
+aocs_insert_values_batch(AOCSInsertDesc idesc, int nrows,
+						 Datum **values, bool **nulls,
+						 AOTupleId *aoTupleIds)
+{
+	Relation	rel = idesc->aoi_rel;
+	int64		firstRowNum;
+	int			i;
+	int			r;
+
+	if (nrows <= 0)
+		return;
+
+	if (rel->rd_rel->relhasoids)
+		ereport(ERROR,
+				(errcode(ERRCODE_GP_FEATURE_NOT_SUPPORTED),
+				 errmsg("append-only column-oriented tables do not support rows with OIDs")));
+
+#ifdef FAULT_INJECTOR
+	FaultInjector_InjectFaultIfSet(
+								   AppendOnlyInsert,
+								   DDLNotSpecified,
+								   "",	/* databaseName */
+								   RelationGetRelationName(idesc->aoi_rel));	/* tableName */
+#endif
+
+	/*
+	 * Make sure the whole batch is covered by fast sequence numbers, and
+	 * that some are left over afterwards, like after a single insert.
+	 */
+	if (idesc->numSequences <= nrows)
+	{
+		int64		firstSequence;
+		int64		numSequences = nrows - idesc->numSequences + NUM_FAST_SEQUENCES;
+
+		firstSequence =
+			GetFastSequences(rel->rd_appendonly->segrelid,
+							 idesc->cur_segno,
+							 idesc->lastSequence + 1 + idesc->numSequences,
+							 numSequences);
+
+		Assert(firstSequence == idesc->lastSequence + 1 + idesc->numSequences);
+		idesc->numSequences += numSequences;
+	}
+
+	firstRowNum = idesc->lastSequence + 1;
+
+	/* As usual, at this moment, we assume one col per vp */
+	for (i = 0; i < RelationGetNumberOfAttributes(rel); ++i)
+	{
+		for (r = 0; r < nrows; r++)
+			aocs_insert_datum(idesc, i, values[i][r], nulls[i][r],
+							  firstRowNum + r);
+	}
+
+	idesc->insertCount += nrows;
+	idesc->lastSequence += nrows;
+	idesc->numSequences -= nrows;
+
+	Assert(idesc->numSequences > 0);
+
+	if (aoTupleIds != NULL)
+	{
+		for (r = 0; r < nrows; r++)
+		{
+			AOTupleIdInit_Init(&aoTupleIds[r]);
+			AOTupleIdInit_segmentFileNum(&aoTupleIds[r], idesc->cur_segno);
+			AOTupleIdInit_rowNum(&aoTupleIds[r], firstRowNum + r);
+		}
+	}
+}
+
 void
 aocs_insert_finish(AOCSInsertDesc idesc)
 {
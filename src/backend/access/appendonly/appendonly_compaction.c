@@ -188,6 +188,64 @@ AppendOnlyCompaction_ShouldCompact(
 	return result;
 }
 
+/*
+ * Returns how many live tuples a lazy compaction of the given segment file
+ * may move under gp_appendonly_compaction_budget, or -1 if it may compact
+ * the whole segment file.
+ *
+ * segmentTotalBytes is the on-disk size of the segment file (of all its
+ * columns for column-oriented tables).  The budget is converted into
+ * tuples using the average on-disk tuple size of the segment file.  A
+ * segment file whose live data fits into the budget is compacted as
+ * before; otherwise only a part of its live tuples is moved and hidden, and
+ * later vacuums continue where this one stopped.
+ */
+int64
+AppendOnlyCompaction_GetMaxMovedTuples(
+	Relation aoRelation,
+	int segno,
+	int64 segmentTotalTupcount,
+	int64 segmentTotalBytes,
+	bool isFull)
+{
+	AppendOnlyVisimap visiMap;
+	int64 hiddenTupcount;
+	double bytesPerTuple;
+	double budgetBytes;
+	int64 maxMovedTuples;
+
+	if (isFull || gp_appendonly_compaction_budget <= 0 ||
+		segmentTotalTupcount <= 0 || segmentTotalBytes <= 0)
+		return -1;
+
+	AppendOnlyVisimap_Init(&visiMap,
+			aoRelation->rd_appendonly->visimaprelid,
+			aoRelation->rd_appendonly->visimapidxid,
+			ShareLock,
+			SnapshotNow);
+	hiddenTupcount = AppendOnlyVisimap_GetSegmentFileHiddenTupleCount(
+			&visiMap, segno);
+	AppendOnlyVisimap_Finish(&visiMap, ShareLock);
+
+	bytesPerTuple = (double) segmentTotalBytes / (double) segmentTotalTupcount;
+	budgetBytes = (double) gp_appendonly_compaction_budget * 1024.0;
+
+	if ((double) (segmentTotalTupcount - hiddenTupcount) * bytesPerTuple <= budgetBytes)
+		return -1;
+
+	maxMovedTuples = (int64) (budgetBytes / bytesPerTuple);
+	if (maxMovedTuples < 1)
+		maxMovedTuples = 1;
+
+	elogif(Debug_appendonly_print_compaction, LOG,
+		"Incremental compaction: segno %d, "
+		"hidden tupcount " INT64_FORMAT ", total tupcount " INT64_FORMAT ", "
+		"move at most " INT64_FORMAT " tuples",
+		segno, hiddenTupcount, segmentTotalTupcount, maxMovedTuples);
+
+	return maxMovedTuples;
+}
+
 /*
  * AppendOnlySegmentFileTruncateToEOF()
  *
@@ -322,14 +380,22 @@ AppendOnlyThrowAwayTuple(
  * Assumes that the segment file lock is already held.
  * Assumes that the segment file should be compacted.
  *
+ * If maxMovedTuples is not negative, at most that many live tuples are
+ * moved, and they are hidden in the visimap instead of dropping the segment
+ * file.  Invisible tuples are then left alone; the compaction that finally
+ * finds no live tuples left throws them away and drops the segment file.
  */
 static void
 AppendOnlySegmentFileFullCompaction(Relation aorel, 
 		AppendOnlyInsertDesc insertDesc,
-		FileSegInfo* fsinfo)
+		FileSegInfo* fsinfo,
+		int64 maxMovedTuples)
 {
 	const char* relname;
 	AppendOnlyVisimap visiMap;
+	AppendOnlyVisimapDelete visiMapDelete;
+	bool isPartial = (maxMovedTuples >= 0);
+	int64 startRowNum = 0;
 	AppendOnlyScanDesc scanDesc;
 	TupleDesc tupDesc;
 	MemTuple		tuple;
@@ -364,6 +430,17 @@ AppendOnlySegmentFileFullCompaction(Relation aorel,
 			LOG, "Compact AO segno %d, relation %s, insert segno %d", 
 			compact_segno, relname, insertDesc->storageWrite.segmentFileNum);
 
+	/*
+	 * The rows earlier partial compactions moved are all hidden; start
+	 * after them.
+	 */
+	if (isPartial)
+	{
+		startRowNum = AppendOnlyVisimap_GetFirstUnhiddenRowNum(&visiMap,
+				compact_segno);
+		AppendOnlyVisimapDelete_Init(&visiMapDelete, &visiMap);
+	}
+
 	/*
 	 * Todo: We need to limit the scan to one file and we need to avoid to
 	 * lock the file again.
@@ -373,6 +450,7 @@ AppendOnlySegmentFileFullCompaction(Relation aorel,
 	scanDesc = appendonly_beginrangescan(aorel,
 			SnapshotAny, SnapshotNow,
 			&compact_segno, 1, 0, NULL);
+	scanDesc->startRowNum = startRowNum;
 
 	tupDesc = RelationGetDescr(aorel);
 	slot = MakeSingleTupleTableSlot(tupDesc);
@@ -403,6 +481,9 @@ AppendOnlySegmentFileFullCompaction(Relation aorel,
 		aoTupleId = (AOTupleId*)slot_get_ctid(slot);
 		if (AppendOnlyVisimap_IsVisible(&scanDesc->visibilityMap, aoTupleId))
 		{
+			if (isPartial && movedTupleCount >= maxMovedTuples)
+				break;
+
 			AppendOnlyMoveTuple(tuple,
 							slot,
 							mt_bind,
@@ -410,8 +491,14 @@ AppendOnlySegmentFileFullCompaction(Relation aorel,
 							resultRelInfo,
 							estate);
 			movedTupleCount++;
+
+			if (isPartial &&
+				AppendOnlyVisimapDelete_Hide(&visiMapDelete, aoTupleId) != HeapTupleMayBeUpdated)
+				elog(ERROR, "could not hide moved tuple (%d," INT64_FORMAT ") of relation %s",
+					 AOTupleIdGet_segmentFileNum(aoTupleId),
+					 AOTupleIdGet_rowNum(aoTupleId), relname);
 		}
-		else
+		else if (!isPartial)
 		{
 			/* Tuple is invisible and needs to be dropped */
 			AppendOnlyThrowAwayTuple(aorel, 
@@ -430,23 +517,36 @@ AppendOnlySegmentFileFullCompaction(Relation aorel,
 		}
 	}
 
-	SetFileSegInfoState(aorel, compact_segno, AOSEG_STATE_AWAITING_DROP);
-
-	AppendOnlyVisimap_DeleteSegmentFile(&visiMap, compact_segno);
-
-	/* Delete all mini pages of the segment files if block directory exists */
-	if (OidIsValid(aorel->rd_appendonly->blkdirrelid))
+	if (isPartial)
 	{
-		AppendOnlyBlockDirectory_DeleteSegmentFile(aorel,
-												   SnapshotNow,
-												   compact_segno,
-												   0);
+		/* The segment file stays; the next vacuum continues with it */
+		AppendOnlyVisimapDelete_Finish(&visiMapDelete);
+
+		elogif(Debug_appendonly_print_compaction, LOG,
+			   "Finished incremental compaction: "
+			   "AO segfile %d, relation %s, moved tuple count " INT64_FORMAT,
+			   compact_segno, relname, movedTupleCount);
 	}
+	else
+	{
+		SetFileSegInfoState(aorel, compact_segno, AOSEG_STATE_AWAITING_DROP);
 
-	elogif(Debug_appendonly_print_compaction, LOG,
-		   "Finished compaction: "
-		   "AO segfile %d, relation %s, moved tuple count " INT64_FORMAT,
-		   compact_segno, relname, movedTupleCount);
+		AppendOnlyVisimap_DeleteSegmentFile(&visiMap, compact_segno);
+
+		/* Delete all mini pages of the segment files if block directory exists */
+		if (OidIsValid(aorel->rd_appendonly->blkdirrelid))
+		{
+			AppendOnlyBlockDirectory_DeleteSegmentFile(aorel,
+													   SnapshotNow,
+													   compact_segno,
+													   0);
+		}
+
+		elogif(Debug_appendonly_print_compaction, LOG,
+			   "Finished compaction: "
+			   "AO segfile %d, relation %s, moved tuple count " INT64_FORMAT,
+			   compact_segno, relname, movedTupleCount);
+	}
 
 	AppendOnlyVisimap_Finish(&visiMap, NoLock);
 
@@ -714,7 +814,10 @@ AppendOnlyCompact(Relation aorel,
 		{
 			AppendOnlySegmentFileFullCompaction(aorel,
 				insertDesc, 
-				fsinfo);
+				fsinfo,
+				AppendOnlyCompaction_GetMaxMovedTuples(aorel,
+					fsinfo->segno, fsinfo->total_tupcount,
+					(int64) fsinfo->eof, isFull));
 		} 
 		pfree(fsinfo);
 	}
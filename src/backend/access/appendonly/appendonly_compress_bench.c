@@ -0,0 +1,466 @@
+/*------------------------------------------------------------------------------
+ *
+ * appendonly_compress_bench.c
+ *   gp_compression_benchmark(), which measures how the compresstypes of
+ *   this build would do on the blocks of an existing append-only table.
+ *
+ * Every block of the table in the current segment is read and decompressed
+ * with the table's own compresstype, and the raw content is then compressed
+ * and decompressed again with each candidate compresstype and level.  One
+ * row is returned per candidate.  Blocks that do not shrink are counted at
+ * their raw size, as the storage layer would store them uncompressed.
+ *
+ * To measure the data on the segments rather than on the master, run it
+ * through gp_dist_random:
+ *
+ *	 SELECT gp_segment_id, (gp_compression_benchmark('t'::regclass)).*
+ *	 FROM gp_dist_random('gp_id');
+ *
+ * Copyright (c) 2017, Pivotal Software Inc.
+ *
+ *------------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/aocssegfiles.h"
+#include "access/aomd.h"
+#include "access/aosegfiles.h"
+#include "access/heapam.h"
+#include "catalog/pg_attribute_encoding.h"
+#include "catalog/pg_compression.h"
+#include "catalog/pg_type.h"
+#include "cdb/cdbappendonlystorageread.h"
+#include "cdb/cdbappendonlystoragewrite.h"
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "portability/instr_time.h"
+#include "utils/builtins.h"
+#include "utils/datumstream.h"
+#include "utils/memutils.h"
+
+/*
+ * The compresstypes and levels that are tried.  zstd and lz4 are only
+ * available if the server was built with them.
+ */
+static const struct
+{
+	char	   *compresstype;
+	int			compresslevel;
+}	bench_candidates[] =
+{
+	{"zlib", 1},
+	{"zlib", 5},
+#ifdef HAVE_LIBZSTD
+	{"zstd", 1},
+	{"zstd", 3},
+	{"zstd", 9},
+#endif
+#ifdef HAVE_LIBLZ4
+	{"lz4", 1},
+#endif
+};
+
+#define NUM_BENCH_CANDIDATES lengthof(bench_candidates)
+
+#define NUM_BENCH_COLUMNS 7
+
+typedef struct BenchCandidate
+{
+	PGFunction *funcs;
+	CompressionState *compressState;
+	CompressionState *decompressState;
+
+	int64		blocks;
+	int64		rawBytes;
+	int64		compressedBytes;
+	instr_time	compressTime;
+	instr_time	decompressTime;
+} BenchCandidate;
+
+typedef struct BenchState
+{
+	BenchCandidate candidates[NUM_BENCH_CANDIDATES];
+
+	/* work buffers, one block in size */
+	char	   *compressed;
+	char	   *decompressed;
+	int32		chunkSize;
+
+	/* raw content of the current block */
+	uint8	   *content;
+	int32		contentSize;
+} BenchState;
+
+/*
+ * Compress and decompress one chunk of raw content with every candidate.
+ */
+static void
+bench_chunk(BenchState *bench, const uint8 *src, int32 srcSize)
+{
+	int			i;
+
+	for (i = 0; i < NUM_BENCH_CANDIDATES; i++)
+	{
+		BenchCandidate *cand = &bench->candidates[i];
+		instr_time	start;
+		instr_time	end;
+		int32		compressedSize;
+		int32		decompressedSize;
+
+		INSTR_TIME_SET_CURRENT(start);
+		callCompressionActuator(cand->funcs[COMPRESSION_COMPRESS],
+								(const void *) src, srcSize,
+								bench->compressed, srcSize,
+								&compressedSize, cand->compressState);
+		INSTR_TIME_SET_CURRENT(end);
+		INSTR_TIME_ACCUM_DIFF(cand->compressTime, end, start);
+
+		cand->blocks++;
+		cand->rawBytes += srcSize;
+
+		if (compressedSize >= srcSize)
+		{
+			/* Stored uncompressed; nothing to decompress on read. */
+			cand->compressedBytes += srcSize;
+			continue;
+		}
+		cand->compressedBytes += compressedSize;
+
+		INSTR_TIME_SET_CURRENT(start);
+		callCompressionActuator(cand->funcs[COMPRESSION_DECOMPRESS],
+								bench->compressed, compressedSize,
+								bench->decompressed, bench->chunkSize,
+								&decompressedSize, cand->decompressState);
+		INSTR_TIME_SET_CURRENT(end);
+		INSTR_TIME_ACCUM_DIFF(cand->decompressTime, end, start);
+
+		if (decompressedSize != srcSize ||
+			memcmp(bench->decompressed, src, srcSize) != 0)
+			elog(ERROR, "%s level %d did not round-trip a block of %d bytes",
+				 bench_candidates[i].compresstype,
+				 bench_candidates[i].compresslevel, srcSize);
+	}
+}
+
+/*
+ * Benchmark every block of an open segment file.
+ *
+ * Large content spanning several blocks is benchmarked in block sized
+ * chunks, the way it was written.
+ */
+static void
+bench_segment_file(BenchState *bench, AppendOnlyStorageRead *storageRead)
+{
+	while (AppendOnlyStorageRead_ReadNextBlock(storageRead))
+	{
+		int32		contentLen;
+		int			executorBlockKind;
+		int64		firstRowNum;
+		int			rowCount;
+		bool		isLarge;
+		bool		isCompressed;
+		int32		offset;
+
+		CHECK_FOR_INTERRUPTS();
+
+		AppendOnlyStorageRead_GetBlockInfo(storageRead, &contentLen,
+										   &executorBlockKind, &firstRowNum,
+										   &rowCount, &isLarge, &isCompressed);
+
+		if (contentLen > bench->contentSize)
+		{
+			if (bench->content != NULL)
+				pfree(bench->content);
+			bench->content = palloc(contentLen);
+			bench->contentSize = contentLen;
+		}
+		AppendOnlyStorageRead_Content(storageRead, bench->content, contentLen);
+
+		for (offset = 0; offset < contentLen; offset += bench->chunkSize)
+			bench_chunk(bench, bench->content + offset,
+						Min(bench->chunkSize, contentLen - offset));
+	}
+}
+
+/*
+ * Benchmark the segment files of an append-only row-oriented table.
+ */
+static void
+bench_ao_rows(BenchState *bench, Relation rel)
+{
+	AppendOnlyStorageRead storageRead;
+	AppendOnlyStorageAttributes attr;
+	PGFunction *fns;
+	FileSegInfo **seginfo;
+	int			segfile_count;
+	int			usableBlockSize;
+	char	   *filenamepath;
+	int			i;
+
+	usableBlockSize = AppendOnlyStorage_GetUsableBlockSize(rel->rd_appendonly->blocksize);
+
+	MemSet(&attr, 0, sizeof(attr));
+	if (strcmp(NameStr(rel->rd_appendonly->compresstype), "") == 0 ||
+		pg_strcasecmp(NameStr(rel->rd_appendonly->compresstype), "none") == 0)
+	{
+		attr.compress = false;
+		attr.compressType = "none";
+	}
+	else
+	{
+		attr.compress = true;
+		attr.compressType = pstrdup(NameStr(rel->rd_appendonly->compresstype));
+	}
+	attr.compressLevel = rel->rd_appendonly->compresslevel;
+	attr.checksum = rel->rd_appendonly->checksum;
+	attr.safeFSWriteSize = rel->rd_appendonly->safefswritesize;
+
+	AppendOnlyStorageRead_Init(&storageRead,
+							   CurrentMemoryContext,
+							   usableBlockSize,
+							   NameStr(rel->rd_rel->relname),
+							   "compression benchmark",
+							   &attr);
+
+	/* The table's own compression functions, to get at the raw content */
+	fns = get_funcs_for_compression(attr.compressType);
+	storageRead.compression_functions = fns;
+	if (fns != NULL)
+	{
+		StorageAttributes sa;
+
+		sa.comptype = attr.compressType;
+		sa.complevel = attr.compressLevel;
+		sa.blocksize = usableBlockSize;
+
+		storageRead.compressionState =
+			callCompressionConstructor(fns[COMPRESSION_CONSTRUCTOR],
+									   RelationGetDescr(rel), &sa,
+									   false /* decompress */ );
+	}
+
+	filenamepath = palloc(AOSegmentFilePathNameLen(rel) + 1);
+
+	seginfo = GetAllFileSegInfo(rel, SnapshotNow, &segfile_count);
+	for (i = 0; i < segfile_count; i++)
+	{
+		int32		fileSegNo;
+
+		if (seginfo[i]->eof == 0 ||
+			seginfo[i]->state == AOSEG_STATE_AWAITING_DROP)
+			continue;
+
+		MakeAOSegmentFileName(rel, seginfo[i]->segno, -1, &fileSegNo,
+							  filenamepath);
+		AppendOnlyStorageRead_OpenFile(&storageRead, filenamepath,
+									   seginfo[i]->formatversion,
+									   seginfo[i]->eof);
+		bench_segment_file(bench, &storageRead);
+		AppendOnlyStorageRead_CloseFile(&storageRead);
+	}
+
+	AppendOnlyStorageRead_FinishSession(&storageRead);
+}
+
+/*
+ * Benchmark the segment files of an append-only column-oriented table.
+ *
+ * The columns are read through their datum streams, so that each one is
+ * decompressed with its own compresstype; the raw content is what the
+ * datum stream layer stores, RLE encoded for rle_type columns.
+ */
+static void
+bench_ao_columns(BenchState *bench, Relation rel)
+{
+	TupleDesc	tupdesc = RelationGetDescr(rel);
+	StdRdOptions **opts = RelationGetAttributeOptions(rel);
+	AOCSFileSegInfo **seginfo;
+	int			segfile_count;
+	char	   *filenamepath;
+	int			attno;
+
+	filenamepath = palloc(AOSegmentFilePathNameLen(rel) + 1);
+
+	seginfo = GetAllAOCSFileSegInfo(rel, SnapshotNow, &segfile_count);
+
+	for (attno = 0; attno < tupdesc->natts; attno++)
+	{
+		DatumStreamRead *ds;
+		int			i;
+
+		if (tupdesc->attrs[attno]->attisdropped)
+			continue;
+
+		Assert(opts[attno]);
+		ds = create_datumstreamread(opts[attno]->compresstype,
+									opts[attno]->compresslevel,
+									rel->rd_appendonly->checksum,
+									 /* safeFSWriteSize */ false,
+									opts[attno]->blocksize,
+									tupdesc->attrs[attno],
+									RelationGetRelationName(rel),
+									"compression benchmark");
+
+		for (i = 0; i < segfile_count; i++)
+		{
+			AOCSVPInfoEntry *e = getAOCSVPEntry(seginfo[i], attno);
+			int32		fileSegNo;
+
+			if (e->eof == 0 ||
+				seginfo[i]->state == AOSEG_STATE_AWAITING_DROP)
+				continue;
+
+			MakeAOSegmentFileName(rel, seginfo[i]->segno, attno, &fileSegNo,
+								  filenamepath);
+			datumstreamread_open_file(ds, filenamepath, e->eof,
+									  e->eof_uncompressed, rel->rd_node,
+									  fileSegNo, seginfo[i]->formatversion);
+			bench_segment_file(bench, &ds->ao_read);
+			datumstreamread_close_file(ds);
+		}
+
+		destroy_datumstreamread(ds);
+	}
+}
+
+Datum
+gp_compression_benchmark(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcctx;
+	BenchState *bench;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		Oid			relid = PG_GETARG_OID(0);
+		TupleDesc	tupdesc;
+		MemoryContext oldcontext;
+		MemoryContext benchcontext;
+		Relation	rel;
+		int			blocksize;
+		int			i;
+
+		funcctx = SRF_FIRSTCALL_INIT();
+		oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+		tupdesc = CreateTemplateTupleDesc(NUM_BENCH_COLUMNS, false);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 1, "compresstype",
+						   TEXTOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 2, "compresslevel",
+						   INT4OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 3, "blocks",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 4, "rawbytes",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 5, "compressedbytes",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 6, "compress_ms",
+						   FLOAT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 7, "decompress_ms",
+						   FLOAT8OID, -1, 0);
+		funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+		rel = heap_open(relid, AccessShareLock);
+		if (!RelationIsAoRows(rel) && !RelationIsAoCols(rel))
+			ereport(ERROR,
+					(errcode(ERRCODE_WRONG_OBJECT_TYPE),
+					 errmsg("\"%s\" is not an append-only table",
+							RelationGetRelationName(rel))));
+
+		bench = palloc0(sizeof(BenchState));
+
+		/*
+		 * The compression buffers, read buffers and segment file lists can
+		 * be big, so do the work in a context of its own and keep only the
+		 * results.
+		 */
+		benchcontext = AllocSetContextCreate(CurrentMemoryContext,
+											 "compression benchmark",
+											 ALLOCSET_DEFAULT_MINSIZE,
+											 ALLOCSET_DEFAULT_INITSIZE,
+											 ALLOCSET_DEFAULT_MAXSIZE);
+		MemoryContextSwitchTo(benchcontext);
+
+		/*
+		 * Columns can have their own blocksize; benchmark everything in
+		 * chunks of the table's.
+		 */
+		blocksize = AppendOnlyStorage_GetUsableBlockSize(rel->rd_appendonly->blocksize);
+		bench->chunkSize = blocksize;
+		bench->compressed = palloc(blocksize);
+		bench->decompressed = palloc(blocksize);
+
+		for (i = 0; i < NUM_BENCH_CANDIDATES; i++)
+		{
+			BenchCandidate *cand = &bench->candidates[i];
+			StorageAttributes sa;
+
+			cand->funcs = GetCompressionImplementation(bench_candidates[i].compresstype);
+
+			sa.comptype = bench_candidates[i].compresstype;
+			sa.complevel = bench_candidates[i].compresslevel;
+			sa.blocksize = blocksize;
+			sa.typid = InvalidOid;
+
+			cand->compressState =
+				callCompressionConstructor(cand->funcs[COMPRESSION_CONSTRUCTOR],
+										   NULL, &sa, true /* compress */ );
+			cand->decompressState =
+				callCompressionConstructor(cand->funcs[COMPRESSION_CONSTRUCTOR],
+										   NULL, &sa, false /* decompress */ );
+			INSTR_TIME_SET_ZERO(cand->compressTime);
+			INSTR_TIME_SET_ZERO(cand->decompressTime);
+		}
+
+		if (RelationIsAoRows(rel))
+			bench_ao_rows(bench, rel);
+		else
+			bench_ao_columns(bench, rel);
+
+		for (i = 0; i < NUM_BENCH_CANDIDATES; i++)
+		{
+			BenchCandidate *cand = &bench->candidates[i];
+
+			callCompressionDestructor(cand->funcs[COMPRESSION_DESTRUCTOR],
+									  cand->compressState);
+			callCompressionDestructor(cand->funcs[COMPRESSION_DESTRUCTOR],
+									  cand->decompressState);
+		}
+
+		MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+		MemoryContextDelete(benchcontext);
+		bench->compressed = NULL;
+		bench->decompressed = NULL;
+		bench->content = NULL;
+
+		heap_close(rel, AccessShareLock);
+
+		funcctx->user_fctx = bench;
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+	bench = (BenchState *) funcctx->user_fctx;
+
+	if (funcctx->call_cntr < NUM_BENCH_CANDIDATES)
+	{
+		int			i = funcctx->call_cntr;
+		BenchCandidate *cand = &bench->candidates[i];
+		Datum		values[NUM_BENCH_COLUMNS];
+		bool		nulls[NUM_BENCH_COLUMNS];
+		HeapTuple	tuple;
+
+		MemSet(nulls, 0, sizeof(nulls));
+		values[0] = CStringGetTextDatum(bench_candidates[i].compresstype);
+		values[1] = Int32GetDatum(bench_candidates[i].compresslevel);
+		values[2] = Int64GetDatum(cand->blocks);
+		values[3] = Int64GetDatum(cand->rawBytes);
+		values[4] = Int64GetDatum(cand->compressedBytes);
+		values[5] = Float8GetDatum(INSTR_TIME_GET_MILLISEC(cand->compressTime));
+		values[6] = Float8GetDatum(INSTR_TIME_GET_MILLISEC(cand->decompressTime));
+
+		tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+		SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+	}
+
+	SRF_RETURN_DONE(funcctx);
+}
@@ -14,6 +14,9 @@
 #include "access/appendonlytid.h"
 #include "cdb/cdbappendonlyblockdirectory.h"
 #include "access/hash.h"
+#include "catalog/aovisimap.h"
+#include "miscadmin.h"
+#include "utils/fmgroids.h"
 #include "utils/guc.h"
 #include "utils/memutils.h"
 
@@ -71,6 +74,9 @@ static void AppendOnlyVisimap_Find(
 		AppendOnlyVisimap *visiMap,
 		AOTupleId *tupleId);
 
+static void AppendOnlyVisimap_UnloadSegmentFile(
+		AppendOnlyVisimap *visiMap);
+
 /*
  * Finishes the visimap operations.
  * No other function should be called with the given
@@ -86,6 +92,8 @@ AppendOnlyVisimap_Finish(
 		AppendOnlyVisimap_Store(visiMap);
 	}
 
+	AppendOnlyVisimap_UnloadSegmentFile(visiMap);
+
 	AppendOnlyVisimapStore_Finish(&visiMap->visimapStore, lockmode);
 	AppendOnlyVisimapEntry_Finish(&visiMap->visimapEntry);
 
@@ -133,9 +141,186 @@ AppendOnlyVisimap_Init(
 			appendOnlyMetaDataSnapshot,
 			visiMap->memoryContext);
 
+	visiMap->loadedSegno = -1;
+	visiMap->numHiddenRanges = 0;
+	visiMap->hiddenRanges = NULL;
+
 	MemoryContextSwitchTo(oldContext);
 }
 
+/*
+ * Frees the hidden rows loaded by AppendOnlyVisimap_LoadSegmentFile.
+ */
+static void
+AppendOnlyVisimap_UnloadSegmentFile(
+		AppendOnlyVisimap *visiMap)
+{
+	int i;
+
+	Assert(visiMap);
+
+	for (i = 0; i < visiMap->numHiddenRanges; i++)
+		bms_free(visiMap->hiddenRanges[i]);
+	if (visiMap->hiddenRanges)
+		pfree(visiMap->hiddenRanges);
+
+	visiMap->loadedSegno = -1;
+	visiMap->numHiddenRanges = 0;
+	visiMap->hiddenRanges = NULL;
+}
+
+/*
+ * Loads the hidden rows of a whole segment file in one pass over the
+ * visimap index, so that a sequential scan of the segment file can check
+ * visibility with a single bit test instead of looking up a visimap entry
+ * every APPENDONLY_VISIMAP_MAX_RANGE rows.  Replaces what was loaded for
+ * the previous segment file.
+ *
+ * Ranges without hidden rows cost a NULL pointer.  If those pointers and
+ * the bitmaps of the hidden rows need more than work_mem, nothing is kept
+ * loaded and AppendOnlyVisimap_IsVisible keeps looking up one entry at a
+ * time.
+ *
+ * Only for visimaps that are not used to hide tuples.
+ */
+void
+AppendOnlyVisimap_LoadSegmentFile(
+		AppendOnlyVisimap *visiMap,
+		int segno)
+{
+	AppendOnlyVisimapEntry *visiMapEntry = &visiMap->visimapEntry;
+	ScanKeyData scanKey;
+	IndexScanDesc indexScan;
+	MemoryContext oldContext;
+	long		loadedBytes = 0;
+	bool		tooLarge = false;
+
+	Assert(visiMap);
+	Assert(!AppendOnlyVisimapEntry_HasChanged(visiMapEntry));
+
+	AppendOnlyVisimap_UnloadSegmentFile(visiMap);
+
+	oldContext = MemoryContextSwitchTo(visiMap->memoryContext);
+
+	ScanKeyInit(&scanKey,
+			Anum_pg_aovisimap_segno, /* segno */
+			BTEqualStrategyNumber,
+			F_INT4EQ,
+			Int32GetDatum(segno));
+
+	indexScan = AppendOnlyVisimapStore_BeginScan(
+			&visiMap->visimapStore,
+			1,
+			&scanKey);
+
+	while (AppendOnlyVisimapStore_GetNext(&visiMap->visimapStore,
+				indexScan, ForwardScanDirection,
+				visiMapEntry, NULL))
+	{
+		int range;
+
+		if (bms_is_empty(visiMapEntry->bitmap))
+			continue;
+
+		loadedBytes += offsetof(Bitmapset, words) +
+			visiMapEntry->bitmap->nwords * sizeof(bitmapword);
+		if (loadedBytes > work_mem * 1024L)
+		{
+			tooLarge = true;
+			break;
+		}
+
+		Assert(visiMapEntry->firstRowNum % APPENDONLY_VISIMAP_MAX_RANGE == 0);
+		range = (int) (visiMapEntry->firstRowNum / APPENDONLY_VISIMAP_MAX_RANGE);
+		if (range >= visiMap->numHiddenRanges)
+		{
+			int newCount = Max(range + 1, visiMap->numHiddenRanges * 2);
+
+			/* The pointers of the ranges without hidden rows count too */
+			loadedBytes += (long) (newCount - visiMap->numHiddenRanges) *
+				sizeof(Bitmapset *);
+			if (loadedBytes > work_mem * 1024L)
+			{
+				tooLarge = true;
+				break;
+			}
+
+			if (visiMap->hiddenRanges == NULL)
+				visiMap->hiddenRanges = palloc0(newCount * sizeof(Bitmapset *));
+			else
+			{
+				visiMap->hiddenRanges = repalloc(visiMap->hiddenRanges,
+						newCount * sizeof(Bitmapset *));
+				memset(&visiMap->hiddenRanges[visiMap->numHiddenRanges], 0,
+						(newCount - visiMap->numHiddenRanges) * sizeof(Bitmapset *));
+			}
+			visiMap->numHiddenRanges = newCount;
+		}
+
+		/* Take over the bitmap; the next copyout allocates a new one */
+		bms_free(visiMap->hiddenRanges[range]);
+		visiMap->hiddenRanges[range] = visiMapEntry->bitmap;
+		visiMapEntry->bitmap = NULL;
+	}
+	AppendOnlyVisimapStore_EndScan(&visiMap->visimapStore, indexScan);
+
+	/* The entry no longer describes anything useful */
+	AppendOnlyVisimapEntry_Reset(visiMapEntry);
+
+	MemoryContextSwitchTo(oldContext);
+
+	if (tooLarge)
+	{
+		AppendOnlyVisimap_UnloadSegmentFile(visiMap);
+
+		elogif(Debug_appendonly_print_visimap, LOG,
+				"Append-only visi map: hidden rows of segment file %d "
+				"exceed work_mem, not loading them", segno);
+		return;
+	}
+
+	visiMap->loadedSegno = segno;
+
+	elogif(Debug_appendonly_print_visimap, LOG,
+			"Append-only visi map: loaded hidden rows of segment file %d "
+			"(%d ranges, %ld bytes)",
+			segno, visiMap->numHiddenRanges, loadedBytes);
+}
+
+/*
+ * Returns true if the rows firstRowNum .. firstRowNum + rowCount - 1 of the
+ * segment file are all known to be visible according to the visibility map,
+ * so that a scan can skip checking them one at a time.  A false result
+ * means they have to be checked with AppendOnlyVisimap_IsVisible.
+ */
+bool
+AppendOnlyVisimap_IsRangeVisible(
+		AppendOnlyVisimap *visiMap,
+		int segno,
+		int64 firstRowNum,
+		int64 rowCount)
+{
+	int64 range;
+	int64 lastRange;
+
+	Assert(visiMap);
+	Assert(firstRowNum >= 0);
+	Assert(rowCount > 0);
+
+	if (visiMap->loadedSegno != segno)
+		return false;
+
+	lastRange = (firstRowNum + rowCount - 1) / APPENDONLY_VISIMAP_MAX_RANGE;
+	for (range = firstRowNum / APPENDONLY_VISIMAP_MAX_RANGE;
+		 range <= lastRange && range < visiMap->numHiddenRanges;
+		 range++)
+	{
+		if (visiMap->hiddenRanges[range] != NULL)
+			return false;
+	}
+	return true;
+}
+
 /*
  * Moves the visibility map entry so that the given
  * AO tuple id is covered by it.
@@ -185,6 +370,18 @@ AppendOnlyVisimap_IsVisible(
 		AOTupleId *aoTupleId)
 {
 	Assert(visiMap);
+
+	if (visiMap->loadedSegno == AOTupleIdGet_segmentFileNum(aoTupleId))
+	{
+		int64 rowNum = AOTupleIdGet_rowNum(aoTupleId);
+		int64 range = rowNum / APPENDONLY_VISIMAP_MAX_RANGE;
+
+		if (range >= visiMap->numHiddenRanges ||
+			visiMap->hiddenRanges[range] == NULL)
+			return true;
+		return !bms_is_member(rowNum % APPENDONLY_VISIMAP_MAX_RANGE,
+				visiMap->hiddenRanges[range]);
+	}
 	
 	elogif (Debug_appendonly_print_visimap, LOG, 
 			"Append-only visi map: Visibility check: "
@@ -272,6 +469,78 @@ AppendOnlyVisimap_GetSegmentFileHiddenTupleCount(
 			&visiMap->visimapStore, &visiMap->visimapEntry, segno);
 }
 
+/*
+ * Returns the first row of a segment file that is not hidden, so that a
+ * scan that only wants the visible rows can start there instead of at the
+ * beginning.  Row numbers start at 1; rows past the end of the segment file
+ * count as not hidden.
+ *
+ * Assumes that the visimap entry holds no changes.
+ */
+int64
+AppendOnlyVisimap_GetFirstUnhiddenRowNum(
+	AppendOnlyVisimap *visiMap,
+	int segno)
+{
+	AppendOnlyVisimapEntry *visiMapEntry = &visiMap->visimapEntry;
+	ScanKeyData scanKey;
+	IndexScanDesc indexScan;
+	int64 rowNum = 1;
+
+	Assert(visiMap);
+	Assert(!AppendOnlyVisimapEntry_HasChanged(visiMapEntry));
+
+	ScanKeyInit(&scanKey,
+			Anum_pg_aovisimap_segno, /* segno */
+			BTEqualStrategyNumber,
+			F_INT4EQ,
+			Int32GetDatum(segno));
+
+	indexScan = AppendOnlyVisimapStore_BeginScan(
+			&visiMap->visimapStore,
+			1,
+			&scanKey);
+
+	/* The entries come in row number order */
+	while (AppendOnlyVisimapStore_GetNext(&visiMap->visimapStore,
+				indexScan, ForwardScanDirection,
+				visiMapEntry, NULL))
+	{
+		Bitmapset *bitmap = visiMapEntry->bitmap;
+		int offset;
+
+		/* An entry's rows only continue the hidden run if it starts there */
+		if (visiMapEntry->firstRowNum > rowNum ||
+			visiMapEntry->firstRowNum + APPENDONLY_VISIMAP_MAX_RANGE <= rowNum)
+			break;
+
+		offset = (int) (rowNum - visiMapEntry->firstRowNum);
+		while (offset < APPENDONLY_VISIMAP_MAX_RANGE)
+		{
+			int wordnum = offset / BITS_PER_BITMAPWORD;
+
+			if (bitmap == NULL || wordnum >= bitmap->nwords)
+				break;
+			if (offset % BITS_PER_BITMAPWORD == 0 &&
+				bitmap->words[wordnum] == ~((bitmapword) 0))
+				offset += BITS_PER_BITMAPWORD;
+			else if (bms_is_member(offset, bitmap))
+				offset++;
+			else
+				break;
+		}
+		rowNum = visiMapEntry->firstRowNum + offset;
+
+		if (offset < APPENDONLY_VISIMAP_MAX_RANGE)
+			break;
+	}
+	AppendOnlyVisimapStore_EndScan(&visiMap->visimapStore, indexScan);
+
+	AppendOnlyVisimapEntry_Reset(visiMapEntry);
+
+	return rowNum;
+}
+
 /*
  * Starts a new scan for invisible tuple ids.
  */ 
@@ -0,0 +1,443 @@
+/*------------------------------------------------------------------------------
+ *
+ * appendonly_zonemap
+ *   per-block value ranges of append-only tables.
+ *
+ * Copyright (c) 2017, Pivotal.
+ *
+ *------------------------------------------------------------------------------
+*/
+#include "postgres.h"
+#include "access/appendonly_zonemap.h"
+#include "access/nbtree.h"
+#include "utils/datum.h"
+#include "utils/guc.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+#include "utils/typcache.h"
+
+/*
+ * Argument of the zone callback of AppendOnlyZoneFilter_BeginSegment.
+ */
+typedef struct ZoneFilterScanArg
+{
+	AppendOnlyZoneFilter *filter;
+	AttrNumber	attno;
+} ZoneFilterScanArg;
+
+static bool zone_refutes_qual(AppendOnlyZoneQual *qual, MinipageZone *zone);
+static void zone_filter_add_range(AppendOnlyZoneFilter *filter,
+					  int64 firstRowNum, int64 lastRowNum);
+static int	zone_range_cmp(const void *a, const void *b);
+
+/*
+ * Returns true if zones are kept for the given column, and sets *cmp to the
+ * comparison function of its type's default btree opclass.
+ *
+ * Zones store values in a MinipageZone's int64 fields, so only by-value
+ * types qualify.
+ */
+bool
+AppendOnlyZone_ColumnWanted(Form_pg_attribute attr, FmgrInfo **cmp)
+{
+	TypeCacheEntry *typentry;
+
+	*cmp = NULL;
+
+	if (attr->attisdropped || !attr->attbyval || attr->attlen <= 0)
+		return false;
+
+	typentry = lookup_type_cache(attr->atttypid, TYPECACHE_CMP_PROC_FINFO);
+	if (!OidIsValid(typentry->cmp_proc_finfo.fn_oid))
+		return false;
+
+	*cmp = &typentry->cmp_proc_finfo;
+	return true;
+}
+
+void
+AppendOnlyZone_Reset(MinipageZone *zone)
+{
+	MemSet(zone, 0, sizeof(MinipageZone));
+}
+
+/*
+ * Adds a value of the column to its zone.
+ */
+void
+AppendOnlyZone_AddValue(MinipageZone *zone, FmgrInfo *cmp,
+						Datum value, bool isnull)
+{
+	int64		v = (int64) value;
+
+	if (isnull)
+	{
+		zone->rowCount++;
+		zone->nullCount++;
+		return;
+	}
+
+	if (zone->rowCount == zone->nullCount)
+	{
+		zone->minValue = v;
+		zone->maxValue = v;
+	}
+	else
+	{
+		if (DatumGetInt32(FunctionCall2(cmp, value,
+										(Datum) zone->minValue)) < 0)
+			zone->minValue = v;
+		else if (DatumGetInt32(FunctionCall2(cmp, value,
+											 (Datum) zone->maxValue)) > 0)
+			zone->maxValue = v;
+	}
+
+	zone->rowCount++;
+}
+
+/*
+ * Builds a zone filter from the quals of a scan of an append-only relation.
+ *
+ * Returns NULL if zone maps are off, the relation has no block directory,
+ * or none of the quals can refute zones.
+ */
+AppendOnlyZoneFilter *
+AppendOnlyZoneFilter_Create(Relation rel, List *qual, Index scanrelid)
+{
+	AppendOnlyZoneFilter *filter;
+	MemoryContext oldcxt;
+	TupleDesc	tupdesc = RelationGetDescr(rel);
+	ListCell   *lc;
+
+	if (!gp_appendonly_zone_maps || qual == NIL)
+		return NULL;
+
+	if (!OidIsValid(rel->rd_appendonly->blkdirrelid))
+		return NULL;
+
+	filter = palloc0(sizeof(AppendOnlyZoneFilter));
+	filter->memoryContext = AllocSetContextCreate(CurrentMemoryContext,
+												  "AppendOnlyZoneFilter",
+												  ALLOCSET_SMALL_MINSIZE,
+												  ALLOCSET_SMALL_INITSIZE,
+												  ALLOCSET_DEFAULT_MAXSIZE);
+	oldcxt = MemoryContextSwitchTo(filter->memoryContext);
+
+	filter->quals = palloc0(list_length(qual) * sizeof(AppendOnlyZoneQual));
+
+	foreach(lc, qual)
+	{
+		Node	   *clause = (Node *) lfirst(lc);
+		AppendOnlyZoneQual *zoneQual = &filter->quals[filter->numQuals];
+		Var		   *var;
+		Form_pg_attribute attr;
+		FmgrInfo   *cmp;
+
+		if (IsA(clause, NullTest))
+		{
+			NullTest   *ntest = (NullTest *) clause;
+
+			if (!IsA(ntest->arg, Var))
+				continue;
+			var = (Var *) ntest->arg;
+			if (var->varno != scanrelid || var->varlevelsup != 0 ||
+				var->varattno <= 0 || var->varattno > tupdesc->natts)
+				continue;
+			attr = tupdesc->attrs[var->varattno - 1];
+			if (!AppendOnlyZone_ColumnWanted(attr, &cmp))
+				continue;
+
+			zoneQual->attno = var->varattno;
+			zoneQual->strategy = InvalidStrategy;
+			zoneQual->nulltesttype = ntest->nulltesttype;
+			filter->numQuals++;
+		}
+		else if (IsA(clause, OpExpr) &&
+				 list_length(((OpExpr *) clause)->args) == 2)
+		{
+			OpExpr	   *opexpr = (OpExpr *) clause;
+			Node	   *left = linitial(opexpr->args);
+			Node	   *right = lsecond(opexpr->args);
+			Oid			opno = opexpr->opno;
+			Const	   *con;
+			TypeCacheEntry *typentry;
+			int			strategy;
+			Oid			lefttype;
+			Oid			righttype;
+			Oid			cmpproc;
+
+			if (IsA(left, Var) && IsA(right, Const))
+			{
+				var = (Var *) left;
+				con = (Const *) right;
+			}
+			else if (IsA(left, Const) && IsA(right, Var))
+			{
+				var = (Var *) right;
+				con = (Const *) left;
+				opno = get_commutator(opno);
+				if (!OidIsValid(opno))
+					continue;
+			}
+			else
+				continue;
+
+			if (var->varno != scanrelid || var->varlevelsup != 0 ||
+				var->varattno <= 0 || var->varattno > tupdesc->natts ||
+				con->constisnull)
+				continue;
+			attr = tupdesc->attrs[var->varattno - 1];
+			if (var->vartype != attr->atttypid ||
+				!AppendOnlyZone_ColumnWanted(attr, &cmp))
+				continue;
+
+			/*
+			 * The operator must be a btree operator of the column type's
+			 * default opclass, for the zone's min and max to mean anything
+			 * to it.
+			 */
+			typentry = lookup_type_cache(attr->atttypid,
+										 TYPECACHE_BTREE_OPFAMILY);
+			if (!OidIsValid(typentry->btree_opf))
+				continue;
+			strategy = get_op_opfamily_strategy(opno, typentry->btree_opf);
+			if (strategy == InvalidStrategy)
+				continue;
+
+			op_input_types(opno, &lefttype, &righttype);
+			if (lefttype != attr->atttypid || righttype != con->consttype)
+				continue;
+			cmpproc = get_opfamily_proc(typentry->btree_opf, lefttype,
+										righttype, BTORDER_PROC);
+			if (!RegProcedureIsValid(cmpproc))
+				continue;
+
+			zoneQual->attno = var->varattno;
+			zoneQual->strategy = strategy;
+			zoneQual->constValue = datumCopy(con->constvalue, con->constbyval,
+											 con->constlen);
+			fmgr_info_cxt(cmpproc, &zoneQual->cmp, filter->memoryContext);
+			filter->numQuals++;
+		}
+	}
+
+	MemoryContextSwitchTo(oldcxt);
+
+	if (filter->numQuals == 0)
+	{
+		AppendOnlyZoneFilter_Free(filter);
+		return NULL;
+	}
+
+	return filter;
+}
+
+/*
+ * Does the zone show that no row it summarizes satisfies the qual?
+ */
+static bool
+zone_refutes_qual(AppendOnlyZoneQual *qual, MinipageZone *zone)
+{
+	int32		cmpmin;
+	int32		cmpmax;
+
+	if (qual->strategy == InvalidStrategy)
+	{
+		if (qual->nulltesttype == IS_NULL)
+			return zone->nullCount == 0;
+		else
+			return zone->nullCount == zone->rowCount;
+	}
+
+	/* Strict operators are never true for NULLs */
+	if (zone->nullCount == zone->rowCount)
+		return true;
+
+	cmpmin = DatumGetInt32(FunctionCall2(&qual->cmp, (Datum) zone->minValue,
+										 qual->constValue));
+	cmpmax = DatumGetInt32(FunctionCall2(&qual->cmp, (Datum) zone->maxValue,
+										 qual->constValue));
+
+	switch (qual->strategy)
+	{
+		case BTLessStrategyNumber:
+			return cmpmin >= 0;
+		case BTLessEqualStrategyNumber:
+			return cmpmin > 0;
+		case BTEqualStrategyNumber:
+			return cmpmin > 0 || cmpmax < 0;
+		case BTGreaterEqualStrategyNumber:
+			return cmpmax < 0;
+		case BTGreaterStrategyNumber:
+			return cmpmax <= 0;
+		default:
+			return false;
+	}
+}
+
+static void
+zone_filter_add_range(AppendOnlyZoneFilter *filter,
+					  int64 firstRowNum, int64 lastRowNum)
+{
+	if (filter->numRanges == filter->maxRanges)
+	{
+		MemoryContext oldcxt = MemoryContextSwitchTo(filter->memoryContext);
+
+		if (filter->maxRanges == 0)
+		{
+			filter->maxRanges = 64;
+			filter->ranges = palloc(filter->maxRanges * sizeof(AppendOnlyZoneRange));
+		}
+		else
+		{
+			filter->maxRanges *= 2;
+			filter->ranges = repalloc(filter->ranges,
+									  filter->maxRanges * sizeof(AppendOnlyZoneRange));
+		}
+
+		MemoryContextSwitchTo(oldcxt);
+	}
+
+	filter->ranges[filter->numRanges].firstRowNum = firstRowNum;
+	filter->ranges[filter->numRanges].lastRowNum = lastRowNum;
+	filter->numRanges++;
+}
+
+static void
+zone_filter_scan_callback(void *arg, MinipageEntry *entry, MinipageZone *zone)
+{
+	ZoneFilterScanArg *scanArg = (ZoneFilterScanArg *) arg;
+	AppendOnlyZoneFilter *filter = scanArg->filter;
+	int			qualNo;
+
+	for (qualNo = 0; qualNo < filter->numQuals; qualNo++)
+	{
+		AppendOnlyZoneQual *qual = &filter->quals[qualNo];
+
+		if (qual->attno == scanArg->attno && zone_refutes_qual(qual, zone))
+		{
+			/*
+			 * Nothing precedes the first block of the file, so the range
+			 * also covers any row numbers skipped before it.
+			 */
+			zone_filter_add_range(filter,
+								  entry->fileOffset == 0 ? 1 : entry->firstRowNum,
+								  entry->firstRowNum + zone->rowCount - 1);
+			return;
+		}
+	}
+}
+
+static int
+zone_range_cmp(const void *a, const void *b)
+{
+	const AppendOnlyZoneRange *ra = (const AppendOnlyZoneRange *) a;
+	const AppendOnlyZoneRange *rb = (const AppendOnlyZoneRange *) b;
+
+	if (ra->firstRowNum < rb->firstRowNum)
+		return -1;
+	if (ra->firstRowNum > rb->firstRowNum)
+		return 1;
+	return 0;
+}
+
+/*
+ * Finds the ranges of rows of a segment file refuted by the zones of the
+ * columns in the quals.
+ *
+ * eof is the eof of a row-oriented segment file; vpinfo gives the eof of
+ * each column of a column-oriented one, and is NULL for row-oriented tables.
+ */
+void
+AppendOnlyZoneFilter_BeginSegment(AppendOnlyZoneFilter *filter,
+								  Relation rel,
+								  Snapshot appendOnlyMetaDataSnapshot,
+								  int segno, int64 eof, AOCSVPInfo *vpinfo)
+{
+	ZoneFilterScanArg scanArg;
+	int			qualNo;
+	int			rangeNo;
+	int			numMerged;
+
+	filter->numRanges = 0;
+	filter->nextRange = 0;
+	scanArg.filter = filter;
+
+	for (qualNo = 0; qualNo < filter->numQuals; qualNo++)
+	{
+		AttrNumber	attno = filter->quals[qualNo].attno;
+		int			prevNo;
+
+		/* Scan the zones of each column once */
+		for (prevNo = 0; prevNo < qualNo; prevNo++)
+		{
+			if (filter->quals[prevNo].attno == attno)
+				break;
+		}
+		if (prevNo < qualNo)
+			continue;
+
+		scanArg.attno = attno;
+		if (vpinfo != NULL)
+		{
+			if (attno > vpinfo->nEntry)
+				continue;
+			AppendOnlyBlockDirectory_ScanZones(rel, appendOnlyMetaDataSnapshot,
+											   segno, attno - 1, 0,
+											   vpinfo->entry[attno - 1].eof,
+											   zone_filter_scan_callback,
+											   &scanArg);
+		}
+		else
+			AppendOnlyBlockDirectory_ScanZones(rel, appendOnlyMetaDataSnapshot,
+											   segno, 0, attno - 1, eof,
+											   zone_filter_scan_callback,
+											   &scanArg);
+	}
+
+	if (filter->numRanges == 0)
+		return;
+
+	/* Sort the ranges, and merge the overlapping and adjacent ones */
+	qsort(filter->ranges, filter->numRanges, sizeof(AppendOnlyZoneRange),
+		  zone_range_cmp);
+
+	numMerged = 0;
+	for (rangeNo = 1; rangeNo < filter->numRanges; rangeNo++)
+	{
+		AppendOnlyZoneRange *last = &filter->ranges[numMerged];
+		AppendOnlyZoneRange *range = &filter->ranges[rangeNo];
+
+		if (range->firstRowNum <= last->lastRowNum + 1)
+			last->lastRowNum = Max(last->lastRowNum, range->lastRowNum);
+		else
+			filter->ranges[++numMerged] = *range;
+	}
+	filter->numRanges = numMerged + 1;
+}
+
+/*
+ * Returns the first row at or after rowNum that the zones do not refute.
+ *
+ * The row numbers passed in must not decrease within a segment file.
+ */
+int64
+AppendOnlyZoneFilter_NextLiveRow(AppendOnlyZoneFilter *filter, int64 rowNum)
+{
+	while (filter->nextRange < filter->numRanges &&
+		   filter->ranges[filter->nextRange].lastRowNum < rowNum)
+		filter->nextRange++;
+
+	if (filter->nextRange < filter->numRanges &&
+		filter->ranges[filter->nextRange].firstRowNum <= rowNum)
+		return filter->ranges[filter->nextRange].lastRowNum + 1;
+
+	return rowNum;
+}
+
+void
+AppendOnlyZoneFilter_Free(AppendOnlyZoneFilter *filter)
+{
+	MemoryContextDelete(filter->memoryContext);
+	pfree(filter);
+}
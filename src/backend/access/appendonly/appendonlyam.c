@@ -26,6 +26,7 @@
 #include "postgres.h"
 
 #include "access/aosegfiles.h"
+#include "access/appendonly_zonemap.h"
 #include "access/appendonlytid.h"
 #include "access/appendonlywriter.h"
 #include "access/aomd.h"
@@ -332,6 +333,19 @@ SetNextFileSegForRead(AppendOnlyScanDesc scan)
 												 &scan->executorReadBlock,
 												  /* blockFirstRowNum */ 1);
 
+	/* Check visibility against the segment file's hidden rows in memory */
+	if (gp_appendonly_visimap_preload && scan->snapshot != SnapshotAny)
+		AppendOnlyVisimap_LoadSegmentFile(&scan->visibilityMap, segno);
+
+	/* Find the rows of the segment file the zones refute */
+	if (scan->zoneFilter != NULL && scan->blockDirectory == NULL)
+		AppendOnlyZoneFilter_BeginSegment(scan->zoneFilter,
+										  reln,
+										  scan->appendOnlyMetaDataSnapshot,
+										  segno,
+										  eof,
+										  NULL);
+
 	/* ready to go! */
 	scan->aos_need_new_segfile = false;
 
@@ -1317,6 +1331,25 @@ AppendOnlyExecutorReadBlock_FetchTuple(AppendOnlyExecutorReadBlock *executorRead
 
 /* ------------------------------------------------------------------------------ */
 
+/*
+ * Does the scan want none of the rows of the block whose info was just
+ * read?
+ */
+static bool
+canSkipBlock(AppendOnlyScanDesc scan)
+{
+	int64		nextRowNum = scan->executorReadBlock.blockFirstRowNum +
+		scan->executorReadBlock.rowCount;
+
+	if (nextRowNum <= scan->startRowNum)
+		return true;
+
+	return (scan->zoneFilter != NULL &&
+			AppendOnlyZoneFilter_NextLiveRow(scan->zoneFilter,
+											 scan->executorReadBlock.blockFirstRowNum) >=
+			nextRowNum);
+}
+
 /*
  * You can think of this scan routine as get next "executor" AO block.
  */
@@ -1347,6 +1380,28 @@ getNextBlock(AppendOnlyScanDesc scan)
 		return false;
 	}
 
+	/*
+	 * Skip the block without reading its content if all of its rows come
+	 * before startRowNum, or if the zones refute a qual of the scan for all
+	 * of them.
+	 */
+	while (scan->blockDirectory == NULL &&
+		   scan->storageRead.current.hasFirstRowNum &&
+		   canSkipBlock(scan))
+	{
+		AppendOnlyStorageRead_SkipCurrentBlock(&scan->storageRead);
+		AppendOnlyExecutionReadBlock_FinishedScanBlock(&scan->executorReadBlock);
+		if (scan->zoneFilter != NULL)
+			scan->zoneFilter->blocksSkipped++;
+
+		if (!AppendOnlyExecutorReadBlock_GetBlockInfo(&scan->storageRead,
+													  &scan->executorReadBlock))
+		{
+			CloseScannedFileSeg(scan);
+			return false;
+		}
+	}
+
 	if (scan->blockDirectory)
 	{
 		AppendOnlyBlockDirectory_InsertEntry(
@@ -1601,7 +1656,20 @@ finishWriteBlock(AppendOnlyInsertDesc aoInsertDesc)
 	}
 
 	/* Insert an entry to the block directory */
-	AppendOnlyBlockDirectory_InsertEntry(
+	if (aoInsertDesc->zones != NULL)
+	{
+		AppendOnlyBlockDirectory_InsertEntryWithZones(
+										 &aoInsertDesc->blockDirectory,
+										 0,
+										 aoInsertDesc->blockFirstRowNum,
+										 AppendOnlyStorageWrite_LogicalBlockStartOffset(&aoInsertDesc->storageWrite),
+										 itemCount,
+										 aoInsertDesc->zones);
+		MemSet(aoInsertDesc->zones, 0,
+			   RelationGetNumberOfAttributes(aoInsertDesc->aoi_rel) * sizeof(MinipageZone));
+	}
+	else
+		AppendOnlyBlockDirectory_InsertEntry(
 										 &aoInsertDesc->blockDirectory,
 										 0,
 										 aoInsertDesc->blockFirstRowNum,
@@ -2889,6 +2957,19 @@ aoInsertDesc->appendOnlyMetaDataSnapshot, //CONCERN:Safe to assume all block dir
 											aoInsertDesc->fsInfo, aoInsertDesc->lastSequence,
 											rel, segno, 1, false);
 
+	/* Keep the zones of the columns the block directory wants */
+	if (aoInsertDesc->blockDirectory.numZoneColumns > 0)
+	{
+		TupleDesc	tupleDesc = RelationGetDescr(rel);
+		int			i;
+
+		aoInsertDesc->zones = palloc0(tupleDesc->natts * sizeof(MinipageZone));
+		aoInsertDesc->zoneCmps = palloc0(tupleDesc->natts * sizeof(FmgrInfo *));
+		for (i = 0; i < tupleDesc->natts; i++)
+			AppendOnlyZone_ColumnWanted(tupleDesc->attrs[i],
+										&aoInsertDesc->zoneCmps[i]);
+	}
+
 	return aoInsertDesc;
 }
 
@@ -3072,6 +3153,26 @@ appendonly_insert(AppendOnlyInsertDesc aoInsertDesc,
 
 		if (itemLen > 0)
 			memcpy(itemPtr, tup, itemLen);
+
+		if (aoInsertDesc->zones != NULL)
+		{
+			int			natts = RelationGetNumberOfAttributes(relation);
+			int			i;
+
+			for (i = 0; i < natts; i++)
+			{
+				Datum		value;
+				bool		isnull;
+
+				if (aoInsertDesc->zoneCmps[i] == NULL)
+					continue;
+
+				value = memtuple_getattr(tup, aoInsertDesc->mt_bind, i + 1, &isnull);
+				AppendOnlyZone_AddValue(&aoInsertDesc->zones[i],
+										aoInsertDesc->zoneCmps[i],
+										value, isnull);
+			}
+		}
 	}
 	else
 	{
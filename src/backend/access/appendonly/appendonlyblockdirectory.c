@@ -30,6 +30,11 @@ static inline uint32 minipage_size(uint32 nEntry)
 		sizeof(MinipageEntry) * nEntry;
 }
 
+static inline uint32 minipage_zones_size(uint32 nEntry, int numZoneColumns)
+{
+	return sizeof(MinipageZone) * nEntry * numZoneColumns;
+}
+
 static void load_last_minipage(
 	AppendOnlyBlockDirectory *blockDirectory,
 	int64 lastSequence,
@@ -56,6 +61,7 @@ insert_new_entry(AppendOnlyBlockDirectory *blockDirectory,
 				 int64 firstRowNum,
 				 int64 fileOffset,
 				 int64 rowCount,
+				 MinipageZone *zones,
 				 bool addColAction);
 
 void 
@@ -146,6 +152,11 @@ init_internal(AppendOnlyBlockDirectory *blockDirectory)
 		minipageInfo->minipage =
 			palloc0(minipage_size(NUM_MINIPAGE_ENTRIES));
 		minipageInfo->numMinipageEntries = 0;
+
+		if (blockDirectory->numZoneColumns > 0)
+			minipageInfo->zones =
+				palloc0(minipage_zones_size(blockDirectory->maxZonedEntries,
+											blockDirectory->numZoneColumns));
 	}
 
 	MemoryContextSwitchTo(oldcxt);
@@ -172,6 +183,7 @@ AppendOnlyBlockDirectory_Init_forSearch(
 	bool *proj)
 {
 	blockDirectory->aoRel = aoRel;
+	blockDirectory->numZoneColumns = 0;
 
 	if (!OidIsValid(aoRel->rd_appendonly->blkdirrelid))
 	{
@@ -234,6 +246,7 @@ AppendOnlyBlockDirectory_Init_forInsert(
 
 	blockDirectory->aoRel = aoRel;
 	blockDirectory->appendOnlyMetaDataSnapshot = appendOnlyMetaDataSnapshot;
+	blockDirectory->numZoneColumns = 0;
 
 	if (!OidIsValid(aoRel->rd_appendonly->blkdirrelid))
 	{
@@ -263,6 +276,26 @@ AppendOnlyBlockDirectory_Init_forInsert(
 	blockDirectory->blkdirIdx =
 		index_open(aoRel->rd_appendonly->blkdiridxid, RowExclusiveLock);
 
+	/*
+	 * Keep zone maps of the inserted rows if asked to, unless a minipage
+	 * with zones for this many columns would hold too few entries.
+	 */
+	if (gp_appendonly_zone_maps)
+	{
+		int numZoneColumns = isAOCol ? 1 : RelationGetNumberOfAttributes(aoRel);
+		uint32 maxZonedEntries;
+
+		maxZonedEntries = MINIPAGE_ZONE_BUDGET /
+			(sizeof(MinipageEntry) + numZoneColumns * sizeof(MinipageZone));
+		maxZonedEntries = Min(maxZonedEntries, NUM_MINIPAGE_ENTRIES);
+
+		if (maxZonedEntries >= MIN_ZONED_MINIPAGE_ENTRIES)
+		{
+			blockDirectory->numZoneColumns = numZoneColumns;
+			blockDirectory->maxZonedEntries = maxZonedEntries;
+		}
+	}
+
 	init_internal(blockDirectory);
 
 	ereportif(Debug_appendonly_print_blockdirectory, LOG,
@@ -296,6 +329,7 @@ AppendOnlyBlockDirectory_Init_addCol(
 {
 	blockDirectory->aoRel = aoRel;
 	blockDirectory->appendOnlyMetaDataSnapshot = appendOnlyMetaDataSnapshot;
+	blockDirectory->numZoneColumns = 0;
 
 	if (!OidIsValid(aoRel->rd_appendonly->blkdirrelid))
 	{
@@ -664,7 +698,28 @@ AppendOnlyBlockDirectory_InsertEntry(
 	bool addColAction)
 {
 	return insert_new_entry(blockDirectory, columnGroupNo, firstRowNum,
-							fileOffset, rowCount, addColAction);
+							fileOffset, rowCount, NULL, addColAction);
+}
+
+/*
+ * AppendOnlyBlockDirectory_InsertEntryWithZones
+ *
+ * Same as AppendOnlyBlockDirectory_InsertEntry, also recording the zones of
+ * the rows of the new block: one zone for a column group of a column-oriented
+ * table, or one per attribute of a row-oriented table.  The zones are ignored
+ * if the block directory does not keep zone maps.
+ */
+bool
+AppendOnlyBlockDirectory_InsertEntryWithZones(
+	AppendOnlyBlockDirectory *blockDirectory,
+	int columnGroupNo,
+	int64 firstRowNum,
+	int64 fileOffset,
+	int64 rowCount,
+	MinipageZone *zones)
+{
+	return insert_new_entry(blockDirectory, columnGroupNo, firstRowNum,
+							fileOffset, rowCount, zones, false);
 }
 
 /*
@@ -679,12 +734,14 @@ insert_new_entry(
 		int64 firstRowNum,
 		int64 fileOffset,
 		int64 rowCount,
+		MinipageZone *zones,
 		bool addColAction)
 {
 	MinipageEntry *entry = NULL;
 	MinipagePerColumnGroup *minipageInfo;
 	int minipageIndex;
 	int lastEntryNo;
+	uint32 maxEntries;
 
 	if (rowCount == 0)
 		return false;
@@ -722,6 +779,10 @@ insert_new_entry(
 		Assert(entry->firstRowNum < firstRowNum);
 		Assert(entry->fileOffset < fileOffset);
 		
+		/*
+		 * The zones of the latest entry keep summarizing only its first
+		 * block's rows when later blocks are folded into the entry.
+		 */
 		if (gp_blockdirectory_entry_min_range > 0 &&
 			fileOffset - entry->fileOffset < gp_blockdirectory_entry_min_range)
 			return true;
@@ -743,7 +804,11 @@ insert_new_entry(
 		entry->rowCount = firstRowNum - entry->firstRowNum;
 	}
 	
-	if (minipageInfo->numMinipageEntries >= (uint32)gp_blockdirectory_minipage_size)
+	maxEntries = (uint32) gp_blockdirectory_minipage_size;
+	if (minipageInfo->zones != NULL)
+		maxEntries = Min(maxEntries, blockDirectory->maxZonedEntries);
+
+	if (minipageInfo->numMinipageEntries >= maxEntries)
 	{
 		write_minipage(blockDirectory, columnGroupNo, minipageInfo);
 
@@ -755,15 +820,32 @@ insert_new_entry(
 		 */
 		MemSet(minipageInfo->minipage->entry, 0,
 			   minipageInfo->numMinipageEntries * sizeof(MinipageEntry));
+		if (minipageInfo->zones != NULL)
+			MemSet(minipageInfo->zones, 0,
+				   minipage_zones_size(blockDirectory->maxZonedEntries,
+									   blockDirectory->numZoneColumns));
 		minipageInfo->numMinipageEntries = 0;
 	}
 	
-	Assert(minipageInfo->numMinipageEntries < (uint32)gp_blockdirectory_minipage_size);
+	Assert(minipageInfo->numMinipageEntries < maxEntries);
 
 	entry = &(minipageInfo->minipage->entry[minipageInfo->numMinipageEntries]);
 	entry->firstRowNum = firstRowNum;
 	entry->fileOffset = fileOffset;
 	entry->rowCount = rowCount;
+
+	if (minipageInfo->zones != NULL)
+	{
+		MinipageZone *entryZones = &minipageInfo->zones[
+			minipageInfo->numMinipageEntries * blockDirectory->numZoneColumns];
+
+		if (zones != NULL)
+			memcpy(entryZones, zones,
+				   minipage_zones_size(1, blockDirectory->numZoneColumns));
+		else
+			MemSet(entryZones, 0,
+				   minipage_zones_size(1, blockDirectory->numZoneColumns));
+	}
 	
 	minipageInfo->numMinipageEntries++;
 	
@@ -822,6 +904,116 @@ AppendOnlyBlockDirectory_DeleteSegmentFile(Relation aoRel,
 
 }
 
+/*
+ * AppendOnlyBlockDirectory_ScanZones
+ *
+ * Calls the callback for every block directory entry of the given segment
+ * file and column group that has a zone for the given zone column.  Entries
+ * at or beyond the eof of the segment file are not visited.
+ */
+void
+AppendOnlyBlockDirectory_ScanZones(Relation aoRel,
+		Snapshot appendOnlyMetaDataSnapshot,
+		int segno,
+		int columnGroupNo,
+		int zoneColumnNo,
+		int64 eof,
+		AppendOnlyBlockDirectoryZoneCallback callback,
+		void *arg)
+{
+	Relation	blkdirRel;
+	Relation	blkdirIdx;
+	TupleDesc	heapTupleDesc;
+	ScanKeyData scanKeys[2];
+	IndexScanDesc indexScan;
+	HeapTuple	tuple;
+	Datum		values[Natts_pg_aoblkdir];
+	bool		nulls[Natts_pg_aoblkdir];
+	Minipage   *minipage;
+
+	if (!OidIsValid(aoRel->rd_appendonly->blkdirrelid))
+		return;
+
+	Assert(OidIsValid(aoRel->rd_appendonly->blkdiridxid));
+
+	blkdirRel = heap_open(aoRel->rd_appendonly->blkdirrelid, AccessShareLock);
+	blkdirIdx = index_open(aoRel->rd_appendonly->blkdiridxid, AccessShareLock);
+	heapTupleDesc = RelationGetDescr(blkdirRel);
+
+	ScanKeyInit(&scanKeys[0],
+			Anum_pg_aoblkdir_segno,
+			BTEqualStrategyNumber,
+			F_INT4EQ,
+			Int32GetDatum(segno));
+	ScanKeyInit(&scanKeys[1],
+			Anum_pg_aoblkdir_columngroupno,
+			BTEqualStrategyNumber,
+			F_INT4EQ,
+			Int32GetDatum(columnGroupNo));
+
+	/* The minipage is copied out to have its 8-byte fields aligned */
+	minipage = palloc(MaxHeapTupleSize);
+
+	indexScan = index_beginscan(blkdirRel,
+								blkdirIdx,
+								appendOnlyMetaDataSnapshot,
+								2,
+								scanKeys);
+
+	while ((tuple = index_getnext(indexScan, ForwardScanDirection)) != NULL)
+	{
+		struct varlena *value;
+		struct varlena *detoast_value;
+		uint32		nEntry;
+		int			numZoneColumns;
+		MinipageZone *zones;
+		uint32		entryNo;
+
+		heap_deform_tuple(tuple, heapTupleDesc, values, nulls);
+		if (nulls[Anum_pg_aoblkdir_minipage - 1])
+			continue;
+
+		value = (struct varlena *)
+			DatumGetPointer(values[Anum_pg_aoblkdir_minipage - 1]);
+		detoast_value = pg_detoast_datum(value);
+
+		if (VARSIZE(detoast_value) > MaxHeapTupleSize)
+			elog(ERROR, "invalid block directory minipage size %u",
+				 (uint32) VARSIZE(detoast_value));
+		memcpy(minipage, detoast_value, VARSIZE(detoast_value));
+		if (detoast_value != value)
+			pfree(detoast_value);
+
+		nEntry = minipage->nEntry;
+		if (minipage->version != MINIPAGE_VERSION_ZONES || nEntry == 0 ||
+			VARSIZE(minipage) <= minipage_size(nEntry))
+			continue;
+
+		numZoneColumns = (VARSIZE(minipage) - minipage_size(nEntry)) /
+			minipage_zones_size(nEntry, 1);
+		if (zoneColumnNo >= numZoneColumns)
+			continue;
+
+		zones = (MinipageZone *) (((char *) minipage) + minipage_size(nEntry));
+		for (entryNo = 0; entryNo < nEntry; entryNo++)
+		{
+			MinipageEntry *entry = &minipage->entry[entryNo];
+			MinipageZone *zone = &zones[entryNo * numZoneColumns + zoneColumnNo];
+
+			if (entry->fileOffset >= eof || zone->rowCount <= 0)
+				continue;
+
+			callback(arg, entry, zone);
+		}
+	}
+
+	index_endscan(indexScan);
+	pfree(minipage);
+
+	index_close(blkdirIdx, AccessShareLock);
+	heap_close(blkdirRel, AccessShareLock);
+}
+
 /*
  * init_scankeys
  *
@@ -882,29 +1074,56 @@ init_scankeys(TupleDesc tupleDesc,
  * copy_out_minipage
  *
  * Copy out the minipage content from a deformed tuple.
+ *
+ * The zones stored with the entries are copied out too if the block
+ * directory keeps zone maps, and reset otherwise.
  */
 static inline void
-copy_out_minipage(MinipagePerColumnGroup *minipageInfo,
+copy_out_minipage(AppendOnlyBlockDirectory *blockDirectory,
+				  MinipagePerColumnGroup *minipageInfo,
 				  Datum minipage_value,
 				  bool minipage_isnull)
 {
 	struct varlena *value;
 	struct varlena *detoast_value;
+	Minipage   *minipage;
+	uint32		nEntry;
 
 	Assert(!minipage_isnull);
 
 	value = (struct varlena *)
 		DatumGetPointer(minipage_value);
 	detoast_value = pg_detoast_datum(value);
-	Assert( VARSIZE(detoast_value) <= minipage_size(NUM_MINIPAGE_ENTRIES));
+	minipage = (Minipage *) detoast_value;
+	nEntry = minipage->nEntry;
+
+	Assert(nEntry <= NUM_MINIPAGE_ENTRIES);
+	Assert(VARSIZE(detoast_value) >= minipage_size(nEntry));
+
+	memcpy(minipageInfo->minipage, detoast_value, minipage_size(nEntry));
+	minipageInfo->numMinipageEntries = nEntry;
+
+	if (minipageInfo->zones != NULL)
+	{
+		int			numZoneColumns = blockDirectory->numZoneColumns;
+
+		MemSet(minipageInfo->zones, 0,
+			   minipage_zones_size(blockDirectory->maxZonedEntries,
+								   numZoneColumns));
+
+		if (minipage->version == MINIPAGE_VERSION_ZONES &&
+			nEntry <= blockDirectory->maxZonedEntries &&
+			VARSIZE(detoast_value) ==
+			minipage_size(nEntry) + minipage_zones_size(nEntry, numZoneColumns))
+		{
+			memcpy(minipageInfo->zones,
+				   ((char *) detoast_value) + minipage_size(nEntry),
+				   minipage_zones_size(nEntry, numZoneColumns));
+		}
+	}
 
-	memcpy(minipageInfo->minipage, detoast_value, VARSIZE(detoast_value));
 	if (detoast_value != value)
 		pfree(detoast_value);
-	
-	Assert(minipageInfo->minipage->nEntry <= NUM_MINIPAGE_ENTRIES);
-	
-	minipageInfo->numMinipageEntries = minipageInfo->minipage->nEntry;
 }
 
 
@@ -937,7 +1156,8 @@ extract_minipage(AppendOnlyBlockDirectory *blockDirectory,
 	/*
 	 * Copy out the minipage
 	 */
-	copy_out_minipage(minipageInfo,
+	copy_out_minipage(blockDirectory,
+					  minipageInfo,
 					  values[Anum_pg_aoblkdir_minipage - 1],
 					  nulls[Anum_pg_aoblkdir_minipage - 1]);
 
@@ -1117,6 +1337,8 @@ write_minipage(AppendOnlyBlockDirectory *blockDirectory,
 	bool *nulls = blockDirectory->nulls;
 	Relation blkdirRel = blockDirectory->blkdirRel;
 	TupleDesc heapTupleDesc = RelationGetDescr(blkdirRel);
+	uint32 nEntry = minipageInfo->numMinipageEntries;
+	Minipage *zonedMinipage = NULL;
 	
 	Assert(minipageInfo->numMinipageEntries > 0);
 
@@ -1136,13 +1358,47 @@ write_minipage(AppendOnlyBlockDirectory *blockDirectory,
 		Int64GetDatum(minipageInfo->minipage->entry[0].firstRowNum);
 	nulls[Anum_pg_aoblkdir_firstrownum - 1] = false;
 
-	SET_VARSIZE(minipageInfo->minipage,
-				minipage_size(minipageInfo->numMinipageEntries));
-	minipageInfo->minipage->nEntry = minipageInfo->numMinipageEntries;
+	SET_VARSIZE(minipageInfo->minipage, minipage_size(nEntry));
+	minipageInfo->minipage->version = MINIPAGE_VERSION_ORIGINAL;
+	minipageInfo->minipage->nEntry = nEntry;
 	values[Anum_pg_aoblkdir_minipage - 1] =
 		PointerGetDatum(minipageInfo->minipage);
 	nulls[Anum_pg_aoblkdir_minipage - 1] = false;
 
+	/*
+	 * If any entry has a zone, write the zones after the entries.  A
+	 * minipage loaded with more entries than a zoned minipage can hold
+	 * keeps the original format.
+	 */
+	if (minipageInfo->zones != NULL &&
+		nEntry <= blockDirectory->maxZonedEntries)
+	{
+		int numZones = nEntry * blockDirectory->numZoneColumns;
+		int zoneNo;
+
+		for (zoneNo = 0; zoneNo < numZones; zoneNo++)
+		{
+			if (minipageInfo->zones[zoneNo].rowCount > 0)
+				break;
+		}
+
+		if (zoneNo < numZones)
+		{
+			uint32 zonesSize = minipage_zones_size(nEntry,
+												   blockDirectory->numZoneColumns);
+
+			zonedMinipage = palloc(minipage_size(nEntry) + zonesSize);
+			memcpy(zonedMinipage, minipageInfo->minipage, minipage_size(nEntry));
+			memcpy(((char *) zonedMinipage) + minipage_size(nEntry),
+				   minipageInfo->zones, zonesSize);
+			SET_VARSIZE(zonedMinipage, minipage_size(nEntry) + zonesSize);
+			zonedMinipage->version = MINIPAGE_VERSION_ZONES;
+
+			values[Anum_pg_aoblkdir_minipage - 1] =
+				PointerGetDatum(zonedMinipage);
+		}
+	}
+
 	tuple = heaptuple_form_to(heapTupleDesc,
 							  values,
 							  nulls,
@@ -1182,6 +1438,8 @@ write_minipage(AppendOnlyBlockDirectory *blockDirectory,
 	CatalogUpdateIndexes(blkdirRel, tuple);
 	
 	heap_freetuple(tuple);
+	if (zonedMinipage != NULL)
+		pfree(zonedMinipage);
 	
 	MemoryContextSwitchTo(oldcxt);
 }
@@ -1212,6 +1470,8 @@ AppendOnlyBlockDirectory_End_forInsert(
 		}
 		
 		pfree(minipageInfo->minipage);
+		if (minipageInfo->zones != NULL)
+			pfree(minipageInfo->zones);
 	}
 
 	ereportif(Debug_appendonly_print_blockdirectory, LOG,
@@ -207,6 +207,7 @@ setDefaultAOStorageOpts(StdRdOptions *copy)
 }
 
 static int setDefaultCompressionLevel(char* compresstype);
+static int maxCompressionLevel(char *compresstype);
 
 /*
  * Transform a relation options list (list of DefElem) into the text array
@@ -1079,10 +1080,13 @@ parse_validate_reloptions(StdRdOptions *result, Datum reloptions,
 
 		result->compresstype = pstrdup(values[3]);
 		if (!compresstype_is_valid(result->compresstype))
+		{
+			compresstype_check_built(result->compresstype);
 			ereport(ERROR,
 					(errcode(ERRCODE_UNDEFINED_OBJECT),
 					 errmsg("unknown compresstype \"%s\"",
 							result->compresstype)));
+		}
 		for (j = 0; j < strlen(result->compresstype); j++)
 			result->compresstype[j] = pg_tolower(result->compresstype[j]);
 	}
@@ -1109,14 +1113,16 @@ parse_validate_reloptions(StdRdOptions *result, Datum reloptions,
 			ereport(ERROR,
 					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
 					 errmsg("compresstype can\'t be used with compresslevel 0")));
-		if (result->compresslevel < 0 || result->compresslevel > 9)
+		if (result->compresslevel < 0 ||
+			result->compresslevel > maxCompressionLevel(result->compresstype))
 		{
 			if (validate)
 				ereport(ERROR,
 						(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
 						 errmsg("compresslevel=%d is out of range (should be "
-								"between 0 and 9)",
-								result->compresslevel)));
+								"between 0 and %d)",
+								result->compresslevel,
+								maxCompressionLevel(result->compresstype))));
 
 			result->compresslevel = setDefaultCompressionLevel(
 					result->compresstype);
@@ -1145,6 +1151,21 @@ parse_validate_reloptions(StdRdOptions *result, Datum reloptions,
 					result->compresstype);
 		}
 
+		if (result->compresstype &&
+			(pg_strcasecmp(result->compresstype, "lz4") == 0) &&
+			(result->compresslevel != 1))
+		{
+			if (validate)
+				ereport(ERROR,
+						(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+						 errmsg("compresslevel=%d is out of range for "
+								"lz4 (should be 1)",
+								result->compresslevel)));
+
+			result->compresslevel = setDefaultCompressionLevel(
+					result->compresstype);
+		}
+
 		if (result->compresstype &&
 			(pg_strcasecmp(result->compresstype, "rle_type") == 0) &&
 			(result->compresslevel > 4))
@@ -1334,6 +1355,8 @@ void validateAppendOnlyRelOptions(bool ao,
 	if (comptype &&
 		(pg_strcasecmp(comptype, "quicklz") == 0 ||
 		 pg_strcasecmp(comptype, "zlib") == 0 ||
+		 pg_strcasecmp(comptype, "zstd") == 0 ||
+		 pg_strcasecmp(comptype, "lz4") == 0 ||
 		 pg_strcasecmp(comptype, "rle_type") == 0))
 	{
 
@@ -1351,11 +1374,11 @@ void validateAppendOnlyRelOptions(bool ao,
 					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
 					 errmsg("compresstype cannot be used with compresslevel 0")));
 
-		if (complevel < 0 || complevel > 9)
+		if (complevel < 0 || complevel > maxCompressionLevel(comptype))
 			ereport(ERROR,
 					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
-					 errmsg("compresslevel=%d is out of range (should be between 0 and 9)",
-							complevel)));
+					 errmsg("compresslevel=%d is out of range (should be between 0 and %d)",
+							complevel, maxCompressionLevel(comptype))));
 
 		if (comptype && (pg_strcasecmp(comptype, "quicklz") == 0) &&
 			(complevel != 1))
@@ -1365,6 +1388,14 @@ void validateAppendOnlyRelOptions(bool ao,
 						 errmsg("compresslevel=%d is out of range for quicklz "
 								 "(should be 1)", complevel)));
 		}
+		if (comptype && (pg_strcasecmp(comptype, "lz4") == 0) &&
+			(complevel != 1))
+		{
+				ereport(ERROR,
+						(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+						 errmsg("compresslevel=%d is out of range for lz4 "
+								 "(should be 1)", complevel)));
+		}
 		if (comptype && (pg_strcasecmp(comptype, "rle_type") == 0) &&
 			(complevel > 4))
 		{
@@ -1397,6 +1428,19 @@ void validateAppendOnlyRelOptions(bool ao,
 						blocksize, gp_safefswritesize)));
 }
 
+/*
+ * The highest compresslevel of a compressor type.  Zstandard goes up to 19,
+ * the others to 9 at most.
+ */
+static int
+maxCompressionLevel(char *compresstype)
+{
+	if (compresstype && pg_strcasecmp(compresstype, "zstd") == 0)
+		return 19;
+	else
+		return 9;
+}
+
 /*
  * if no compressor type was specified, we set to no compression (level 0)
  * otherwise default for both zlib, quicklz and RLE to level 1.
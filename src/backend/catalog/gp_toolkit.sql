@@ -2250,6 +2250,93 @@ ORDER BY segid;
 
 GRANT SELECT ON gp_toolkit.gp_workfile_mgr_used_diskspace TO public;
 
+-- Interconnect views
+--------------------------------------------------------------------------------
+
+--------------------------------------------------------------------------------
+-- @function:
+--        gp_toolkit.__gp_interconnect_peer_stats_f
+--
+-- @in:
+--
+-- @out:
+--        int - segment id
+--        int - segment id of the peer,
+--        real - congestion window of the last connection,
+--        real - slow start threshold of the last connection,
+--        bigint - smoothed round trip time of the last connection (us),
+--        bigint - smallest ack time seen (us),
+--        bigint - number of connections,
+--        bigint - packets sent,
+--        bigint - acks received,
+--        bigint - packets resent,
+--        bigint - loss events,
+--        bigint - congestion window decreases,
+--        timestamptz - time the last connection was torn down
+--
+-- @doc:
+--        UDF to retrieve the UDP interconnect statistics of the peers one
+--        segment has sent to
+--
+--------------------------------------------------------------------------------
+
+CREATE FUNCTION gp_toolkit.__gp_interconnect_peer_stats_f()
+RETURNS SETOF record
+AS '$libdir/gp_interconnect_stats', 'gp_interconnect_peer_stats'
+LANGUAGE C IMMUTABLE;
+
+GRANT EXECUTE ON FUNCTION gp_toolkit.__gp_interconnect_peer_stats_f() TO public;
+
+--------------------------------------------------------------------------------
+-- @view:
+--        gp_toolkit.gp_interconnect_peer_stats
+--
+-- @doc:
+--        Congestion control state and counters of the UDP interconnect
+--        connections from each segment to each peer, since startup
+--
+--------------------------------------------------------------------------------
+CREATE VIEW gp_toolkit.gp_interconnect_peer_stats AS
+WITH all_entries AS (
+  SELECT C.*
+	FROM gp_toolkit.__gp_localid, gp_toolkit.__gp_interconnect_peer_stats_f() as C (
+	  segid int,
+	  peer_segid int,
+	  cwnd real,
+	  ssthresh real,
+	  rtt_us bigint,
+	  min_rtt_us bigint,
+	  conns bigint,
+	  pkts_sent bigint,
+	  acks bigint,
+	  resent bigint,
+	  losses bigint,
+	  cwnd_cuts bigint,
+	  last_update timestamptz
+	)
+  UNION ALL
+  SELECT C.*
+	FROM gp_toolkit.__gp_masterid, gp_toolkit.__gp_interconnect_peer_stats_f() as C (
+	  segid int,
+	  peer_segid int,
+	  cwnd real,
+	  ssthresh real,
+	  rtt_us bigint,
+	  min_rtt_us bigint,
+	  conns bigint,
+	  pkts_sent bigint,
+	  acks bigint,
+	  resent bigint,
+	  losses bigint,
+	  cwnd_cuts bigint,
+	  last_update timestamptz
+	))
+SELECT *
+FROM all_entries
+ORDER BY segid, peer_segid;
+
+GRANT SELECT ON gp_toolkit.gp_interconnect_peer_stats TO public;
+
 --------------------------------------------------------------------------------
 
 -- Finalize install
@@ -0,0 +1,144 @@
+/*
+ * lz4_compression.c
+ *	  Interfaces to LZ4 compression for append-only storage.
+ *
+ * LZ4 trades some compression ratio for very fast decompression, which
+ * suits tables that are scanned far more often than they are written.  It
+ * has a single compression level, 1.
+ *
+ * Without --with-lz4, the functions below only report that lz4 is not
+ * supported, the same way the quicklz stubs do.
+ *
+ * Copyright (c) 2017, Pivotal Software Inc.
+ */
+
+#include "postgres.h"
+#include "fmgr.h"
+
+#include "catalog/pg_compression.h"
+#include "utils/builtins.h"
+
+#ifdef HAVE_LIBLZ4
+
+#include <lz4.h>
+
+Datum
+lz4_constructor(PG_FUNCTION_ARGS)
+{
+	/* PG_GETARG_POINTER(0) is TupleDesc that is currently unused. */
+
+	StorageAttributes *sa = PG_GETARG_POINTER(1);
+	CompressionState *cs = palloc0(sizeof(CompressionState));
+
+	/* LZ4 keeps no state between blocks */
+	cs->opaque = NULL;
+	cs->desired_sz = NULL;
+
+	Insist(PointerIsValid(sa->comptype));
+
+	if (sa->complevel == 0)
+		sa->complevel = 1;
+
+	PG_RETURN_POINTER(cs);
+}
+
+Datum
+lz4_destructor(PG_FUNCTION_ARGS)
+{
+	PG_RETURN_VOID();
+}
+
+Datum
+lz4_compress(PG_FUNCTION_ARGS)
+{
+	const void *src = PG_GETARG_POINTER(0);
+	int32		src_sz = PG_GETARG_INT32(1);
+	void	   *dst = PG_GETARG_POINTER(2);
+	int32		dst_sz = PG_GETARG_INT32(3);
+	int32	   *dst_used = PG_GETARG_POINTER(4);
+	int			result;
+
+	result = LZ4_compress_default(src, dst, src_sz, dst_sz);
+
+	/*
+	 * LZ4 returns 0 when it couldn't compress the data into the buffer. The
+	 * caller expects to detect this themselves so we set dst_used
+	 * accordingly, as for zlib.
+	 */
+	if (result <= 0)
+		*dst_used = src_sz;
+	else
+		*dst_used = result;
+
+	PG_RETURN_VOID();
+}
+
+Datum
+lz4_decompress(PG_FUNCTION_ARGS)
+{
+	const char *src = PG_GETARG_POINTER(0);
+	int32		src_sz = PG_GETARG_INT32(1);
+	void	   *dst = PG_GETARG_POINTER(2);
+	int32		dst_sz = PG_GETARG_INT32(3);
+	int32	   *dst_used = PG_GETARG_POINTER(4);
+	int			result;
+
+	Insist(src_sz > 0 && dst_sz > 0);
+
+	result = LZ4_decompress_safe(src, dst, src_sz, dst_sz);
+
+	if (result < 0)
+		elog(ERROR, "lz4 encountered data in an unexpected format");
+
+	*dst_used = result;
+
+	PG_RETURN_VOID();
+}
+
+Datum
+lz4_validator(PG_FUNCTION_ARGS)
+{
+	PG_RETURN_VOID();
+}
+
+#else							/* HAVE_LIBLZ4 */
+
+Datum
+lz4_constructor(PG_FUNCTION_ARGS)
+{
+	elog(ERROR, "lz4 compression not supported by this build");
+	PG_RETURN_VOID();
+}
+
+Datum
+lz4_destructor(PG_FUNCTION_ARGS)
+{
+	elog(ERROR, "lz4 compression not supported by this build");
+	PG_RETURN_VOID();
+}
+
+Datum
+lz4_compress(PG_FUNCTION_ARGS)
+{
+	elog(ERROR, "lz4 compression not supported by this build");
+	PG_RETURN_VOID();
+}
+
+Datum
+lz4_decompress(PG_FUNCTION_ARGS)
+{
+	elog(ERROR, "lz4 compression not supported by this build");
+	PG_RETURN_VOID();
+}
+
+Datum
+lz4_validator(PG_FUNCTION_ARGS)
+{
+	ereport(ERROR,
+			(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+			 errmsg("lz4 compression not supported by this build"),
+			 errhint("Build with --with-lz4.")));
+	PG_RETURN_VOID();
+}
+
+#endif							/* HAVE_LIBLZ4 */
@@ -462,10 +462,18 @@ compresstype_is_valid(char *comptype)
 	 * before IsNormalProcessingMode() is true.
 	 *
 	 * Whenever the list of supported compresstypes is changed, this
-	 * must change!
+	 * must change!  zstd and lz4 are only valid in builds that have the
+	 * library.
 	 */
 	static const char *const valid_comptypes[] =
-			{"quicklz", "zlib", "rle_type", "none"};
+			{"quicklz", "zlib", "rle_type", "none",
+#ifdef HAVE_LIBZSTD
+			 "zstd",
+#endif
+#ifdef HAVE_LIBLZ4
+			 "lz4",
+#endif
+			};
 	for (i = 0; !found && i < ARRAY_SIZE(valid_comptypes); ++i)
 	{
 		if (pg_strcasecmp(valid_comptypes[i], comptype) == 0)
@@ -474,6 +482,29 @@ compresstype_is_valid(char *comptype)
 	return found;
 }
 
+/*
+ * Error out if `compresstype' names a compression algorithm that this
+ * build was made without, rather than calling it unknown.
+ */
+void
+compresstype_check_built(char *comptype)
+{
+#ifndef HAVE_LIBZSTD
+	if (pg_strcasecmp(comptype, "zstd") == 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("zstd compression not supported by this build"),
+				 errhint("Build with --with-zstd.")));
+#endif
+#ifndef HAVE_LIBLZ4
+	if (pg_strcasecmp(comptype, "lz4") == 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("lz4 compression not supported by this build"),
+				 errhint("Build with --with-lz4.")));
+#endif
+}
+
 /*
  * Make encoding (compresstype = none, blocksize=...) based on
  * currently configured defaults.
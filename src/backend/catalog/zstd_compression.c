@@ -0,0 +1,197 @@
+/*
+ * zstd_compression.c
+ *	  Interfaces to Zstandard compression for append-only storage.
+ *
+ * Zstandard offers compression levels 1 to 19; the low levels compress
+ * about as well as zlib at a fraction of its CPU cost, and decompression
+ * stays fast at every level.
+ *
+ * Without --with-zstd, the functions below only report that zstd is not
+ * supported, the same way the quicklz stubs do.
+ *
+ * Copyright (c) 2017, Pivotal Software Inc.
+ */
+
+#include "postgres.h"
+#include "fmgr.h"
+
+#include "catalog/pg_compression.h"
+#include "utils/builtins.h"
+
+#ifdef HAVE_LIBZSTD
+
+#include <zstd.h>
+#include <zstd_errors.h>
+
+/* Internal state for zstd */
+typedef struct zstd_state
+{
+	int			level;			/* compression level */
+	bool		compress;		/* compress or decompress? */
+
+	/*
+	 * The contexts are reused for every block, so that zstd doesn't
+	 * allocate its working memory again for each one.
+	 */
+	ZSTD_CCtx  *cctx;
+	ZSTD_DCtx  *dctx;
+} zstd_state;
+
+Datum
+zstd_constructor(PG_FUNCTION_ARGS)
+{
+	/* PG_GETARG_POINTER(0) is TupleDesc that is currently unused. */
+
+	StorageAttributes *sa = PG_GETARG_POINTER(1);
+	CompressionState *cs = palloc0(sizeof(CompressionState));
+	zstd_state *state = palloc0(sizeof(zstd_state));
+	bool		compress = PG_GETARG_BOOL(2);
+
+	cs->opaque = (void *) state;
+	cs->desired_sz = NULL;
+
+	Insist(PointerIsValid(sa->comptype));
+
+	if (sa->complevel == 0)
+		sa->complevel = 1;
+
+	state->level = sa->complevel;
+	state->compress = compress;
+
+	if (compress)
+		state->cctx = ZSTD_createCCtx();
+	else
+		state->dctx = ZSTD_createDCtx();
+	if (state->cctx == NULL && state->dctx == NULL)
+		elog(ERROR, "out of memory");
+
+	PG_RETURN_POINTER(cs);
+}
+
+Datum
+zstd_destructor(PG_FUNCTION_ARGS)
+{
+	CompressionState *cs = PG_GETARG_POINTER(0);
+
+	if (cs != NULL && cs->opaque != NULL)
+	{
+		zstd_state *state = (zstd_state *) cs->opaque;
+
+		if (state->cctx != NULL)
+			ZSTD_freeCCtx(state->cctx);
+		if (state->dctx != NULL)
+			ZSTD_freeDCtx(state->dctx);
+		pfree(state);
+	}
+
+	PG_RETURN_VOID();
+}
+
+Datum
+zstd_compress(PG_FUNCTION_ARGS)
+{
+	const void *src = PG_GETARG_POINTER(0);
+	int32		src_sz = PG_GETARG_INT32(1);
+	void	   *dst = PG_GETARG_POINTER(2);
+	int32		dst_sz = PG_GETARG_INT32(3);
+	int32	   *dst_used = PG_GETARG_POINTER(4);
+	CompressionState *cs = (CompressionState *) PG_GETARG_POINTER(5);
+	zstd_state *state = (zstd_state *) cs->opaque;
+	size_t		result;
+
+	Insist(state->cctx != NULL);
+
+	result = ZSTD_compressCCtx(state->cctx, dst, dst_sz, src, src_sz,
+							   state->level);
+
+	if (ZSTD_isError(result))
+	{
+		/*
+		 * The data didn't compress to a size smaller than the buffer. The
+		 * caller expects to detect this themselves so we set dst_used
+		 * accordingly, as for zlib.
+		 */
+		if (ZSTD_getErrorCode(result) != ZSTD_error_dstSize_tooSmall)
+			elog(ERROR, "zstd compression failed: %s",
+				 ZSTD_getErrorName(result));
+		*dst_used = src_sz;
+	}
+	else
+		*dst_used = result;
+
+	PG_RETURN_VOID();
+}
+
+Datum
+zstd_decompress(PG_FUNCTION_ARGS)
+{
+	const char *src = PG_GETARG_POINTER(0);
+	int32		src_sz = PG_GETARG_INT32(1);
+	void	   *dst = PG_GETARG_POINTER(2);
+	int32		dst_sz = PG_GETARG_INT32(3);
+	int32	   *dst_used = PG_GETARG_POINTER(4);
+	CompressionState *cs = (CompressionState *) PG_GETARG_POINTER(5);
+	zstd_state *state = (zstd_state *) cs->opaque;
+	size_t		result;
+
+	Insist(src_sz > 0 && dst_sz > 0);
+	Insist(state->dctx != NULL);
+
+	result = ZSTD_decompressDCtx(state->dctx, dst, dst_sz, src, src_sz);
+
+	if (ZSTD_isError(result))
+		elog(ERROR, "zstd decompression failed: %s",
+			 ZSTD_getErrorName(result));
+
+	*dst_used = result;
+
+	PG_RETURN_VOID();
+}
+
+Datum
+zstd_validator(PG_FUNCTION_ARGS)
+{
+	PG_RETURN_VOID();
+}
+
+#else							/* HAVE_LIBZSTD */
+
+Datum
+zstd_constructor(PG_FUNCTION_ARGS)
+{
+	elog(ERROR, "zstd compression not supported by this build");
+	PG_RETURN_VOID();
+}
+
+Datum
+zstd_destructor(PG_FUNCTION_ARGS)
+{
+	elog(ERROR, "zstd compression not supported by this build");
+	PG_RETURN_VOID();
+}
+
+Datum
+zstd_compress(PG_FUNCTION_ARGS)
+{
+	elog(ERROR, "zstd compression not supported by this build");
+	PG_RETURN_VOID();
+}
+
+Datum
+zstd_decompress(PG_FUNCTION_ARGS)
+{
+	elog(ERROR, "zstd compression not supported by this build");
+	PG_RETURN_VOID();
+}
+
+Datum
+zstd_validator(PG_FUNCTION_ARGS)
+{
+	ereport(ERROR,
+			(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+			 errmsg("zstd compression not supported by this build"),
+			 errhint("Build with --with-zstd.")));
+	PG_RETURN_VOID();
+}
+
+#endif							/* HAVE_LIBZSTD */
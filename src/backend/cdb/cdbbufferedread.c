@@ -16,6 +16,8 @@
 
 static void BufferedReadIo(
     BufferedRead        *bufferedRead);
+static void BufferedReadPrefetch(
+    BufferedRead        *bufferedRead);
 static uint8 *BufferedReadUseBeforeBuffer(
     BufferedRead       *bufferedRead,
     int32              maxReadAheadLen,
@@ -96,6 +98,7 @@ void BufferedReadInit(
 	 */
 	bufferedRead->file = -1;
     bufferedRead->fileLen = 0;
+	bufferedRead->prefetchPosition = 0;
 
 	/*
 	 * Temporary limit support for random reading.
@@ -130,6 +133,7 @@ void BufferedReadSetFile(
 	bufferedRead->file = file;
     bufferedRead->filePathName = filePathName;
     bufferedRead->fileLen = fileLen;
+	bufferedRead->prefetchPosition = 0;
 
 	bufferedRead->haveTemporaryLimitInEffect = false;
 	bufferedRead->temporaryLimitFileLen = 0;
@@ -231,10 +235,89 @@ static void BufferedReadIo(
 		offset += actualLen;
 	}
 
+	BufferedReadPrefetch(bufferedRead);
+
 	if (VacuumCostActive)
 		VacuumCostBalance += VacuumCostPageMiss;
 }
 
+/*
+ * Ask the kernel to start reading the large reads that follow the current
+ * one, so that disk i/o overlaps with the caller working through the
+ * current large-read buffer instead of alternating with it.
+ *
+ * We keep gp_appendonly_readahead_large_reads large reads hinted beyond the
+ * current one, bounded by the in-effect EOF.  Since every large read moves
+ * the window forward by one large read, only the newly uncovered tail is
+ * hinted each time.  A column-oriented scan has one BufferedRead per column,
+ * so each column's segment file gets its own window.
+ */
+static void BufferedReadPrefetch(
+    BufferedRead        *bufferedRead)
+{
+	int64 inEffectFileLen;
+	int64 readAfterPos;
+	int64 prefetchBeginPos;
+	int64 prefetchAfterPos;
+
+	if (gp_appendonly_readahead_large_reads <= 0)
+		return;
+
+	if (bufferedRead->haveTemporaryLimitInEffect)
+		inEffectFileLen = bufferedRead->temporaryLimitFileLen;
+	else
+		inEffectFileLen = bufferedRead->fileLen;
+
+	readAfterPos = bufferedRead->largeReadPosition + bufferedRead->largeReadLen;
+
+	prefetchAfterPos = readAfterPos +
+					   (int64)gp_appendonly_readahead_large_reads *
+					   bufferedRead->maxLargeReadLen;
+	if (prefetchAfterPos > inEffectFileLen)
+		prefetchAfterPos = inEffectFileLen;
+
+	/*
+	 * Don't hint again what an earlier call already covered.
+	 */
+	prefetchBeginPos = readAfterPos;
+	if (bufferedRead->prefetchPosition > readAfterPos &&
+		bufferedRead->prefetchPosition <= prefetchAfterPos)
+		prefetchBeginPos = bufferedRead->prefetchPosition;
+
+	while (prefetchBeginPos < prefetchAfterPos)
+	{
+		int32 prefetchLen;
+		int result;
+
+		if (prefetchAfterPos - prefetchBeginPos > bufferedRead->maxLargeReadLen)
+			prefetchLen = bufferedRead->maxLargeReadLen;
+		else
+			prefetchLen = (int32)(prefetchAfterPos - prefetchBeginPos);
+
+		/*
+		 * The hint is only advisory, so a failure here is not an error; the
+		 * synchronous read will still be done when the data is needed.
+		 */
+		result = FilePrefetch(bufferedRead->file, prefetchBeginPos, prefetchLen);
+
+		elogif(Debug_appendonly_print_read_block, LOG,
+				 "Append-Only storage read-ahead: table \"%s\", segment file \"%s\", position " INT64_FORMAT ", "
+				 "length %d (result %d)",
+				 bufferedRead->relationName,
+				 bufferedRead->filePathName,
+				 prefetchBeginPos,
+				 prefetchLen,
+				 result);
+
+		if (result != 0)
+			break;
+
+		prefetchBeginPos += prefetchLen;
+	}
+
+	bufferedRead->prefetchPosition = prefetchBeginPos;
+}
+
 static uint8 *BufferedReadUseBeforeBuffer(
     BufferedRead       *bufferedRead,
     int32              maxReadAheadLen,
@@ -431,6 +514,14 @@ void BufferedReadSetTemporaryRange(
 
 		bufferedRead->largeReadPosition = beginFileOffset;
 
+		/*
+		 * Forget the read-ahead window of the old position, and establish
+		 * the temporary limit first so read-ahead stops at it.
+		 */
+		bufferedRead->prefetchPosition = 0;
+		bufferedRead->haveTemporaryLimitInEffect = true;
+		bufferedRead->temporaryLimitFileLen = afterFileOffset;
+
 		if (bufferedRead->largeReadLen > 0)
 			BufferedReadIo(bufferedRead);
 	}
@@ -675,6 +766,7 @@ void BufferedReadCompleteFile(
 	bufferedRead->file = -1;
 	bufferedRead->filePathName = NULL;
 	bufferedRead->fileLen = 0;
+	bufferedRead->prefetchPosition = 0;
 
 	bufferedRead->bufferOffset = 0;
 	bufferedRead->bufferLen = 0;
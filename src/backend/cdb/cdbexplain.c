@@ -92,6 +92,7 @@ typedef struct CdbExplain_StatInst
 	instr_time	firststart;		/* Start time of first iteration of node */
 	double		peakMemBalance; /* Max mem account balance */
 	int			numPartScanned; /* Number of part tables scanned */
+	double		zoneBlocksSkipped;	/* AO blocks skipped by zone maps */
 	ExplainSortMethod sortMethod;	/* Type of sort */
 	ExplainSortSpaceType sortSpaceType;	/* Sort space type */
 	long			  sortSpaceUsed; /* Memory / Disk used by sort(KBytes) */
@@ -162,6 +163,8 @@ typedef struct CdbExplain_NodeSummary
 	CdbExplain_Agg peakMemBalance;
 	/* Used for DynamicTableScan, DynamicIndexScan and DynamicBitmapTableScan */
 	CdbExplain_Agg totalPartTableScanned;
+	/* Used for scans of append-only tables */
+	CdbExplain_Agg zoneBlocksSkipped;
 	/* Summary of space used by sort */
 	CdbExplain_Agg sortSpaceUsed[NUM_SORT_SPACE_TYPE][NUM_SORT_METHOD];
 
@@ -939,6 +942,7 @@ cdbexplain_collectStatsFromNode(PlanState *planstate, CdbExplain_SendStatCtx *ct
 	si->peakMemBalance = MemoryAccounting_GetAccountPeakBalance(planstate->plan->memoryAccountId);
 	si->firststart = instr->firststart;
 	si->numPartScanned = instr->numPartScanned;
+	si->zoneBlocksSkipped = instr->zoneBlocksSkipped;
 	si->sortMethod = String2ExplainSortMethod(instr->sortMethod);
 	si->sortSpaceType = String2ExplainSortSpaceType(instr->sortSpaceType, si->sortMethod);
 	si->sortSpaceUsed = instr->sortSpaceUsed;
@@ -1068,6 +1072,7 @@ cdbexplain_depositStatsToNode(PlanState *planstate, CdbExplain_RecvStatCtx *ctx)
 	CdbExplain_DepStatAcc memory_accounting_global_peak;
 	CdbExplain_DepStatAcc peakMemBalance;
 	CdbExplain_DepStatAcc totalPartTableScanned;
+	CdbExplain_DepStatAcc zoneBlocksSkipped;
 	CdbExplain_DepStatAcc sortSpaceUsed[NUM_SORT_SPACE_TYPE][NUM_SORT_METHOD];
 	int			imsgptr;
 	int			nInst;
@@ -1093,6 +1098,7 @@ cdbexplain_depositStatsToNode(PlanState *planstate, CdbExplain_RecvStatCtx *ctx)
 	cdbexplain_depStatAcc_init0(&totalWorkfileCreated);
 	cdbexplain_depStatAcc_init0(&peakMemBalance);
 	cdbexplain_depStatAcc_init0(&totalPartTableScanned);
+	cdbexplain_depStatAcc_init0(&zoneBlocksSkipped);
 	for (int idx = 0; idx < NUM_SORT_METHOD; ++idx) {
 		cdbexplain_depStatAcc_init0(&sortSpaceUsed[MEMORY_SORT_SPACE_TYPE-1][idx]);
 		cdbexplain_depStatAcc_init0(&sortSpaceUsed[DISK_SORT_SPACE_TYPE-1][idx]);
@@ -1143,6 +1149,7 @@ cdbexplain_depositStatsToNode(PlanState *planstate, CdbExplain_RecvStatCtx *ctx)
 		cdbexplain_depStatAcc_upd(&totalWorkfileCreated, (rsi->workfileCreated ? 1 : 0), rsh, rsi, nsi);
 		cdbexplain_depStatAcc_upd(&peakMemBalance, rsi->peakMemBalance, rsh, rsi, nsi);
 		cdbexplain_depStatAcc_upd(&totalPartTableScanned, rsi->numPartScanned, rsh, rsi, nsi);
+		cdbexplain_depStatAcc_upd(&zoneBlocksSkipped, rsi->zoneBlocksSkipped, rsh, rsi, nsi);
 		if (rsi->sortMethod < NUM_SORT_METHOD && rsi->sortMethod != UNINITIALIZED_SORT && rsi->sortSpaceType != UNINITIALIZED_SORT_SPACE_TYPE) {
 			Assert(rsi->sortSpaceType <= NUM_SORT_SPACE_TYPE);
 			cdbexplain_depStatAcc_upd(&sortSpaceUsed[rsi->sortSpaceType-1][rsi->sortMethod - 1], (double)rsi->sortSpaceUsed, rsh, rsi, nsi);
@@ -1162,6 +1169,7 @@ cdbexplain_depositStatsToNode(PlanState *planstate, CdbExplain_RecvStatCtx *ctx)
 	ns->totalWorkfileCreated = totalWorkfileCreated.agg;
 	ns->peakMemBalance = peakMemBalance.agg;
 	ns->totalPartTableScanned = totalPartTableScanned.agg;
+	ns->zoneBlocksSkipped = zoneBlocksSkipped.agg;
 	for (int idx = 0; idx < NUM_SORT_METHOD; ++idx) {
 		ns->sortSpaceUsed[MEMORY_SORT_SPACE_TYPE-1][idx] = sortSpaceUsed[MEMORY_SORT_SPACE_TYPE-1][idx].agg;
 		ns->sortSpaceUsed[DISK_SORT_SPACE_TYPE-1][idx] = sortSpaceUsed[DISK_SORT_SPACE_TYPE-1][idx].agg;
@@ -1770,6 +1778,27 @@ cdbexplain_showExecStats(struct PlanState *planstate,
 		}
 	}
 
+	/*
+	 * Blocks of append-only tables the zone maps let the scan skip.
+	 */
+	if (ns->zoneBlocksSkipped.vcnt > 0)
+	{
+		appendStringInfoFill(str, 2 * indent, ' ');
+		if (ns->zoneBlocksSkipped.vcnt == 1)
+			appendStringInfo(str,
+							 "Blocks skipped by zone maps:  %.0f.\n",
+							 ns->zoneBlocksSkipped.vmax);
+		else
+		{
+			cdbexplain_formatSeg(segbuf, sizeof(segbuf), ns->zoneBlocksSkipped.imax, ns->ninst);
+			appendStringInfo(str,
+							 "Blocks skipped by zone maps:  %.0f avg, %.0f max%s.\n",
+							 cdbexplain_agg_avg(&ns->zoneBlocksSkipped),
+							 ns->zoneBlocksSkipped.vmax,
+							 segbuf);
+		}
+	}
+
 	/*
 	 * Print number of partitioned tables scanned for dynamic scans.
 	 */
@@ -10,6 +10,7 @@
 
 #include "catalog/pg_operator.h"
 #include "catalog/pg_proc.h"    /* CDB_PROC_TIDTOI8 */
+#include "catalog/pg_statistic.h"   /* STATISTIC_KIND_MCV */
 #include "catalog/pg_type.h"    /* INT8OID */
 #include "nodes/makefuncs.h"    /* makeFuncExpr() */
 #include "nodes/relation.h"     /* PlannerInfo, RelOptInfo, CdbRelDedupInfo */
@@ -21,6 +22,9 @@
 #include "parser/parse_expr.h"	/* exprType() */
 #include "parser/parse_oper.h"
 
+#include "utils/datum.h"        /* datumCopy() */
+#include "utils/lsyscache.h"    /* get_attstatsslot() */
+#include "utils/selfuncs.h"     /* examine_variable() */
 #include "utils/syscache.h"
 
 #include "cdb/cdbdef.h"         /* CdbSwap() */
@@ -758,6 +762,10 @@ typedef struct
         bool            require_existing_order;
 } CdbpathMfjRel;
 
+static bool cdbpath_motion_for_skew(PlannerInfo *root,
+                                    CdbpathMfjRel *outer,
+                                    CdbpathMfjRel *inner);
+
 CdbPathLocus
 cdbpath_motion_for_join(PlannerInfo    *root,
                         JoinType        jointype,           /* JOIN_INNER/FULL/LEFT/RIGHT/IN */
@@ -771,6 +779,7 @@ cdbpath_motion_for_join(PlannerInfo    *root,
 {
     CdbpathMfjRel   outer;
     CdbpathMfjRel   inner;
+    bool            consider_skew = false;
 
     outer.path  = *p_outer_path;
     inner.path  = *p_inner_path;
@@ -1002,7 +1011,7 @@ cdbpath_motion_for_join(PlannerInfo    *root,
                                              large->path,
                                              &large->move_to,
                                              &small->move_to))
-        {}
+            consider_skew = gp_enable_motion_skew;
 
         /* No usable equijoin preds, or couldn't consider the preferred motion.
          * Replicate one rel if possible.
@@ -1057,6 +1066,19 @@ cdbpath_motion_for_join(PlannerInfo    *root,
     *p_outer_path = outer.path;
     *p_inner_path = inner.path;
 
+    /*
+     * With skewed join key values spread over the segments, the join
+     * result isn't partitioned on the join key anymore.
+     */
+    if (consider_skew &&
+        cdbpath_motion_for_skew(root, &outer, &inner))
+    {
+        CdbPathLocus    locus;
+
+        CdbPathLocus_MakeStrewn(&locus);
+        return locus;
+    }
+
     /* Tell caller where the join will be done. */
     return cdbpathlocus_join(outer.path->locus, inner.path->locus);
 
@@ -1066,6 +1088,157 @@ fail:                           /* can't do this join */
 }                               /* cdbpath_motion_for_join */
 
 
+/*
+ * cdbpath_skewed_values
+ *
+ * Returns the values of a rel's single partitioning key which are common
+ * enough to overload the segment they hash to, i.e. the most common values
+ * with a frequency of at least gp_motion_skew_threshold, as a List of
+ * Consts.  Their total frequency is returned in *p_freq.
+ */
+static List *
+cdbpath_skewed_values(PlannerInfo *root, CdbpathMfjRel *rel, double *p_freq)
+{
+    PathKey    *pathkey;
+    ListCell   *cell;
+    List       *values = NIL;
+
+    *p_freq = 0.0;
+
+    if (!CdbPathLocus_IsHashed(rel->move_to) ||
+        list_length(rel->move_to.partkey_h) != 1)
+        return NIL;
+
+    /* Look for a column of the rel in the partitioning key's eclass. */
+    pathkey = (PathKey *) linitial(rel->move_to.partkey_h);
+    foreach(cell, pathkey->pk_eclass->ec_members)
+    {
+        EquivalenceMember  *em = (EquivalenceMember *) lfirst(cell);
+        VariableStatData    vardata;
+        Datum              *mcv;
+        int                 nmcv;
+        float4             *freq;
+        int                 nfreq;
+        int                 i;
+
+        if (em->em_is_const ||
+            !IsA(em->em_expr, Var) ||
+            !bms_is_subset(em->em_relids, rel->path->parent->relids))
+            continue;
+
+        examine_variable(root, (Node *) em->em_expr, 0, &vardata);
+
+        if (HeapTupleIsValid(vardata.statsTuple) &&
+            get_attstatsslot(vardata.statsTuple,
+                             vardata.atttype, vardata.atttypmod,
+                             STATISTIC_KIND_MCV, InvalidOid,
+                             &mcv, &nmcv,
+                             &freq, &nfreq))
+        {
+            int16       typlen;
+            bool        typbyval;
+
+            get_typlenbyval(vardata.atttype, &typlen, &typbyval);
+
+            for (i = 0; i < nmcv && i < nfreq; i++)
+            {
+                if (freq[i] < gp_motion_skew_threshold)
+                    continue;
+
+                values = lappend(values,
+                                 makeConst(vardata.atttype,
+                                           vardata.atttypmod,
+                                           typlen,
+                                           datumCopy(mcv[i], typbyval, typlen),
+                                           false,
+                                           typbyval));
+                *p_freq += freq[i];
+            }
+
+            free_attstatsslot(vardata.atttype, mcv, nmcv, freq, nfreq);
+        }
+
+        ReleaseVariableStats(vardata);
+
+        if (values)
+            break;
+    }
+
+    return values;
+}                               /* cdbpath_skewed_values */
+
+
+/*
+ * cdbpath_motion_for_skew
+ *
+ * Both rels of a join are being redistributed on a single join key.  If
+ * some key values are known to be very common in one of them, all of its
+ * rows with such a value would land on the same segment.  Instead, have the
+ * Motion spread those rows over all segments, and the other rel's Motion
+ * broadcast its rows with the same values, so that each pair of matching
+ * rows still meets on exactly one segment.
+ *
+ * The broadcasting rel must not be the preserved rel of an outer join, as
+ * it would then be null-extended on every segment.
+ *
+ * Returns true if skew handling was added to the Motions.
+ */
+static bool
+cdbpath_motion_for_skew(PlannerInfo *root, CdbpathMfjRel *outer, CdbpathMfjRel *inner)
+{
+    CdbpathMfjRel  *spread = NULL;
+    CdbpathMfjRel  *bcast = NULL;
+    CdbMotionPath  *spreadpath;
+    CdbMotionPath  *bcastpath;
+    List           *outer_values;
+    List           *inner_values;
+    double          outer_freq;
+    double          inner_freq;
+
+    if (!IsA(outer->path, CdbMotionPath) ||
+        !IsA(inner->path, CdbMotionPath))
+        return false;
+
+    outer_values = cdbpath_skewed_values(root, outer, &outer_freq);
+    inner_values = cdbpath_skewed_values(root, inner, &inner_freq);
+
+    /* Spread the rel with more rows on skewed values, if allowed. */
+    if (outer_values && inner->ok_to_replicate &&
+        (!inner_values || !outer->ok_to_replicate ||
+         outer_freq * outer->bytes >= inner_freq * inner->bytes))
+    {
+        spread = outer;
+        bcast = inner;
+    }
+    else if (inner_values && outer->ok_to_replicate)
+    {
+        spread = inner;
+        bcast = outer;
+    }
+    else
+        return false;
+
+    spreadpath = (CdbMotionPath *) spread->path;
+    bcastpath = (CdbMotionPath *) bcast->path;
+
+    spreadpath->skewAction = MOTIONSKEW_SPREAD;
+    spreadpath->skewValues = (spread == outer) ? outer_values : inner_values;
+    bcastpath->skewAction = MOTIONSKEW_BROADCAST;
+    bcastpath->skewValues = copyObject(spreadpath->skewValues);
+
+    /*
+     * Charge the broadcasting Motion for sending its matching rows to every
+     * segment, assuming they are as common there as in the spread rel.
+     */
+    bcastpath->path.total_cost += (root->config->cdbpath_segments - 1) *
+        cdbpath_rows(root, bcast->path) *
+        ((spread == outer) ? outer_freq : inner_freq) *
+        ((gp_motion_cost_per_row > 0.0) ? gp_motion_cost_per_row : 2.0 * cpu_tuple_cost);
+
+    return true;
+}                               /* cdbpath_motion_for_skew */
+
+
 /*
  * cdbpath_dedup_fixup
  *      Modify path to support unique rowid operation for subquery preds.
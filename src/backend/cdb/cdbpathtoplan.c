@@ -190,6 +190,8 @@ cdbpathtoplan_create_motion_plan(PlannerInfo   *root,
         motion = make_hashed_motion(subplan,
                                     hashExpr,
                                     false /* useExecutorVarFormat */);
+        motion->skewAction = path->skewAction;
+        motion->skewValues = path->skewValues;
     }
     else
         Insist(0);
@@ -0,0 +1,101 @@
+/*-------------------------------------------------------------------------
+ *
+ * cdbruntimefilter.c
+ *	  Bloom filters over cdbhash values, used to filter the outer side of a
+ *	  hash join before it is redistributed.
+ *
+ * A hash join whose outer child is a Redistribute Motion on the join keys
+ * only ever sees the outer rows whose cdbhash value maps to its segment,
+ * and can only match them against the inner rows it holds itself.  So
+ * once it has built its hash table it can summarise its inner keys in a
+ * filter, send it back to the senders of that motion, and they can drop the
+ * rows sent to this segment that can't match, before they cross the network.
+ *
+ * The filter is built at the largest size that fits in one interconnect
+ * packet, and folded down to about eight bits per key when complete.  A
+ * filter that would have fewer than four bits per key is not worth sending.
+ *
+ * Copyright (c) 2017, Pivotal Inc.
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "cdb/cdbruntimefilter.h"
+
+/* bits per key aimed for, and the least worth sending */
+#define RUNTIME_FILTER_BITS_PER_KEY		8
+#define RUNTIME_FILTER_MIN_BITS_PER_KEY	4
+
+/*
+ * Create an empty filter of at most maxbytes bytes, or return NULL if that
+ * is too small to be useful.
+ */
+RuntimeFilter *
+RuntimeFilterCreate(int maxbytes)
+{
+	RuntimeFilter *filter;
+	int			nbits = RUNTIME_FILTER_MAX_BITS;
+
+	while (nbits > RUNTIME_FILTER_MIN_BITS && nbits / 8 > maxbytes)
+		nbits /= 2;
+	if (nbits / 8 > maxbytes)
+		return NULL;
+
+	filter = (RuntimeFilter *) palloc(sizeof(RuntimeFilter));
+	filter->bits = (uint8 *) palloc0(nbits / 8);
+	filter->nbits = nbits;
+	filter->nkeys = 0;
+
+	return filter;
+}
+
+/*
+ * Add a key, given its cdbhash value.
+ */
+void
+RuntimeFilterAdd(RuntimeFilter *filter, uint32 hash)
+{
+	uint32		m = RuntimeFilterMix(hash);
+	uint32		h1 = m & (filter->nbits - 1);
+	uint32		h2 = (m >> 16) & (filter->nbits - 1);
+
+	filter->bits[h1 >> 3] |= 1 << (h1 & 7);
+	filter->bits[h2 >> 3] |= 1 << (h2 & 7);
+	filter->nkeys++;
+}
+
+/*
+ * Fold the filter down to the size its number of keys needs.
+ *
+ * Since both probes are taken modulo the size, halving the filter is just
+ * OR-ing its upper half into its lower half.  Returns the final size in
+ * bytes, or 0 if the filter is too full to be selective.
+ */
+int
+RuntimeFilterFinish(RuntimeFilter *filter)
+{
+	double		wanted = filter->nkeys * RUNTIME_FILTER_BITS_PER_KEY;
+
+	if (filter->nkeys * RUNTIME_FILTER_MIN_BITS_PER_KEY > filter->nbits)
+		return 0;
+
+	while (filter->nbits > RUNTIME_FILTER_MIN_BITS && filter->nbits / 2 >= wanted)
+	{
+		int			half = filter->nbits / 16;
+		int			i;
+
+		for (i = 0; i < half; i++)
+			filter->bits[i] |= filter->bits[half + i];
+		filter->nbits /= 2;
+	}
+
+	return filter->nbits / 8;
+}
+
+void
+RuntimeFilterDestroy(RuntimeFilter *filter)
+{
+	pfree(filter->bits);
+	pfree(filter);
+}
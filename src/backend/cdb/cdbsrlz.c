@@ -20,6 +20,10 @@
 #include "utils/memaccounting.h"
 #include "utils/zlib_wrapper.h"
 
+#ifdef HAVE_LIBZSTD
+#include <zstd.h>
+#endif
+
 static char *compress_string(const char *src, int uncompressed_size, int *size);
 static char *uncompress_string(const char *src, int size, int *uncompressed_len);
 
@@ -83,6 +87,80 @@ deserializeNode(const char *strNode, int size)
 	return node;
 }
 
+#ifdef HAVE_LIBZSTD
+
+/*
+ * Compress a (binary) string using zstd.
+ *
+ * Plans are compressed on the QD once per dispatch and decompressed on
+ * every QE, so both sides run the same build and agree on the format.  The
+ * fastest level already beats zlib on ratio for serialized plans, at a
+ * fraction of the CPU cost.
+ *
+ * returns the compressed data and the size of the compressed data.
+ */
+static char *
+compress_string(const char *src, int uncompressed_size, int *size)
+{
+	int level = 1;
+	size_t compressed_size;
+	char *result;
+
+	Assert(size != NULL);
+
+	if (src == NULL)
+	{
+		*size = 0;
+		return NULL;
+	}
+
+	compressed_size = ZSTD_compressBound(uncompressed_size); /* worst case */
+
+	result = palloc(compressed_size + sizeof(int));
+	memcpy(result, &uncompressed_size, sizeof(int)); /* save the original length */
+
+	compressed_size = ZSTD_compress(result + sizeof(int), compressed_size,
+									src, uncompressed_size, level);
+	if (ZSTD_isError(compressed_size))
+		elog(ERROR,"Compression failed: %s uncompressed len %d",
+			 ZSTD_getErrorName(compressed_size), uncompressed_size);
+
+	*size = compressed_size + sizeof(int);
+
+	return result;
+}
+
+/*
+ * Uncompress the binary string
+ */
+static char *
+uncompress_string(const char *src, int size, int *uncompressed_len)
+{
+	char *result;
+	size_t resultlen;
+	*uncompressed_len = 0;
+
+	if (src == NULL)
+		return NULL;
+
+	Assert(size >= sizeof(int));
+
+	memcpy(uncompressed_len, src, sizeof(int));
+
+	result = palloc(*uncompressed_len);
+
+	resultlen = ZSTD_decompress(result, *uncompressed_len,
+								src + sizeof(int), size - sizeof(int));
+	if (ZSTD_isError(resultlen) || resultlen != *uncompressed_len)
+		elog(ERROR,"Uncompress failed: %s (compressed len %d, uncompressed %d)",
+			 ZSTD_isError(resultlen) ? ZSTD_getErrorName(resultlen) : "length mismatch",
+			 size, *uncompressed_len);
+
+	return result;
+}
+
+#else	/* HAVE_LIBZSTD */
+
 /*
  * Compress a (binary) string using zlib.
  *
@@ -148,3 +226,5 @@ uncompress_string(const char *src, int size, int *uncompressed_len)
 		
 	return (char *)result;
 }
+
+#endif	/* HAVE_LIBZSTD */
@@ -214,6 +214,19 @@ bool		gp_interconnect_aggressive_retry = true; /* fast-track app-level retry */
 
 bool		gp_interconnect_full_crc = false;	/* sanity check UDP data. */
 
+bool		gp_interconnect_batch_io = true;	/* batched UDP send/receive */
+
+bool		gp_interconnect_compression = false;	/* compress motion packets */
+int			gp_interconnect_compression_threshold = 0;	/* in kB */
+int			gp_interconnect_compression_method = INTERCONNECT_COMPRESSION_DEFAULT;
+
+bool		gp_interconnect_adaptive_cwnd = false;	/* per-connection cwnd */
+int			gp_interconnect_cwnd_target_delay = 5;	/* in ms */
+
+bool		gp_interconnect_local_shm = false;	/* shm rings for local peers */
+
+int			gp_motion_batch_tuples = 0;		/* tuples per TC_BATCH chunk */
+
 bool		gp_interconnect_log_stats = false;	/* emit stats at log-level */
 
 bool		gp_interconnect_cache_future_packets = true;
@@ -255,6 +268,11 @@ int			gp_segments_for_planner = 0;
 
 int			gp_hashagg_default_nbatches = 32;
 
+bool		gp_enable_motion_skew = false;
+double		gp_motion_skew_threshold = 0.1;
+
+bool		gp_enable_runtime_filter = false;
+
 bool		gp_adjust_selectivity_for_outerjoins = TRUE;
 bool		gp_selectivity_damping_for_scans = false;
 bool		gp_selectivity_damping_for_joins = false;
@@ -285,6 +303,8 @@ bool		gp_enable_explain_allstat = FALSE;
 bool		gp_enable_motion_deadlock_sanity = FALSE;	/* planning time sanity
 														 * check */
 
+bool		gp_enable_motion_loser_tree = true;	/* loser tree merge receive */
+
 #ifdef USE_ASSERT_CHECKING
 bool		gp_mk_sort_check = false;
 #endif
@@ -965,6 +985,53 @@ gpvars_show_gp_interconnect_fc_method(void)
 	}
 }	/* gpvars_show_gp_interconnect_fc_method */
 
+/*
+ * gpvars_assign_gp_interconnect_compression_method
+ * gpvars_show_gp_interconnect_compression_method
+ */
+const char *
+gpvars_assign_gp_interconnect_compression_method(const char *newval, bool doit, GucSource source __attribute__((unused)))
+{
+	int			newmethod = 0;
+
+	if (newval == NULL || newval[0] == 0)
+		newmethod = INTERCONNECT_COMPRESSION_DEFAULT;
+	else if (!pg_strcasecmp("zlib", newval))
+		newmethod = INTERCONNECT_COMPRESSION_ZLIB;
+	else if (!pg_strcasecmp("lz4", newval))
+	{
+#ifdef HAVE_LIBLZ4
+		newmethod = INTERCONNECT_COMPRESSION_LZ4;
+#else
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("interconnect compression method \"lz4\" is not supported by this build")));
+#endif
+	}
+	else
+		elog(ERROR, "Unknown interconnect compression method. (current method is '%s')", gpvars_show_gp_interconnect_compression_method());
+
+	if (doit)
+	{
+		gp_interconnect_compression_method = newmethod;
+	}
+
+	return newval;
+}	/* gpvars_assign_gp_interconnect_compression_method */
+
+const char *
+gpvars_show_gp_interconnect_compression_method(void)
+{
+	switch (gp_interconnect_compression_method)
+	{
+		case INTERCONNECT_COMPRESSION_LZ4:
+			return "LZ4";
+		case INTERCONNECT_COMPRESSION_ZLIB:
+		default:
+			return "ZLIB";
+	}
+}	/* gpvars_show_gp_interconnect_compression_method */
+
 /*
  * Parse the string value of gp_autostats_mode and gp_autostats_mode_in_functions
  */
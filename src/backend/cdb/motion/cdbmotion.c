@@ -16,10 +16,12 @@
 #include "gp-libpq-int.h"
 #include "cdb/cdbconn.h"
 #include "cdb/cdbmotion.h"
+#include "cdb/cdbruntimefilter.h"
 #include "cdb/cdbvars.h"
 #include "cdb/htupfifo.h"
 #include "cdb/ml_ipc.h"
 #include "cdb/tupser.h"
+#include "executor/execUtils.h"
 #include "utils/memutils.h"
 #include "utils/typcache.h"
 
@@ -61,8 +63,24 @@ static void processIncomingChunks(MotionLayerState *mlStates,
 
 static inline void reconstructTuple(MotionNodeEntry * pMNEntry, ChunkSorterEntry * pCSEntry, TupleRemapper *remapper);
 
+static TupleBatch *getSendBatch(MotionLayerState *mlStates,
+								ChunkTransportState *transportStates,
+								MotionNodeEntry * pMNEntry,
+								int16 motNodeID,
+								int16 targetRoute);
+static bool flushSendBatch(MotionLayerState *mlStates,
+						   ChunkTransportState *transportStates,
+						   MotionNodeEntry * pMNEntry,
+						   int16 motNodeID,
+						   int16 targetRoute);
+static bool flushAllSendBatches(MotionLayerState *mlStates,
+								ChunkTransportState *transportStates,
+								MotionNodeEntry * pMNEntry,
+								int16 motNodeID);
+
 /* Stats-function declarations. */
 static void statSendTuple(MotionLayerState *mlStates, MotionNodeEntry * pMNEntry, TupleChunkList tcList);
+static void statSendBatch(MotionLayerState *mlStates, MotionNodeEntry * pMNEntry, int chunkSize);
 static void statSendEOS(MotionLayerState *mlStates, MotionNodeEntry * pMNEntry);
 static void statChunksProcessed(MotionLayerState *mlStates, MotionNodeEntry * pMNEntry, int chunksProcessed, int chunkBytes, int tupleBytes);
 static void statNewTupleArrived(MotionNodeEntry * pMNEntry, ChunkSorterEntry * pCSEntry);
@@ -335,6 +353,9 @@ UpdateMotionLayerNode(MotionLayerState *mlStates, int16 motNodeID, bool preserve
 	pEntry->tuple_desc = CreateTupleDescCopy(tupDesc);
 	InitSerTupInfo(pEntry->tuple_desc, &pEntry->ser_tup_info);
 
+	pEntry->send_batches = NULL;
+	pEntry->num_send_batches = 0;
+
 	pEntry->memKB = operatorMemKB;
 
 	if (!preserveOrder)
@@ -393,6 +414,39 @@ SendStopMessage(MotionLayerState *mlStates,
 		transportStates->doSendStopMessage(transportStates, motNodeID);
 }
 
+void
+SendRuntimeFilter(MotionLayerState *mlStates,
+				  ChunkTransportState *transportStates,
+				  int16 motNodeID,
+				  const uint8 *bits, int nbytes)
+{
+	MotionNodeEntry *pEntry = getMotionNodeEntry(mlStates, motNodeID, "SendRuntimeFilter");
+
+	if (pEntry->stopped)
+		return;
+	if (transportStates != NULL && transportStates->doSendRuntimeFilter != NULL)
+		transportStates->doSendRuntimeFilter(transportStates, motNodeID, bits, nbytes);
+}
+
+bool
+RuntimeFilterRejects(ChunkTransportState *transportStates,
+					 int16 motNodeID,
+					 int16 targetRoute,
+					 uint32 hash)
+{
+	ChunkTransportStateEntry *pEntry = NULL;
+	MotionConn *conn;
+
+	if (transportStates == NULL || targetRoute == BROADCAST_SEGIDX)
+		return false;
+
+	getChunkTransportState(transportStates, motNodeID, &pEntry);
+	conn = &pEntry->conns[targetRoute];
+
+	return conn->rtFilter != NULL &&
+		!RuntimeFilterProbe(conn->rtFilter, conn->rtFilterBits, hash);
+}
+
 void
 CheckAndSendRecordCache(MotionLayerState *mlStates,
 						ChunkTransportState *transportStates,
@@ -504,6 +558,46 @@ SendTuple(MotionLayerState *mlStates,
 	elog(DEBUG5, "Serializing HeapTuple for sending.");
 #endif
 
+	/*
+	 * Narrow tuples are collected into batches, one per route, and sent
+	 * a batch at a time in a single TC_BATCH chunk.
+	 */
+	if (targetRoute != BROADCAST_SEGIDX && gp_motion_batch_tuples > 1 &&
+		pMNEntry->ser_tup_info.batch_width > 0)
+	{
+		TupleBatch *batch;
+
+		batch = getSendBatch(mlStates, transportStates, pMNEntry, motNodeID, targetRoute);
+		if (batch != NULL)
+		{
+			AddTupleToBatch(tuple, &pMNEntry->ser_tup_info, batch);
+
+			/* count the send, the chunk is accounted for when it goes out */
+			tcList.num_chunks = 0;
+			tcList.serialized_data_length = 0;
+			statSendTuple(mlStates, pMNEntry, &tcList);
+
+			if (batch->ntuples < batch->capacity)
+				return SEND_COMPLETE;
+
+			if (!flushSendBatch(mlStates, transportStates, pMNEntry, motNodeID, targetRoute))
+			{
+				pMNEntry->stopped = true;
+				return STOP_SENDING;
+			}
+			return SEND_COMPLETE;
+		}
+	}
+	else if (targetRoute == BROADCAST_SEGIDX && pMNEntry->send_batches != NULL)
+	{
+		/* keep the order of tuples on each route */
+		if (!flushAllSendBatches(mlStates, transportStates, pMNEntry, motNodeID))
+		{
+			pMNEntry->stopped = true;
+			return STOP_SENDING;
+		}
+	}
+
 	if (targetRoute != BROADCAST_SEGIDX)
 	{
 		struct directTransportBuffer b;
@@ -569,6 +663,140 @@ SendTuple(MotionLayerState *mlStates,
 	return rc;
 }
 
+/*
+ * Get the batch of tuples waiting to be sent to a route, setting it up if
+ * this is the first tuple.  Returns NULL if the motion's tuples cannot be
+ * batched.
+ *
+ * A motion received by the QD is never batched: the QD hands rows to the
+ * client (or to a cursor's FETCH, or a LIMIT) as they arrive, and holding
+ * them back until a batch fills would delay the first rows of the result.
+ */
+static TupleBatch *
+getSendBatch(MotionLayerState *mlStates,
+			 ChunkTransportState *transportStates,
+			 MotionNodeEntry * pMNEntry,
+			 int16 motNodeID,
+			 int16 targetRoute)
+{
+	MemoryContext oldCtxt;
+	TupleBatch *batch;
+
+	if (pMNEntry->send_batches == NULL)
+	{
+		ChunkTransportStateEntry *pEntry = NULL;
+
+		getChunkTransportState(transportStates, motNodeID, &pEntry);
+
+		if (sliceRunsOnQD(pEntry->recvSlice))
+		{
+			pMNEntry->ser_tup_info.batch_width = 0;
+			return NULL;
+		}
+
+		pMNEntry->num_send_batches = pEntry->numConns;
+		pMNEntry->send_batches = (TupleBatch **)
+			MemoryContextAllocZero(mlStates->motion_layer_mctx,
+								   pEntry->numConns * sizeof(TupleBatch *));
+	}
+
+	Assert(targetRoute >= 0 && targetRoute < pMNEntry->num_send_batches);
+
+	batch = pMNEntry->send_batches[targetRoute];
+	if (batch == NULL)
+	{
+		oldCtxt = MemoryContextSwitchTo(mlStates->motion_layer_mctx);
+		batch = CreateTupleBatch(&pMNEntry->ser_tup_info, gp_motion_batch_tuples);
+		MemoryContextSwitchTo(oldCtxt);
+
+		/* tuples too wide to batch: don't try again */
+		if (batch == NULL)
+			pMNEntry->ser_tup_info.batch_width = 0;
+
+		pMNEntry->send_batches[targetRoute] = batch;
+	}
+
+	return batch;
+}
+
+/*
+ * Send out the tuples batched up for a route, as a single TC_BATCH chunk.
+ * Returns false if the receiver doesn't want any more tuples.
+ */
+static bool
+flushSendBatch(MotionLayerState *mlStates,
+			   ChunkTransportState *transportStates,
+			   MotionNodeEntry * pMNEntry,
+			   int16 motNodeID,
+			   int16 targetRoute)
+{
+	TupleBatch *batch = pMNEntry->send_batches[targetRoute];
+	struct directTransportBuffer b;
+	TupleChunkListData tcList;
+	TupleChunkListItem tcItem;
+	MemoryContext oldCtxt;
+	int			size;
+	bool		ok;
+
+	if (batch == NULL || batch->ntuples == 0)
+		return true;
+
+	size = TupleBatchChunkSize(&pMNEntry->ser_tup_info, batch);
+
+	/* Serialize straight into the connection's buffer if it fits. */
+	getTransportDirectBuffer(transportStates, motNodeID, targetRoute, &b);
+	if (b.pri != NULL && b.prilen >= size)
+	{
+		SerializeTupleBatch(&pMNEntry->ser_tup_info, batch, (char *) b.pri);
+		putTransportDirectBuffer(transportStates, motNodeID, targetRoute, size);
+		statSendBatch(mlStates, pMNEntry, size);
+
+		return true;
+	}
+
+	oldCtxt = MemoryContextSwitchTo(mlStates->motion_layer_mctx);
+	tcItem = getChunkFromCache(&pMNEntry->ser_tup_info.chunkCache);
+	MemoryContextSwitchTo(oldCtxt);
+
+	tcItem->chunk_length = SerializeTupleBatch(&pMNEntry->ser_tup_info, batch,
+											   (char *) tcItem->chunk_data);
+
+	tcList.p_first = NULL;
+	tcList.p_last = NULL;
+	tcList.num_chunks = 0;
+	tcList.serialized_data_length = 0;
+	appendChunkToTCList(&tcList, tcItem);
+
+	ok = SendTupleChunkToAMS(mlStates, transportStates, motNodeID, targetRoute, tcItem);
+	if (ok)
+		statSendBatch(mlStates, pMNEntry, size);
+
+	clearTCList(&pMNEntry->ser_tup_info.chunkCache, &tcList);
+
+	return ok;
+}
+
+/*
+ * Send out the tuples batched up for all routes.
+ */
+static bool
+flushAllSendBatches(MotionLayerState *mlStates,
+					ChunkTransportState *transportStates,
+					MotionNodeEntry * pMNEntry,
+					int16 motNodeID)
+{
+	bool		ok = true;
+	int			i;
+
+	for (i = 0; i < pMNEntry->num_send_batches; i++)
+	{
+		if (!flushSendBatch(mlStates, transportStates, pMNEntry, motNodeID, i))
+			ok = false;
+	}
+
+	return ok;
+}
+
 TupleChunkListItem
 get_eos_tuplechunklist(void)
 {
@@ -593,6 +821,13 @@ SendEndOfStream(MotionLayerState       *mlStates,
 	 */
 	pMNEntry = getMotionNodeEntry(mlStates, motNodeID, "SendEndOfStream");
 
+	/*
+	 * Tuples still waiting in batches go out ahead of the end-of-stream; if
+	 * a receiver has stopped listening it doesn't need them anyway.
+	 */
+	if (pMNEntry->send_batches != NULL)
+		flushAllSendBatches(mlStates, transportStates, pMNEntry, motNodeID);
+
 	transportStates->SendEos(mlStates, transportStates, motNodeID, s_eos_chunk_data);
 
 	/*
@@ -1119,6 +1354,36 @@ addChunkToSorter(MotionLayerState *mlStates,
 
 			break;
 
+		case TC_BATCH:
+			/* There shouldn't be any partial tuple data in the list! */
+			if (chunkSorterEntry->chunk_list.num_chunks != 0)
+			{
+				ereport(ERROR, (errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+				   errmsg("Received TC_BATCH chunk from [src=%d,mn=%d] after"
+						  " partial tuple data.", srcRoute, motNodeID)));
+			}
+
+			/* Turn the whole batch into HeapTuples in one go. */
+			{
+				HeapTuple  *tuples;
+				int			ntuples;
+				int			i;
+
+				tuples = DeserializeTupleBatch(&pMNEntry->ser_tup_info, tcItem, &ntuples);
+
+				for (i = 0; i < ntuples; i++)
+				{
+					htfifo_addtuple(chunkSorterEntry->ready_tuples, tuples[i]);
+					statNewTupleArrived(pMNEntry, chunkSorterEntry);
+				}
+				pfree(tuples);
+			}
+
+			/* The tuples have their own storage; we're done with the chunk. */
+			pfree(tcItem);
+
+			break;
+
 		case TC_PARTIAL_START:
 
 			/* There shouldn't be any partial tuple data in the list! */
@@ -1258,6 +1523,22 @@ statSendTuple(MotionLayerState *mlStates, MotionNodeEntry * pMNEntry, TupleChunk
 
 }
 
+static void
+statSendBatch(MotionLayerState *mlStates, MotionNodeEntry * pMNEntry, int chunkSize)
+{
+	AssertArg(pMNEntry != NULL);
+
+	/* per motion-node stats. */
+	pMNEntry->stat_total_chunks_sent++;
+	pMNEntry->stat_total_bytes_sent += chunkSize;
+	pMNEntry->stat_tuple_bytes_sent += chunkSize - TUPLE_CHUNK_HEADER_SIZE;
+
+	/* Update global motion-layer statistics. */
+	mlStates->stat_total_chunks_sent++;
+	mlStates->stat_total_bytes_sent += chunkSize;
+	mlStates->stat_tuple_bytes_sent += chunkSize - TUPLE_CHUNK_HEADER_SIZE;
+}
+
 static void
 statSendEOS(MotionLayerState *mlStates, MotionNodeEntry * pMNEntry)
 {
@@ -16,6 +16,8 @@
 #include "libpq/ip.h"
 #include "utils/builtins.h"
 #include "utils/debugbreak.h"
+#include "utils/memutils.h"
+#include "executor/execUtils.h"
 
 #include "cdb/ml_ipc.h"
 #include "cdb/cdbvars.h"
@@ -26,6 +28,10 @@
 #include <arpa/inet.h>
 #include <sys/time.h>
 #include <netinet/in.h>
+#include <zlib.h>
+#ifdef HAVE_LIBLZ4
+#include <lz4.h>
+#endif
 
 #ifdef WIN32
 #define WIN32_LEAN_AND_MEAN
@@ -97,6 +103,10 @@ RecvTupleChunk(MotionConn *conn, ChunkTransportState *transportStates)
 	TupleChunkListItem lastTcItem = NULL;
 	uint32		tcSize;
 	int			bytesProcessed = 0;
+	uint8	   *msgData;
+	int32		msgLen;
+	bool		compressed;
+	int			method;
 
 	if (Gp_interconnect_type == INTERCONNECT_TYPE_TCP)
 	{
@@ -112,24 +122,53 @@ RecvTupleChunk(MotionConn *conn, ChunkTransportState *transportStates)
 		bytesProcessed = sizeof(struct icpkthdr);
 	}
 
+	/*
+	 * The chunks of a compressed packet are parsed from a decompressed copy.
+	 * The packet's flags tell the method the sender used, whatever this
+	 * process would use itself.
+	 */
+	if (Gp_interconnect_type == INTERCONNECT_TYPE_TCP)
+	{
+		uint32		hdr;
+
+		memcpy(&hdr, conn->msgPos, sizeof(uint32));
+		compressed = (hdr & PACKET_HEADER_COMPRESSED) != 0;
+		method = (hdr & PACKET_HEADER_COMPRESSED_LZ4) ?
+			INTERCONNECT_COMPRESSION_LZ4 : INTERCONNECT_COMPRESSION_ZLIB;
+	}
+	else
+	{
+		uint32		flags = ((icpkthdr *) conn->msgPos)->flags;
+
+		compressed = (flags & UDPIC_FLAGS_COMPRESSED) != 0;
+		method = (flags & UDPIC_FLAGS_COMPRESSED_LZ4) ?
+			INTERCONNECT_COMPRESSION_LZ4 : INTERCONNECT_COMPRESSION_ZLIB;
+	}
+
+	msgData = conn->msgPos;
+	msgLen = conn->msgSize;
+	if (compressed)
+		msgData = decompressPacket(conn->msgPos, conn->msgSize, bytesProcessed,
+								   method, &msgLen);
+
 #ifdef AMS_VERBOSE_LOGGING
 	elog(DEBUG5, "recvtuple chunk recv bytes %d msgsize %d conn->pBuff %p conn->msgPos: %p",
 		 conn->recvBytes, conn->msgSize, conn->pBuff, conn->msgPos);
 #endif
 
-	while (bytesProcessed != conn->msgSize)
+	while (bytesProcessed != msgLen)
 	{
-		if (conn->msgSize - bytesProcessed < TUPLE_CHUNK_HEADER_SIZE)
+		if (msgLen - bytesProcessed < TUPLE_CHUNK_HEADER_SIZE)
 		{
 			logChunkParseDetails(conn);
 
 			ereport(ERROR, (errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
 							errmsg("Interconnect error parsing message: insufficient data received."),
 							errdetail("conn->msgSize %d bytesProcessed %d < chunk-header %d",
-									  conn->msgSize, bytesProcessed, TUPLE_CHUNK_HEADER_SIZE)));
+									  msgLen, bytesProcessed, TUPLE_CHUNK_HEADER_SIZE)));
 		}
 
-		tcSize = TUPLE_CHUNK_HEADER_SIZE + (*(uint16 *) (conn->msgPos + bytesProcessed));
+		tcSize = TUPLE_CHUNK_HEADER_SIZE + (*(uint16 *) (msgData + bytesProcessed));
 
 		/* sanity check */
 		if (tcSize > Gp_max_packet_size)
@@ -152,14 +191,14 @@ RecvTupleChunk(MotionConn *conn, ChunkTransportState *transportStates)
 							errmsg("Interconnect error parsing message"),
 							errdetail("tcSize %d > max %d header %d processed %d/%d from %p",
 									  tcSize, Gp_max_packet_size,
-									  TUPLE_CHUNK_HEADER_SIZE, bytesProcessed, conn->msgSize, conn->msgPos)));
+									  TUPLE_CHUNK_HEADER_SIZE, bytesProcessed, msgLen, msgData)));
 		}
 
 
 		/* we only check for interrupts here when we don't have a guaranteed full-message */
 		if (Gp_interconnect_type == INTERCONNECT_TYPE_TCP)
 		{
-			if (tcSize >= conn->msgSize)
+			if (tcSize >= msgLen)
 			{
 				/* see MPP-720: it is possible that our message got
 				 * messed up by a cancellation ? */
@@ -169,10 +208,10 @@ RecvTupleChunk(MotionConn *conn, ChunkTransportState *transportStates)
 
 				ereport(ERROR, (errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
 								errmsg("Interconnect error parsing message"),
-								errdetail("tcSize %d >= conn->msgSize %d", tcSize, conn->msgSize)));
+								errdetail("tcSize %d >= conn->msgSize %d", tcSize, msgLen)));
 			}
 		}
-		Assert(tcSize < conn->msgSize);
+		Assert(tcSize < msgLen);
 
 		/*
 		 * We store the data inplace, and handle any necessary copying later
@@ -181,7 +220,7 @@ RecvTupleChunk(MotionConn *conn, ChunkTransportState *transportStates)
 		tcItem = (TupleChunkListItem) palloc0(sizeof(TupleChunkListItemData));
 
 		tcItem->chunk_length = tcSize;
-		tcItem->inplace = (char *) (conn->msgPos + bytesProcessed);
+		tcItem->inplace = (char *) (msgData + bytesProcessed);
 
 		bytesProcessed += TYPEALIGN(TUPLE_CHUNK_ALIGN,tcSize);
 
@@ -211,6 +250,211 @@ RecvTupleChunk(MotionConn *conn, ChunkTransportState *transportStates)
 	return firstTcItem;
 }
 
+/*
+ * Motion compression.
+ *
+ * Motions whose estimated output reaches gp_interconnect_compression_threshold
+ * compress the payload of each packet, i.e. everything after the transport's
+ * header, with gp_interconnect_compression_method: LZ4 when the build has
+ * it, or raw deflate at its fastest level. The transport's header marks
+ * the packet as compressed and names the method, so that the receiver
+ * decodes it whatever its own setting. Packets are compressed
+ * independently, so that a lost or retransmitted UDP packet can be
+ * decompressed on its own, and a packet is only sent compressed if that
+ * makes it smaller. The receiver decompresses into a buffer of its own, in
+ * which the chunks stay in place until the next packet is read.
+ */
+#define IC_COMPRESS_MIN_PAYLOAD		(128)
+
+static z_stream ic_deflate_stream;
+static z_stream ic_inflate_stream;
+static bool ic_deflate_ready = false;
+static bool ic_inflate_ready = false;
+static uint8 *ic_compress_buf = NULL;
+static uint8 *ic_decompress_buf = NULL;
+
+/*
+ * setupMotionCompression
+ * 		Decide whether the outgoing connections of a sending motion compress
+ * 		their packets.
+ */
+void
+setupMotionCompression(EState *estate, ChunkTransportStateEntry *pEntry)
+{
+	bool		compress = gp_interconnect_compression;
+	int			i;
+
+	if (compress && gp_interconnect_compression_threshold > 0 &&
+		estate->es_plannedstmt != NULL)
+	{
+		Motion	   *motion = findSenderMotion(estate->es_plannedstmt, pEntry->motNodeId);
+
+		if (motion != NULL &&
+			motion->plan.plan_rows * motion->plan.plan_width < (double) gp_interconnect_compression_threshold * 1024.0)
+			compress = false;
+	}
+
+	for (i = 0; i < pEntry->numConns; i++)
+		pEntry->conns[i].compress = compress;
+}
+
+/*
+ * deflatePayload
+ * 		Raw deflate 'len' bytes at 'src' into at most 'maxlen' bytes at 'dst'.
+ *
+ * Returns the compressed size, or -1 if it would not fit.
+ */
+static int
+deflatePayload(uint8 *src, int len, uint8 *dst, int maxlen)
+{
+	if (!ic_deflate_ready)
+	{
+		MemSet(&ic_deflate_stream, 0, sizeof(z_stream));
+		if (deflateInit2(&ic_deflate_stream, Z_BEST_SPEED, Z_DEFLATED, -MAX_WBITS,
+						 8, Z_DEFAULT_STRATEGY) != Z_OK)
+			ereport(ERROR,
+					(errcode(ERRCODE_OUT_OF_MEMORY),
+					 errmsg("out of memory"),
+					 errdetail("Failed to initialize interconnect compression.")));
+		ic_deflate_ready = true;
+	}
+
+	if (deflateReset(&ic_deflate_stream) != Z_OK)
+		return -1;
+
+	ic_deflate_stream.next_in = src;
+	ic_deflate_stream.avail_in = len;
+	ic_deflate_stream.next_out = dst;
+	ic_deflate_stream.avail_out = maxlen;
+
+	/* anything but Z_STREAM_END means the result would not fit */
+	if (deflate(&ic_deflate_stream, Z_FINISH) != Z_STREAM_END)
+		return -1;
+
+	return ic_deflate_stream.total_out;
+}
+
+/*
+ * compressPacket
+ * 		Compress the payload of an outgoing packet in place.
+ *
+ * Returns the new size of the packet and the method used in *pMethod, or
+ * -1 if the packet is left as it is.
+ */
+int
+compressPacket(uint8 *msg, int msgSize, int hdrSize, int *pMethod)
+{
+	int			payload = msgSize - hdrSize;
+	int			clen;
+
+	if (payload < IC_COMPRESS_MIN_PAYLOAD)
+		return -1;
+
+	if (ic_compress_buf == NULL)
+		ic_compress_buf = MemoryContextAlloc(TopMemoryContext, Gp_max_packet_size);
+
+	Assert(msgSize <= Gp_max_packet_size);
+
+	*pMethod = gp_interconnect_compression_method;
+	switch (gp_interconnect_compression_method)
+	{
+#ifdef HAVE_LIBLZ4
+		case INTERCONNECT_COMPRESSION_LZ4:
+			clen = LZ4_compress_default((const char *) msg + hdrSize,
+										(char *) ic_compress_buf,
+										payload, payload - 1);
+			if (clen <= 0)
+				return -1;
+			break;
+#endif
+
+		default:
+			*pMethod = INTERCONNECT_COMPRESSION_ZLIB;
+			clen = deflatePayload(msg + hdrSize, payload, ic_compress_buf, payload - 1);
+			if (clen < 0)
+				return -1;
+			break;
+	}
+
+	memcpy(msg + hdrSize, ic_compress_buf, clen);
+
+	return hdrSize + clen;
+}
+
+/*
+ * decompressPacket
+ * 		Decompress the payload of an incoming packet, compressed with the
+ * 		given method.
+ *
+ * Returns a copy of the packet with its payload decompressed, and its size
+ * in *pMsgSize. The copy is only valid until the next call.
+ */
+uint8 *
+decompressPacket(uint8 *msg, int msgSize, int hdrSize, int method, int *pMsgSize)
+{
+	int			ret;
+
+	if (ic_decompress_buf == NULL)
+		ic_decompress_buf = MemoryContextAlloc(TopMemoryContext, Gp_max_packet_size);
+
+	memcpy(ic_decompress_buf, msg, hdrSize);
+
+	if (method == INTERCONNECT_COMPRESSION_LZ4)
+	{
+#ifdef HAVE_LIBLZ4
+		ret = LZ4_decompress_safe((const char *) msg + hdrSize,
+								  (char *) ic_decompress_buf + hdrSize,
+								  msgSize - hdrSize,
+								  Gp_max_packet_size - hdrSize);
+		if (ret < 0)
+			ereport(ERROR,
+					(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+					 errmsg("Interconnect error: could not decompress an incoming packet."),
+					 errdetail("lz4 error %d, packet size %d", ret, msgSize)));
+
+		*pMsgSize = hdrSize + ret;
+
+		return ic_decompress_buf;
+#else
+		ereport(ERROR,
+				(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+				 errmsg("Interconnect error: received a packet compressed with lz4, which is not supported by this build.")));
+#endif
+	}
+
+	if (!ic_inflate_ready)
+	{
+		MemSet(&ic_inflate_stream, 0, sizeof(z_stream));
+		if (inflateInit2(&ic_inflate_stream, -MAX_WBITS) != Z_OK)
+			ereport(ERROR,
+					(errcode(ERRCODE_OUT_OF_MEMORY),
+					 errmsg("out of memory"),
+					 errdetail("Failed to initialize interconnect decompression.")));
+		ic_inflate_ready = true;
+	}
+
+	ret = inflateReset(&ic_inflate_stream);
+	if (ret == Z_OK)
+	{
+		ic_inflate_stream.next_in = msg + hdrSize;
+		ic_inflate_stream.avail_in = msgSize - hdrSize;
+		ic_inflate_stream.next_out = ic_decompress_buf + hdrSize;
+		ic_inflate_stream.avail_out = Gp_max_packet_size - hdrSize;
+
+		ret = inflate(&ic_inflate_stream, Z_FINISH);
+	}
+
+	if (ret != Z_STREAM_END || ic_inflate_stream.avail_in != 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+				 errmsg("Interconnect error: could not decompress an incoming packet."),
+				 errdetail("zlib error %d, packet size %d", ret, msgSize)));
+
+	*pMsgSize = hdrSize + ic_inflate_stream.total_out;
+
+	return ic_decompress_buf;
+}
+
 /*=========================================================================
  * VISIBLE FUNCTIONS
  */
@@ -759,6 +1003,7 @@ createChunkTransportState(ChunkTransportState *transportStates,
     pEntry->numConns = numPrimaryConns;
 	pEntry->numPrimaryConns = numPrimaryConns;
     pEntry->scanStart = 0;
+	pEntry->numShmConns = 0;
     pEntry->sendSlice = sendSlice;
     pEntry->recvSlice = recvSlice;
 
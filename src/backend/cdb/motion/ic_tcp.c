@@ -386,6 +386,7 @@ readPacket(MotionConn *conn, ChunkTransportState *transportStates)
 	if (conn->recvBytes >= PACKET_HEADER_SIZE)
 	{
 		memcpy(&conn->msgSize, conn->msgPos, sizeof(uint32));
+		conn->msgSize &= ~PACKET_HEADER_FLAGS;
 		gotHeader = true;
 		if (conn->recvBytes >= conn->msgSize)
 		{
@@ -495,6 +496,7 @@ readPacket(MotionConn *conn, ChunkTransportState *transportStates)
 			{
 				/* got the header */
 				memcpy(&conn->msgSize, conn->msgPos, sizeof(uint32));
+				conn->msgSize &= ~PACKET_HEADER_FLAGS;
 				gotHeader = true;
 			}
 			conn->recvBytes = bytesRead;
@@ -1423,7 +1425,10 @@ SetupTCPInterconnect(EState *estate)
 
 	/* Initiate outgoing connections. */
 	if (mySlice->parentIndex != -1)
+	{
 		sendingChunkTransportState = startOutgoingConnections(estate->interconnect_context, mySlice, &expectedTotalOutgoing);
+		setupMotionCompression(estate, sendingChunkTransportState);
+	}
 
 	/* now we'll do some setup for each of our Receiving Motion Nodes. */
 	foreach(cell, mySlice->children)
@@ -2787,8 +2792,24 @@ flushBuffer(MotionLayerState *mlStates, ChunkTransportState *transportStates,
 
 	pMNEntry = getMotionNodeEntry(mlStates, motionId, "flushBuffer");
 
-	/* first set header length */
-	*(uint32 *) conn->pBuff = conn->msgSize;
+	/* first set header length, marking compressed packets */
+	if (conn->compress)
+	{
+		int			method;
+		int			len = compressPacket(conn->pBuff, conn->msgSize, PACKET_HEADER_SIZE, &method);
+		uint32		flags = 0;
+
+		if (len >= 0)
+		{
+			conn->msgSize = len;
+			flags = PACKET_HEADER_COMPRESSED;
+			if (method == INTERCONNECT_COMPRESSION_LZ4)
+				flags |= PACKET_HEADER_COMPRESSED_LZ4;
+		}
+		*(uint32 *) conn->pBuff = conn->msgSize | flags;
+	}
+	else
+		*(uint32 *) conn->pBuff = conn->msgSize;
 
 	/* now send message */
 	sendptr = (char *) conn->pBuff;
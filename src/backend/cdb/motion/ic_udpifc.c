@@ -35,6 +35,9 @@
 #include "port/atomics.h"
 #include "port/pg_crc32c.h"
 #include "storage/pmsignal.h"
+#include "storage/fd.h"
+#include "storage/shmem.h"
+#include "storage/spin.h"
 
 #include "cdb/tupchunklist.h"
 #include "cdb/ml_ipc.h"
@@ -42,10 +45,14 @@
 #include "cdb/cdbdisp.h"
 #include "cdb/cdbdispatchresult.h"
 #include "cdb/cdbicudpfaultinjection.h"
+#include "cdb/cdbruntimefilter.h"
 
 #include <fcntl.h>
+#include <signal.h>
 #include <limits.h>
 #include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <arpa/inet.h>
 #include "pgtime.h"
 #include <netinet/in.h>
@@ -126,6 +133,23 @@ timeoutArray[] =
 /* 1/4 sec in msec */
 #define RX_THREAD_POLL_TIMEOUT (250)
 
+/*
+ * Batched socket I/O.
+ *
+ * On Linux, sendmmsg() and recvmmsg() move up to UDPIFC_MAX_BATCH datagrams
+ * between the kernel and us in a single system call. The sender flushes all
+ * the packets of a connection that the flow control lets out with one call,
+ * and the rx thread drains the listener socket into several rx-buffers at
+ * once and sends the resulting acks together. Elsewhere, or when
+ * gp_interconnect_batch_io is off, every packet takes its own system call.
+ */
+#if defined(__linux__) && defined(MSG_WAITFORONE)
+#define UDPIFC_BATCH_IO
+#define UDPIFC_MAX_BATCH (16)
+#else
+#define UDPIFC_MAX_BATCH (1)
+#endif
+
 /*
  * Flags definitions for flag-field of UDP-messages
  *
@@ -139,6 +163,16 @@ timeoutArray[] =
 #define UDPIC_FLAGS_DISORDER    		(32)
 #define UDPIC_FLAGS_DUPLICATE   		(64)
 #define UDPIC_FLAGS_CAPACITY    		(128)
+/* UDPIC_FLAGS_COMPRESSED (256) is defined in ml_ipc.h, the receive path shares it */
+#define UDPIC_FLAGS_SHM_DOORBELL		(512)
+#define UDPIC_FLAGS_RUNTIME_FILTER		(1024)
+/* UDPIC_FLAGS_COMPRESSED_LZ4 (2048) is defined in ml_ipc.h, too */
+
+/*
+ * Acks are small, but a runtime filter sent back to a sender can take up
+ * a whole packet.
+ */
+#define ACK_BUFFER_SIZE		Max(MIN_PACKET_SIZE, Gp_max_packet_size)
 
 /*
  * ConnHtabBin
@@ -312,10 +346,10 @@ struct RxBufferPool
 /*
  * The buffer pool used for keeping data packets.
  *
- * maxCount is set to 1 to make sure there is always a buffer
- * for picking packets from OS buffer.
+ * maxCount is set to UDPIFC_MAX_BATCH to make sure there are always
+ * buffers for picking packets from OS buffer.
  */
-static RxBufferPool rx_buffer_pool = {1, 0, NULL};
+static RxBufferPool rx_buffer_pool = {UDPIFC_MAX_BATCH, 0, NULL};
 
 /*
  * SendBufferPool
@@ -513,6 +547,92 @@ static ICGlobalControlInfo ic_control_info;
 
 #define MAX_SEQS_IN_DISORDER_ACK (4)
 
+#define MIN_CONN_CWND (1)
+#define CWND_TARGET_DELAY (gp_interconnect_cwnd_target_delay * 1000) /* default: 5ms */
+#define PEER_STATS_WINDOW (10 * 1000) /* ms, age beyond which peer statistics are stale */
+
+/*
+ * Events that shrink the congestion window of a connection.
+ */
+typedef enum CwndEvent
+{
+	CWND_EVENT_DELAY,		/* ack took too long */
+	CWND_EVENT_DISORDER,	/* receiver reported lost packets */
+	CWND_EVENT_TIMEOUT		/* packet expired and was resent */
+} CwndEvent;
+
+/*
+ * Per-peer statistics in shared memory, see ICPeerStats.
+ */
+typedef struct ICPeerStatsShmem
+{
+	slock_t		lock;
+	ICPeerStats	peers[IC_PEER_STATS_SLOTS];
+} ICPeerStatsShmem;
+
+static ICPeerStatsShmem *ic_peer_stats = NULL;
+
+/*
+ * Shared memory ring between a sender and a receiver on the same host.
+ *
+ * The receiver creates the ring at setup, before it accepts the first packet
+ * of the connection, and removes it at teardown.  The sender sends packets
+ * over UDP until the first one is acked, then maps the ring and puts the rest
+ * of the packets, headers included, into its slots.  The receiver moves the
+ * slots into the packet queue of the connection without copying and frees
+ * them as they are consumed, so ring packets need no acks, CRC or resends.
+ *
+ * head and tail count the packets put and freed; the slot of a packet is its
+ * count modulo nslots.  A side about to sleep on an empty (receiver) or full
+ * (sender) ring sets rxSleeping or txSleeping, and the other side sends it a
+ * UDPIC_FLAGS_SHM_DOORBELL message after its next update of the ring.
+ */
+#define IC_SHM_DIR "/dev/shm"
+#define IC_SHM_PREFIX "gpic."
+#define IC_SHM_CACHE_LINE (64)
+
+typedef struct ICShmRing
+{
+	pg_atomic_uint32 head;			/* packets put by the sender */
+	pg_atomic_uint32 rxSleeping;	/* receiver waits for head to move */
+	char		pad1[IC_SHM_CACHE_LINE];
+
+	pg_atomic_uint32 tail;			/* packets freed by the receiver */
+	pg_atomic_uint32 txSleeping;	/* sender waits for tail to move */
+	char		pad2[IC_SHM_CACHE_LINE];
+
+	pg_atomic_uint32 stopRequested;	/* receiver wants no more packets */
+	uint32		nslots;
+	uint32		slotSize;
+} ICShmRing;
+
+#define IC_SHM_RING_HDR_SIZE TYPEALIGN(IC_SHM_CACHE_LINE, sizeof(ICShmRing))
+#define IC_SHM_RING_SIZE(nslots, slotSize) (IC_SHM_RING_HDR_SIZE + (Size) (nslots) * (slotSize))
+#define IC_SHM_RING_SLOT(ring, n) \
+	((icpkthdr *) ((char *) (ring) + IC_SHM_RING_HDR_SIZE + (Size) ((n) % (ring)->nslots) * (ring)->slotSize))
+#define IC_SHM_RING_OWNS(ring, buf) \
+	((char *) (buf) >= (char *) (ring) && \
+	 (char *) (buf) < (char *) (ring) + IC_SHM_RING_SIZE((ring)->nslots, (ring)->slotSize))
+
+/* can shared memory rings be created on this host */
+static bool ic_shm_available = false;
+
+/*
+ * Listener addresses of peers known to be of this host or not, see
+ * isLocalAddress().
+ */
+#define IC_HOST_ADDR_CACHE_SIZE (64)
+#define IC_HOST_ADDR_LEN (64)
+
+typedef struct ICHostAddr
+{
+	char		addr[IC_HOST_ADDR_LEN];
+	bool		local;
+} ICHostAddr;
+
+static ICHostAddr ic_host_addrs[IC_HOST_ADDR_CACHE_SIZE];
+static int	ic_num_host_addrs = 0;
+
 /*
  * UnackQueueRing
  *
@@ -596,6 +716,12 @@ typedef struct AckSendParam
  * duplicatedPktNum          - duplicate packet number.
  * recvAckNum                - the number of Acks received.
  * statusQueryMsgNum         - the number of status query messages sent.
+ * xmitSyscallNum            - the number of system calls sending data packets.
+ * xmitPktNum                - the number of data packets passed to those calls.
+ * rxSyscallNum              - the number of system calls by which the rx thread got packets.
+ * rxPktNum                  - the number of packets got by those calls.
+ * ackSyscallNum             - the number of system calls by which the rx thread sent acks.
+ * ackPktNum                 - the number of acks passed to those calls.
  *
  */
 typedef struct ICStatistics
@@ -617,6 +743,12 @@ typedef struct ICStatistics
 	int32   duplicatedPktNum;
 	int32	recvAckNum;
 	int32	statusQueryMsgNum;
+	int32	xmitSyscallNum;
+	int32	xmitPktNum;
+	int32	rxSyscallNum;
+	int32	rxPktNum;
+	int32	ackSyscallNum;
+	int32	ackPktNum;
 } ICStatistics;
 
 /* Statistics for UDP interconnect. */
@@ -662,6 +794,7 @@ static void destroyConnHashTable(ConnHashTable *ht);
 
 static inline void sendAckWithParam(AckSendParam *param);
 static void sendAck(MotionConn *conn, int32 flags, uint32 seq, uint32 extraSeq);
+static void sendAcksWithParams(AckSendParam *params, int nparams);
 static void sendDisorderAck(MotionConn *conn, uint32 seq, uint32 extraSeq, uint32 lostPktCnt);
 static void sendStatusQueryMessage(MotionConn *conn, int fd, uint32 seq);
 static inline void sendControlMessage(icpkthdr *pkt, int fd, struct sockaddr *addr, socklen_t peerLen);
@@ -718,11 +851,13 @@ static bool SendChunkUDPIFC(MotionLayerState *mlStates, ChunkTransportState *tra
 						 ChunkTransportStateEntry *pEntry, MotionConn * conn, TupleChunkListItem tcItem, int16 motionId);
 
 static void doSendStopMessageUDPIFC(ChunkTransportState *transportStates, int16 motNodeID);
+static void doSendRuntimeFilterUDPIFC(ChunkTransportState *transportStates, int16 motNodeID, const uint8 *bits, int nbytes);
 static bool dispatcherAYT(void);
 static void checkQDConnectionAlive(void);
 
 
 static void *rxThreadFunc(void *arg);
+static bool handleRxPacket(icpkthdr *pkt, int read_count, struct sockaddr_storage *peer, socklen_t peerlen, AckSendParam *param);
 
 static bool handleMismatch(icpkthdr *pkt, struct sockaddr_storage *peer, int peer_len);
 static void handleAckedPacket(MotionConn *ackConn, ICBuffer *buf, uint64 now);
@@ -738,6 +873,9 @@ static inline void addCRC(icpkthdr *pkt);
 static inline bool checkCRC(icpkthdr *pkt);
 static void sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, MotionConn *conn);
 static void sendOnce(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, ICBuffer *buf, MotionConn * conn);
+#ifdef UDPIFC_BATCH_IO
+static void sendBatch(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, MotionConn *conn, ICBuffer **bufs, int nbufs);
+#endif
 static inline uint64 computeExpirationPeriod(MotionConn *conn, uint32 retry);
 
 static ICBuffer *getSndBuffer(MotionConn *conn);
@@ -760,8 +898,29 @@ static bool waitOnCondition(int timeout_us, pthread_cond_t *cond, pthread_mutex_
 static inline void logPkt(char *prefix, icpkthdr *pkt);
 static void aggregateStatistics(ChunkTransportStateEntry *pEntry);
 
+static ICPeerStats *getPeerStatsSlot(int contentId);
+static void initConnCwnd(MotionConn *conn);
+static void adjustConnCwndOnAck(MotionConn *conn, uint64 ackTime, uint64 now);
+static void reduceConnCwnd(MotionConn *conn, CwndEvent event, uint64 now);
+static void recordPeerStats(MotionConn *conn);
+
+static bool isLocalAddress(const char *addr);
+static bool isLocalPeer(CdbProcess *peer);
+static void getShmRingPath(char *path, icpkthdr *connInfo);
+static void createShmRing(ChunkTransportStateEntry *pEntry, MotionConn *conn);
+static bool startShmRing(MotionConn *conn);
+static void detachShmRing(MotionConn *conn, bool remove);
+static bool sendShmPacket(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, MotionConn *conn);
+static void sendShmDoorbell(ChunkTransportStateEntry *pEntry, MotionConn *conn);
+static void pullShmRing(MotionConn *conn);
+static MotionConn *pullShmRings(ChunkTransportStateEntry *pEntry, MotionConn *target);
+static void setShmRingsSleeping(ChunkTransportStateEntry *pEntry, MotionConn *target, bool sleeping);
+
 static inline bool pollAcks(ChunkTransportState *transportStates, int fd, int timeout);
 
+static void sendRuntimeFilter(MotionConn *conn);
+static void installRuntimeFilter(MotionConn *conn, icpkthdr *pkt);
+
 /* #define TRANSFER_PROTOCOL_STATS */
 
 #ifdef TRANSFER_PROTOCOL_STATS
@@ -891,6 +1050,17 @@ dumpTransProtoStats()
 
 	pthread_mutex_unlock(&trans_proto_stats.lock);
 
+	/* packets per system call, for each kind of socket I/O */
+	fprintf(ofile, "xmit pkts %d syscalls %d pkts/syscall %.2f\n",
+			ic_statistics.xmitPktNum, ic_statistics.xmitSyscallNum,
+			ic_statistics.xmitSyscallNum > 0 ? (double) ic_statistics.xmitPktNum / ic_statistics.xmitSyscallNum : 0.0);
+	fprintf(ofile, "rx pkts %d syscalls %d pkts/syscall %.2f\n",
+			ic_statistics.rxPktNum, ic_statistics.rxSyscallNum,
+			ic_statistics.rxSyscallNum > 0 ? (double) ic_statistics.rxPktNum / ic_statistics.rxSyscallNum : 0.0);
+	fprintf(ofile, "ack pkts %d syscalls %d pkts/syscall %.2f\n",
+			ic_statistics.ackPktNum, ic_statistics.ackSyscallNum,
+			ic_statistics.ackSyscallNum > 0 ? (double) ic_statistics.ackPktNum / ic_statistics.ackSyscallNum : 0.0);
+
     fclose(ofile);
 }
 
@@ -1376,15 +1546,23 @@ InitMotionUDPIFC(int *listenerSocketFd, uint16 *listenerPort)
 	rx_control_info.lastTornIcId = 0;
 	initCursorICHistoryTable(&rx_control_info.cursorHistoryTable);
 
+	/*
+	 * Rings for local peers live in tmpfs, and their counters are only
+	 * usable across processes with native atomics.
+	 */
+#ifndef PG_HAVE_ATOMIC_U32_SIMULATION
+	ic_shm_available = (access(IC_SHM_DIR, W_OK) == 0);
+#endif
+
 	/* Initialize receive buffer pool */
 	rx_buffer_pool.count = 0;
-	rx_buffer_pool.maxCount = 1;
+	rx_buffer_pool.maxCount = UDPIFC_MAX_BATCH;
 	rx_buffer_pool.freeList = NULL;
 
 	/* Initialize send control data */
 	snd_control_info.cwnd = 0;
 	snd_control_info.minCwnd = 0;
-	snd_control_info.ackBuffer = palloc0(MIN_PACKET_SIZE);
+	snd_control_info.ackBuffer = palloc0(ACK_BUFFER_SIZE);
 
 	MemoryContextSwitchTo(old);
 
@@ -1808,6 +1986,79 @@ sendAckWithParam(AckSendParam *param)
 	sendControlMessage(&param->msg, UDP_listenerFd, (struct sockaddr *)&param->peer, param->peer_len);
 }
 
+/*
+ * sendAcksWithParams
+ * 		Send the acknowledgments collected by the rx thread for a batch of packets.
+ *
+ * Like sendControlMessage(), acks the kernel does not take are left to the
+ * retransmit logic.
+ */
+static void
+sendAcksWithParams(AckSendParam *params, int nparams)
+{
+	int		i;
+
+#ifdef UDPIFC_BATCH_IO
+	if (nparams > 1)
+	{
+		struct mmsghdr	msgs[UDPIFC_MAX_BATCH];
+		struct iovec	iovs[UDPIFC_MAX_BATCH];
+		int				nmsgs = 0;
+		int				n;
+
+		Assert(nparams <= UDPIFC_MAX_BATCH);
+
+		for (i = 0; i < nparams; i++)
+		{
+			icpkthdr *pkt = &params[i].msg;
+
+#ifdef USE_ASSERT_CHECKING
+			if (testmode_inject_fault(gp_udpic_dropacks_percent))
+			{
+			#ifdef AMS_VERBOSE_LOGGING
+				write_log("THROW CONTROL MESSAGE with seq %d extraSeq %d srcpid %d despid %d", pkt->seq, pkt->extraSeq, pkt->srcPid, pkt->dstPid);
+			#endif
+				continue;
+			}
+#endif
+
+			/* Add CRC for the control message. */
+			if (gp_interconnect_full_crc)
+				addCRC(pkt);
+
+			iovs[nmsgs].iov_base = pkt;
+			iovs[nmsgs].iov_len = pkt->len;
+
+			memset(&msgs[nmsgs], 0, sizeof(struct mmsghdr));
+			msgs[nmsgs].msg_hdr.msg_name = &params[i].peer;
+			msgs[nmsgs].msg_hdr.msg_namelen = params[i].peer_len;
+			msgs[nmsgs].msg_hdr.msg_iov = &iovs[nmsgs];
+			msgs[nmsgs].msg_hdr.msg_iovlen = 1;
+			nmsgs++;
+		}
+
+		if (nmsgs == 0)
+			return;
+
+		n = sendmmsg(UDP_listenerFd, msgs, nmsgs, 0);
+		if (n < nmsgs)
+			write_log("sendAcksWithParams: sent %d of %d acks, errno %d", n, nmsgs, errno);
+
+		pg_atomic_add_fetch_u32((pg_atomic_uint32 *)&ic_statistics.ackSyscallNum, 1);
+		if (n > 0)
+			pg_atomic_add_fetch_u32((pg_atomic_uint32 *)&ic_statistics.ackPktNum, n);
+		return;
+	}
+#endif
+
+	for (i = 0; i < nparams; i++)
+	{
+		sendAckWithParam(&params[i]);
+		pg_atomic_add_fetch_u32((pg_atomic_uint32 *)&ic_statistics.ackSyscallNum, 1);
+		pg_atomic_add_fetch_u32((pg_atomic_uint32 *)&ic_statistics.ackPktNum, 1);
+	}
+}
+
 /*
  * sendAck
  * 		Send acknowledgment to sender.
@@ -1919,10 +2170,38 @@ putRxBufferAndSendAck(MotionConn *conn, AckSendParam *param)
 	conn->pkt_q_head = (conn->pkt_q_head + 1) % conn->pkt_q_capacity;
 	conn->pkt_q_size--;
 
+	/* now that we have heard from the sender, we can send it our filter */
+	if (conn->rtFilter != NULL)
+		sendRuntimeFilter(conn);
+
 #ifdef AMS_VERBOSE_LOGGING
 	elog(LOG, "putRxBufferAndSendAck conn %p pkt [seq %d] for node %d route %d, [head seq] %d queue size %d, queue head %d queue tail %d", conn, buf->seq, buf->motNodeId, conn->route, conn->conn_info.seq - conn->pkt_q_size, conn->pkt_q_size, conn->pkt_q_head, conn->pkt_q_tail);
 #endif
 
+	if (conn->shmRing != NULL && IC_SHM_RING_OWNS(conn->shmRing, buf))
+	{
+		ICShmRing  *ring = conn->shmRing;
+
+		/* ring packets are freed in order, and need no ack */
+		pg_memory_barrier();
+		pg_atomic_write_u32(&ring->tail, pg_atomic_read_u32(&ring->tail) + 1);
+		conn->conn_info.extraSeq = seq;
+
+		/* wake up the sender if it waits for a free slot */
+		pg_memory_barrier();
+		if (pg_atomic_read_u32(&ring->txSleeping) != 0 &&
+			pg_atomic_exchange_u32(&ring->txSleeping, 0) != 0)
+		{
+			int32		flags = UDPIC_FLAGS_RECEIVER_TO_SENDER | UDPIC_FLAGS_SHM_DOORBELL;
+
+			if (param != NULL)
+				setAckSendParam(param, conn, flags, conn->conn_info.seq - 1, seq);
+			else
+				sendAck(conn, flags, conn->conn_info.seq - 1, seq);
+		}
+		return;
+	}
+
 	putRxBufferToFreeList(&rx_buffer_pool, buf);
 
 	conn->conn_info.extraSeq = seq;
@@ -2746,6 +3025,7 @@ setupOutgoingUDPConnection(ChunkTransportState *transportStates, ChunkTransportS
 	conn->wakeup_ms = 0;
 	conn->remoteContentId = cdbProc->contentid;
 	conn->stat_min_ack_time = ~((uint64)0);
+	initConnCwnd(conn);
 
 	/* Save the information for the error message if getaddrinfo fails */
 	if (strchr(cdbProc->listenerAddr,':') != 0)
@@ -2866,6 +3146,9 @@ setupOutgoingUDPConnection(ChunkTransportState *transportStates, ChunkTransportS
 	conn->conn_info.sessionId = gp_session_id;
 	conn->conn_info.icId = gp_interconnect_id;
 
+	/* the ring is mapped once the receiver has acked the first packet */
+	conn->localPeer = isLocalPeer(conn->cdbProc);
+
 	connAddHash(&ic_control_info.connHtab, conn);
 
 	/*
@@ -2998,6 +3281,7 @@ SetupUDPIFCInterconnect_Internal(EState *estate)
 	estate->interconnect_context->SendEos = SendEosUDPIFC;
 	estate->interconnect_context->SendChunk = SendChunkUDPIFC;
 	estate->interconnect_context->doSendStopMessage = doSendStopMessageUDPIFC;
+	estate->interconnect_context->doSendRuntimeFilter = doSendRuntimeFilterUDPIFC;
 
 	mySlice = (Slice *) list_nth(estate->interconnect_context->sliceTable->slices, LocallyExecutingSliceIndex(estate));
 
@@ -3101,6 +3385,10 @@ SetupUDPIFCInterconnect_Internal(EState *estate)
 				conn->conn_info.icId = gp_interconnect_id;
 				conn->conn_info.flags = UDPIC_FLAGS_RECEIVER_TO_SENDER;
 
+				/* the ring must exist before the sender can see an ack */
+				if (isLocalPeer(conn->cdbProc))
+					createShmRing(pEntry, conn);
+
 				connAddHash(&ic_control_info.connHtab, conn);
 			}
 		}
@@ -3126,6 +3414,7 @@ SetupUDPIFCInterconnect_Internal(EState *estate)
 		ic_control_info.lastDeadlockCheckTime = ic_control_info.lastExpirationCheckTime;
 
 		sendingChunkTransportState = startOutgoingUDPConnections(estate->interconnect_context, mySlice, &expectedTotalOutgoing);
+		setupMotionCompression(estate, sendingChunkTransportState);
 		n = sendingChunkTransportState->numConns;
 
 		for (i = 0; i < n; i++)
@@ -3385,10 +3674,20 @@ TeardownUDPIFCInterconnect_Internal(ChunkTransportState *transportStates,
 					/* compute some statistics */
 					computeNetworkStatistics(conn->rtt, &minRtt, &maxRtt, &avgRtt);
 					computeNetworkStatistics(conn->dev, &minDev, &maxDev, &avgDev);
+					recordPeerStats(conn);
 
 					icBufferListReturn(&conn->sndQueue, false);
 					icBufferListReturn(&conn->unackQueue, Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_CAPACITY ? false : true);
 
+					if (conn->shmRing != NULL)
+						detachShmRing(conn, false);
+
+					if (conn->rtFilter != NULL)
+					{
+						pfree(conn->rtFilter);
+						conn->rtFilter = NULL;
+					}
+
 					connDelHash(&ic_control_info.connHtab, conn);
 				}
 				avgRtt = avgRtt / pEntry->numConns;
@@ -3459,6 +3758,9 @@ TeardownUDPIFCInterconnect_Internal(ChunkTransportState *transportStates,
 
 					connDelHash(&ic_control_info.connHtab, conn);
 
+					/* too late for the filter, if it's still unsent */
+					conn->rtFilter = NULL;
+
 					/* putRxBufferAndSendAck() dequeues messages and moves them to pBuff */
 					while (conn->pkt_q_size > 0)
 					{
@@ -3468,6 +3770,10 @@ TeardownUDPIFCInterconnect_Internal(ChunkTransportState *transportStates,
 					/* we also need to clear all the out-of-order packets */
 					freeDisorderedPackets(conn);
 
+					/* the queue no longer points into the ring */
+					if (conn->shmRing != NULL)
+						detachShmRing(conn, true);
+
 					/* free up the packet queue */
 					pfree(conn->pkt_q);
 					conn->pkt_q = NULL;
@@ -3523,7 +3829,8 @@ TeardownUDPIFCInterconnect_Internal(ChunkTransportState *transportStates,
 			" freebuf_avg %f "
 			"mismatch_pkt_num %d disordered_pkt_num %d duplicated_pkt_num %d"
 			" rtt/dev [" UINT64_FORMAT "/" UINT64_FORMAT ", %f/%f, " UINT64_FORMAT "/" UINT64_FORMAT "] "
-			" cwnd %f status_query_msg_num %d",
+			" cwnd %f status_query_msg_num %d"
+			" xmit_pkt/syscall %d/%d rx_pkt/syscall %d/%d ack_pkt/syscall %d/%d",
 			ic_control_info.isSender, isReceiver,
 			Gp_interconnect_snd_queue_depth, Gp_interconnect_queue_depth, Gp_max_packet_size,
 			UNACK_QUEUE_RING_SLOTS_NUM, TIMER_SPAN, DEFAULT_RTT,
@@ -3536,7 +3843,10 @@ TeardownUDPIFCInterconnect_Internal(ChunkTransportState *transportStates,
 			(double)((double)ic_statistics.totalBuffers)/((double)ic_statistics.bufferCountingTime),
 			ic_statistics.mismatchNum, ic_statistics.disorderedPktNum, ic_statistics.duplicatedPktNum,
 			(minRtt == ~((uint64)0) ? 0 : minRtt), (minDev == ~((uint64)0) ? 0 : minDev), avgRtt, avgDev, maxRtt, maxDev,
-			snd_control_info.cwnd, ic_statistics.statusQueryMsgNum);
+			snd_control_info.cwnd, ic_statistics.statusQueryMsgNum,
+			ic_statistics.xmitPktNum, ic_statistics.xmitSyscallNum,
+			ic_statistics.rxPktNum, ic_statistics.rxSyscallNum,
+			ic_statistics.ackPktNum, ic_statistics.ackSyscallNum);
 
 	ic_control_info.isSender = false;
 	memset(&ic_statistics, 0, sizeof(ICStatistics));
@@ -3609,6 +3919,117 @@ prepareRxConnForRead(MotionConn *conn)
 	conn->recvBytes = conn->msgSize;
 }
 
+/*
+ * pullShmRing
+ * 		Move the packets the sender has put into the shared memory ring of the
+ * 		connection into its packet queue.
+ *
+ * The queue points into the ring; the slots are freed by
+ * putRxBufferAndSendAck().  Nothing is pulled once a stop is requested, the
+ * sender stops when it finds the ring full.
+ *
+ * MUST BE CALLED WITH ic_control_info.lock LOCKED.
+ */
+static void
+pullShmRing(MotionConn *conn)
+{
+	ICShmRing  *ring = conn->shmRing;
+	uint32		head = pg_atomic_read_u32(&ring->head);
+
+	if (conn->shmPulled == head || conn->stopRequested || !conn->stillActive)
+		return;
+
+	/* read the slots only after seeing head move */
+	pg_read_barrier();
+
+	while (conn->shmPulled != head && conn->pkt_q_size < conn->pkt_q_capacity)
+	{
+		icpkthdr   *pkt = IC_SHM_RING_SLOT(ring, conn->shmPulled);
+
+		if (pkt->seq != conn->conn_info.seq)
+		{
+			pthread_mutex_unlock(&ic_control_info.lock);
+			elog(FATAL, "Interconnect error: shared memory ring of route %d has packet seq %u, expected %u",
+				 conn->route, pkt->seq, conn->conn_info.seq);
+		}
+
+		Assert(conn->pkt_q[conn->pkt_q_tail] == NULL);
+		conn->pkt_q[conn->pkt_q_tail] = (uint8 *) pkt;
+		conn->pkt_q_tail = (conn->pkt_q_tail + 1) % conn->pkt_q_capacity;
+		conn->pkt_q_size++;
+		conn->conn_info.seq++;
+		conn->shmPulled++;
+
+		if (pkt->flags & UDPIC_FLAGS_EOS)
+			conn->conn_info.flags |= UDPIC_FLAGS_EOS;
+
+		ic_statistics.recvPktNum++;
+	}
+}
+
+/*
+ * pullShmRings
+ * 		Pull the shared memory rings of a motion, or only the one of target.
+ *
+ * Returns a connection that has packets queued, or NULL.
+ *
+ * MUST BE CALLED WITH ic_control_info.lock LOCKED.
+ */
+static MotionConn *
+pullShmRings(ChunkTransportStateEntry *pEntry, MotionConn *target)
+{
+	MotionConn *ready = NULL;
+	int			i;
+
+	if (target != NULL)
+	{
+		if (target->shmRing != NULL)
+			pullShmRing(target);
+
+		return (target->pkt_q_size > 0 ? target : NULL);
+	}
+
+	for (i = 0; i < pEntry->numConns; i++)
+	{
+		MotionConn *conn = pEntry->conns + i;
+
+		if (conn->shmRing == NULL)
+			continue;
+
+		pullShmRing(conn);
+
+		if (ready == NULL && conn->pkt_q_size > 0)
+			ready = conn;
+	}
+
+	return ready;
+}
+
+/*
+ * setShmRingsSleeping
+ * 		Set or clear the request of the main thread for a doorbell on the
+ * 		shared memory rings of a motion, or only on the one of target.
+ */
+static void
+setShmRingsSleeping(ChunkTransportStateEntry *pEntry, MotionConn *target, bool sleeping)
+{
+	int			i;
+
+	for (i = 0; i < pEntry->numConns; i++)
+	{
+		MotionConn *conn = pEntry->conns + i;
+
+		if (conn->shmRing == NULL || (target != NULL && conn != target))
+			continue;
+
+		pg_atomic_write_u32(&conn->shmRing->rxSleeping, sleeping ? 1 : 0);
+	}
+
+	/* make the requests visible before looking at the rings again */
+	if (sleeping)
+		pg_memory_barrier();
+}
+
 /*
  * receiveChunksUDPIFC
  * 		Receive chunks from the senders
@@ -3648,7 +4069,17 @@ receiveChunksUDPIFC(ChunkTransportState *pTransportStates, ChunkTransportStateEn
 	/* we didn't have any data, so we've got to read it from the network. */
 	for (;;)
 	{
+		bool		woken;
+
 		/* 1. Do we have data ready */
+		if (rx_control_info.mainWaitingState.reachRoute == ANY_ROUTE && pEntry->numShmConns > 0)
+		{
+			MotionConn *ready = pullShmRings(pEntry, conn);
+
+			if (ready != NULL)
+				rx_control_info.mainWaitingState.reachRoute = ready->route;
+		}
+
 		if (rx_control_info.mainWaitingState.reachRoute != ANY_ROUTE)
 		{
 			rxconn = pEntry->conns + rx_control_info.mainWaitingState.reachRoute;
@@ -3680,7 +4111,23 @@ receiveChunksUDPIFC(ChunkTransportState *pTransportStates, ChunkTransportStateEn
 		retries++;
 
 		/* 2. Wait for data to become ready */
-		if (waitOnCondition(MAIN_THREAD_COND_TIMEOUT, &ic_control_info.cond, &ic_control_info.lock))
+		if (pEntry->numShmConns > 0)
+		{
+			/* ask the local senders for a doorbell, then look again */
+			setShmRingsSleeping(pEntry, conn, true);
+			if (pullShmRings(pEntry, conn) != NULL)
+			{
+				setShmRingsSleeping(pEntry, conn, false);
+				continue;
+			}
+		}
+
+		woken = waitOnCondition(MAIN_THREAD_COND_TIMEOUT, &ic_control_info.cond, &ic_control_info.lock);
+
+		if (pEntry->numShmConns > 0)
+			setShmRingsSleeping(pEntry, conn, false);
+
+		if (woken)
 		{
 			continue; /* success ! */
 		}
@@ -3754,6 +4201,9 @@ RecvTupleChunkFromAnyUDPIFC_Internal(MotionLayerState *mlStates,
 
 	pthread_mutex_lock(&ic_control_info.lock);
 
+	if (pEntry->numShmConns > 0)
+		pullShmRings(pEntry, NULL);
+
 	for (i = 0; i < pEntry->numConns; i++, index++)
 	{
 		if (index >= pEntry->numConns)
@@ -3886,6 +4336,9 @@ RecvTupleChunkFromUDPIFC_Internal(ChunkTransportState *transportStates,
 		return NULL;
 	}
 
+	if (conn->shmRing != NULL)
+		pullShmRing(conn);
+
 	ic_statistics.totalRecvQueueSize += conn->pkt_q_size;
 	ic_statistics.recvQueueSizeCountingTime++;
 
@@ -3989,95 +4442,337 @@ aggregateStatistics(ChunkTransportStateEntry *pEntry)
 }
 
 /*
- * logPkt
- * 		Log a packet.
- *
+ * ICPeerStatsShmemSize
+ * 		Size of the shared memory holding the per-peer statistics.
  */
-static inline void
-logPkt(char *prefix, icpkthdr *pkt)
+Size
+ICPeerStatsShmemSize(void)
 {
-	write_log("%s [%s: seq %d extraSeq %d]: motNodeId %d, crc %d len %d "
-			"srcContentId %d dstDesContentId %d "
-			"srcPid %d dstPid %d "
-			"srcListenerPort %d dstListernerPort %d "
-			"sendSliceIndex %d recvSliceIndex %d "
-			"sessionId %d icId %d "
-			"flags %d ",
-			prefix, pkt->flags & UDPIC_FLAGS_RECEIVER_TO_SENDER ? "ACK" : "DATA",
-			pkt->seq, pkt->extraSeq, pkt->motNodeId, pkt->crc, pkt->len,
-			pkt->srcContentId, pkt->dstContentId,
-			pkt->srcPid, pkt->dstPid,
-			pkt->srcListenerPort, pkt->dstListenerPort,
-			pkt->sendSliceIndex, pkt->recvSliceIndex,
-			pkt->sessionId, pkt->icId,
-			pkt->flags);
+	return add_size(offsetof(ICPeerStatsShmem, peers),
+					mul_size(IC_PEER_STATS_SLOTS, sizeof(ICPeerStats)));
 }
 
 /*
- * handleAckedPacket
- * 		Called by sender to process acked packet.
- *
- * 	Remove it from unack queue and unack queue ring, change the rtt ...
- *
- * 	RTT (Round Trip Time) is computed as the time between we send the packet
- * 	and receive the acknowledgement for the packet. When an acknowledgement 
- * 	is received, an estimated RTT value (called SRTT, smoothed RTT) is updated
- * 	by using the following equation. And we also set a limitation of the max
- * 	value and min value for SRTT.
- *	    (1) SRTT = (1 - g) SRTT + g x RTT (0 < g < 1)
- *	where RTT is the measured round trip time of the packet. In implementation,
- *	g is set to 1/8. In order to compute expiration period, we also compute an
- *	estimated delay variance SDEV by using:
- *	    (2) SDEV = (1 - h) x SDEV + h x |SERR| (0 < h < 1, In implementation, h is set to 1/4)
- *	where SERR is calculated by using:
- *	    (3) SERR = RTT - SRTT
- *	Expiration period determines the timing we resend a packet. A long RTT means
- *	a long expiration period. Delay variance is used to incorporate the variance
- *	of workload/network variances at different time. When a packet is retransmitted,
- *	we back off exponentially the expiration period.
- *	    (4) exp_period = (SRTT + y x SDEV) << retry
- *	Here y is a constant (In implementation, we use 4) and retry is the times the
- *	packet is retransmitted.
+ * ICPeerStatsShmemInit
+ * 		Allocate and initialize the per-peer statistics.
  */
-static void
-handleAckedPacket(MotionConn *ackConn, ICBuffer *buf, uint64 now)
+void
+ICPeerStatsShmemInit(void)
 {
-	uint64 ackTime = 0;
-
-	bool bufIsHead = (&buf->primary == icBufferListFirst(&ackConn->unackQueue));
+	bool		found;
+	int			i;
 
-	buf = icBufferListDelete(&ackConn->unackQueue, buf);
+	ic_peer_stats = (ICPeerStatsShmem *)
+		ShmemInitStruct("Interconnect Peer Stats", ICPeerStatsShmemSize(), &found);
 
-	if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_LOSS)
+	if (!found)
 	{
-		buf = icBufferListDelete(&unack_queue_ring.slots[buf->unackQueueRingSlot], buf);
-		unack_queue_ring.numOutStanding--;
-		if (icBufferListLength(&ackConn->unackQueue) >= 1)
-			unack_queue_ring.numSharedOutStanding--;
+		MemSet(ic_peer_stats, 0, ICPeerStatsShmemSize());
+		SpinLockInit(&ic_peer_stats->lock);
 
-		ackTime = now - buf->sentTime;
-
-		/* In udp_testmode, we do not change rtt dynamically due to the
-		 * large number of packet losses introduced by fault injection code.
-		 * This can decrease the testing time.
-		 */
-#ifdef USE_ASSERT_CHECKING
-		if (!udp_testmode)
-#endif
+		for (i = 0; i < IC_PEER_STATS_SLOTS; i++)
 		{
-	        uint64 newRTT = 0;
-	        uint64 newDEV = 0;
+			ic_peer_stats->peers[i].contentId = UNDEF_SEGMENT;
+			ic_peer_stats->peers[i].minRtt = ~((uint64)0);
+		}
+	}
+}
 
-	        if (buf->nRetry == 0)
-	        {
-	        	newRTT = buf->conn->rtt - (buf->conn->rtt >> RTT_SHIFT_COEFFICIENT) + (ackTime >> RTT_SHIFT_COEFFICIENT);
-	        	newRTT = Min(MAX_RTT, Max(newRTT, MIN_RTT));
-	        	buf->conn->rtt = newRTT;
+/*
+ * getICPeerStats
+ * 		Copy the statistics of up to maxStats peers, return the number copied.
+ */
+int
+getICPeerStats(ICPeerStats *stats, int maxStats)
+{
+	int			n = 0;
+	int			i;
+
+	if (ic_peer_stats == NULL)
+		return 0;
+
+	SpinLockAcquire(&ic_peer_stats->lock);
+	for (i = 0; i < IC_PEER_STATS_SLOTS && n < maxStats; i++)
+	{
+		if (ic_peer_stats->peers[i].contentId != UNDEF_SEGMENT)
+			stats[n++] = ic_peer_stats->peers[i];
+	}
+	SpinLockRelease(&ic_peer_stats->lock);
+
+	return n;
+}
+
+/*
+ * getPeerStatsSlot
+ * 		The shared memory slot of a peer, NULL if it has none.
+ */
+static ICPeerStats *
+getPeerStatsSlot(int contentId)
+{
+	int			slot = contentId + 1;
+
+	if (ic_peer_stats == NULL || slot < 0 || slot >= IC_PEER_STATS_SLOTS)
+		return NULL;
+
+	return &ic_peer_stats->peers[slot];
+}
+
+/*
+ * initConnCwnd
+ * 		Initialize the congestion control state of an outgoing connection.
+ *
+ * A new connection starts with the minimal window and a slow start
+ * threshold of the receive queue depth.  If connections to the same peer
+ * recorded their state within the last PEER_STATS_WINDOW, their slow start
+ * threshold and smallest ack time are used instead, so that a query does
+ * not have to learn again what the path to a congested peer can take.
+ * Older statistics say little about the path as it is now, and are not
+ * used.
+ */
+static void
+initConnCwnd(MotionConn *conn)
+{
+	ICPeerStats *peer = getPeerStatsSlot(conn->remoteContentId);
+	TimestampTz	now;
+
+	conn->cwnd = MIN_CONN_CWND;
+	conn->ssthresh = Gp_interconnect_queue_depth;
+	conn->minRtt = ~((uint64)0);
+	conn->measuredMinRtt = ~((uint64)0);
+	conn->lastCwndCutTime = 0;
+	conn->stat_count_sent = 0;
+	conn->stat_count_loss = 0;
+	conn->stat_count_cwnd_cut = 0;
+
+	if (peer == NULL)
+		return;
+
+	now = GetCurrentTimestamp();
+
+	SpinLockAcquire(&ic_peer_stats->lock);
+	if (peer->contentId == conn->remoteContentId)
+	{
+		if (!TimestampDifferenceExceeds(peer->lastUpdate, now, PEER_STATS_WINDOW))
+			conn->ssthresh = Min(Max(peer->ssthresh, MIN_CONN_CWND), Gp_interconnect_queue_depth);
+		if (!TimestampDifferenceExceeds(peer->minRttTime, now, PEER_STATS_WINDOW))
+			conn->minRtt = peer->minRtt;
+	}
+	SpinLockRelease(&ic_peer_stats->lock);
+}
+
+/*
+ * adjustConnCwndOnAck
+ * 		Adjust the congestion window of a connection for an ack of a packet
+ * 		that was sent once.
+ *
+ * The window follows AIMD driven by the ack time: it grows by one packet per
+ * ack below the slow start threshold and by one packet per window above it,
+ * as long as the ack time stays within CWND_TARGET_DELAY of the smallest one
+ * seen on the connection.  A longer ack time means that packets queue up at
+ * the receiver or in the network, typically because many senders target the
+ * same receiver (incast), and the window is halved before packets are lost.
+ *
+ * The window never exceeds the receive queue depth, beyond which the
+ * receiver would not accept more packets anyway.
+ */
+static void
+adjustConnCwndOnAck(MotionConn *conn, uint64 ackTime, uint64 now)
+{
+	if (ackTime > conn->minRtt + CWND_TARGET_DELAY)
+	{
+		reduceConnCwnd(conn, CWND_EVENT_DELAY, now);
+		return;
+	}
+
+	if (conn->cwnd < conn->ssthresh)
+		conn->cwnd += 1;
+	else
+		conn->cwnd += 1 / conn->cwnd;
+	conn->cwnd = Min(conn->cwnd, Gp_interconnect_queue_depth);
+}
+
+/*
+ * reduceConnCwnd
+ * 		Shrink the congestion window of a connection on a congestion event.
+ *
+ * Delay and disorder halve the window, an expired packet shrinks it to the
+ * minimum.  A single congestion episode usually affects a whole window of
+ * packets, so the window is shrunk at most once per round trip.  Losses are
+ * counted even when gp_interconnect_adaptive_cwnd is off.
+ */
+static void
+reduceConnCwnd(MotionConn *conn, CwndEvent event, uint64 now)
+{
+	if (event != CWND_EVENT_DELAY)
+		conn->stat_count_loss++;
+
+	if (!gp_interconnect_adaptive_cwnd)
+		return;
+
+	if (conn->lastCwndCutTime != 0 && now - conn->lastCwndCutTime < conn->rtt)
+		return;
+
+	conn->ssthresh = Max(conn->cwnd / 2, MIN_CONN_CWND);
+	conn->cwnd = (event == CWND_EVENT_TIMEOUT) ? MIN_CONN_CWND : conn->ssthresh;
+	conn->lastCwndCutTime = now;
+	conn->stat_count_cwnd_cut++;
+}
+
+/*
+ * recordPeerStats
+ * 		Record the state and counters of an outgoing connection that is torn
+ * 		down in the statistics of its peer.
+ *
+ * Many connections to a peer, of this and of concurrent queries, are torn
+ * down in any order, so the window, slow start threshold and rtt kept for
+ * the peer are a moving average over them rather than the values of
+ * whichever came last.  After PEER_STATS_WINDOW without a connection the
+ * average starts over.
+ *
+ * The smallest ack time is a windowed minimum: one measured on this
+ * connection replaces it if it is smaller, or if the recorded one is older
+ * than PEER_STATS_WINDOW.  A path that got slower for good thus stops
+ * being judged against an ack time it can no longer reach.
+ */
+static void
+recordPeerStats(MotionConn *conn)
+{
+	ICPeerStats *peer = getPeerStatsSlot(conn->remoteContentId);
+	TimestampTz	now;
+
+	if (peer == NULL)
+		return;
+
+	now = GetCurrentTimestamp();
+
+	SpinLockAcquire(&ic_peer_stats->lock);
+	if (peer->contentId == conn->remoteContentId &&
+		!TimestampDifferenceExceeds(peer->lastUpdate, now, PEER_STATS_WINDOW))
+	{
+		/* moving average, weighing this connection 1/4 */
+		peer->cwnd += (conn->cwnd - peer->cwnd) / 4;
+		peer->ssthresh += (conn->ssthresh - peer->ssthresh) / 4;
+		peer->rtt = peer->rtt - (peer->rtt >> 2) + (conn->rtt >> 2);
+	}
+	else
+	{
+		peer->contentId = conn->remoteContentId;
+		peer->cwnd = conn->cwnd;
+		peer->ssthresh = conn->ssthresh;
+		peer->rtt = conn->rtt;
+	}
+	if (conn->measuredMinRtt != ~((uint64)0) &&
+		(conn->measuredMinRtt <= peer->minRtt ||
+		 TimestampDifferenceExceeds(peer->minRttTime, now, PEER_STATS_WINDOW)))
+	{
+		peer->minRtt = conn->measuredMinRtt;
+		peer->minRttTime = now;
+	}
+	peer->numConns++;
+	peer->pktsSent += conn->stat_count_sent;
+	peer->acks += conn->stat_count_acks;
+	peer->resent += conn->stat_count_resent;
+	peer->losses += conn->stat_count_loss;
+	peer->cwndCuts += conn->stat_count_cwnd_cut;
+	peer->lastUpdate = now;
+	SpinLockRelease(&ic_peer_stats->lock);
+}
+
+/*
+ * logPkt
+ * 		Log a packet.
+ *
+ */
+static inline void
+logPkt(char *prefix, icpkthdr *pkt)
+{
+	write_log("%s [%s: seq %d extraSeq %d]: motNodeId %d, crc %d len %d "
+			"srcContentId %d dstDesContentId %d "
+			"srcPid %d dstPid %d "
+			"srcListenerPort %d dstListernerPort %d "
+			"sendSliceIndex %d recvSliceIndex %d "
+			"sessionId %d icId %d "
+			"flags %d ",
+			prefix, pkt->flags & UDPIC_FLAGS_RECEIVER_TO_SENDER ? "ACK" : "DATA",
+			pkt->seq, pkt->extraSeq, pkt->motNodeId, pkt->crc, pkt->len,
+			pkt->srcContentId, pkt->dstContentId,
+			pkt->srcPid, pkt->dstPid,
+			pkt->srcListenerPort, pkt->dstListenerPort,
+			pkt->sendSliceIndex, pkt->recvSliceIndex,
+			pkt->sessionId, pkt->icId,
+			pkt->flags);
+}
+
+/*
+ * handleAckedPacket
+ * 		Called by sender to process acked packet.
+ *
+ * 	Remove it from unack queue and unack queue ring, change the rtt ...
+ *
+ * 	RTT (Round Trip Time) is computed as the time between we send the packet
+ * 	and receive the acknowledgement for the packet. When an acknowledgement 
+ * 	is received, an estimated RTT value (called SRTT, smoothed RTT) is updated
+ * 	by using the following equation. And we also set a limitation of the max
+ * 	value and min value for SRTT.
+ *	    (1) SRTT = (1 - g) SRTT + g x RTT (0 < g < 1)
+ *	where RTT is the measured round trip time of the packet. In implementation,
+ *	g is set to 1/8. In order to compute expiration period, we also compute an
+ *	estimated delay variance SDEV by using:
+ *	    (2) SDEV = (1 - h) x SDEV + h x |SERR| (0 < h < 1, In implementation, h is set to 1/4)
+ *	where SERR is calculated by using:
+ *	    (3) SERR = RTT - SRTT
+ *	Expiration period determines the timing we resend a packet. A long RTT means
+ *	a long expiration period. Delay variance is used to incorporate the variance
+ *	of workload/network variances at different time. When a packet is retransmitted,
+ *	we back off exponentially the expiration period.
+ *	    (4) exp_period = (SRTT + y x SDEV) << retry
+ *	Here y is a constant (In implementation, we use 4) and retry is the times the
+ *	packet is retransmitted.
+ */
+static void
+handleAckedPacket(MotionConn *ackConn, ICBuffer *buf, uint64 now)
+{
+	uint64 ackTime = 0;
+
+	bool bufIsHead = (&buf->primary == icBufferListFirst(&ackConn->unackQueue));
+
+	buf = icBufferListDelete(&ackConn->unackQueue, buf);
+
+	if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_LOSS)
+	{
+		buf = icBufferListDelete(&unack_queue_ring.slots[buf->unackQueueRingSlot], buf);
+		unack_queue_ring.numOutStanding--;
+		if (icBufferListLength(&ackConn->unackQueue) >= 1)
+			unack_queue_ring.numSharedOutStanding--;
+
+		ackTime = now - buf->sentTime;
+
+		/* In udp_testmode, we do not change rtt dynamically due to the
+		 * large number of packet losses introduced by fault injection code.
+		 * This can decrease the testing time.
+		 */
+#ifdef USE_ASSERT_CHECKING
+		if (!udp_testmode)
+#endif
+		{
+	        uint64 newRTT = 0;
+	        uint64 newDEV = 0;
+
+	        if (buf->nRetry == 0)
+	        {
+	        	newRTT = buf->conn->rtt - (buf->conn->rtt >> RTT_SHIFT_COEFFICIENT) + (ackTime >> RTT_SHIFT_COEFFICIENT);
+	        	newRTT = Min(MAX_RTT, Max(newRTT, MIN_RTT));
+	        	buf->conn->rtt = newRTT;
 
 	        	newDEV = buf->conn->dev - (buf->conn->dev >> DEV_SHIFT_COEFFICIENT) + ((Max(ackTime, newRTT) - Min(ackTime, newRTT)) >> DEV_SHIFT_COEFFICIENT);
 	        	newDEV = Min(MAX_DEV, Max(newDEV, MIN_DEV));
 	        	buf->conn->dev = newDEV;
 
+				buf->conn->minRtt = Min(buf->conn->minRtt, ackTime);
+				buf->conn->measuredMinRtt = Min(buf->conn->measuredMinRtt, ackTime);
+				if (gp_interconnect_adaptive_cwnd)
+					adjustConnCwndOnAck(buf->conn, ackTime, now);
+
 				/* adjust the congestion control window. */
 	        	if (snd_control_info.cwnd < snd_control_info.ssthresh)
 	        		snd_control_info.cwnd += 1;
@@ -4141,7 +4836,7 @@ handleAcks(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntr
 
 		/* ready to read on our socket ? */
 		peerlen = sizeof(peer);
-		n = recvfrom(pEntry->txfd, (char *)pkt, MIN_PACKET_SIZE, 0,
+		n = recvfrom(pEntry->txfd, (char *)pkt, ACK_BUFFER_SIZE, 0,
 					 (struct sockaddr *)&peer, &peerlen);
 
 		if (n < 0)
@@ -4188,6 +4883,10 @@ handleAcks(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntr
 		log_pkt("GOT ACK", pkt);
 #endif
 
+		/* a doorbell only wakes us up, see sendShmPacket() */
+		if (pkt->flags & UDPIC_FLAGS_SHM_DOORBELL)
+			continue;
+
 
 		/* read packet, is this the ack we want ?
 		 *
@@ -4214,6 +4913,13 @@ handleAcks(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntr
 				continue;
 			}
 
+			/* not an ack, but the receiver's filter of the rows it wants */
+			if (pkt->flags & UDPIC_FLAGS_RUNTIME_FILTER)
+			{
+				installRuntimeFilter(ackConn, pkt);
+				continue;
+			}
+
 			ackConn->stat_count_acks++;
 			ic_statistics.recvAckNum++;
 
@@ -4374,6 +5080,88 @@ checkCRC(icpkthdr *pkt)
 	return true;
 }
 
+/*
+ * benchmarkICPacketPath
+ * 		Time the CPU work done on every packet with the UDP interconnect.
+ *
+ * Fills numPackets packets of packetSize bytes like SendChunkUDPIFC() and
+ * prepareXmit() do, then adds and checks their CRC like senders and
+ * receivers do with gp_interconnect_full_crc.  The time spent in each step
+ * is returned in usecs[IC_BENCH_NUM_STEPS], in microseconds.  Packets are
+ * handled in rounds over a few buffers, so that they stay in cache like a
+ * packet does between being filled and sent.
+ */
+#define IC_BENCH_BUFFERS (16)
+
+void
+benchmarkICPacketPath(int packetSize, int numPackets, uint64 *usecs)
+{
+	icpkthdr	hdr;
+	char	   *payload;
+	char	   *bufs[IC_BENCH_BUFFERS];
+	int			payloadSize;
+	int			done;
+	int			i;
+
+	if (packetSize <= (int) sizeof(icpkthdr) || packetSize > MAX_PACKET_SIZE)
+		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+						errmsg("packet size must be between %d and %d bytes",
+							   (int) sizeof(icpkthdr) + 1, MAX_PACKET_SIZE)));
+
+	payloadSize = packetSize - sizeof(icpkthdr);
+
+	MemSet(&hdr, 0, sizeof(hdr));
+	hdr.len = packetSize;
+	hdr.srcPid = MyProcPid;
+	hdr.srcContentId = Gp_segment;
+	hdr.sessionId = gp_session_id;
+
+	/* something that does not compress to nothing, like tuple data */
+	payload = palloc(payloadSize);
+	for (i = 0; i < payloadSize; i++)
+		payload[i] = (char) random();
+
+	for (i = 0; i < IC_BENCH_BUFFERS; i++)
+		bufs[i] = palloc(packetSize);
+
+	for (i = 0; i < IC_BENCH_NUM_STEPS; i++)
+		usecs[i] = 0;
+
+	for (done = 0; done < numPackets; done += IC_BENCH_BUFFERS)
+	{
+		int			n = Min(IC_BENCH_BUFFERS, numPackets - done);
+		uint64		start;
+
+		start = getCurrentTime();
+		for (i = 0; i < n; i++)
+		{
+			hdr.seq++;
+			memcpy(bufs[i], &hdr, sizeof(hdr));
+			memcpy(bufs[i] + sizeof(hdr), payload, payloadSize);
+		}
+		usecs[IC_BENCH_FILL] += getCurrentTime() - start;
+
+		start = getCurrentTime();
+		for (i = 0; i < n; i++)
+			addCRC((icpkthdr *) bufs[i]);
+		usecs[IC_BENCH_ADD_CRC] += getCurrentTime() - start;
+
+		start = getCurrentTime();
+		for (i = 0; i < n; i++)
+		{
+			if (!checkCRC((icpkthdr *) bufs[i]))
+				elog(ERROR, "interconnect packet benchmark: CRC mismatch on packet %d", done + i);
+		}
+		usecs[IC_BENCH_CHECK_CRC] += getCurrentTime() - start;
+
+		CHECK_FOR_INTERRUPTS();
+	}
+
+	for (i = 0; i < IC_BENCH_BUFFERS; i++)
+		pfree(bufs[i]);
+	pfree(payload);
+}
+
 
 /*
  * prepareXmit
@@ -4392,7 +5180,24 @@ prepareXmit(MotionConn *conn)
 	/* increase the sequence no */
 	conn->conn_info.seq++;
 
-	if (gp_interconnect_full_crc)
+	if (conn->compress)
+	{
+		int		method;
+		int		len = compressPacket(conn->pBuff, conn->msgSize, sizeof(conn->conn_info), &method);
+
+		if (len >= 0)
+		{
+			icpkthdr *pkt = (icpkthdr *)conn->pBuff;
+
+			pkt->flags |= UDPIC_FLAGS_COMPRESSED;
+			if (method == INTERCONNECT_COMPRESSION_LZ4)
+				pkt->flags |= UDPIC_FLAGS_COMPRESSED_LZ4;
+			pkt->len = len;
+		}
+	}
+
+	/* packets in a shared memory ring never see the network */
+	if (gp_interconnect_full_crc && conn->shmRing == NULL)
 	{
 		icpkthdr *pkt = (icpkthdr *)conn->pBuff;
 		addCRC(pkt);
@@ -4453,6 +5258,9 @@ xmit_retry:
 		/* not reached */
 	}
 
+	ic_statistics.xmitSyscallNum++;
+	ic_statistics.xmitPktNum++;
+
 	if (n != buf->pkt->len)
 	{
 		if (DEBUG1 >= log_min_messages)
@@ -4468,6 +5276,82 @@ xmit_retry:
 	return;
 }
 
+#ifdef UDPIFC_BATCH_IO
+/*
+ * sendBatch
+ * 		Send a batch of packets of a connection with sendmmsg().
+ *
+ * The packets must already be in the unack queue, for the same reason as
+ * for sendOnce(). A packet the kernel does not take is handed to sendOnce(),
+ * which retries or reports the error, and the rest of the batch is sent
+ * after it.
+ */
+static void
+sendBatch(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, MotionConn *conn, ICBuffer **bufs, int nbufs)
+{
+	struct mmsghdr	msgs[UDPIFC_MAX_BATCH];
+	struct iovec	iovs[UDPIFC_MAX_BATCH];
+	int				nmsgs = 0;
+	int				sent = 0;
+	int				i;
+
+	Assert(nbufs <= UDPIFC_MAX_BATCH);
+
+	for (i = 0; i < nbufs; i++)
+	{
+#ifdef USE_ASSERT_CHECKING
+		if (testmode_inject_fault(gp_udpic_dropxmit_percent))
+		{
+		#ifdef AMS_VERBOSE_LOGGING
+			write_log("THROW PKT with seq %d srcpid %d despid %d", bufs[i]->pkt->seq, bufs[i]->pkt->srcPid, bufs[i]->pkt->dstPid);
+		#endif
+			continue;
+		}
+#endif
+		bufs[nmsgs] = bufs[i];
+
+		iovs[nmsgs].iov_base = bufs[i]->pkt;
+		iovs[nmsgs].iov_len = bufs[i]->pkt->len;
+
+		memset(&msgs[nmsgs], 0, sizeof(struct mmsghdr));
+		msgs[nmsgs].msg_hdr.msg_name = &conn->peer;
+		msgs[nmsgs].msg_hdr.msg_namelen = conn->peer_len;
+		msgs[nmsgs].msg_hdr.msg_iov = &iovs[nmsgs];
+		msgs[nmsgs].msg_hdr.msg_iovlen = 1;
+		nmsgs++;
+	}
+
+	while (sent < nmsgs)
+	{
+		int		n;
+
+		n = sendmmsg(pEntry->txfd, msgs + sent, nmsgs - sent, 0);
+		if (n <= 0)
+		{
+			sendOnce(transportStates, pEntry, bufs[sent], conn);
+			sent++;
+			continue;
+		}
+
+		ic_statistics.xmitSyscallNum++;
+		ic_statistics.xmitPktNum += n;
+
+		for (i = sent; i < sent + n; i++)
+		{
+			if (msgs[i].msg_len != bufs[i]->pkt->len)
+			{
+				if (DEBUG1 >= log_min_messages)
+					write_log("Interconnect error writing an outgoing packet [seq %d]: short transmit (given %d sent %d) during sendmmsg() call."
+						  "For Remote Connection: contentId=%d at %s", bufs[i]->pkt->seq, bufs[i]->pkt->len, (int) msgs[i].msg_len,
+						  conn->remoteContentId,
+						  conn->remoteHostAndPort);
+			}
+		}
+
+		sent += n;
+	}
+}
+#endif   /* UDPIFC_BATCH_IO */
 
 /*
  * handleStopMsgs
@@ -4577,6 +5461,11 @@ handleStopMsgs(ChunkTransportState *transportStates, ChunkTransportStateEntry *p
 static void
 sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, MotionConn *conn)
 {
+#ifdef UDPIFC_BATCH_IO
+	ICBuffer   *batch[UDPIFC_MAX_BATCH];
+	int			nbatch = 0;
+#endif
+
 	while (conn->capacity > 0 && icBufferListLength(&conn->sndQueue) > 0)
 	{
 		ICBuffer *buf = NULL;
@@ -4585,6 +5474,11 @@ sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEnt
 				&& unack_queue_ring.numSharedOutStanding >= (snd_control_info.cwnd - snd_control_info.minCwnd)))
 			break;
 
+		/* the connection's own window; it is at least one packet. */
+		if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_LOSS && gp_interconnect_adaptive_cwnd
+				&& icBufferListLength(&conn->unackQueue) >= (int) conn->cwnd)
+			break;
+
 		/* for connection setup, we only allow one outstanding packet. */
 		if (conn->state == mcsSetupOutgoingConnection && icBufferListLength(&conn->unackQueue) >= 1)
 			break;
@@ -4622,8 +5516,22 @@ sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEnt
 		updateStats(TPE_DATA_PKT_SEND, conn, buf->pkt);
 #endif
 
-		sendOnce(transportStates, pEntry, buf, conn);
+#ifdef UDPIFC_BATCH_IO
+		if (gp_interconnect_batch_io)
+		{
+			/* sent below, together with the other packets let out */
+			batch[nbatch++] = buf;
+			if (nbatch == UDPIFC_MAX_BATCH)
+			{
+				sendBatch(transportStates, pEntry, conn, batch, nbatch);
+				nbatch = 0;
+			}
+		}
+		else
+#endif
+			sendOnce(transportStates, pEntry, buf, conn);
 		ic_statistics.sndPktNum++;
+		conn->stat_count_sent++;
 
 #ifdef AMS_VERBOSE_LOGGING
 		logPkt("SEND PKT DETAIL", buf->pkt);
@@ -4631,6 +5539,11 @@ sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEnt
 
 		buf->conn->sentSeq = buf->pkt->seq;
 	}
+
+#ifdef UDPIFC_BATCH_IO
+	if (nbatch > 0)
+		sendBatch(transportStates, pEntry, conn, batch, nbatch);
+#endif
 }
 
 /*
@@ -4817,6 +5730,7 @@ handleAckForDisorderPkt(ChunkTransportState *transportStates, ChunkTransportStat
 	{
 		snd_control_info.ssthresh = Max(snd_control_info.cwnd/2, snd_control_info.minCwnd);
 		snd_control_info.cwnd = snd_control_info.ssthresh;
+		reduceConnCwnd(conn, CWND_EVENT_DISORDER, now);
 	}
 #ifdef AMS_VERBOSE_LOGGING
 	write_log("After DISORDER: sndQ %d unackQ %d", icBufferListLength(&conn->sndQueue), icBufferListLength(&conn->unackQueue));
@@ -4947,6 +5861,7 @@ checkExpiration(ChunkTransportState *transportStates, ChunkTransportStateEntry *
 			ic_statistics.retransmits++;
 			curBuf->conn->stat_count_resent++;
 			curBuf->conn->stat_max_resent = Max(curBuf->conn->stat_max_resent, curBuf->conn->stat_count_resent);
+			reduceConnCwnd(curBuf->conn, CWND_EVENT_TIMEOUT, now);
 
 			checkNetworkTimeout(curBuf, now);
 
@@ -5184,17 +6099,406 @@ computeTimeout(MotionConn *conn, int retry)
 }
 
 /*
- * SendChunkUDPIFC
- * 		is used to send a tcItem to a single destination. Tuples often are
- * 		*very small* we aggregate in our local buffer before sending into the kernel.
+ * isLocalAddress
+ * 		Is a listener address one of the addresses of this host.
  *
- * PARAMETERS
- *	 conn - MotionConn that the tcItem is to be sent to.
- *	 tcItem - message to be sent.
- *	 motionId - Node Motion Id.
+ * Peers on the same host may listen on different addresses, e.g. of
+ * different network interfaces, so comparing the address to our own is
+ * not enough.  An address belongs to this host if a socket can be bound
+ * to it.  The answers are cached, there is only an address or a few per
+ * host of the cluster.
  */
 static bool
-SendChunkUDPIFC(MotionLayerState *mlStates,
+isLocalAddress(const char *addr)
+{
+	struct addrinfo *addrs = NULL;
+	struct addrinfo *ai;
+	struct addrinfo hint;
+	bool		local = false;
+	int			i;
+
+	for (i = 0; i < ic_num_host_addrs; i++)
+	{
+		if (strcmp(ic_host_addrs[i].addr, addr) == 0)
+			return ic_host_addrs[i].local;
+	}
+
+	MemSet(&hint, 0, sizeof(hint));
+	hint.ai_socktype = SOCK_DGRAM;
+	hint.ai_family = AF_UNSPEC;
+	hint.ai_flags = AI_NUMERICHOST;  /* Never do name resolution */
+
+	if (pg_getaddrinfo_all(addr, NULL, &hint, &addrs) == 0)
+	{
+		for (ai = addrs; ai != NULL && !local; ai = ai->ai_next)
+		{
+			int			fd = socket(ai->ai_family, SOCK_DGRAM, 0);
+
+			if (fd < 0)
+				continue;
+
+			/* any port will do, the address is what matters */
+			local = (bind(fd, ai->ai_addr, ai->ai_addrlen) == 0);
+			closesocket(fd);
+		}
+	}
+	if (addrs)
+		pg_freeaddrinfo_all(hint.ai_family, addrs);
+
+	if (ic_num_host_addrs < IC_HOST_ADDR_CACHE_SIZE &&
+		strlen(addr) < IC_HOST_ADDR_LEN)
+	{
+		strcpy(ic_host_addrs[ic_num_host_addrs].addr, addr);
+		ic_host_addrs[ic_num_host_addrs].local = local;
+		ic_num_host_addrs++;
+	}
+
+	return local;
+}
+
+/*
+ * isLocalPeer
+ * 		Should the connection to the peer go through a shared memory ring.
+ *
+ * True if the peer listens on an address of this host.  Both ends of a
+ * connection decide this independently; a ring that only one of them wants
+ * is simply never used.
+ */
+static bool
+isLocalPeer(CdbProcess *peer)
+{
+	if (!gp_interconnect_local_shm || !ic_shm_available)
+		return false;
+
+	if (peer == NULL || peer->listenerAddr == NULL)
+		return false;
+
+	return isLocalAddress(peer->listenerAddr);
+}
+
+/*
+ * getShmRingPath
+ * 		Name the shared memory ring of a connection.
+ *
+ * Senders and receivers fill in the identifying fields of their conn_info
+ * alike, so both ends get the same name.
+ */
+static void
+getShmRingPath(char *path, icpkthdr *connInfo)
+{
+	snprintf(path, MAXPGPATH, IC_SHM_DIR "/" IC_SHM_PREFIX "%d.%u.%d.%d.%d.%d.%d",
+			 connInfo->sessionId, connInfo->icId, connInfo->motNodeId,
+			 connInfo->srcContentId, connInfo->srcPid,
+			 connInfo->dstContentId, connInfo->dstPid);
+}
+
+/*
+ * RemoveICShmRings
+ * 		Remove the shared memory rings left behind by crashed processes.
+ *
+ * A ring is removed by its receiver at teardown, or by its sender as soon
+ * as it has mapped it, but a process that crashes before either leaves it
+ * in tmpfs, where it takes up memory until reboot.  The postmaster calls
+ * this at startup and after a crash, and removes the rings of receivers
+ * that are gone.  Rings of other postmasters on the host are only removed
+ * once their receiver is gone, too.
+ */
+void
+RemoveICShmRings(void)
+{
+	DIR		   *dir;
+	struct dirent *de;
+
+	dir = AllocateDir(IC_SHM_DIR);
+	if (dir == NULL)
+		return;
+
+	while ((de = ReadDir(dir, IC_SHM_DIR)) != NULL)
+	{
+		char		path[MAXPGPATH];
+		int			dstPid;
+		int			n;
+
+		if (strncmp(de->d_name, IC_SHM_PREFIX, strlen(IC_SHM_PREFIX)) != 0)
+			continue;
+
+		/* the receiver is the last field of the name */
+		n = sscanf(de->d_name + strlen(IC_SHM_PREFIX), "%*d.%*u.%*d.%*d.%*d.%*d.%d", &dstPid);
+		if (n != 1 || dstPid <= 0)
+			continue;
+
+		if (kill(dstPid, 0) == 0 || errno != ESRCH)
+			continue;
+
+		snprintf(path, MAXPGPATH, IC_SHM_DIR "/%s", de->d_name);
+		if (unlink(path) == 0)
+			elog(LOG, "removed stale interconnect shared memory ring \"%s\"", path);
+	}
+
+	FreeDir(dir);
+}
+
+/*
+ * createShmRing
+ * 		Create the shared memory ring of an incoming connection.
+ *
+ * The ring has a slot for every entry of the packet queue of the connection.
+ * If it cannot be created, the connection just stays on UDP: the sender will
+ * not find the ring.
+ *
+ * MUST BE CALLED WITH ic_control_info.lock LOCKED.
+ */
+static void
+createShmRing(ChunkTransportStateEntry *pEntry, MotionConn *conn)
+{
+	char		path[MAXPGPATH];
+	uint32		slotSize = MAXALIGN(Gp_max_packet_size);
+	Size		size = IC_SHM_RING_SIZE(conn->pkt_q_capacity, slotSize);
+	ICShmRing  *ring;
+	int			fd;
+	int			err;
+
+	getShmRingPath(path, &conn->conn_info);
+
+	fd = open(path, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+	if (fd < 0 && errno == EEXIST)
+	{
+		/* left behind by a backend that exited without teardown */
+		unlink(path);
+		fd = open(path, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+	}
+	if (fd < 0)
+	{
+		elog(LOG, "Interconnect could not create shared memory ring \"%s\": %m", path);
+		return;
+	}
+
+	/* allocate the pages now, running out of them later would be a SIGBUS */
+	err = posix_fallocate(fd, 0, size);
+	if (err != 0)
+	{
+		close(fd);
+		unlink(path);
+		elog(LOG, "Interconnect could not allocate %lu bytes for shared memory ring \"%s\": %s",
+			 (unsigned long) size, path, strerror(err));
+		return;
+	}
+
+	ring = (ICShmRing *) mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	err = errno;
+	close(fd);
+
+	if (ring == MAP_FAILED)
+	{
+		unlink(path);
+		elog(LOG, "Interconnect could not map shared memory ring \"%s\": %s", path, strerror(err));
+		return;
+	}
+
+	/* the file starts out zeroed, which is an empty ring */
+	ring->nslots = conn->pkt_q_capacity;
+	ring->slotSize = slotSize;
+
+	conn->shmRing = ring;
+	conn->shmPulled = 0;
+	pEntry->numShmConns++;
+
+	if (gp_log_interconnect >= GPVARS_VERBOSITY_DEBUG)
+		elog(DEBUG1, "Interconnect receiving from seg%d pid %d through shared memory ring \"%s\"",
+			 conn->conn_info.srcContentId, conn->conn_info.srcPid, path);
+}
+
+/*
+ * startShmRing
+ * 		Switch an outgoing connection to a local peer to its shared memory ring.
+ *
+ * This is done once the receiver has acked the first packet, which it does
+ * only after creating the ring, and all packets sent over UDP are acked, so
+ * the ring carries on with the next sequence number.  Until then, and for
+ * good if the ring cannot be mapped, packets go over UDP.
+ */
+static bool
+startShmRing(MotionConn *conn)
+{
+	char		path[MAXPGPATH];
+	struct stat st;
+	ICShmRing  *ring;
+	int			fd;
+
+	if (conn->state != mcsStarted ||
+		icBufferListLength(&conn->sndQueue) > 0 ||
+		icBufferListLength(&conn->unackQueue) > 0)
+		return false;
+
+	/* whatever happens, try only once */
+	conn->localPeer = false;
+
+	getShmRingPath(path, &conn->conn_info);
+
+	fd = open(path, O_RDWR, 0);
+	if (fd < 0)
+		return false;
+
+	if (fstat(fd, &st) != 0 || st.st_size < IC_SHM_RING_HDR_SIZE)
+	{
+		close(fd);
+		return false;
+	}
+
+	ring = (ICShmRing *) mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (ring == MAP_FAILED)
+		return false;
+
+	if (ring->nslots == 0 || ring->slotSize < Gp_max_packet_size ||
+		IC_SHM_RING_SIZE(ring->nslots, ring->slotSize) != st.st_size)
+	{
+		munmap(ring, st.st_size);
+		return false;
+	}
+
+	conn->shmRing = ring;
+
+	/*
+	 * Both ends have the ring mapped now, and nobody else needs its name:
+	 * remove it, so that it goes away with the two mappings even if neither
+	 * end gets to tear down.
+	 */
+	unlink(path);
+
+	/* no point in compressing what is not sent */
+	conn->compress = false;
+
+	if (gp_log_interconnect >= GPVARS_VERBOSITY_DEBUG)
+		elog(DEBUG1, "Interconnect sending to seg%d pid %d through shared memory ring \"%s\"",
+			 conn->conn_info.dstContentId, conn->conn_info.dstPid, path);
+
+	return true;
+}
+
+/*
+ * detachShmRing
+ * 		Unmap the shared memory ring of a connection.
+ *
+ * The receiver also removes it, unless the sender has already done so, and
+ * tells a sender that still has it mapped to stop.
+ */
+static void
+detachShmRing(MotionConn *conn, bool remove)
+{
+	ICShmRing  *ring = conn->shmRing;
+
+	if (remove)
+	{
+		char		path[MAXPGPATH];
+
+		pg_atomic_write_u32(&ring->stopRequested, 1);
+
+		getShmRingPath(path, &conn->conn_info);
+		unlink(path);
+	}
+
+	munmap(ring, IC_SHM_RING_SIZE(ring->nslots, ring->slotSize));
+	conn->shmRing = NULL;
+}
+
+/*
+ * sendShmPacket
+ * 		Put the packet in the buffer of the connection into its shared memory ring.
+ *
+ * Waits while the ring is full, handling acks of the UDP connections in the
+ * meantime.  If the receiver asks to stop, the packet is dropped.  Returns
+ * true if there are stop requests to handle, like handleAcks().
+ */
+static bool
+sendShmPacket(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, MotionConn *conn)
+{
+	ICShmRing  *ring = conn->shmRing;
+	uint32		head = pg_atomic_read_u32(&ring->head);
+	icpkthdr   *pkt;
+	bool		gotStops = false;
+	int			retry = 0;
+
+	prepareXmit(conn);
+	pkt = (icpkthdr *) conn->pBuff;
+
+	Assert(pkt->len <= ring->slotSize);
+
+	while (head - pg_atomic_read_u32(&ring->tail) >= ring->nslots &&
+		   pg_atomic_read_u32(&ring->stopRequested) == 0)
+	{
+		/* ask the receiver for a doorbell, then look again before sleeping */
+		pg_atomic_write_u32(&ring->txSleeping, 1);
+		pg_memory_barrier();
+
+		if (head - pg_atomic_read_u32(&ring->tail) >= ring->nslots &&
+			pollAcks(transportStates, pEntry->txfd, TIMER_CHECKING_PERIOD))
+		{
+			if (handleAcks(transportStates, pEntry))
+				gotStops = true;
+		}
+
+		pg_atomic_write_u32(&ring->txSleeping, 0);
+
+		checkExceptions(transportStates, pEntry, conn, retry++, TIMER_CHECKING_PERIOD);
+	}
+
+	if (pg_atomic_read_u32(&ring->stopRequested) != 0)
+	{
+		if (!conn->stopRequested && conn->stillActive)
+		{
+			conn->stopRequested = true;
+			conn->conn_info.flags |= UDPIC_FLAGS_STOP;
+		}
+		return true;
+	}
+
+	memcpy(IC_SHM_RING_SLOT(ring, head), pkt, pkt->len);
+	pg_write_barrier();
+	pg_atomic_write_u32(&ring->head, head + 1);
+
+	/* wake up the receiver if it waits for this */
+	pg_memory_barrier();
+	if (pg_atomic_read_u32(&ring->rxSleeping) != 0 &&
+		pg_atomic_exchange_u32(&ring->rxSleeping, 0) != 0)
+		sendShmDoorbell(pEntry, conn);
+
+	conn->sentSeq = pkt->seq;
+	conn->stat_count_sent++;
+	ic_statistics.sndPktNum++;
+
+	return gotStops;
+}
+
+/*
+ * sendShmDoorbell
+ * 		Tell the rx thread of a local receiver that its ring has data.
+ */
+static void
+sendShmDoorbell(ChunkTransportStateEntry *pEntry, MotionConn *conn)
+{
+	icpkthdr	msg;
+
+	memcpy(&msg, (char *) &conn->conn_info, sizeof(msg));
+	msg.flags = UDPIC_FLAGS_SHM_DOORBELL;
+	msg.len = sizeof(msg);
+
+	sendControlMessage(&msg, pEntry->txfd, (struct sockaddr *) &conn->peer, conn->peer_len);
+}
+
+/*
+ * SendChunkUDPIFC
+ * 		is used to send a tcItem to a single destination. Tuples often are
+ * 		*very small* we aggregate in our local buffer before sending into the kernel.
+ *
+ * PARAMETERS
+ *	 conn - MotionConn that the tcItem is to be sent to.
+ *	 tcItem - message to be sent.
+ *	 motionId - Node Motion Id.
+ */
+static bool
+SendChunkUDPIFC(MotionLayerState *mlStates,
 					  ChunkTransportState *transportStates,
 					  ChunkTransportStateEntry *pEntry,
 					  MotionConn *conn,
@@ -5227,6 +6531,27 @@ SendChunkUDPIFC(MotionLayerState *mlStates,
 	ic_statistics.totalCapacity += conn->capacity;
 	ic_statistics.capacityCountingTime++;
 
+	if (conn->shmRing != NULL || (conn->localPeer && startShmRing(conn)))
+	{
+		if (sendShmPacket(transportStates, pEntry, conn))
+		{
+			handleStopMsgs(transportStates, pEntry, motionId);
+			if (!conn->stillActive)
+				return true;
+		}
+
+		/* the packet was copied into the ring, reuse the buffer */
+		conn->tupleCount = 0;
+		conn->msgSize = sizeof(conn->conn_info);
+
+		memcpy(conn->pBuff + conn->msgSize, tcItem->chunk_data, tcItem->chunk_length);
+		conn->msgSize += length;
+
+		conn->tupleCount++;
+
+		return true;
+	}
+
 	/* try to send it */
 
 	prepareXmit(conn);
@@ -5359,6 +6684,17 @@ SendEosUDPIFC(MotionLayerState *mlStates,
 			if (pEntry->sendingEos)
 				conn->conn_info.flags |= UDPIC_FLAGS_EOS;
 
+			if (conn->shmRing != NULL || (conn->localPeer && startShmRing(conn)))
+			{
+				/* nothing to wait for once it is in the ring */
+				sendShmPacket(transportStates, pEntry, conn);
+
+				conn->tupleCount = 0;
+				conn->msgSize = sizeof(conn->conn_info);
+				conn->deadlockCheckBeginTime = now;
+				continue;
+			}
+
 			prepareXmit(conn);
 
 			/* place it into the send queue */
@@ -5501,6 +6837,10 @@ doSendStopMessageUDPIFC(ChunkTransportState *transportStates, int16 motNodeID)
 				}
 #endif
 
+				/* a local sender also looks for the stop in the ring */
+				if (conn->shmRing != NULL)
+					pg_atomic_write_u32(&conn->shmRing->stopRequested, 1);
+
 				if (conn->peer.ss_family == AF_INET || conn->peer.ss_family == AF_INET6)
 				{
 					uint32 seq = conn->conn_info.seq > 0 ? conn->conn_info.seq - 1 : 0;
@@ -5520,6 +6860,111 @@ doSendStopMessageUDPIFC(ChunkTransportState *transportStates, int16 motNodeID)
 	pthread_mutex_unlock(&ic_control_info.lock);
 }
 
+/*
+ * doSendRuntimeFilterUDPIFC
+ * 		Send a runtime filter to all senders of a motion node.
+ *
+ * The filter goes to each sender once, as a control message, like a stop
+ * message.  If it is lost, that sender just doesn't filter.  A sender we
+ * haven't heard from yet gets it with the first ack we send it.
+ */
+static void
+doSendRuntimeFilterUDPIFC(ChunkTransportState *transportStates, int16 motNodeID,
+						  const uint8 *bits, int nbytes)
+{
+	ChunkTransportStateEntry	*pEntry = NULL;
+	MotionConn			*conn = NULL;
+	uint8				*copy;
+	int			i;
+
+	if (!transportStates->activated)
+		return;
+
+	if (nbytes > Gp_max_packet_size - sizeof(icpkthdr) ||
+		nbytes > RUNTIME_FILTER_MAX_BITS / 8)
+		return;
+
+	getChunkTransportState(transportStates, motNodeID, &pEntry);
+	Assert(pEntry);
+
+	/* kept for the senders we haven't heard from yet, until teardown */
+	copy = (uint8 *) palloc(nbytes);
+	memcpy(copy, bits, nbytes);
+
+	pthread_mutex_lock(&ic_control_info.lock);
+
+	for (i = 0; i < pEntry->numConns; i++)
+	{
+		conn = pEntry->conns + i;
+
+		if (conn->cdbProc == NULL || !conn->stillActive || conn->stopRequested)
+			continue;
+
+		conn->rtFilter = copy;
+		conn->rtFilterBits = nbytes * 8;
+
+		if (conn->peer.ss_family == AF_INET || conn->peer.ss_family == AF_INET6)
+			sendRuntimeFilter(conn);
+	}
+
+	pthread_mutex_unlock(&ic_control_info.lock);
+
+	if (gp_log_interconnect >= GPVARS_VERBOSITY_DEBUG)
+		elog(DEBUG1, "Interconnect sent a runtime filter of %d bytes to the senders of motion node %d",
+			 nbytes, motNodeID);
+}
+
+/*
+ * sendRuntimeFilter
+ * 		Send the runtime filter of an incoming connection to its sender.
+ */
+static void
+sendRuntimeFilter(MotionConn *conn)
+{
+	struct
+	{
+		icpkthdr	hdr;
+		uint8		bits[RUNTIME_FILTER_MAX_BITS / 8];
+	}			msg;
+	int			nbytes = conn->rtFilterBits / 8;
+
+	memcpy(&msg.hdr, &conn->conn_info, sizeof(msg.hdr));
+	msg.hdr.flags = UDPIC_FLAGS_RECEIVER_TO_SENDER | UDPIC_FLAGS_RUNTIME_FILTER;
+	msg.hdr.len = sizeof(msg.hdr) + nbytes;
+	memcpy(msg.bits, conn->rtFilter, nbytes);
+
+	sendControlMessage(&msg.hdr, UDP_listenerFd, (struct sockaddr *)&conn->peer, conn->peer_len);
+
+	conn->rtFilter = NULL;
+}
+
+/*
+ * installRuntimeFilter
+ * 		Keep the runtime filter a receiver sent, to apply it to the rows sent
+ * 		to it from now on.
+ */
+static void
+installRuntimeFilter(MotionConn *conn, icpkthdr *pkt)
+{
+	int			nbytes = pkt->len - sizeof(icpkthdr);
+
+	if (nbytes < RUNTIME_FILTER_MIN_BITS / 8 ||
+		nbytes > RUNTIME_FILTER_MAX_BITS / 8 ||
+		(nbytes & (nbytes - 1)) != 0)
+		return;
+
+	if (conn->rtFilter == NULL)
+		conn->rtFilter = MemoryContextAlloc(ic_control_info.memContext,
+											RUNTIME_FILTER_MAX_BITS / 8);
+
+	memcpy(conn->rtFilter, (uint8 *) pkt + sizeof(icpkthdr), nbytes);
+	conn->rtFilterBits = nbytes * 8;
+
+	if (gp_log_interconnect >= GPVARS_VERBOSITY_DEBUG)
+		elog(DEBUG1, "Interconnect got a runtime filter of %d bytes for route %d of motion node %d",
+			 nbytes, conn->route, pkt->motNodeId);
+}
+
 /*
  * formatSockAddr
  * 		Format sockaddr.
@@ -5972,16 +7417,26 @@ handleDataPacket(MotionConn *conn, icpkthdr *pkt, struct sockaddr_storage *peer,
 static void *
 rxThreadFunc(void *arg)
 {
-	icpkthdr *pkt = NULL;
+	icpkthdr *pkts[UDPIFC_MAX_BATCH];
+	struct sockaddr_storage peers[UDPIFC_MAX_BATCH];
+	socklen_t peerlens[UDPIFC_MAX_BATCH];
+	int		read_counts[UDPIFC_MAX_BATCH];
+	AckSendParam params[UDPIFC_MAX_BATCH];
+	int		npkts = 0;
 	bool	skip_poll = false;
 	uint32 	expected = 1;
+	int		i;
 
 	gp_set_thread_sigmasks();
 
 	for (;;)
 	{
 		struct pollfd nfd;
-		int		n;
+		int		n = 0;
+		int		batch;
+		int		nread;
+		int		nacks;
+		int		nkept;
 
 		/* check shutdown condition*/
 		expected = 1;
@@ -5994,14 +7449,21 @@ rxThreadFunc(void *arg)
 			break;
 		}
 
-		/* Try to get a buffer */
-		if (pkt == NULL)
+		/* Try to get buffers, one for each packet of a batch */
+		batch = gp_interconnect_batch_io ? UDPIFC_MAX_BATCH : 1;
+		if (npkts < batch)
 		{
 			pthread_mutex_lock(&ic_control_info.lock);
-			pkt = getRxBuffer(&rx_buffer_pool);
+			while (npkts < batch)
+			{
+				pkts[npkts] = getRxBuffer(&rx_buffer_pool);
+				if (pkts[npkts] == NULL)
+					break;
+				npkts++;
+			}
 			pthread_mutex_unlock(&ic_control_info.lock);
 
-			if (pkt == NULL)
+			if (npkts == 0)
 			{
 				setRxThreadError(ENOMEM);
 				continue;
@@ -6046,157 +7508,119 @@ rxThreadFunc(void *arg)
 				continue;
 		}
 
-		if (skip_poll || (n == 1 && (nfd.events & POLLIN)))
-		{
-			/* we've got something interesting to read */
-			/* handle incoming */
-			/* ready to read on our socket */
-			MotionConn *conn = NULL;
-			int read_count = 0;
-
-			struct sockaddr_storage peer;
-			socklen_t peerlen;
+		if (!skip_poll && !(n == 1 && (nfd.events & POLLIN)))
+			continue;
 
-			peerlen = sizeof(peer);
-			read_count = recvfrom(UDP_listenerFd, (char *)pkt, Gp_max_packet_size, 0,
-								  (struct sockaddr *)&peer, &peerlen);
+		/* we've got something interesting to read */
+		/* handle incoming */
+		/* ready to read on our socket */
+#ifdef UDPIFC_BATCH_IO
+		if (Min(npkts, batch) > 1)
+		{
+			struct mmsghdr	msgs[UDPIFC_MAX_BATCH];
+			struct iovec	iovs[UDPIFC_MAX_BATCH];
 
-			expected = 1;
-			if (pg_atomic_compare_exchange_u32((pg_atomic_uint32 *)&ic_control_info.shutdown, &expected, 0))
+			batch = Min(npkts, batch);
+			for (i = 0; i < batch; i++)
 			{
-				if (DEBUG1 >= log_min_messages)
-				{
-					write_log("udp-ic: rx-thread shutting down");
-				}
-				break;
+				iovs[i].iov_base = pkts[i];
+				iovs[i].iov_len = Gp_max_packet_size;
+
+				memset(&msgs[i], 0, sizeof(struct mmsghdr));
+				msgs[i].msg_hdr.msg_name = &peers[i];
+				msgs[i].msg_hdr.msg_namelen = sizeof(peers[i]);
+				msgs[i].msg_hdr.msg_iov = &iovs[i];
+				msgs[i].msg_hdr.msg_iovlen = 1;
 			}
 
-			if (DEBUG5 >= log_min_messages)
-				write_log("received inbound len %d", read_count);
+			nread = recvmmsg(UDP_listenerFd, msgs, batch, 0, NULL);
 
-			if (read_count < 0)
+			for (i = 0; i < nread; i++)
 			{
-				skip_poll = false;
-
-				if (errno == EWOULDBLOCK || errno == EINTR)
-					continue;
-
-				write_log("Interconnect error: recvfrom (%d)", errno);
-				/*
-				 * ERROR case: if simply break out the loop here, there will be a hung here,
-				 * since main thread will never be waken up, and senders will not
-				 * get responses anymore.
-				 *
-				 * Thus, we set an error flag, and let main thread to report an error.
-				 */
-				setRxThreadError(errno);
-				continue;
+				read_counts[i] = msgs[i].msg_len;
+				peerlens[i] = msgs[i].msg_hdr.msg_namelen;
 			}
+		}
+		else
+#endif
+		{
+			peerlens[0] = sizeof(peers[0]);
+			read_counts[0] = recvfrom(UDP_listenerFd, (char *)pkts[0], Gp_max_packet_size, 0,
+									  (struct sockaddr *)&peers[0], &peerlens[0]);
+			nread = (read_counts[0] < 0 ? -1 : 1);
+		}
 
-			if (read_count < sizeof(icpkthdr))
+		expected = 1;
+		if (pg_atomic_compare_exchange_u32((pg_atomic_uint32 *)&ic_control_info.shutdown, &expected, 0))
+		{
+			if (DEBUG1 >= log_min_messages)
 			{
-				if (DEBUG1 >= log_min_messages)
-					write_log("Interconnect error: short conn receive (%d)", read_count);
-				continue;
+				write_log("udp-ic: rx-thread shutting down");
 			}
+			break;
+		}
 
-			/* when we get a "good" recvfrom() result, we can skip poll() until we get a bad one. */
-			skip_poll = true;
-
-			/* length must be >= 0 */
-			if (pkt->len < 0)
-			{
-				if (DEBUG3 >= log_min_messages)
-					write_log("received inbound with negative length");
-				continue;
-			}
+		if (nread < 0)
+		{
+			skip_poll = false;
 
-			if (pkt->len != read_count)
-			{
-				if (DEBUG3 >= log_min_messages)
-					write_log("received inbound packet [%d], short: read %d bytes, pkt->len %d", pkt->seq, read_count, pkt->len);
+			if (errno == EWOULDBLOCK || errno == EINTR)
 				continue;
-			}
-
-			/*
-			 * check the CRC of the payload.
-			 */
-			if (gp_interconnect_full_crc)
-			{
-				if (!checkCRC(pkt))
-				{
-					pg_atomic_add_fetch_u32((pg_atomic_uint32 *)&ic_statistics.crcErrors, 1);
-					if (DEBUG2 >= log_min_messages)
-						write_log("received network data error, dropping bad packet, user data unaffected.");
-					continue;
-				}
-			}
-
-			#ifdef AMS_VERBOSE_LOGGING
-				logPkt("GOT MESSAGE", pkt);
-			#endif
-
-			AckSendParam param;
-			memset(&param, 0, sizeof(AckSendParam));
 
+			write_log("Interconnect error: recvfrom (%d)", errno);
 			/*
-			 * Get the connection for the pkt.
+			 * ERROR case: if simply break out the loop here, there will be a hung here,
+			 * since main thread will never be waken up, and senders will not
+			 * get responses anymore.
 			 *
-			 * 	The connection hash table should be locked until
-			 * 	finishing the processing of the packet to avoid
-			 *  the connection addition/removal from the hash table
-			 *  during the mean time.
+			 * Thus, we set an error flag, and let main thread to report an error.
 			 */
+			setRxThreadError(errno);
+			continue;
+		}
 
-			pthread_mutex_lock(&ic_control_info.lock);
-			conn = findConnByHeader(&ic_control_info.connHtab, pkt);
+		pg_atomic_add_fetch_u32((pg_atomic_uint32 *)&ic_statistics.rxSyscallNum, 1);
+		pg_atomic_add_fetch_u32((pg_atomic_uint32 *)&ic_statistics.rxPktNum, nread);
 
-			if (conn != NULL)
-			{
-				/* Handling a regular packet */
-				if (handleDataPacket(conn, pkt, &peer, &peerlen, &param))
-					pkt = NULL;
-				ic_statistics.recvPktNum++;
-			}
-			else
-			{
-				/*
-				 * There may have two kinds of Mismatched packets:
-				 *    a) Past packets from previous command after I was torn down
-				 *    b) Future packets from current command before my connections are built.
-				 *
-				 * The handling logic is to "Ack the past and Nak the future".
-				 */
-				if ((pkt->flags & UDPIC_FLAGS_RECEIVER_TO_SENDER) == 0)
-				{
-					if (DEBUG1 >= log_min_messages)
-						write_log("mismatched packet received, seq %d, srcpid %d, dstpid %d, icid %d, sid %d", pkt->seq, pkt->srcPid, pkt->dstPid, pkt->icId, pkt->sessionId);
+		/* when we get a "good" receive result, we can skip poll() until we get a bad one. */
+		skip_poll = true;
 
-				#ifdef AMS_VERBOSE_LOGGING
-					logPkt("Got a Mismatched Packet", pkt);
-				#endif
+		nacks = 0;
+		for (i = 0; i < nread; i++)
+		{
+			if (DEBUG5 >= log_min_messages)
+				write_log("received inbound len %d", read_counts[i]);
 
-					if (handleMismatch(pkt, &peer, peerlen))
-						pkt = NULL;
-					ic_statistics.mismatchNum++;
-				}
-			}
-			pthread_mutex_unlock(&ic_control_info.lock);
+			memset(&params[nacks], 0, sizeof(AckSendParam));
+			if (handleRxPacket(pkts[i], read_counts[i], &peers[i], peerlens[i], &params[nacks]))
+				pkts[i] = NULL;
+			if (params[nacks].msg.len != 0)
+				nacks++;
+		}
 
-			/* real ack sending is after lock release to decrease the lock holding time. */
-			if (param.msg.len != 0)
-				sendAckWithParam(&param);
+		/* real ack sending is after lock release to decrease the lock holding time. */
+		if (nacks > 0)
+			sendAcksWithParams(params, nacks);
+
+		/* keep the buffers that were not handed over */
+		nkept = 0;
+		for (i = 0; i < npkts; i++)
+		{
+			if (pkts[i] != NULL)
+				pkts[nkept++] = pkts[i];
 		}
+		npkts = nkept;
 
 		/* pthread_yield(); */
 	}
 
-	/* Before return, we release the packet. */
-	if (pkt)
+	/* Before return, we release the packets. */
+	if (npkts > 0)
 	{
 		pthread_mutex_lock(&ic_control_info.lock);
-		freeRxBuffer(&rx_buffer_pool, pkt);
-		pkt = NULL;
+		for (i = 0; i < npkts; i++)
+			freeRxBuffer(&rx_buffer_pool, pkts[i]);
+		npkts = 0;
 		pthread_mutex_unlock(&ic_control_info.lock);
 	}
 
@@ -6204,6 +7628,125 @@ rxThreadFunc(void *arg)
 	return NULL;
 }
 
+/*
+ * handleRxPacket
+ * 		Called by rx thread to handle a packet it has received.
+ *
+ * Returns true if the packet buffer has been handed over to a connection or
+ * the startup cache. If an ack is to be sent for the packet, it is set up in
+ * param.
+ *
+ * NOTE: This function MUST NOT contain elog or ereport statements.
+ */
+static bool
+handleRxPacket(icpkthdr *pkt, int read_count, struct sockaddr_storage *peer, socklen_t peerlen, AckSendParam *param)
+{
+	MotionConn *conn = NULL;
+	bool		consumed = false;
+
+	if (read_count < sizeof(icpkthdr))
+	{
+		if (DEBUG1 >= log_min_messages)
+			write_log("Interconnect error: short conn receive (%d)", read_count);
+		return false;
+	}
+
+	/* length must be >= 0 */
+	if (pkt->len < 0)
+	{
+		if (DEBUG3 >= log_min_messages)
+			write_log("received inbound with negative length");
+		return false;
+	}
+
+	if (pkt->len != read_count)
+	{
+		if (DEBUG3 >= log_min_messages)
+			write_log("received inbound packet [%d], short: read %d bytes, pkt->len %d", pkt->seq, read_count, pkt->len);
+		return false;
+	}
+
+	/*
+	 * check the CRC of the payload.
+	 */
+	if (gp_interconnect_full_crc)
+	{
+		if (!checkCRC(pkt))
+		{
+			pg_atomic_add_fetch_u32((pg_atomic_uint32 *)&ic_statistics.crcErrors, 1);
+			if (DEBUG2 >= log_min_messages)
+				write_log("received network data error, dropping bad packet, user data unaffected.");
+			return false;
+		}
+	}
+
+	#ifdef AMS_VERBOSE_LOGGING
+		logPkt("GOT MESSAGE", pkt);
+	#endif
+
+	/*
+	 * A doorbell from a sender on this host: the data is in a shared memory
+	 * ring, which only the main thread reads.
+	 */
+	if (pkt->flags & UDPIC_FLAGS_SHM_DOORBELL)
+	{
+		pthread_mutex_lock(&ic_control_info.lock);
+		if (rx_control_info.mainWaitingState.waiting &&
+				rx_control_info.mainWaitingState.waitingNode == pkt->motNodeId &&
+				rx_control_info.mainWaitingState.waitingQuery == pkt->icId)
+			pthread_cond_signal(&ic_control_info.cond);
+		pthread_mutex_unlock(&ic_control_info.lock);
+
+		return false;
+	}
+
+	/*
+	 * Get the connection for the pkt.
+	 *
+	 * 	The connection hash table should be locked until
+	 * 	finishing the processing of the packet to avoid
+	 *  the connection addition/removal from the hash table
+	 *  during the mean time.
+	 */
+
+	pthread_mutex_lock(&ic_control_info.lock);
+	conn = findConnByHeader(&ic_control_info.connHtab, pkt);
+
+	if (conn != NULL)
+	{
+		/* Handling a regular packet */
+		if (handleDataPacket(conn, pkt, peer, &peerlen, param))
+			consumed = true;
+		ic_statistics.recvPktNum++;
+	}
+	else
+	{
+		/*
+		 * There may have two kinds of Mismatched packets:
+		 *    a) Past packets from previous command after I was torn down
+		 *    b) Future packets from current command before my connections are built.
+		 *
+		 * The handling logic is to "Ack the past and Nak the future".
+		 */
+		if ((pkt->flags & UDPIC_FLAGS_RECEIVER_TO_SENDER) == 0)
+		{
+			if (DEBUG1 >= log_min_messages)
+				write_log("mismatched packet received, seq %d, srcpid %d, dstpid %d, icid %d, sid %d", pkt->seq, pkt->srcPid, pkt->dstPid, pkt->icId, pkt->sessionId);
+
+		#ifdef AMS_VERBOSE_LOGGING
+			logPkt("Got a Mismatched Packet", pkt);
+		#endif
+
+			if (handleMismatch(pkt, peer, peerlen))
+				consumed = true;
+			ic_statistics.mismatchNum++;
+		}
+	}
+	pthread_mutex_unlock(&ic_control_info.lock);
+
+	return consumed;
+}
+
 /*
  * handleMismatch
  * 		If the mismatched packet is from an old connection, we may need to
@@ -255,6 +255,38 @@ InitSerTupInfo(TupleDesc tupdesc, SerTupInfo * pSerInfo)
 		attrInfo->varlen_scratch_size = VARLEN_SCRATCH_SIZE;
 #endif
 	}
+
+	/*
+	 * Tuples made up of fixed-width attributes only can be sent in batches.
+	 * Remember where each attribute lives in such a tuple, if it has no
+	 * nulls.
+	 */
+	if (!pSerInfo->has_record_types && !tupdesc->tdhasoid)
+	{
+		int			off = 0;
+
+		pSerInfo->batch_attoff = (int *) palloc(numAttrs * sizeof(int));
+
+		for (i = 0; i < numAttrs; i++)
+		{
+			Form_pg_attribute attr = tupdesc->attrs[i];
+
+			if (attr->attlen <= 0 || attr->attisdropped)
+				break;
+
+			off = att_align_nominal(off, attr->attalign);
+			pSerInfo->batch_attoff[i] = off;
+			off += attr->attlen;
+			pSerInfo->batch_width += attr->attlen;
+		}
+
+		if (i < numAttrs)
+		{
+			pfree(pSerInfo->batch_attoff);
+			pSerInfo->batch_attoff = NULL;
+			pSerInfo->batch_width = 0;
+		}
+	}
 }
 
 
@@ -281,6 +313,15 @@ CleanupSerTupInfo(SerTupInfo * pSerInfo)
 		pfree(pSerInfo->nulls);
 	pSerInfo->nulls = NULL;
 
+	if (pSerInfo->batch_attoff != NULL)
+		pfree(pSerInfo->batch_attoff);
+	pSerInfo->batch_attoff = NULL;
+	pSerInfo->batch_width = 0;
+
+	if (pSerInfo->batch_mt_bind != NULL)
+		destroy_memtuple_binding(pSerInfo->batch_mt_bind);
+	pSerInfo->batch_mt_bind = NULL;
+
 	pSerInfo->tupdesc = NULL;
 
 	while (pSerInfo->chunkCache.items != NULL)
@@ -894,6 +935,331 @@ SerializeTupleDirect(HeapTuple tuple, SerTupInfo * pSerInfo, struct directTransp
 	return dataSize;   
 }
 
+/*
+ * Copy a fixed-width attribute value to or from a batch, where it is not
+ * necessarily aligned.
+ */
+static inline void
+storeBatchAtt(char *dest, Datum value, Form_pg_attribute attr)
+{
+	if (attr->attbyval)
+	{
+		Datum		buf;
+
+		store_att_byval(&buf, value, attr->attlen);
+		memcpy(dest, &buf, attr->attlen);
+	}
+	else
+		memcpy(dest, DatumGetPointer(value), attr->attlen);
+}
+
+static inline Datum
+fetchBatchAtt(char *src, Form_pg_attribute attr)
+{
+	Datum		buf;
+
+	if (!attr->attbyval)
+		return PointerGetDatum(src);
+
+	memcpy(&buf, src, attr->attlen);
+	return fetch_att(&buf, true, attr->attlen);
+}
+
+/* Size of the TC_BATCH chunk payload for a number of tuples */
+static inline int
+tupleBatchDataSize(SerTupInfo *pSerInfo, int ntuples, bool hasnulls)
+{
+	int			size;
+
+	size = TUPLE_BATCH_HEADER_SIZE + ntuples * pSerInfo->batch_width;
+	if (hasnulls)
+		size += pSerInfo->tupdesc->natts * BITMAPLEN(ntuples);
+
+	return TYPEALIGN(TUPLE_CHUNK_ALIGN, size);
+}
+
+/*
+ * Set up a batch of tuples to be sent in TC_BATCH chunks, holding at most
+ * maxTuples tuples.  Returns NULL if the tuples cannot be batched, because
+ * some attribute is not fixed-width or because too few of them fit in a
+ * chunk to make it worthwhile.
+ *
+ * The batch is allocated in the current memory context.
+ */
+TupleBatch *
+CreateTupleBatch(SerTupInfo *pSerInfo, int maxTuples)
+{
+	TupleBatch *batch;
+	int			capacity;
+	int			natts;
+	int			avail;
+
+	AssertArg(pSerInfo != NULL);
+
+	if (pSerInfo->batch_width <= 0)
+		return NULL;
+
+	natts = pSerInfo->tupdesc->natts;
+	avail = Gp_max_tuple_chunk_size - TUPLE_CHUNK_HEADER_SIZE;
+
+	/* Find the number of tuples that fit in a chunk, with null bitmaps. */
+	capacity = Min(maxTuples, TUPLE_BATCH_MAX_TUPLES);
+	capacity = Min(capacity, ((avail - TUPLE_BATCH_HEADER_SIZE) * 8) /
+				   (pSerInfo->batch_width * 8 + natts));
+	while (capacity > 0 && tupleBatchDataSize(pSerInfo, capacity, true) > avail)
+		capacity--;
+
+	if (capacity < 2)
+		return NULL;
+
+	if (pSerInfo->batch_mt_bind == NULL)
+		pSerInfo->batch_mt_bind = create_memtuple_binding(pSerInfo->tupdesc);
+
+	batch = (TupleBatch *) palloc(sizeof(TupleBatch));
+	batch->ntuples = 0;
+	batch->capacity = capacity;
+	batch->hasnulls = false;
+	batch->values = (char *) palloc(capacity * pSerInfo->batch_width);
+	batch->nulls = (bits8 *) palloc0(natts * BITMAPLEN(capacity));
+
+	return batch;
+}
+
+/*
+ * Add a tuple to a batch, which must not be full yet.  The values of each
+ * attribute go into their own column.
+ */
+void
+AddTupleToBatch(HeapTuple tuple, SerTupInfo *pSerInfo, TupleBatch *batch)
+{
+	TupleDesc	tupdesc = pSerInfo->tupdesc;
+	int			natts = tupdesc->natts;
+	int			row = batch->ntuples;
+	char	   *col = batch->values;
+	int			i;
+
+	AssertArg(batch->ntuples < batch->capacity);
+
+	if (!is_heaptuple_memtuple(tuple) && !HeapTupleHasNulls(tuple) &&
+		HeapTupleHeaderGetNatts(tuple->t_data) == natts)
+	{
+		/* Easy case: copy the values straight out of the tuple. */
+		char	   *tupdata = (char *) tuple->t_data + tuple->t_data->t_hoff;
+
+		for (i = 0; i < natts; i++)
+		{
+			int			attlen = tupdesc->attrs[i]->attlen;
+
+			memcpy(col + row * attlen, tupdata + pSerInfo->batch_attoff[i], attlen);
+			col += batch->capacity * attlen;
+		}
+	}
+	else
+	{
+		if (is_heaptuple_memtuple(tuple))
+			memtuple_deform((MemTuple) tuple, pSerInfo->batch_mt_bind,
+							pSerInfo->values, pSerInfo->nulls);
+		else
+			heap_deform_tuple(tuple, tupdesc, pSerInfo->values, pSerInfo->nulls);
+
+		for (i = 0; i < natts; i++)
+		{
+			Form_pg_attribute attr = tupdesc->attrs[i];
+
+			if (pSerInfo->nulls[i])
+			{
+				bits8	   *bitmap = batch->nulls + i * BITMAPLEN(batch->capacity);
+
+				bitmap[row >> 3] |= (1 << (row & 7));
+				memset(col + row * attr->attlen, 0, attr->attlen);
+				batch->hasnulls = true;
+			}
+			else
+				storeBatchAtt(col + row * attr->attlen, pSerInfo->values[i], attr);
+
+			col += batch->capacity * attr->attlen;
+		}
+	}
+
+	batch->ntuples++;
+}
+
+/*
+ * Size of the TC_BATCH chunk for a batch, including the chunk header.
+ */
+int
+TupleBatchChunkSize(SerTupInfo *pSerInfo, TupleBatch *batch)
+{
+	return TUPLE_CHUNK_HEADER_SIZE +
+		tupleBatchDataSize(pSerInfo, batch->ntuples, batch->hasnulls);
+}
+
+/*
+ * Write a batch out as a TC_BATCH chunk at dest, which must have room for
+ * TupleBatchChunkSize() bytes, and empty the batch.  Returns the size of the
+ * chunk.
+ */
+int
+SerializeTupleBatch(SerTupInfo *pSerInfo, TupleBatch *batch, char *dest)
+{
+	TupleDesc	tupdesc = pSerInfo->tupdesc;
+	int			natts = tupdesc->natts;
+	int			size = TupleBatchChunkSize(pSerInfo, batch);
+	uint16		hdr[2];
+	char	   *pos;
+	char	   *col;
+	int			i;
+
+	AssertArg(batch->ntuples > 0);
+
+	SetChunkType(dest, TC_BATCH);
+	SetChunkDataSize(dest, size - TUPLE_CHUNK_HEADER_SIZE);
+	pos = dest + TUPLE_CHUNK_HEADER_SIZE;
+
+	hdr[0] = batch->ntuples;
+	hdr[1] = batch->hasnulls ? 1 : 0;
+	memcpy(pos, hdr, TUPLE_BATCH_HEADER_SIZE);
+	pos += TUPLE_BATCH_HEADER_SIZE;
+
+	if (batch->hasnulls)
+	{
+		for (i = 0; i < natts; i++)
+		{
+			memcpy(pos, batch->nulls + i * BITMAPLEN(batch->capacity),
+				   BITMAPLEN(batch->ntuples));
+			pos += BITMAPLEN(batch->ntuples);
+		}
+		memset(batch->nulls, 0, natts * BITMAPLEN(batch->capacity));
+	}
+
+	col = batch->values;
+	for (i = 0; i < natts; i++)
+	{
+		int			attlen = tupdesc->attrs[i]->attlen;
+
+		memcpy(pos, col, batch->ntuples * attlen);
+		pos += batch->ntuples * attlen;
+		col += batch->capacity * attlen;
+	}
+
+	memset(pos, 0, dest + size - pos);
+
+	batch->ntuples = 0;
+	batch->hasnulls = false;
+
+	return size;
+}
+
+/*
+ * Convert a TC_BATCH chunk into HeapTuples.  Returns a palloc'd array of
+ * *ntuples tuples.
+ *
+ * All tuples without nulls have the same layout, so only the first one is
+ * formed with heap_form_tuple(); the others are copied from it, with their
+ * attribute values patched in.
+ */
+HeapTuple *
+DeserializeTupleBatch(SerTupInfo *pSerInfo, TupleChunkListItem tcItem, int *ntuples)
+{
+	TupleDesc	tupdesc = pSerInfo->tupdesc;
+	int			natts = tupdesc->natts;
+	char	   *data = GetChunkDataPtr(tcItem) + TUPLE_CHUNK_HEADER_SIZE;
+	HeapTuple  *tuples;
+	HeapTuple	template = NULL;
+	uint16		hdr[2];
+	bool		hasnulls;
+	bits8	   *nulls;
+	char	   *cols;
+	int			n;
+	int			row;
+	int			i;
+
+	if (pSerInfo->batch_width <= 0)
+		ereport(ERROR, (errcode(ERRCODE_PROTOCOL_VIOLATION),
+						errmsg("received TC_BATCH chunk for tuples that cannot be batched")));
+
+	memcpy(hdr, data, TUPLE_BATCH_HEADER_SIZE);
+	n = hdr[0];
+	hasnulls = (hdr[1] != 0);
+
+	if (n <= 0 || n > TUPLE_BATCH_MAX_TUPLES ||
+		tcItem->chunk_length != TUPLE_CHUNK_HEADER_SIZE + tupleBatchDataSize(pSerInfo, n, hasnulls))
+		ereport(ERROR, (errcode(ERRCODE_PROTOCOL_VIOLATION),
+						errmsg("malformed TC_BATCH chunk of %d tuples (len %d)",
+							   n, tcItem->chunk_length)));
+
+	nulls = (bits8 *) (data + TUPLE_BATCH_HEADER_SIZE);
+	cols = (char *) nulls + (hasnulls ? natts * BITMAPLEN(n) : 0);
+
+	tuples = (HeapTuple *) palloc(n * sizeof(HeapTuple));
+
+	for (row = 0; row < n; row++)
+	{
+		bool		rowhasnulls = false;
+		char	   *col;
+
+		if (hasnulls)
+		{
+			for (i = 0; i < natts; i++)
+			{
+				bits8	   *bitmap = nulls + i * BITMAPLEN(n);
+
+				if (bitmap[row >> 3] & (1 << (row & 7)))
+				{
+					rowhasnulls = true;
+					break;
+				}
+			}
+		}
+
+		if (template != NULL && !rowhasnulls)
+		{
+			HeapTuple	htup;
+			char	   *tupdata;
+
+			htup = (HeapTuple) palloc(HEAPTUPLESIZE + template->t_len);
+			memcpy(htup, template, HEAPTUPLESIZE + template->t_len);
+			htup->t_data = (HeapTupleHeader) ((char *) htup + HEAPTUPLESIZE);
+
+			tupdata = (char *) htup->t_data + htup->t_data->t_hoff;
+			col = cols;
+			for (i = 0; i < natts; i++)
+			{
+				int			attlen = tupdesc->attrs[i]->attlen;
+
+				memcpy(tupdata + pSerInfo->batch_attoff[i], col + row * attlen, attlen);
+				col += n * attlen;
+			}
+
+			tuples[row] = htup;
+			continue;
+		}
+
+		col = cols;
+		for (i = 0; i < natts; i++)
+		{
+			Form_pg_attribute attr = tupdesc->attrs[i];
+			bits8	   *bitmap = nulls + i * BITMAPLEN(n);
+
+			pSerInfo->nulls[i] = hasnulls && (bitmap[row >> 3] & (1 << (row & 7))) != 0;
+			if (pSerInfo->nulls[i])
+				pSerInfo->values[i] = (Datum) 0;
+			else
+				pSerInfo->values[i] = fetchBatchAtt(col + row * attr->attlen, attr);
+
+			col += n * attr->attlen;
+		}
+
+		tuples[row] = heap_form_tuple(tupdesc, pSerInfo->values, pSerInfo->nulls);
+
+		if (!rowhasnulls)
+			template = tuples[row];
+	}
+
+	*ntuples = n;
+	return tuples;
+}
+
 /*
  * Deserialize a HeapTuple's data from a byte-array.
  *
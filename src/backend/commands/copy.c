@@ -48,6 +48,7 @@
 #include "tcop/utility.h"
 #include "utils/acl.h"
 #include "utils/builtins.h"
+#include "utils/datum.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "utils/resscheduler.h"
@@ -120,6 +121,17 @@ static void CopyInitPartitioningState(EState *estate);
 static void CopyInitDataParser(CopyState cstate);
 static bool CopyCheckIsLastLine(CopyState cstate);
 static char *extract_line_buf(CopyState cstate);
+static void CopyFromFlushAOCSBatch(ResultRelInfo *resultRelInfo,
+								   MemoryContext batchContext,
+								   Datum **values, bool **nulls, int *nrows);
+
+/*
+ * COPY into a column-oriented table without indexes, triggers or partitions
+ * buffers up to this many rows (or about this many bytes of by-reference
+ * values) and hands them to the storage layer column by column.
+ */
+#define COPY_AOCS_BATCH_ROWS	1000
+#define COPY_AOCS_BATCH_BYTES	(1024 * 1024)
 uint64
 DoCopyInternal(const CopyStmt *stmt, const char *queryString, CopyState cstate);
 
@@ -4344,6 +4356,11 @@ CopyFrom(CopyState cstate)
 	bool		cur_row_rejected = false;
 	int			original_lineno_for_qe = 0; /* keep compiler happy (var referenced by macro) */
 	CdbCopy    *cdbCopy = NULL; /* never used... for compiling COPY_HANDLE_ERROR */
+	MemoryContext aocsBatchContext = NULL;	/* NULL if rows are not batched */
+	Datum	  **aocsBatchValues = NULL;
+	bool	  **aocsBatchNulls = NULL;
+	int			aocsBatchRows = 0;
+	Size		aocsBatchBytes = 0;
 	tupDesc = RelationGetDescr(cstate->rel);
 	attr = tupDesc->attrs;
 	num_phys_attrs = tupDesc->natts;
@@ -4415,6 +4432,29 @@ CopyFrom(CopyState cstate)
 	/* Set up a tuple slot too */
 	baseSlot = MakeSingleTupleTableSlot(tupDesc);
 
+	/*
+	 * Rows for a column-oriented table are buffered and inserted column by
+	 * column, unless something needs to see each row as it is stored.
+	 */
+	if (RelationIsAoCols(cstate->rel) &&
+		resultRelInfo->ri_NumIndices == 0 &&
+		resultRelInfo->ri_TrigDesc == NULL &&
+		estate->es_result_partitions == NULL)
+	{
+		aocsBatchContext = AllocSetContextCreate(estate->es_query_cxt,
+												 "COPY AOCS batch",
+												 ALLOCSET_DEFAULT_MINSIZE,
+												 ALLOCSET_DEFAULT_INITSIZE,
+												 ALLOCSET_DEFAULT_MAXSIZE);
+		aocsBatchValues = (Datum **) palloc(num_phys_attrs * sizeof(Datum *));
+		aocsBatchNulls = (bool **) palloc(num_phys_attrs * sizeof(bool *));
+		for (i = 0; i < num_phys_attrs; i++)
+		{
+			aocsBatchValues[i] = (Datum *) palloc(COPY_AOCS_BATCH_ROWS * sizeof(Datum));
+			aocsBatchNulls[i] = (bool *) palloc(COPY_AOCS_BATCH_ROWS * sizeof(bool));
+		}
+	}
+
 	econtext = GetPerTupleExprContext(estate);
 
 	/*
@@ -5023,6 +5063,39 @@ PROCESS_SEGMENT_DATA:
 						if (resultRelInfo->ri_NumIndices > 0)
 							ExecInsertIndexTuples(slot, (ItemPointer)&aoTupleId, estate, false);
 					}
+					else if (relstorage == RELSTORAGE_AOCOLS &&
+							 aocsBatchContext != NULL)
+					{
+						MemoryContext batcholdcontext;
+
+						/* copy the row out of the per-tuple context */
+						batcholdcontext = MemoryContextSwitchTo(aocsBatchContext);
+						for (i = 0; i < num_phys_attrs; i++)
+						{
+							aocsBatchNulls[i][aocsBatchRows] = nulls[i];
+							if (nulls[i])
+								aocsBatchValues[i][aocsBatchRows] = (Datum) 0;
+							else
+							{
+								aocsBatchValues[i][aocsBatchRows] =
+									datumCopy(values[i], attr[i]->attbyval, attr[i]->attlen);
+								if (!attr[i]->attbyval)
+									aocsBatchBytes += datumGetSize(values[i],
+																   attr[i]->attbyval,
+																   attr[i]->attlen);
+							}
+						}
+						MemoryContextSwitchTo(batcholdcontext);
+
+						if (++aocsBatchRows == COPY_AOCS_BATCH_ROWS ||
+							aocsBatchBytes >= COPY_AOCS_BATCH_BYTES)
+						{
+							CopyFromFlushAOCSBatch(resultRelInfo, aocsBatchContext,
+												   aocsBatchValues, aocsBatchNulls,
+												   &aocsBatchRows);
+							aocsBatchBytes = 0;
+						}
+					}
 					else if (relstorage == RELSTORAGE_AOCOLS)
 					{
 						AOTupleId aoTupleId;
@@ -5107,6 +5180,11 @@ PROCESS_SEGMENT_DATA:
 		goto PROCESS_SEGMENT_DATA;
 	}
 
+	/* Store what is left in the AOCS batch */
+	if (aocsBatchRows > 0)
+		CopyFromFlushAOCSBatch(estate->es_result_relations, aocsBatchContext,
+							   aocsBatchValues, aocsBatchNulls, &aocsBatchRows);
+
 	elog(DEBUG1, "Segment %u, Copied %lu rows.", GpIdentity.segindex, cstate->processed);
 
 	/* Done, clean up */
@@ -5173,6 +5251,24 @@ PROCESS_SEGMENT_DATA:
 	FreeExecutorState(estate);
 }
 
+/*
+ * Inserts the rows buffered by CopyFrom into a column-oriented table and
+ * empties the buffer.
+ */
+static void
+CopyFromFlushAOCSBatch(ResultRelInfo *resultRelInfo,
+					   MemoryContext batchContext,
+					   Datum **values, bool **nulls, int *nrows)
+{
+	Assert(resultRelInfo->ri_aocsInsertDesc != NULL);
+
+	aocs_insert_values_batch(resultRelInfo->ri_aocsInsertDesc, *nrows,
+							 values, nulls, NULL);
+
+	MemoryContextReset(batchContext);
+	*nrows = 0;
+}
+
 /*
  * Finds the next TEXT line that is in the input buffer and loads
  * it into line_buf. Returns an indication if the line that was read
@@ -50,6 +50,8 @@
 #include "miscadmin.h"
 
 #ifdef USE_ORCA
+#include "gpopt/utils/optstats.h"
+
 extern char *SzDXLPlan(Query *parse);
 extern const char *OptVersion();
 #endif
@@ -285,14 +287,138 @@ ExplainOneQuery(Query *query, ExplainStmt *stmt, const char *queryString,
 	else
 	{
 		PlannedStmt *plan;
+#ifdef USE_ORCA
+		OptimizerStats optstats;
+
+		/* have the optimizer record per-phase statistics, if requested */
+		if (stmt->optimizer_stats)
+		{
+			memset(&optstats, 0, sizeof(optstats));
+			optimizer_stats_collector = &optstats;
+		}
+
+		PG_TRY();
+		{
+			/* plan the query */
+			plan = planner(query, 0, params);
+		}
+		PG_CATCH();
+		{
+			optimizer_stats_collector = NULL;
+			PG_RE_THROW();
+		}
+		PG_END_TRY();
 
+		optimizer_stats_collector = NULL;
+#else
 		/* plan the query */
 		plan = planner(query, 0, params);
+#endif
 
 		/* run it (if needed) and produce output */
 		ExplainOnePlan(plan, params, stmt, queryString, tstate);
+
+#ifdef USE_ORCA
+		if (stmt->optimizer_stats)
+			ExplainOptimizerStats(&optstats, plan, tstate);
+#endif
+	}
+}
+
+#ifdef USE_ORCA
+/*
+ * ExplainOptimizerStats -
+ *	  print time and peak memory spent in each phase of ORCA, the metadata
+ *	  it had to fetch from the relcache, and the statistics it logged for
+ *	  each search stage
+ *
+ * This is exported because it's called back from prepare.c in the
+ * EXPLAIN EXECUTE case
+ */
+void
+ExplainOptimizerStats(OptimizerStats *optstats, PlannedStmt *plan,
+					  TupOutputState *tstate)
+{
+	static const char *const phase_names[OPTSTATS_NUM_PHASES] = {
+		"Query-to-DXL translation",
+		"Optimization",
+		"DXL-to-PlStmt translation"
+	};
+	static const char *const md_kind_names[OPTSTATS_NUM_MD_KINDS] = {
+		"objects",
+		"relation stats",
+		"column stats",
+		"casts",
+		"comparisons"
+	};
+	StringInfoData buf;
+	uint64		total_fetches = 0;
+	int			i;
+
+	if (plan->planGen != PLANGEN_OPTIMIZER)
+	{
+		do_text_output_oneline(tstate, "Optimizer statistics: not available, query was planned by the legacy query optimizer");
+		return;
+	}
+	if (optstats->optimizations == 0)
+	{
+		do_text_output_oneline(tstate, "Optimizer statistics: not available, the cached plan was reused");
+		return;
+	}
+
+	initStringInfo(&buf);
+
+	appendStringInfo(&buf, "Optimizer statistics:\n");
+	for (i = 0; i < OPTSTATS_NUM_PHASES; i++)
+	{
+		appendStringInfo(&buf, "  %s: %.3f ms, peak memory " UINT64_FORMAT "kB",
+						 phase_names[i],
+						 optstats->phase_time[i],
+						 (optstats->phase_peak_memory[i] + 1023) / 1024);
+		if (i == OPTSTATS_PHASE_OPTIMIZE)
+			appendStringInfo(&buf, ", %d search stage%s",
+							 optstats->search_stages,
+							 optstats->search_stages == 1 ? "" : "s");
+		appendStringInfoChar(&buf, '\n');
+	}
+
+	for (i = 0; i < OPTSTATS_NUM_MD_KINDS; i++)
+		total_fetches += optstats->md_fetches[i];
+
+	appendStringInfo(&buf, "  Metadata fetched from relcache: " UINT64_FORMAT "\n",
+					 total_fetches);
+	for (i = 0; i < OPTSTATS_NUM_MD_KINDS; i++)
+	{
+		if (optstats->md_fetches[i] == 0)
+			continue;
+
+		appendStringInfo(&buf, "    %s: " UINT64_FORMAT ", %.3f ms\n",
+						 md_kind_names[i],
+						 optstats->md_fetches[i],
+						 optstats->md_fetch_time[i]);
+	}
+
+	/* the optimizer's own report of each search stage, indented */
+	if (optstats->search_log != NULL)
+	{
+		char	   *line = optstats->search_log;
+
+		appendStringInfo(&buf, "  Search statistics:\n");
+		while (*line != '\0')
+		{
+			char	   *eol = strchr(line, '\n');
+			int			len = eol ? eol - line : strlen(line);
+
+			if (len > 0)
+				appendStringInfo(&buf, "    %.*s\n", len, line);
+			line += eol ? len + 1 : len;
+		}
 	}
+
+	do_text_output_multiline(tstate, buf.data);
+	pfree(buf.data);
 }
+#endif
 
 /*
  * ExplainOneUtility -
@@ -1701,6 +1827,18 @@ explain_outNode(StringInfo str,
 							"Merge Key",
 							str, indent, es);
 
+				if (pMotion->skewAction != MOTIONSKEW_NONE)
+				{
+					int			i;
+
+					for (i = 0; i < indent; i++)
+						appendStringInfoString(str, "  ");
+					appendStringInfo(str, "  Skewed Keys: %d (%s)\n",
+									 list_length(pMotion->skewValues),
+									 pMotion->skewAction == MOTIONSKEW_SPREAD ?
+									 "spread" : "broadcast");
+				}
+
                 /* Descending into a new slice. */
                 if (sliceTable)
                     es->currentSlice = (Slice *)list_nth(sliceTable->slices,
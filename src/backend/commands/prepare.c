@@ -35,6 +35,10 @@
 #include "utils/builtins.h"
 #include "utils/memutils.h"
 
+#ifdef USE_ORCA
+#include "gpopt/utils/optstats.h"
+#endif
+
 extern char *savedSeqServerHost;
 extern int savedSeqServerPort;
 
@@ -676,6 +680,9 @@ ExplainExecuteQuery(ExecuteStmt *execstmt, ExplainStmt *stmt,
 	ListCell   *p;
 	ParamListInfo paramLI = NULL;
 	EState	   *estate = NULL;
+#ifdef USE_ORCA
+	OptimizerStats optstats;
+#endif
 
 	/* Look it up in the hash table */
 	entry = FetchPreparedStatement(execstmt->name, true);
@@ -700,9 +707,33 @@ ExplainExecuteQuery(ExecuteStmt *execstmt, ExplainStmt *stmt,
 								 queryString, estate);
 	}
 
+#ifdef USE_ORCA
+	/* have the optimizer record per-phase statistics, if it is run at all */
+	if (stmt->optimizer_stats)
+	{
+		memset(&optstats, 0, sizeof(optstats));
+		optimizer_stats_collector = &optstats;
+	}
+
+	PG_TRY();
+	{
+		/* Replan if needed, and acquire a transient refcount */
+		cplan = RevalidateCachedPlanWithParams(entry->plansource, true,
+											   paramLI, execstmt->into);
+	}
+	PG_CATCH();
+	{
+		optimizer_stats_collector = NULL;
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+
+	optimizer_stats_collector = NULL;
+#else
 	/* Replan if needed, and acquire a transient refcount */
 	cplan = RevalidateCachedPlanWithParams(entry->plansource, true,
 										   paramLI, execstmt->into);
+#endif
 
 	plan_list = cplan->stmt_list;
 
@@ -731,6 +762,11 @@ ExplainExecuteQuery(ExecuteStmt *execstmt, ExplainStmt *stmt,
 			}
 
 			ExplainOnePlan(pstmt, paramLI, stmt, queryString, tstate);
+
+#ifdef USE_ORCA
+			if (stmt->optimizer_stats)
+				ExplainOptimizerStats(&optstats, pstmt, tstate);
+#endif
 		}
 		else
 		{
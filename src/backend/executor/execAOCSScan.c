@@ -6,16 +6,38 @@
  */
 #include "postgres.h"
 
+#include "access/appendonly_zonemap.h"
 #include "executor/executor.h"
+#include "executor/instrument.h"
+#include "miscadmin.h"
 #include "nodes/execnodes.h"
+#include "optimizer/clauses.h"
 #include "cdb/cdbaocsam.h"
+#include "utils/guc.h"
+
+/*
+ * Move the count of the blocks the zone filter skipped to the node's
+ * instrumentation.
+ */
+static void
+CollectAOCSZoneStats(AOCSScanState *node)
+{
+	AppendOnlyZoneFilter *filter = node->opaque->scandesc->zoneFilter;
+
+	if (filter == NULL || filter->blocksSkipped == 0)
+		return;
+
+	if (node->ss.ps.instrument)
+		node->ss.ps.instrument->zoneBlocksSkipped += filter->blocksSkipped;
+	filter->blocksSkipped = 0;
+}
 
 static void
 InitAOCSScanOpaque(ScanState *scanState)
 {
 	AOCSScanState *state = (AOCSScanState *)scanState;
 	Assert(state->opaque == NULL);
-	state->opaque = palloc(sizeof(AOCSScanOpaqueData));
+	state->opaque = palloc0(sizeof(AOCSScanOpaqueData));
 
 	/* Initialize AOCS projection info */
 	AOCSScanOpaqueData *opaque = (AOCSScanOpaqueData *)state->opaque;
@@ -46,6 +68,113 @@ InitAOCSScanOpaque(ScanState *scanState)
 	}
 }
 
+/*
+ * Find the projected columns that the qual of the scan does not reference,
+ * which need to be read only for the rows satisfying the qual.
+ *
+ * Returns NULL if there are none, or if the qual references no column.
+ */
+static bool *
+GetLateColumns(AOCSScanState *node)
+{
+	AOCSScanOpaqueData *opaque = node->opaque;
+	List *qual = node->ss.ps.plan->qual;
+	bool *qualCols;
+	bool *lateCols;
+	bool anyQualCol = false;
+	bool anyLateCol = false;
+	int i;
+
+	if (!gp_aocs_late_materialization || qual == NIL)
+		return NULL;
+
+	qualCols = palloc0(sizeof(bool) * opaque->ncol);
+	GetNeededColumnsForScan((Node *)qual, qualCols, opaque->ncol);
+
+	lateCols = palloc0(sizeof(bool) * opaque->ncol);
+	for (i = 0; i < opaque->ncol; i++)
+	{
+		if (qualCols[i])
+			anyQualCol = true;
+		else if (opaque->proj[i])
+		{
+			lateCols[i] = true;
+			anyLateCol = true;
+		}
+	}
+	pfree(qualCols);
+
+	if (!anyQualCol || !anyLateCol)
+	{
+		pfree(lateCols);
+		return NULL;
+	}
+
+	return lateCols;
+}
+
+/*
+ * Hand the "column = constant" clauses of the qual that the scan can check
+ * on dictionary codes to the scan.
+ *
+ * Returns the state of the rest of the qual.
+ */
+static List *
+PushEqualityFilters(AOCSScanState *node)
+{
+	List *planQual = node->ss.ps.plan->qual;
+	List *qual = node->ss.ss_accessQual;
+	List *rest = NIL;
+	ListCell *lc1;
+	ListCell *lc2;
+
+	if (list_length(planQual) != list_length(qual))
+		return qual;
+
+	forboth(lc1, planQual, lc2, qual)
+	{
+		if (!aocs_add_equality_filter(node->opaque->scandesc,
+									  (Node *) lfirst(lc1),
+									  ((Scan *) node->ss.ps.plan)->scanrelid))
+			rest = lappend(rest, lfirst(lc2));
+	}
+
+	if (node->opaque->scandesc->numEqFilters == 0)
+	{
+		list_free(rest);
+		return qual;
+	}
+
+	return rest;
+}
+
+/*
+ * Check the qual of the scan on the rows of a new batch, and keep only the
+ * rows that satisfy it, so that the columns the qual does not reference are
+ * read for those rows only.
+ */
+static void
+FilterAOCSBatch(AOCSScanState *node)
+{
+	AOCSScanDesc scandesc = node->opaque->scandesc;
+	AOCSBatch batch = node->opaque->batch;
+	ExprContext *econtext = node->ss.ps.ps_ExprContext;
+	TupleTableSlot *slot = node->ss.ss_ScanTupleSlot;
+	int nkeep = 0;
+
+	econtext->ecxt_scantuple = slot;
+	while (aocs_batch_next(scandesc, batch, slot))
+	{
+		ResetExprContext(econtext);
+		if (ExecQual(node->opaque->qual, econtext, false))
+			batch->sel[nkeep++] = batch->current;
+	}
+	ResetExprContext(econtext);
+
+	batch->nsel = nkeep;
+	batch->next = 0;
+}
+
 static void
 FreeAOCSScanOpaque(ScanState *scanState)
 {
@@ -68,8 +197,62 @@ AOCSScanNext(ScanState *scanState)
 	Assert(node->opaque != NULL &&
 		   node->opaque->scandesc != NULL);
 
-	aocs_getnext(node->opaque->scandesc, node->ss.ps.state->es_direction, node->ss.ss_ScanTupleSlot);
-	return node->ss.ss_ScanTupleSlot;
+	AOCSScanDesc scandesc = node->opaque->scandesc;
+	AOCSBatch batch = node->opaque->batch;
+	List *qual = node->opaque->qual;
+	ExprContext *econtext = node->ss.ps.ps_ExprContext;
+	TupleTableSlot *slot = node->ss.ss_ScanTupleSlot;
+
+	/*
+	 * The scan checks its qual itself (see ExecAssignScanQual), and returns
+	 * only the rows that satisfy it.
+	 */
+	if (batch != NULL)
+	{
+		for (;;)
+		{
+			while (!aocs_batch_next(scandesc, batch, slot))
+			{
+				bool found;
+
+				CHECK_FOR_INTERRUPTS();
+
+				found = aocs_getnextbatch(scandesc, batch);
+				CollectAOCSZoneStats(node);
+				if (!found)
+					return ExecClearTuple(slot);
+
+				if (qual != NIL && !node->opaque->qualPerRow)
+					FilterAOCSBatch(node);
+			}
+
+			aocs_batch_materialize(scandesc, batch, slot);
+
+			if (qual == NIL || !node->opaque->qualPerRow)
+				return slot;
+
+			econtext->ecxt_scantuple = slot;
+			ResetExprContext(econtext);
+			if (ExecQual(qual, econtext, false))
+				return slot;
+		}
+	}
+
+	for (;;)
+	{
+		aocs_getnext(scandesc, node->ss.ps.state->es_direction, slot);
+		CollectAOCSZoneStats(node);
+
+		if (TupIsNull(slot) || qual == NIL)
+			return slot;
+
+		econtext->ecxt_scantuple = slot;
+		ResetExprContext(econtext);
+		if (ExecQual(qual, econtext, false))
+			return slot;
+
+		CHECK_FOR_INTERRUPTS();
+	}
 }
 
 void
@@ -102,6 +285,38 @@ BeginScanAOCSRelation(ScanState *scanState)
 					   NULL /* relationTupleDesc */,
 					   node->opaque->proj);
 
+	node->opaque->scandesc->zoneFilter =
+		AppendOnlyZoneFilter_Create(node->ss.ss_currentRelation,
+									scanState->ps.plan->qual,
+									((Scan *) scanState->ps.plan)->scanrelid);
+
+	node->opaque->qual = node->ss.ss_accessQual;
+	node->opaque->qualPerRow =
+		contain_volatile_functions((Node *) scanState->ps.plan->qual);
+
+	/*
+	 * Decode the projected columns a batch of rows at a time, unless asked
+	 * not to.  A volatile qual is still checked one row at a time, in the
+	 * order the rows are returned, and so no clause of it is pushed down and
+	 * no column is read late.
+	 */
+	if (gp_aocs_scan_batch_size > 0 &&
+		node->opaque->scandesc->num_proj_atts > 0)
+	{
+		bool *lateCols = NULL;
+
+		if (!node->opaque->qualPerRow)
+		{
+			node->opaque->qual = PushEqualityFilters(node);
+			lateCols = GetLateColumns(node);
+		}
+		node->opaque->batch = aocs_create_batch(node->opaque->scandesc,
+												gp_aocs_scan_batch_size,
+												lateCols);
+		if (lateCols != NULL)
+			pfree(lateCols);
+	}
+
 	node->ss.scan_state = SCAN_SCAN;
 }
  
@@ -116,6 +331,23 @@ EndScanAOCSRelation(ScanState *scanState)
 	Assert(node->opaque != NULL &&
 		   node->opaque->scandesc != NULL);
 
+	if (node->opaque->scandesc->zoneFilter != NULL)
+	{
+		CollectAOCSZoneStats(node);
+		AppendOnlyZoneFilter_Free(node->opaque->scandesc->zoneFilter);
+		node->opaque->scandesc->zoneFilter = NULL;
+	}
+
+	if (node->opaque->batch != NULL)
+	{
+		aocs_destroy_batch(node->opaque->scandesc, node->opaque->batch);
+		node->opaque->batch = NULL;
+	}
+
+	if (node->opaque->qual != node->ss.ss_accessQual)
+		list_free(node->opaque->qual);
+	node->opaque->qual = NIL;
+
 	aocs_endscan(node->opaque->scandesc);
         
 	FreeAOCSScanOpaque(scanState);
@@ -133,4 +365,10 @@ ReScanAOCSRelation(ScanState *scanState)
 		   node->opaque->scandesc != NULL);
 
 	aocs_rescan(node->opaque->scandesc); 
+
+	if (node->opaque->batch != NULL)
+	{
+		node->opaque->batch->nsel = 0;
+		node->opaque->batch->next = 0;
+	}
 }
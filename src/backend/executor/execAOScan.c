@@ -6,10 +6,29 @@
  */
 #include "postgres.h"
 
+#include "access/appendonly_zonemap.h"
 #include "executor/executor.h"
+#include "executor/instrument.h"
 #include "nodes/execnodes.h"
 #include "cdb/cdbappendonlyam.h"
 
+/*
+ * Move the count of the blocks the zone filter skipped to the node's
+ * instrumentation.
+ */
+static void
+CollectAppendOnlyZoneStats(AppendOnlyScanState *node)
+{
+	AppendOnlyZoneFilter *filter = node->aos_ScanDesc->zoneFilter;
+
+	if (filter == NULL || filter->blocksSkipped == 0)
+		return;
+
+	if (node->ss.ps.instrument)
+		node->ss.ps.instrument->zoneBlocksSkipped += filter->blocksSkipped;
+	filter->blocksSkipped = 0;
+}
+
 TupleTableSlot *
 AppendOnlyScanNext(ScanState *scanState)
 {
@@ -35,6 +54,7 @@ AppendOnlyScanNext(ScanState *scanState)
 	 * put the next tuple from the access methods in our tuple slot
 	 */
 	appendonly_getnext(scandesc, direction, slot);
+	CollectAppendOnlyZoneStats(node);
 
 	return slot;
 }
@@ -67,6 +87,10 @@ BeginScanAppendOnlyRelation(ScanState *scanState)
 			node->ss.ps.state->es_snapshot, 
 			appendOnlyMetaDataSnapshot,
 			0, NULL);
+	node->aos_ScanDesc->zoneFilter =
+		AppendOnlyZoneFilter_Create(node->ss.ss_currentRelation,
+									scanState->ps.plan->qual,
+									((Scan *) scanState->ps.plan)->scanrelid);
 	node->ss.scan_state = SCAN_SCAN;
 }
 
@@ -79,6 +103,12 @@ EndScanAppendOnlyRelation(ScanState *scanState)
 	Assert(node->aos_ScanDesc != NULL);
 
 	Assert((node->ss.scan_state & SCAN_SCAN) != 0);
+	if (node->aos_ScanDesc->zoneFilter != NULL)
+	{
+		CollectAppendOnlyZoneStats(node);
+		AppendOnlyZoneFilter_Free(node->aos_ScanDesc->zoneFilter);
+		node->aos_ScanDesc->zoneFilter = NULL;
+	}
 	appendonly_endscan(node->aos_ScanDesc);
 
 	node->aos_ScanDesc = NULL;
@@ -178,6 +178,33 @@ ExecScan(ScanState *node,
 	}
 }
 
+/*
+ * ExecAssignScanQual
+ *		Hand the initialized qual of a table scan to the access method of
+ *		the current relation, if that checks the qual itself.
+ *
+ * AOCS scans do, so that they can check the columns the qual references
+ * before reading the other ones; ExecScan then sees a NIL qual.  Must be
+ * called whenever ps.qual is initialized or the table type changes.
+ */
+void
+ExecAssignScanQual(ScanState *node)
+{
+	if (node->tableType == TableTypeAOCS)
+	{
+		if (node->ps.qual != NIL)
+		{
+			node->ss_accessQual = node->ps.qual;
+			node->ps.qual = NIL;
+		}
+	}
+	else if (node->ss_accessQual != NIL)
+	{
+		node->ps.qual = node->ss_accessQual;
+		node->ss_accessQual = NIL;
+	}
+}
+
 /*
  * ExecAssignScanProjectionInfo
  *		Set up projection info for a scan node, if necessary.
@@ -145,6 +145,7 @@ initNextTableToScan(DynamicTableScanState *node)
 			MemoryContext oldCxt = MemoryContextSwitchTo(node->partitionMemoryContext);
 
 			/* Initialize child expressions */
+			scanState->ss_accessQual = NIL;
 			scanState->ps.qual = (List *)ExecInitExpr((Expr *)scanState->ps.plan->qual, (PlanState*)scanState);
 			scanState->ps.targetlist = (List *)ExecInitExpr((Expr *)scanState->ps.plan->targetlist, (PlanState*)scanState);
 
@@ -159,6 +160,7 @@ initNextTableToScan(DynamicTableScanState *node)
 		ExecAssignScanProjectionInfo(scanState);
 		
 		scanState->tableType = getTableType(scanState->ss_currentRelation);
+		ExecAssignScanQual(scanState);
 		BeginTableScanRelation(scanState);
 	}
 
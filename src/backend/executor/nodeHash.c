@@ -41,9 +41,14 @@
 #include "utils/faultinjector.h"
 
 #include "cdb/cdbexplain.h"
+#include "cdb/cdbhash.h"
+#include "cdb/cdbmotion.h"
+#include "cdb/cdbruntimefilter.h"
 #include "cdb/cdbvars.h"
 
 static void ExecHashIncreaseNumBatches(HashJoinTable hashtable);
+static void ExecHashRuntimeFilterAdd(HashState *node);
+static void ExecHashRuntimeFilterSend(HashState *node);
 static void ExecHashTableExplainEnd(PlanState *planstate, struct StringInfoData *buf);
 static void
 ExecHashTableExplainBatches(HashJoinTable   hashtable,
@@ -115,6 +120,19 @@ MultiExecHash(HashState *node)
 
 	SIMPLE_FAULT_INJECTOR(MultiExecHashLargeVmem);
 
+	/*
+	 * CDB: Build a runtime filter for the outer motion's senders, the first
+	 * time only.  Half a packet is the largest power of two it fits in.
+	 */
+	if (node->hs_rtfilterKeys != NIL)
+	{
+		int			nkeys = list_length(hashkeys);
+
+		node->hs_rtfilter = RuntimeFilterCreate(Gp_max_packet_size / 2);
+		node->hs_rtfilterValues = (Datum *) palloc(nkeys * sizeof(Datum));
+		node->hs_rtfilterNulls = (bool *) palloc(nkeys * sizeof(bool));
+	}
+
 	/*
 	 * get all inner tuples and insert into the hash table (or temp files)
 	 */
@@ -134,6 +152,9 @@ MultiExecHash(HashState *node)
 								 node->hs_keepnull, &hashvalue, &hashkeys_null))
 		{
 			ExecHashTableInsert(node, hashtable, slot, hashvalue);
+
+			if (node->hs_rtfilter != NULL)
+				ExecHashRuntimeFilterAdd(node);
 		}
 
 		if (hashkeys_null)
@@ -150,6 +171,9 @@ MultiExecHash(HashState *node)
 	/* Now we have set up all the initial batches & primary overflow batches. */
 	hashtable->nbatch_outstart = hashtable->nbatch;
 
+	if (node->hs_rtfilter != NULL)
+		ExecHashRuntimeFilterSend(node);
+
 	/* must provide our own instrumentation support */
 	if (node->ps.instrument)
 		InstrStopNode(node->ps.instrument, hashtable->totalTuples);
@@ -164,6 +188,62 @@ MultiExecHash(HashState *node)
 	return NULL;
 }
 
+/*
+ * ExecHashRuntimeFilterAdd
+ *		Add the inner tuple just hashed by ExecHashGetHashValue() to the
+ *		runtime filter.
+ *
+ * The key values it evaluated are hashed again the way the outer motion's
+ * senders hash theirs, which is not the hash of the hash table.  Tuples
+ * with a null key are left out: they can't match.
+ */
+static void
+ExecHashRuntimeFilterAdd(HashState *node)
+{
+	CdbHash    *h = node->hs_rtfilterHash;
+	ListCell   *lk;
+	ListCell   *lt;
+
+	cdbhashinit(h);
+	forboth(lk, node->hs_rtfilterKeys, lt, node->hs_rtfilterTypes)
+	{
+		int			i = lfirst_int(lk);
+
+		if (node->hs_rtfilterNulls[i])
+			return;
+		cdbhash(h, node->hs_rtfilterValues[i], lfirst_oid(lt));
+	}
+
+	RuntimeFilterAdd(node->hs_rtfilter, h->hash);
+}
+
+/*
+ * ExecHashRuntimeFilterSend
+ *		Send the completed runtime filter to the outer motion's senders, if
+ *		it is selective enough, and don't build it again on rescan.
+ */
+static void
+ExecHashRuntimeFilterSend(HashState *node)
+{
+	EState	   *estate = node->ps.state;
+	int			nbytes = RuntimeFilterFinish(node->hs_rtfilter);
+
+	if (nbytes > 0)
+		SendRuntimeFilter(estate->motionlayer_context,
+						  estate->interconnect_context,
+						  node->hs_rtfilterMotionId,
+						  node->hs_rtfilter->bits, nbytes);
+
+	RuntimeFilterDestroy(node->hs_rtfilter);
+	node->hs_rtfilter = NULL;
+	node->hs_rtfilterKeys = NIL;
+
+	pfree(node->hs_rtfilterValues);
+	pfree(node->hs_rtfilterNulls);
+	node->hs_rtfilterValues = NULL;
+	node->hs_rtfilterNulls = NULL;
+}
+
 /* ----------------------------------------------------------------
  *		ExecInitHash
  *
@@ -1072,6 +1152,13 @@ ExecHashGetHashValue(HashState *hashState, HashJoinTable hashtable,
 			*hashkeys_null = false;
 		}
 
+		/* CDB: keep the inner key for the runtime filter */
+		if (!outer_tuple && hashState->hs_rtfilter != NULL)
+		{
+			hashState->hs_rtfilterValues[i] = keyval;
+			hashState->hs_rtfilterNulls[i] = isNull;
+		}
+
 		/*
 		 * If the attribute is NULL, and the join operator is strict, then
 		 * this tuple cannot pass the join qual so we can reject it
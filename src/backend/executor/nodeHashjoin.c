@@ -21,9 +21,12 @@
 #include "executor/instrument.h"	/* Instrumentation */
 #include "executor/nodeHash.h"
 #include "executor/nodeHashjoin.h"
+#include "optimizer/clauses.h"
+#include "parser/parse_expr.h"
 #include "utils/faultinjector.h"
 #include "utils/memutils.h"
 
+#include "cdb/cdbhash.h"
 #include "cdb/cdbvars.h"
 #include "miscadmin.h"			/* work_mem */
 
@@ -38,6 +41,8 @@ static int	ExecHashJoinNewBatch(HashJoinState *hjstate);
 static bool isNotDistinctJoin(List *qualList);
 
 static void ReleaseHashTable(HashJoinState *node);
+static void initRuntimeFilter(HashJoinState *hjstate, HashJoin *node);
+static Node *motion_input_expr_mutator(Node *node, Motion *motion);
 static bool isHashtableEmpty(HashJoinTable hashtable);
 
 /* ----------------------------------------------------------------
@@ -610,6 +615,8 @@ ExecInitHashJoin(HashJoin *node, EState *estate, int eflags)
 	/* child Hash node needs to evaluate inner hash keys, too */
 	((HashState *) innerPlanState(hjstate))->hashkeys = rclauses;
 
+	initRuntimeFilter(hjstate, node);
+
 	hjstate->js.ps.ps_OuterTupleSlot = NULL;
 	hjstate->hj_NeedNewOuter = true;
 	hjstate->hj_MatchedOuter = false;
@@ -1237,6 +1244,111 @@ isNotDistinctJoin(List *qualList)
 	return false;
 }
 
+/*
+ * Translate an expression over the output of a motion into one over its
+ * input, like the motion's hash keys.  Motions don't project, each column
+ * of their output is a Var on their input.
+ */
+static Node *
+motion_input_expr_mutator(Node *node, Motion *motion)
+{
+	if (node == NULL)
+		return NULL;
+
+	if (IsA(node, Var) && ((Var *) node)->varno == OUTER)
+	{
+		Var		   *var = (Var *) node;
+		TargetEntry *tle;
+
+		if (var->varattno <= 0 ||
+			var->varattno > list_length(motion->plan.targetlist))
+			return node;
+
+		tle = (TargetEntry *) list_nth(motion->plan.targetlist, var->varattno - 1);
+		return (Node *) copyObject(tle->expr);
+	}
+
+	return expression_tree_mutator(node, motion_input_expr_mutator, (void *) motion);
+}
+
+/*
+ * If the outer side of the join comes through a Redistribute Motion on the
+ * join keys, have the Hash node build a runtime filter of its keys for the
+ * senders of that motion.  See cdbruntimefilter.c.
+ */
+static void
+initRuntimeFilter(HashJoinState *hjstate, HashJoin *node)
+{
+	HashState  *hashstate = (HashState *) innerPlanState(hjstate);
+	Motion	   *motion;
+	List	   *keys = NIL;
+	List	   *outerkeys = NIL;
+	ListCell   *lc;
+	ListCell   *lct;
+
+	if (!gp_enable_runtime_filter)
+		return;
+
+	/* Only outer rows that can't match may be dropped, nulls never match. */
+	if ((hjstate->js.jointype != JOIN_INNER && hjstate->js.jointype != JOIN_IN) ||
+		hjstate->hj_nonequijoin)
+		return;
+
+	if (!IsA(outerPlan(node), Motion))
+		return;
+	motion = (Motion *) outerPlan(node);
+	if (motion->motionType != MOTIONTYPE_HASH ||
+		motion->hashExpr == NIL ||
+		((MotionState *) outerPlanState(hjstate))->mstype != MOTIONSTATE_RECV)
+		return;
+
+	/* our outer keys, in the terms of the motion's hash keys */
+	foreach(lc, hjstate->hj_OuterHashKeys)
+	{
+		Expr	   *oexpr = ((ExprState *) lfirst(lc))->expr;
+
+		outerkeys = lappend(outerkeys,
+							motion_input_expr_mutator((Node *) oexpr, motion));
+	}
+
+	/*
+	 * Each hash key of the motion must be the outer side of one of our hash
+	 * clauses, whose inner side has the same type: then hashing the inner
+	 * keys gives the cdbhash value the senders route by.
+	 */
+	forboth(lc, motion->hashExpr, lct, motion->hashDataTypes)
+	{
+		Node	   *mexpr = strip_implicit_coercions((Node *) lfirst(lc));
+		int			inner = -1;
+		int			i = 0;
+		ListCell   *lo;
+		ListCell   *li;
+
+		forboth(lo, outerkeys, li, hjstate->hj_InnerHashKeys)
+		{
+			Node	   *oexpr = strip_implicit_coercions((Node *) lfirst(lo));
+			Expr	   *iexpr = ((ExprState *) lfirst(li))->expr;
+
+			if (equal(oexpr, mexpr) &&
+				exprType((Node *) iexpr) == lfirst_oid(lct))
+			{
+				inner = i;
+				break;
+			}
+			i++;
+		}
+
+		if (inner < 0)
+			return;
+		keys = lappend_int(keys, inner);
+	}
+
+	hashstate->hs_rtfilterKeys = keys;
+	hashstate->hs_rtfilterTypes = motion->hashDataTypes;
+	hashstate->hs_rtfilterMotionId = motion->motionID;
+	hashstate->hs_rtfilterHash = makeCdbHash(motion->numOutputSegs);
+}
+
 void
 initGpmonPktForHashJoin(Plan *planNode, gpmon_packet_t *gpmon_pkt, EState *estate)
 {
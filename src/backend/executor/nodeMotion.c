@@ -101,6 +101,48 @@ CdbMergeComparator_CreateContext(TupleDesc      tupDesc,
 static void
 CdbMergeComparator_DestroyContext(CdbMergeComparatorContext *ctx);
 
+/*
+ * MotionLoserTree
+ *
+ * Tournament tree merging the sorted tuple streams of all senders, used
+ * by the sorted receiver (Merge Receive) when gp_enable_motion_loser_tree
+ * is set.
+ *
+ * Leaf i holds the next tuple from sender route i, together with its sort
+ * key columns, which are extracted once when the tuple arrives so that no
+ * comparison ever has to deform a tuple.  Internal node n (0 < n < nleaves)
+ * holds the leaf that lost the match played at n, and losers[0] the overall
+ * winner.  Replacing the winner's tuple replays only the matches on its
+ * path to the root, one comparison per level.
+ *
+ * While the winner keeps winning every match on its path, runBound holds
+ * the best of the leaves it beat, which is the runner-up of the whole
+ * tournament.  As long as the sender's next tuple still sorts before the
+ * runner-up the tree needs no change at all, so a run of tuples from one
+ * sender is drained with a single comparison per tuple.
+ */
+typedef struct MotionLoserTreeLeaf
+{
+	HeapTuple	tuple;			/* next tuple from this sender, NULL at EOS */
+	Datum	   *keys;			/* sort key columns of tuple */
+	bool	   *nulls;
+} MotionLoserTreeLeaf;
+
+#define LOSERTREE_NO_RUN	(-2)	/* winner's runner-up is not known */
+#define LOSERTREE_RUN_ALONE	(-1)	/* all other senders are at EOS */
+
+typedef struct MotionLoserTree
+{
+	CdbMergeComparatorContext *cmpctx;
+	int			nleaves;		/* one per sender route */
+	MotionLoserTreeLeaf *leaves;
+	int		   *losers;			/* losers[0] is the winner */
+	int			runBound;		/* leaf of the runner-up, or LOSERTREE_xxx */
+} MotionLoserTree;
+
+static MotionLoserTree *MotionLoserTree_Create(MotionState *node, TupleDesc tupDesc);
+static void MotionLoserTree_Destroy(MotionLoserTree *lt);
+
 
 /*=========================================================================
  * FUNCTIONS PROTOTYPES
@@ -109,6 +151,7 @@ static TupleTableSlot *execMotionSender(MotionState * node);
 static TupleTableSlot *execMotionUnsortedReceiver(MotionState * node);
 static TupleTableSlot *execMotionSortedReceiver(MotionState * node);
 static TupleTableSlot *execMotionSortedReceiver_mk(MotionState * node);
+static TupleTableSlot *execMotionSortedReceiver_lt(MotionState * node);
 
 static void execMotionSortedReceiverFirstTime(MotionState * node);
 
@@ -214,7 +257,9 @@ ExecMotion(MotionState * node)
 
 		if (motion->sendSorted)
         {
-            if (gp_enable_motion_mk_sort)
+            if (node->mergeType == MOTIONMERGE_LOSERTREE)
+                tuple = execMotionSortedReceiver_lt(node);
+            else if (node->mergeType == MOTIONMERGE_MKHEAP)
                 tuple = execMotionSortedReceiver_mk(node);
             else
                 tuple = execMotionSortedReceiver(node);
@@ -847,6 +892,272 @@ execMotionSortedReceiverFirstTime(MotionState * node)
 }                               /* execMotionSortedReceiverFirstTime */
 
 
+/*
+ * MotionLoserTree_SetLeaf
+ *		Make tuple the current tuple of the given leaf, and extract its
+ *		sort keys.  A NULL tuple marks the sender as finished.
+ */
+static void
+MotionLoserTree_SetLeaf(MotionLoserTree *lt, int leaf, HeapTuple tuple)
+{
+	CdbMergeComparatorContext *ctx = lt->cmpctx;
+	MotionLoserTreeLeaf *l = &lt->leaves[leaf];
+	int			nkey;
+
+	l->tuple = tuple;
+	if (tuple == NULL)
+		return;
+
+	if (is_heaptuple_memtuple(tuple))
+	{
+		for (nkey = 0; nkey < ctx->numSortCols; nkey++)
+			l->keys[nkey] = memtuple_getattr((MemTuple) tuple, ctx->mt_bind,
+											 ctx->sortColIdx[nkey], &l->nulls[nkey]);
+	}
+	else
+	{
+		for (nkey = 0; nkey < ctx->numSortCols; nkey++)
+			l->keys[nkey] = heap_getattr(tuple, ctx->sortColIdx[nkey],
+										 ctx->tupDesc, &l->nulls[nkey]);
+	}
+}
+
+/*
+ * MotionLoserTree_Beats
+ *		Does leaf a go before leaf b?  Finished senders go after everything
+ *		else, and ties are broken on the route so that the order is total.
+ */
+static inline bool
+MotionLoserTree_Beats(MotionLoserTree *lt, int a, int b)
+{
+	CdbMergeComparatorContext *ctx = lt->cmpctx;
+	MotionLoserTreeLeaf *la = &lt->leaves[a];
+	MotionLoserTreeLeaf *lb = &lt->leaves[b];
+	int			nkey;
+
+	if (la->tuple == NULL)
+		return lb->tuple == NULL && a < b;
+	if (lb->tuple == NULL)
+		return true;
+
+	for (nkey = 0; nkey < ctx->numSortCols; nkey++)
+	{
+		int32		compare;
+
+		compare = ApplySortFunction(&ctx->sortFunctions[nkey],
+									ctx->cmpFlags[nkey],
+									la->keys[nkey], la->nulls[nkey],
+									lb->keys[nkey], lb->nulls[nkey]);
+		if (compare != 0)
+			return compare < 0;
+	}
+
+	return a < b;
+}
+
+/*
+ * MotionLoserTree_Build
+ *		Play the whole tournament once all leaves hold their first tuple.
+ */
+static void
+MotionLoserTree_Build(MotionLoserTree *lt)
+{
+	int			k = lt->nleaves;
+	int		   *winners;
+	int			n;
+
+	lt->runBound = LOSERTREE_NO_RUN;
+
+	if (k == 1)
+	{
+		lt->losers[0] = 0;
+		return;
+	}
+
+	/* winners[n] is the winner of the subtree rooted at n; leaves are k..2k-1 */
+	winners = (int *) palloc(2 * k * sizeof(int));
+	for (n = k; n < 2 * k; n++)
+		winners[n] = n - k;
+
+	for (n = k - 1; n > 0; n--)
+	{
+		int			a = winners[2 * n];
+		int			b = winners[2 * n + 1];
+
+		if (MotionLoserTree_Beats(lt, a, b))
+		{
+			winners[n] = a;
+			lt->losers[n] = b;
+		}
+		else
+		{
+			winners[n] = b;
+			lt->losers[n] = a;
+		}
+	}
+	lt->losers[0] = winners[1];
+
+	pfree(winners);
+}
+
+/*
+ * MotionLoserTree_Replay
+ *		The current tuple of leaf has changed: replay the matches on its path
+ *		to the root.
+ *
+ * If leaf wins all of them, remember the best of the leaves it beat as the
+ * bound of its run.
+ */
+static void
+MotionLoserTree_Replay(MotionLoserTree *lt, int leaf)
+{
+	int			cand = leaf;
+	int			bound = LOSERTREE_RUN_ALONE;
+	bool		unbeaten = true;
+	int			n;
+
+	for (n = (leaf + lt->nleaves) / 2; n > 0; n /= 2)
+	{
+		int			other = lt->losers[n];
+
+		if (MotionLoserTree_Beats(lt, cand, other))
+		{
+			if (unbeaten &&
+				lt->leaves[other].tuple != NULL &&
+				(bound == LOSERTREE_RUN_ALONE ||
+				 MotionLoserTree_Beats(lt, other, bound)))
+				bound = other;
+		}
+		else
+		{
+			lt->losers[n] = cand;
+			cand = other;
+			unbeaten = false;
+		}
+	}
+
+	lt->losers[0] = cand;
+	lt->runBound = unbeaten ? bound : LOSERTREE_NO_RUN;
+}
+
+/* Sorted receiver using MotionLoserTree */
+static TupleTableSlot *
+execMotionSortedReceiver_lt(MotionState * node)
+{
+	TupleTableSlot *slot;
+	MotionLoserTree *lt = (MotionLoserTree *) node->tupleheap;
+	Motion	   *motion = (Motion *) node->ps.plan;
+	HeapTuple	tuple;
+	int			winner;
+
+	AssertState(motion->motionType == MOTIONTYPE_FIXED &&
+				motion->numOutputSegs <= 1 &&
+				motion->sendSorted &&
+				lt != NULL);
+
+	/* Notify senders and return EOS if caller doesn't want any more data. */
+	if (node->stopRequested)
+	{
+		SendStopMessage(node->ps.state->motionlayer_context,
+						node->ps.state->interconnect_context,
+						motion->motionID);
+		return NULL;
+	}
+
+	/* On first call, get the first tuple of every sender and play the tournament. */
+	if (!node->tupleheapReady)
+	{
+		ListCell   *lcProcess;
+		int			iSegIdx;
+		Slice	   *sendSlice = (Slice *) list_nth(node->ps.state->es_sliceTable->slices,
+												   motion->motionID);
+
+		Assert(sendSlice->sliceIndex == motion->motionID);
+
+		foreach_with_count(lcProcess, sendSlice->primaryProcesses, iSegIdx)
+		{
+			HeapTuple	inputTuple = NULL;
+
+			/* Senders we are not receiving from stay at EOS. */
+			if (lfirst(lcProcess) != NULL &&
+				RecvTupleFrom(node->ps.state->motionlayer_context,
+							  node->ps.state->interconnect_context,
+							  motion->motionID, &inputTuple,
+							  iSegIdx) == GOT_TUPLE)
+				node->numTuplesFromAMS++;
+			else
+				inputTuple = NULL;
+
+			MotionLoserTree_SetLeaf(lt, iSegIdx, inputTuple);
+		}
+		Assert(iSegIdx == lt->nleaves);
+
+		MotionLoserTree_Build(lt);
+		node->tupleheapReady = true;
+	}
+
+	/*
+	 * Receive the successor of the tuple that we returned last time, and
+	 * let it take its predecessor's place in the tournament.  While it still
+	 * sorts before the runner-up, it is the winner and nothing moves.
+	 */
+	else
+	{
+		HeapTuple	inputTuple = NULL;
+		int			leaf = node->routeIdNext;
+
+		/* Already returned EOS. */
+		if (leaf < 0)
+			return NULL;
+
+		Assert(lt->losers[0] == leaf && lt->leaves[leaf].tuple == NULL);
+
+		if (RecvTupleFrom(node->ps.state->motionlayer_context,
+						  node->ps.state->interconnect_context,
+						  motion->motionID, &inputTuple,
+						  leaf) == GOT_TUPLE)
+			node->numTuplesFromAMS++;
+		else
+			inputTuple = NULL;
+
+		MotionLoserTree_SetLeaf(lt, leaf, inputTuple);
+
+		if (inputTuple == NULL ||
+			lt->runBound == LOSERTREE_NO_RUN ||
+			(lt->runBound != LOSERTREE_RUN_ALONE &&
+			 !MotionLoserTree_Beats(lt, leaf, lt->runBound)))
+			MotionLoserTree_Replay(lt, leaf);
+	}
+
+	/* Finished if all senders have returned EOS. */
+	winner = lt->losers[0];
+	tuple = lt->leaves[winner].tuple;
+	if (tuple == NULL)
+	{
+		Assert(node->numTuplesFromAMS == node->numTuplesToParent);
+		node->routeIdNext = -1;
+		return NULL;
+	}
+
+	/*
+	 * Transfer ownership of the tuple to our caller.  The leaf's keys point
+	 * into it, so zap the tuple pointer: the leaf must not be compared again
+	 * until it has received the next tuple.
+	 */
+	lt->leaves[winner].tuple = NULL;
+	node->routeIdNext = winner;
+
+	/* Update counters. */
+	node->numTuplesToParent++;
+
+	/* Store tuple in our result slot. */
+	slot = node->ps.ps_ResultTupleSlot;
+	slot = ExecStoreGenericTuple(tuple, slot, true /* shouldFree */);
+
+	return slot;
+}								/* execMotionSortedReceiver_lt */
+
+
 /* ----------------------------------------------------------------
  *		ExecInitMotion
  *
@@ -887,6 +1198,9 @@ ExecInitMotion(Motion * node, EState *estate, int eflags)
 	motionstate->stopRequested = false;
 	motionstate->hashExpr = NULL;
 	motionstate->cdbhash = NULL;
+	motionstate->skewHashes = NULL;
+	motionstate->numSkewHashes = 0;
+	motionstate->skewNextRoute = 0;
 
     /* Look up the sending gang's slice table entry. */
     sendSlice = (Slice *)list_nth(sliceTable->slices, node->motionID);
@@ -1006,13 +1320,47 @@ ExecInitMotion(Motion * node, EState *estate, int eflags)
 		 * Create hash API reference
 		 */
 		motionstate->cdbhash = makeCdbHash(node->numOutputSegs);
+
+		/*
+		 * Skewed key values are recognized by their hash value.  Values of
+		 * the other join input that collide with one are treated the same
+		 * way on both sides, so that is harmless.
+		 */
+		if (node->skewAction != MOTIONSKEW_NONE && node->skewValues != NIL)
+		{
+			ListCell   *lc;
+
+			motionstate->skewHashes = (uint32 *)
+				palloc(list_length(node->skewValues) * sizeof(uint32));
+			foreach(lc, node->skewValues)
+			{
+				Const	   *skewValue = (Const *) lfirst(lc);
+
+				Assert(IsA(skewValue, Const) && !skewValue->constisnull);
+
+				cdbhashinit(motionstate->cdbhash);
+				cdbhash(motionstate->cdbhash, skewValue->constvalue, skewValue->consttype);
+				motionstate->skewHashes[motionstate->numSkewHashes++] = motionstate->cdbhash->hash;
+			}
+
+			/* Start spreading at a different segment in each sender. */
+			motionstate->skewNextRoute = Max(GpIdentity.segindex, 0) % node->numOutputSegs;
+		}
     }
 
 	/* Merge Receive: Set up the key comparator and priority queue. */
     if (node->sendSorted && motionstate->mstype == MOTIONSTATE_RECV) 
 	{
-        if (gp_enable_motion_mk_sort)
+        if (gp_enable_motion_loser_tree)
+        {
+            motionstate->mergeType = MOTIONMERGE_LOSERTREE;
+            motionstate->tupleheap = MotionLoserTree_Create(motionstate, tupDesc);
+        }
+        else if (gp_enable_motion_mk_sort)
+        {
+            motionstate->mergeType = MOTIONMERGE_MKHEAP;
             create_motion_mk_heap(motionstate);
+        }
         else
         {
             CdbMergeComparatorContext  *mcContext;
@@ -1025,6 +1373,7 @@ ExecInitMotion(Motion * node, EState *estate, int eflags)
 				node->nullsFirst);
 
             /* Create the priority queue structure. */
+            motionstate->mergeType = MOTIONMERGE_CDBHEAP;
             motionstate->tupleheap = CdbHeap_Create(CdbMergeComparator,
                     mcContext,
                     motionstate->numInputSegs,
@@ -1161,7 +1510,9 @@ ExecEndMotion(MotionState * node)
 	/* Merge Receive: Free the priority queue and associated structures. */
     if (node->tupleheap != NULL)
 	{
-        if (gp_enable_motion_mk_sort)
+        if (node->mergeType == MOTIONMERGE_LOSERTREE)
+            MotionLoserTree_Destroy((MotionLoserTree *) node->tupleheap);
+        else if (node->mergeType == MOTIONMERGE_MKHEAP)
             destroy_motion_mk_heap(node);
         else
         {
@@ -1179,6 +1530,12 @@ ExecEndMotion(MotionState * node)
 		node->cdbhash = NULL;
 	}
 
+	if (node->skewHashes != NULL)
+	{
+		pfree(node->skewHashes);
+		node->skewHashes = NULL;
+	}
+
 	/*
 	 * Free up this motion node's resources in the Motion Layer.
 	 *
@@ -1326,6 +1683,58 @@ CdbMergeComparator_DestroyContext(CdbMergeComparatorContext *ctx)
 }                               /* CdbMergeComparator_DestroyContext */
 
 
+/* Create the loser tree of a Merge Receive, with one leaf per sender route */
+MotionLoserTree *
+MotionLoserTree_Create(MotionState *node, TupleDesc tupDesc)
+{
+	Motion	   *motion = (Motion *) node->ps.plan;
+	MotionLoserTree *lt;
+	Datum	   *keys;
+	bool	   *nulls;
+	int			nkeys = motion->numSortCols;
+	int			i;
+
+	Assert(node->numInputSegs >= 1);
+
+	lt = (MotionLoserTree *) palloc0(sizeof(*lt));
+	lt->cmpctx = CdbMergeComparator_CreateContext(tupDesc,
+												  motion->numSortCols,
+												  motion->sortColIdx,
+												  motion->sortOperators,
+												  motion->nullsFirst);
+	lt->nleaves = node->numInputSegs;
+	lt->leaves = (MotionLoserTreeLeaf *) palloc0(lt->nleaves * sizeof(MotionLoserTreeLeaf));
+	lt->losers = (int *) palloc0(lt->nleaves * sizeof(int));
+	lt->runBound = LOSERTREE_NO_RUN;
+
+	/* The key arrays of all leaves are carved out of one allocation each. */
+	keys = (Datum *) palloc0(lt->nleaves * nkeys * sizeof(Datum));
+	nulls = (bool *) palloc0(lt->nleaves * nkeys * sizeof(bool));
+	for (i = 0; i < lt->nleaves; i++)
+	{
+		lt->leaves[i].keys = keys + i * nkeys;
+		lt->leaves[i].nulls = nulls + i * nkeys;
+	}
+
+	return lt;
+}								/* MotionLoserTree_Create */
+
+
+void
+MotionLoserTree_Destroy(MotionLoserTree *lt)
+{
+	CdbMergeComparator_DestroyContext(lt->cmpctx);
+	if (lt->nleaves > 0)
+	{
+		pfree(lt->leaves[0].keys);
+		pfree(lt->leaves[0].nulls);
+	}
+	pfree(lt->leaves);
+	pfree(lt->losers);
+	pfree(lt);
+}								/* MotionLoserTree_Destroy */
+
+
 /*
  * Experimental code that will be replaced later with new hashing mechanism
  */
@@ -1479,6 +1888,38 @@ doSendTuple(Motion * motion, MotionState * node, TupleTableSlot *outerTupleSlot)
 		 * makeDefaultSegIdxArray() in cdbmutate.c (it is the trivial
 		 * map, and is passed around our system a fair amount!). */
 		Assert(targetRoute != BROADCAST_SEGIDX);
+
+		/* Spread or broadcast the tuple if its key is skewed. */
+		if (node->numSkewHashes > 0)
+		{
+			int			i;
+
+			for (i = 0; i < node->numSkewHashes; i++)
+			{
+				if (node->skewHashes[i] == node->cdbhash->hash)
+					break;
+			}
+
+			if (i < node->numSkewHashes)
+			{
+				if (motion->skewAction == MOTIONSKEW_BROADCAST)
+					targetRoute = BROADCAST_SEGIDX;
+				else
+				{
+					targetRoute = motion->outputSegIdx[node->skewNextRoute];
+					node->skewNextRoute = (node->skewNextRoute + 1) % motion->numOutputSegs;
+				}
+			}
+		}
+
+		/*
+		 * Drop the tuple if the hash join on the target segment has told us
+		 * it can't match (see cdbruntimefilter.c).
+		 */
+		if (RuntimeFilterRejects(node->ps.state->interconnect_context,
+								 motion->motionID, targetRoute,
+								 node->cdbhash->hash))
+			return;
 	}
 	else /* ExplicitRedistribute */
 	{
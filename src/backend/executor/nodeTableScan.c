@@ -22,6 +22,7 @@ ExecInitTableScan(TableScan *node, EState *estate, int eflags)
 	state->ss.scan_state = SCAN_INIT;
 
 	InitScanStateInternal((ScanState *)state, (Plan *)node, estate, eflags, true /* initCurrentRelation */);
+	ExecAssignScanQual((ScanState *)state);
 	
 	initGpmonPktForTableScan((Plan *)node, &state->ss.ps.gpmon_pkt, estate);
 
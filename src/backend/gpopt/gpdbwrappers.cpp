@@ -429,6 +429,36 @@ gpdb::PbmsAddMember
 	return NULL;
 }
 
+bool
+gpdb::FBmsIsMember
+	(
+	int x,
+	const Bitmapset *a
+	)
+{
+	GP_WRAP_START;
+	{
+		return bms_is_member(x, a);
+	}
+	GP_WRAP_END;
+	return false;
+}
+
+bool
+gpdb::FBmsOverlap
+	(
+	const Bitmapset *a,
+	const Bitmapset *b
+	)
+{
+	GP_WRAP_START;
+	{
+		return bms_overlap(a, b);
+	}
+	GP_WRAP_END;
+	return false;
+}
+
 void *
 gpdb::PvCopyObject
 	(
@@ -2824,6 +2854,21 @@ gpdb::PexprEvaluate
 	return NULL;
 }
 
+// does the expression contain calls to volatile functions
+bool
+gpdb::FContainVolatileFunctions
+	(
+	Node *pnode
+	)
+{
+	GP_WRAP_START;
+	{
+		return contain_volatile_functions(pnode);
+	}
+	GP_WRAP_END;
+	return false;
+}
+
 // interpret the value of "With oids" option from a list of defelems
 bool
 gpdb::FInterpretOidsOption
@@ -15,6 +15,9 @@
 //---------------------------------------------------------------------------
 
 #include "postgres.h"
+#include "portability/instr_time.h"
+
+#include "gpopt/utils/optstats.h"
 #include "gpopt/relcache/CMDProviderRelcache.h"
 #include "gpopt/translate/CTranslatorRelcacheToDXL.h"
 #include "gpopt/mdcache/CMDAccessor.h"
@@ -37,14 +40,49 @@ using namespace gpmd;
 //---------------------------------------------------------------------------
 CMDProviderRelcache::CMDProviderRelcache
 	(
-	IMemoryPool *pmp
+	IMemoryPool *pmp,
+	CHistogramColumns *phistcols
 	)
 	:
-	m_pmp(pmp)
+	m_pmp(pmp),
+	m_phistcols(phistcols)
 {
 	GPOS_ASSERT(NULL != m_pmp);
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CMDProviderRelcache::EmdkindStats
+//
+//	@doc:
+//		Map a metadata id to the request kind reported in optimizer statistics
+//
+//---------------------------------------------------------------------------
+OptStatsMDKind
+CMDProviderRelcache::EmdkindStats
+	(
+	IMDId *pmdid
+	)
+{
+	switch (pmdid->Emdidt())
+	{
+		case IMDId::EmdidRelStats:
+			return OPTSTATS_MD_RELSTATS;
+
+		case IMDId::EmdidColStats:
+			return OPTSTATS_MD_COLSTATS;
+
+		case IMDId::EmdidCastFunc:
+			return OPTSTATS_MD_CAST;
+
+		case IMDId::EmdidScCmp:
+			return OPTSTATS_MD_SCCMP;
+
+		default:
+			return OPTSTATS_MD_OBJECT;
+	}
+}
+
 //---------------------------------------------------------------------------
 //	@function:
 //		CMDProviderRelcache::PstrObject
@@ -62,10 +100,30 @@ CMDProviderRelcache::PstrObject
 	)
 	const
 {
-	IMDCacheObject *pimdobj = CTranslatorRelcacheToDXL::Pimdobj(pmp, pmda, pmdid);
+	instr_time starttime;
+	if (NULL != optimizer_stats_collector)
+	{
+		INSTR_TIME_SET_CURRENT(starttime);
+	}
+
+	IMDCacheObject *pimdobj = CTranslatorRelcacheToDXL::Pimdobj(pmp, pmda, pmdid, m_phistcols);
 
 	GPOS_ASSERT(NULL != pimdobj);
 
+	if (NULL != optimizer_stats_collector)
+	{
+		instr_time endtime;
+		INSTR_TIME_SET_CURRENT(endtime);
+		INSTR_TIME_SUBTRACT(endtime, starttime);
+
+		OptStatsMDKind emdkind = EmdkindStats(pmdid);
+		optimizer_stats_collector->md_fetches[emdkind]++;
+		optimizer_stats_collector->md_fetch_time[emdkind] += INSTR_TIME_GET_MILLISEC(endtime);
+
+		// metadata is fetched throughout the search, so sample the pool here
+		OptStatsSampleMemory(optimizer_stats_collector, pmp->UllTotalAllocatedSize());
+	}
+
 	CWStringDynamic *pstr = CDXLUtils::PstrSerializeMDObj(m_pmp, pimdobj, true /*fSerializeHeaders*/, false /*findent*/);
 
 	// cleanup DXL object
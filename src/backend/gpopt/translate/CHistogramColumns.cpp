@@ -0,0 +1,669 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2017 Pivotal Software, Inc.
+//
+//	@filename:
+//		CHistogramColumns.cpp
+//
+//	@doc:
+//		Implementation of the set of columns for which the optimizer needs
+//		histograms
+//
+//	@test:
+//
+//
+//---------------------------------------------------------------------------
+
+#include "postgres.h"
+#include "gpopt/translate/CHistogramColumns.h"
+
+#include "nodes/bitmapset.h"
+#include "nodes/parsenodes.h"
+#include "utils/memutils.h"
+
+#include "gpos/base.h"
+#include "gpos/memory/CCacheAccessor.h"
+#include "gpopt/gpdbwrappers.h"
+#include "gpopt/mdcache/CMDCache.h"
+#include "gpopt/mdcache/CMDKey.h"
+
+#include "naucrates/md/CMDIdColStats.h"
+#include "naucrates/md/CMDIdGPDB.h"
+
+using namespace gpdxl;
+using namespace gpmd;
+using namespace gpopt;
+
+// query nesting beyond which all columns get histograms
+#define GPDXL_HISTCOLS_MAX_DEPTH 64
+
+// columns of one relation; attribute number 0 stands for all columns
+typedef struct SRelColumns
+{
+	Oid oidRel;
+	Bitmapset *pbms;
+} SRelColumns;
+
+// column statistics entry of the MD cache
+typedef struct SColStatsEntry
+{
+	Oid oidRel;
+	INT iAttno;
+	ULONG ulPos;
+} SColStatsEntry;
+
+struct CHistogramColumns::SQueryLevel
+{
+	Query *m_pquery;
+	SQueryLevel *m_pqlParent;
+};
+
+struct CHistogramColumns::SCollectContext
+{
+	// query level the walked expression belongs to
+	SQueryLevel *m_pql;
+
+	// current nesting of queries
+	ULONG m_ulDepth;
+
+	// query is too deep to analyze, all columns need histograms
+	BOOL m_fAll;
+
+	// collected columns
+	List *m_plRelColumns;
+};
+
+//---------------------------------------------------------------------------
+//	@function:
+//		PlAddColumn
+//
+//	@doc:
+//		Add a column to a set of columns, allocated in the current memory
+//		context
+//
+//---------------------------------------------------------------------------
+static List *
+PlAddColumn
+	(
+	List *plRelColumns,
+	OID oidRel,
+	INT iAttno
+	)
+{
+	ListCell *plc = NULL;
+	ForEach (plc, plRelColumns)
+	{
+		SRelColumns *prelcols = (SRelColumns *) lfirst(plc);
+		if (prelcols->oidRel == oidRel)
+		{
+			prelcols->pbms = gpdb::PbmsAddMember(prelcols->pbms, iAttno);
+			return plRelColumns;
+		}
+	}
+
+	SRelColumns *prelcols = (SRelColumns *) gpdb::GPDBAlloc(sizeof(SRelColumns));
+	prelcols->oidRel = oidRel;
+	prelcols->pbms = gpdb::PbmsAddMember(NULL, iAttno);
+
+	return gpdb::PlAppendElement(plRelColumns, prelcols);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		FMember
+//
+//	@doc:
+//		Is the column in a set of columns
+//
+//---------------------------------------------------------------------------
+static BOOL
+FMember
+	(
+	List *plRelColumns,
+	OID oidRel,
+	INT iAttno
+	)
+{
+	ListCell *plc = NULL;
+	ForEach (plc, plRelColumns)
+	{
+		SRelColumns *prelcols = (SRelColumns *) lfirst(plc);
+		if (prelcols->oidRel == oidRel)
+		{
+			return gpdb::FBmsIsMember(iAttno, prelcols->pbms) ||
+					gpdb::FBmsIsMember(0, prelcols->pbms);
+		}
+	}
+
+	return false;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CHistogramColumns::CollectQuery
+//
+//	@doc:
+//		Collect the columns referenced in the predicates of a query level
+//		and of the queries nested in it
+//
+//---------------------------------------------------------------------------
+void
+CHistogramColumns::CollectQuery
+	(
+	Query *pquery,
+	SQueryLevel *pqlParent,
+	SCollectContext *pctx
+	)
+{
+	if (GPDXL_HISTCOLS_MAX_DEPTH < ++pctx->m_ulDepth)
+	{
+		pctx->m_fAll = true;
+	}
+
+	if (pctx->m_fAll)
+	{
+		pctx->m_ulDepth--;
+		return;
+	}
+
+	SQueryLevel ql = {pquery, pqlParent};
+	SQueryLevel *pqlPrev = pctx->m_pql;
+	pctx->m_pql = &ql;
+
+	// WHERE, JOIN ... ON and HAVING clauses
+	(void) FPredicateWalker((Node *) pquery->jointree, pctx);
+	(void) FPredicateWalker(pquery->havingQual, pctx);
+
+	// subqueries in the target list
+	(void) FSubqueryWalker((Node *) pquery->targetList, pctx);
+
+	ListCell *plc = NULL;
+	ForEach (plc, pquery->rtable)
+	{
+		RangeTblEntry *prte = (RangeTblEntry *) lfirst(plc);
+		if (NULL != prte->subquery &&
+			(RTE_SUBQUERY == prte->rtekind || RTE_TABLEFUNCTION == prte->rtekind))
+		{
+			CollectQuery(prte->subquery, &ql, pctx);
+		}
+	}
+
+	ForEach (plc, pquery->cteList)
+	{
+		CommonTableExpr *pcte = (CommonTableExpr *) lfirst(plc);
+		CollectQuery((Query *) pcte->ctequery, &ql, pctx);
+	}
+
+	pctx->m_pql = pqlPrev;
+	pctx->m_ulDepth--;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CHistogramColumns::CollectOutputColumn
+//
+//	@doc:
+//		Collect the base table columns that the given output column of a
+//		query depends on. Attribute number 0 stands for all output columns.
+//
+//---------------------------------------------------------------------------
+void
+CHistogramColumns::CollectOutputColumn
+	(
+	Query *pquery,
+	SQueryLevel *pqlParent,
+	INT iAttno,
+	SCollectContext *pctx
+	)
+{
+	if (GPDXL_HISTCOLS_MAX_DEPTH < ++pctx->m_ulDepth)
+	{
+		pctx->m_fAll = true;
+	}
+
+	if (pctx->m_fAll)
+	{
+		pctx->m_ulDepth--;
+		return;
+	}
+
+	SQueryLevel ql = {pquery, pqlParent};
+	ListCell *plc = NULL;
+
+	if (NULL != pquery->setOperations)
+	{
+		// output columns of a set operation come from all its inputs
+		ForEach (plc, pquery->rtable)
+		{
+			RangeTblEntry *prte = (RangeTblEntry *) lfirst(plc);
+			if (RTE_SUBQUERY == prte->rtekind)
+			{
+				CollectOutputColumn(prte->subquery, &ql, iAttno, pctx);
+			}
+		}
+
+		pctx->m_ulDepth--;
+		return;
+	}
+
+	SQueryLevel *pqlPrev = pctx->m_pql;
+	pctx->m_pql = &ql;
+
+	ForEach (plc, pquery->targetList)
+	{
+		TargetEntry *pte = (TargetEntry *) lfirst(plc);
+		if (0 == iAttno || pte->resno == iAttno)
+		{
+			(void) FPredicateWalker((Node *) pte->expr, pctx);
+		}
+	}
+
+	pctx->m_pql = pqlPrev;
+	pctx->m_ulDepth--;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CHistogramColumns::CollectVar
+//
+//	@doc:
+//		Collect the base table columns that a variable used in a predicate
+//		depends on, looking through joins, subqueries and CTEs
+//
+//---------------------------------------------------------------------------
+void
+CHistogramColumns::CollectVar
+	(
+	Var *pvar,
+	SQueryLevel *pql,
+	SCollectContext *pctx
+	)
+{
+	for (Index ul = 0; ul < pvar->varlevelsup && NULL != pql; ul++)
+	{
+		pql = pql->m_pqlParent;
+	}
+
+	if (NULL == pql || 0 == pvar->varno ||
+		(ULONG) pvar->varno > gpdb::UlListLength(pql->m_pquery->rtable))
+	{
+		return;
+	}
+
+	RangeTblEntry *prte = (RangeTblEntry *) gpdb::PvListNth(pql->m_pquery->rtable, pvar->varno - 1);
+	INT iAttno = pvar->varattno;
+
+	switch (prte->rtekind)
+	{
+		case RTE_RELATION:
+		{
+			// statistics of system columns are always computed on the fly
+			if (0 <= iAttno)
+			{
+				pctx->m_plRelColumns = PlAddColumn(pctx->m_plRelColumns, prte->relid, iAttno);
+			}
+			break;
+		}
+
+		case RTE_JOIN:
+		{
+			SQueryLevel *pqlPrev = pctx->m_pql;
+			pctx->m_pql = pql;
+			if (0 == iAttno)
+			{
+				(void) FPredicateWalker((Node *) prte->joinaliasvars, pctx);
+			}
+			else if (iAttno <= (INT) gpdb::UlListLength(prte->joinaliasvars))
+			{
+				(void) FPredicateWalker((Node *) gpdb::PvListNth(prte->joinaliasvars, iAttno - 1), pctx);
+			}
+			pctx->m_pql = pqlPrev;
+			break;
+		}
+
+		case RTE_SUBQUERY:
+		case RTE_TABLEFUNCTION:
+		{
+			if (NULL != prte->subquery)
+			{
+				CollectOutputColumn(prte->subquery, pql, iAttno, pctx);
+			}
+			break;
+		}
+
+		case RTE_CTE:
+		{
+			SQueryLevel *pqlCTE = pql;
+			for (Index ul = 0; ul < prte->ctelevelsup && NULL != pqlCTE; ul++)
+			{
+				pqlCTE = pqlCTE->m_pqlParent;
+			}
+
+			if (NULL == pqlCTE)
+			{
+				break;
+			}
+
+			ListCell *plc = NULL;
+			ForEach (plc, pqlCTE->m_pquery->cteList)
+			{
+				CommonTableExpr *pcte = (CommonTableExpr *) lfirst(plc);
+				if (0 == strcmp(pcte->ctename, prte->ctename))
+				{
+					CollectOutputColumn((Query *) pcte->ctequery, pqlCTE, iAttno, pctx);
+					break;
+				}
+			}
+			break;
+		}
+
+		default:
+			break;
+	}
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CHistogramColumns::FPredicateWalker
+//
+//	@doc:
+//		Walker collecting the columns referenced in a predicate
+//
+//---------------------------------------------------------------------------
+BOOL
+CHistogramColumns::FPredicateWalker
+	(
+	Node *pnode,
+	void *pvCtx
+	)
+{
+	if (NULL == pnode)
+	{
+		return false;
+	}
+
+	SCollectContext *pctx = (SCollectContext *) pvCtx;
+
+	if (IsA(pnode, Var))
+	{
+		CollectVar((Var *) pnode, pctx->m_pql, pctx);
+		return false;
+	}
+
+	if (IsA(pnode, SubLink))
+	{
+		SubLink *psublink = (SubLink *) pnode;
+		(void) FPredicateWalker(psublink->testexpr, pctx);
+
+		// the outputs of an IN, ANY or ALL subquery are compared with the
+		// test expression
+		if (ANY_SUBLINK == psublink->subLinkType ||
+			ALL_SUBLINK == psublink->subLinkType ||
+			ROWCOMPARE_SUBLINK == psublink->subLinkType)
+		{
+			CollectOutputColumn((Query *) psublink->subselect, pctx->m_pql, 0 /*iAttno*/, pctx);
+		}
+
+		CollectQuery((Query *) psublink->subselect, pctx->m_pql, pctx);
+		return false;
+	}
+
+	if (IsA(pnode, Query))
+	{
+		CollectQuery((Query *) pnode, pctx->m_pql, pctx);
+		return false;
+	}
+
+	return gpdb::FWalkExpressionTree
+			(
+			pnode,
+			(BOOL (*)()) CHistogramColumns::FPredicateWalker,
+			pvCtx
+			);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CHistogramColumns::FSubqueryWalker
+//
+//	@doc:
+//		Walker collecting the predicate columns of subqueries in expressions
+//		that are not predicates themselves
+//
+//---------------------------------------------------------------------------
+BOOL
+CHistogramColumns::FSubqueryWalker
+	(
+	Node *pnode,
+	void *pvCtx
+	)
+{
+	if (NULL == pnode)
+	{
+		return false;
+	}
+
+	if (IsA(pnode, SubLink))
+	{
+		return FPredicateWalker(pnode, pvCtx);
+	}
+
+	if (IsA(pnode, Query))
+	{
+		SCollectContext *pctx = (SCollectContext *) pvCtx;
+		CollectQuery((Query *) pnode, pctx->m_pql, pctx);
+		return false;
+	}
+
+	return gpdb::FWalkExpressionTree
+			(
+			pnode,
+			(BOOL (*)()) CHistogramColumns::FSubqueryWalker,
+			pvCtx
+			);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CHistogramColumns::CHistogramColumns
+//
+//	@doc:
+//		Compute the histogram columns of the query to be optimized; without
+//		fLazy, or if the query cannot be analyzed, every column needs one.
+//		The sets are allocated in the current memory context.
+//
+//---------------------------------------------------------------------------
+CHistogramColumns::CHistogramColumns
+	(
+	Query *pquery,
+	BOOL fLazy,
+	CScalarOnlyColStats *pscos
+	)
+	:
+	m_fActive(false),
+	m_plRelColumns(NIL),
+	m_pscos(pscos)
+{
+	GPOS_ASSERT(NULL != pquery);
+	GPOS_ASSERT(NULL != pscos);
+
+	if (fLazy)
+	{
+		SCollectContext ctx = {NULL, 0, false, NIL};
+		CollectQuery(pquery, NULL /*pqlParent*/, &ctx);
+
+		if (!ctx.m_fAll)
+		{
+			m_fActive = true;
+			m_plRelColumns = ctx.m_plRelColumns;
+		}
+	}
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CHistogramColumns::FHistogramColumn
+//
+//	@doc:
+//		Is the column one that needs a histogram in this optimization
+//
+//---------------------------------------------------------------------------
+BOOL
+CHistogramColumns::FHistogramColumn
+	(
+	OID oidRel,
+	INT iAttno
+	)
+	const
+{
+	return !m_fActive || FMember(m_plRelColumns, oidRel, iAttno);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CHistogramColumns::FNeedsHistogram
+//
+//	@doc:
+//		Does the column need a histogram in this optimization. If not, its
+//		statistics entry, which is about to be stored in the MD cache, is
+//		recorded as scalar-only.
+//
+//---------------------------------------------------------------------------
+BOOL
+CHistogramColumns::FNeedsHistogram
+	(
+	OID oidRel,
+	INT iAttno,
+	ULONG ulPos
+	)
+{
+	if (FHistogramColumn(oidRel, iAttno))
+	{
+		return true;
+	}
+
+	m_pscos->Add(oidRel, iAttno, ulPos);
+
+	return false;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CScalarOnlyColStats::CScalarOnlyColStats
+//
+//	@doc:
+//		Ctor
+//
+//---------------------------------------------------------------------------
+CScalarOnlyColStats::CScalarOnlyColStats()
+	:
+	m_plColumns(NIL)
+{
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CScalarOnlyColStats::Add
+//
+//	@doc:
+//		Record the statistics entry of a column; the record must survive
+//		the current query, like the MD cache
+//
+//---------------------------------------------------------------------------
+void
+CScalarOnlyColStats::Add
+	(
+	OID oidRel,
+	INT iAttno,
+	ULONG ulPos
+	)
+{
+	ListCell *plc = NULL;
+	ForEach (plc, m_plColumns)
+	{
+		SColStatsEntry *pentry = (SColStatsEntry *) lfirst(plc);
+		if (pentry->oidRel == oidRel && pentry->ulPos == ulPos)
+		{
+			return;
+		}
+	}
+
+	MemoryContext mcxtOld = MemoryContextSwitchTo(TopMemoryContext);
+	SColStatsEntry *pentry = (SColStatsEntry *) gpdb::GPDBAlloc(sizeof(SColStatsEntry));
+	pentry->oidRel = oidRel;
+	pentry->iAttno = iAttno;
+	pentry->ulPos = ulPos;
+	m_plColumns = gpdb::PlAppendElement(m_plColumns, pentry);
+	MemoryContextSwitchTo(mcxtOld);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CScalarOnlyColStats::EvictStale
+//
+//	@doc:
+//		Evict the recorded entries of columns that need histograms in the
+//		given optimization from the MD cache, so that the relcache
+//		translator is asked for full statistics. Must be called before the
+//		optimization accesses the cache.
+//
+//---------------------------------------------------------------------------
+void
+CScalarOnlyColStats::EvictStale
+	(
+	IMemoryPool *pmp,
+	const CHistogramColumns *phistcols
+	)
+{
+	GPOS_ASSERT(CMDCache::FInitialized());
+
+	List *plKept = NIL;
+
+	ListCell *plc = NULL;
+	ForEach (plc, m_plColumns)
+	{
+		SColStatsEntry *pentry = (SColStatsEntry *) lfirst(plc);
+		if (!phistcols->FHistogramColumn(pentry->oidRel, pentry->iAttno))
+		{
+			MemoryContext mcxtOld = MemoryContextSwitchTo(TopMemoryContext);
+			plKept = gpdb::PlAppendElement(plKept, pentry);
+			MemoryContextSwitchTo(mcxtOld);
+			continue;
+		}
+
+		// relation mdids of column statistics carry the default version
+		CMDIdGPDB *pmdidRel = GPOS_NEW(pmp) CMDIdGPDB(pentry->oidRel);
+		CMDIdColStats *pmdidColStats = GPOS_NEW(pmp) CMDIdColStats(pmdidRel, pentry->ulPos);
+		{
+			CMDKey mdkey(pmdidColStats);
+			CCacheAccessor<IMDCacheObject*, CMDKey*> cacheaccessor(CMDCache::Pcache());
+			if (NULL != cacheaccessor.Lookup(&mdkey))
+			{
+				cacheaccessor.MarkForDeletion();
+			}
+		}
+		pmdidColStats->Release();
+
+		gpdb::GPDBFree(pentry);
+	}
+
+	gpdb::FreeList(m_plColumns);
+	m_plColumns = plKept;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CScalarOnlyColStats::Reset
+//
+//	@doc:
+//		The MD cache has been emptied, forget all entries
+//
+//---------------------------------------------------------------------------
+void
+CScalarOnlyColStats::Reset()
+{
+	gpdb::FreeListDeep(m_plColumns);
+	m_plColumns = NIL;
+}
+
+// EOF
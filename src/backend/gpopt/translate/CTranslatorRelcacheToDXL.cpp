@@ -41,6 +41,7 @@
 #include "naucrates/md/CMDArrayCoerceCastGPDB.h"
 #include "naucrates/md/CMDScCmpGPDB.h"
 
+#include "gpopt/translate/CHistogramColumns.h"
 #include "gpopt/translate/CTranslatorUtils.h"
 #include "gpopt/translate/CTranslatorRelcacheToDXL.h"
 #include "gpopt/translate/CTranslatorScalarToDXL.h"
@@ -99,7 +100,8 @@ CTranslatorRelcacheToDXL::Pimdobj
 	(
 	IMemoryPool *pmp,
 	CMDAccessor *pmda,
-	IMDId *pmdid
+	IMDId *pmdid,
+	CHistogramColumns *phistcols
 	)
 {
 	IMDCacheObject *pmdcacheobj = NULL;
@@ -116,7 +118,7 @@ CTranslatorRelcacheToDXL::Pimdobj
 			break;
 		
 		case IMDId::EmdidColStats:
-			pmdcacheobj = PimdobjColStats(pmp, pmda, pmdid);
+			pmdcacheobj = PimdobjColStats(pmp, pmda, pmdid, phistcols);
 			break;
 		
 		case IMDId::EmdidCastFunc:
@@ -2220,7 +2222,8 @@ CTranslatorRelcacheToDXL::PimdobjColStats
 	(
 	IMemoryPool *pmp,
 	CMDAccessor *pmda,
-	IMDId *pmdid
+	IMDId *pmdid,
+	CHistogramColumns *phistcols
 	)
 {
 	CMDIdColStats *pmdidColStats = CMDIdColStats::PmdidConvert(pmdid);
@@ -2287,6 +2290,23 @@ CTranslatorRelcacheToDXL::PimdobjColStats
 		return CDXLColStats::PdxlcolstatsDummy(pmp, pmdidColStats, pmdnameCol, dWidth);
 	}
 
+	// columns not referenced in predicates only need scalar statistics,
+	// skip extracting and transforming MCVs and histogram
+	if (NULL != phistcols && !phistcols->FNeedsHistogram(oidRelation, attrnum, ulPos))
+	{
+		CDXLColStats *pdxlcolstats = PdxlcolstatsScalar
+										(
+										pmp,
+										pmdidColStats,
+										pmdnameCol,
+										(Form_pg_statistic) GETSTRUCT(heaptupleStats),
+										pdrgpdxlbucket,
+										dRows
+										);
+		gpdb::FreeHeapTuple(heaptupleStats);
+
+		return pdxlcolstats;
+	}
 
 	Datum	   *pdrgdatumMCVValues = NULL;
 	int			iNumMCVValues = 0;
@@ -2447,6 +2467,75 @@ CTranslatorRelcacheToDXL::PimdobjColStats
 }
 
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CTranslatorRelcacheToDXL::PdxlcolstatsScalar
+//
+//	@doc:
+//		Generate column statistics without buckets from a pg_statistic
+//		entry: all non-null values are accounted for as remaining values
+//
+//---------------------------------------------------------------------------
+CDXLColStats *
+CTranslatorRelcacheToDXL::PdxlcolstatsScalar
+	(
+	IMemoryPool *pmp,
+	CMDIdColStats *pmdidColStats,
+	CMDName *pmdnameCol,
+	Form_pg_statistic fpsStats,
+	DrgPdxlbucket *pdrgpdxlbucket,
+	CDouble dRows
+	)
+{
+	GPOS_ASSERT(NULL != fpsStats);
+	GPOS_ASSERT(0 == pdrgpdxlbucket->UlLength());
+
+	CDouble dNullFrequency(0.0);
+	int iNullNDV = 0;
+	if (CStatistics::DEpsilon < fpsStats->stanullfrac)
+	{
+		dNullFrequency = std::min(CDouble(1.0), CDouble(fpsStats->stanullfrac));
+		iNullNDV = 1;
+	}
+
+	CDouble dDistinct(1.0);
+	if (fpsStats->stadistinct < 0)
+	{
+		GPOS_ASSERT(fpsStats->stadistinct > -1.01);
+		dDistinct = dRows * CDouble(-fpsStats->stadistinct);
+	}
+	else
+	{
+		dDistinct = CDouble(fpsStats->stadistinct);
+	}
+	dDistinct = dDistinct.FpCeil();
+
+	// same as the remainder computed for a column without buckets
+	CDouble dDistinctRemain(0.0);
+	CDouble dFreqRemain(0.0);
+	if ((1 - CStatistics::DEpsilon > dNullFrequency) &&
+		(0 < dDistinct - iNullNDV))
+	{
+		dDistinctRemain = dDistinct - iNullNDV;
+		dFreqRemain = 1 - dNullFrequency;
+	}
+
+	pmdidColStats->AddRef();
+	return GPOS_NEW(pmp) CDXLColStats
+							(
+							pmp,
+							pmdidColStats,
+							pmdnameCol,
+							CDouble(fpsStats->stawidth),
+							dNullFrequency,
+							dDistinctRemain,
+							dFreqRemain,
+							pdrgpdxlbucket,
+							false /* fColStatsMissing */
+							);
+}
+
+
 //---------------------------------------------------------------------------
 //      @function:
 //              CTranslatorRelcacheToDXL::PdxlcolstatsSystemColumn
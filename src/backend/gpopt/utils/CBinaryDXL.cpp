@@ -0,0 +1,1175 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2017 Pivotal Software, Inc.
+//
+//	@filename:
+//		CBinaryDXL.cpp
+//
+//	@doc:
+//		Compact binary encoding of DXL documents
+//
+//		Layout of an encoded document:
+//
+//			bytes  0-3	magic "BDXL"
+//			byte   4	format version
+//			byte   5	flags (BDXL_FLAG_COMPRESSED)
+//			bytes  6-7	reserved, zero
+//			bytes  8-11	length of the uncompressed token stream
+//			bytes 12-15	length of the decoded XML document
+//			bytes 16-19	length of the structure part of the token stream
+//			bytes 20-	token stream, zlib compressed if flagged
+//
+//		Integers in the header are little-endian. The token stream consists
+//		of a structure part, holding opcodes and string references, followed
+//		by a literal part, holding the bytes of strings seen for the first
+//		time. Keeping the literals together lets zlib find the repetitions
+//		in attribute values that the dictionary does not cover.
+//
+//		A string reference is a varint: 0 introduces a literal, whose varint
+//		length follows in the structure part and whose bytes are taken from
+//		the literal part; n > 0 refers to the (n-1)th dictionary entry.
+//		Literals no longer than BDXL_MAX_DICT_STRLEN are appended to the
+//		dictionary by both encoder and decoder, until it holds
+//		BDXL_MAX_DICT_ENTRIES strings.
+//
+//	@test:
+//
+//
+//---------------------------------------------------------------------------
+
+#include "gpopt/utils/CBinaryDXL.h"
+
+extern "C" {
+#include <zlib.h>
+
+#include "storage/fd.h"
+#include "utils/memutils.h"
+#include "utils/hsearch.h"
+}
+
+// token stream is compressed
+#define BDXL_FLAG_COMPRESSED	0x01
+
+// longest string that is entered into the dictionary
+#define BDXL_MAX_DICT_STRLEN	64
+
+// maximum number of dictionary entries
+#define BDXL_MAX_DICT_ENTRIES	65536
+
+// zlib compression level of the token stream
+#define BDXL_ZLIB_LEVEL			6
+
+// dictionary key and entry used by the encoder
+typedef struct SDictKey
+{
+	uint32		ulLen;
+	char		rgch[BDXL_MAX_DICT_STRLEN];
+} SDictKey;
+
+typedef struct SDictEntry
+{
+	SDictKey	key;
+	uint32		ulIndex;
+} SDictEntry;
+
+struct CBinaryDXL::SEncodeState
+{
+	// structure part of the token stream
+	StringInfoData m_str;
+
+	// literal part of the token stream
+	StringInfoData m_strLiterals;
+
+	// string -> dictionary index
+	HTAB *m_phtab;
+
+	// number of dictionary entries
+	uint32 m_ulEntries;
+};
+
+struct CBinaryDXL::SDecodeState
+{
+	// structure part of the token stream
+	const unsigned char *m_pc;
+	const unsigned char *m_pcEnd;
+
+	// literal part of the token stream
+	const unsigned char *m_pcLiterals;
+	const unsigned char *m_pcLiteralsEnd;
+
+	// dictionary entries, not null-terminated
+	const char **m_rgpcDict;
+	uint32 *m_rgulLen;
+	uint32 m_ulEntries;
+	uint32 m_ulMaxEntries;
+};
+
+// is the character allowed in a tag or attribute name
+static inline bool
+FNameChar
+	(
+	char c
+	)
+{
+	return !(' ' == c || '\t' == c || '\n' == c || '\r' == c ||
+			 '<' == c || '>' == c || '/' == c || '=' == c ||
+			 '"' == c || '\'' == c || '\0' == c);
+}
+
+// scan a name starting at pc, returning its length
+static inline uint32
+UlNameLength
+	(
+	const char *pc,
+	uint32 ulLen
+	)
+{
+	uint32 ul = 0;
+	while (ul < ulLen && FNameChar(pc[ul]))
+	{
+		ul++;
+	}
+	return ul;
+}
+
+static inline void
+StoreUint32
+	(
+	unsigned char *pc,
+	uint32 ul
+	)
+{
+	pc[0] = (unsigned char) (ul & 0xff);
+	pc[1] = (unsigned char) ((ul >> 8) & 0xff);
+	pc[2] = (unsigned char) ((ul >> 16) & 0xff);
+	pc[3] = (unsigned char) ((ul >> 24) & 0xff);
+}
+
+static inline uint32
+UlLoadUint32
+	(
+	const unsigned char *pc
+	)
+{
+	return (uint32) pc[0] | ((uint32) pc[1] << 8) |
+		((uint32) pc[2] << 16) | ((uint32) pc[3] << 24);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CBinaryDXL::AppendVarint
+//
+//	@doc:
+//		Append an unsigned integer using 7 bits per byte, low bits first
+//
+//---------------------------------------------------------------------------
+void
+CBinaryDXL::AppendVarint
+	(
+	StringInfo str,
+	uint32 ul
+	)
+{
+	while (ul >= 0x80)
+	{
+		appendStringInfoCharMacro(str, (char) ((ul & 0x7f) | 0x80));
+		ul >>= 7;
+	}
+	appendStringInfoCharMacro(str, (char) ul);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CBinaryDXL::AppendString
+//
+//	@doc:
+//		Append a reference to a dictionary string, or a literal if the string
+//		has not been seen before
+//
+//---------------------------------------------------------------------------
+void
+CBinaryDXL::AppendString
+	(
+	SEncodeState *pes,
+	const char *pc,
+	uint32 ulLen
+	)
+{
+	if (ulLen <= BDXL_MAX_DICT_STRLEN)
+	{
+		SDictKey key;
+		memset(&key, 0, sizeof(key));
+		key.ulLen = ulLen;
+		memcpy(key.rgch, pc, ulLen);
+
+		SDictEntry *pentry = (SDictEntry *) hash_search(pes->m_phtab, &key, HASH_FIND, NULL);
+		if (NULL != pentry)
+		{
+			AppendVarint(&pes->m_str, pentry->ulIndex + 1);
+			return;
+		}
+
+		if (pes->m_ulEntries < BDXL_MAX_DICT_ENTRIES)
+		{
+			bool fFound = false;
+			pentry = (SDictEntry *) hash_search(pes->m_phtab, &key, HASH_ENTER, &fFound);
+			Assert(!fFound);
+			pentry->ulIndex = pes->m_ulEntries++;
+		}
+	}
+
+	AppendVarint(&pes->m_str, 0);
+	AppendVarint(&pes->m_str, ulLen);
+	appendBinaryStringInfo(&pes->m_strLiterals, pc, ulLen);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CBinaryDXL::UlScanTag
+//
+//	@doc:
+//		Scan the tag starting at pc. Only tags exactly in the form written by
+//		the DXL serializer are accepted:
+//
+//			'<' name (' ' name '="' value '"')* ('>' | '/>')
+//			'</' name '>'
+//
+//		If pes is NULL the tag is only validated, otherwise its tokens are
+//		appended to the stream. Returns the number of bytes consumed, or 0
+//		if the tag must be copied verbatim.
+//
+//---------------------------------------------------------------------------
+uint32
+CBinaryDXL::UlScanTag
+	(
+	SEncodeState *pes,
+	const char *pc,
+	uint32 ulLen
+	)
+{
+	Assert(0 < ulLen && '<' == pc[0]);
+
+	uint32 ulPos = 1;
+
+	if (ulPos < ulLen && '/' == pc[ulPos])
+	{
+		ulPos++;
+		uint32 ulName = UlNameLength(pc + ulPos, ulLen - ulPos);
+		if (0 == ulName || ulPos + ulName >= ulLen || '>' != pc[ulPos + ulName])
+		{
+			return 0;
+		}
+
+		if (NULL != pes)
+		{
+			appendStringInfoCharMacro(&pes->m_str, (char) EopEndTag);
+			AppendString(pes, pc + ulPos, ulName);
+		}
+		return ulPos + ulName + 1;
+	}
+
+	uint32 ulName = UlNameLength(pc + ulPos, ulLen - ulPos);
+	if (0 == ulName)
+	{
+		return 0;
+	}
+
+	if (NULL != pes)
+	{
+		appendStringInfoCharMacro(&pes->m_str, (char) EopStartTag);
+		AppendString(pes, pc + ulPos, ulName);
+	}
+	ulPos += ulName;
+
+	while (ulPos < ulLen)
+	{
+		if ('>' == pc[ulPos])
+		{
+			if (NULL != pes)
+			{
+				appendStringInfoCharMacro(&pes->m_str, (char) EopStartTagClose);
+			}
+			return ulPos + 1;
+		}
+
+		if ('/' == pc[ulPos])
+		{
+			if (ulPos + 1 >= ulLen || '>' != pc[ulPos + 1])
+			{
+				return 0;
+			}
+			if (NULL != pes)
+			{
+				appendStringInfoCharMacro(&pes->m_str, (char) EopEmptyTagClose);
+			}
+			return ulPos + 2;
+		}
+
+		// attribute: ' ' name '="' value '"'
+		if (' ' != pc[ulPos])
+		{
+			return 0;
+		}
+		ulPos++;
+
+		uint32 ulAttrName = UlNameLength(pc + ulPos, ulLen - ulPos);
+		if (0 == ulAttrName || ulPos + ulAttrName + 2 > ulLen ||
+			'=' != pc[ulPos + ulAttrName] || '"' != pc[ulPos + ulAttrName + 1])
+		{
+			return 0;
+		}
+		const char *pcAttrName = pc + ulPos;
+		ulPos += ulAttrName + 2;
+
+		const char *pcValue = pc + ulPos;
+		uint32 ulValue = 0;
+		while (ulPos + ulValue < ulLen && '"' != pcValue[ulValue])
+		{
+			if ('<' == pcValue[ulValue] || '\0' == pcValue[ulValue])
+			{
+				return 0;
+			}
+			ulValue++;
+		}
+		if (ulPos + ulValue >= ulLen)
+		{
+			return 0;
+		}
+
+		if (NULL != pes)
+		{
+			appendStringInfoCharMacro(&pes->m_str, (char) EopAttribute);
+			AppendString(pes, pcAttrName, ulAttrName);
+			AppendString(pes, pcValue, ulValue);
+		}
+		ulPos += ulValue + 1;
+	}
+
+	// unterminated tag
+	return 0;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CBinaryDXL::UlRawMarkupLength
+//
+//	@doc:
+//		Length of the markup starting at pc, for markup that is copied
+//		verbatim: comments, CDATA sections, processing instructions and tags
+//		that are not in canonical form
+//
+//---------------------------------------------------------------------------
+uint32
+CBinaryDXL::UlRawMarkupLength
+	(
+	const char *pc,
+	uint32 ulLen
+	)
+{
+	const char *szTerminator = NULL;
+
+	if (4 <= ulLen && 0 == strncmp(pc, "<!--", 4))
+	{
+		szTerminator = "-->";
+	}
+	else if (9 <= ulLen && 0 == strncmp(pc, "<![CDATA[", 9))
+	{
+		szTerminator = "]]>";
+	}
+	else if (2 <= ulLen && 0 == strncmp(pc, "<?", 2))
+	{
+		szTerminator = "?>";
+	}
+
+	if (NULL != szTerminator)
+	{
+		uint32 ulTerm = strlen(szTerminator);
+		for (uint32 ul = 1; ul + ulTerm <= ulLen; ul++)
+		{
+			if (0 == strncmp(pc + ul, szTerminator, ulTerm))
+			{
+				return ul + ulTerm;
+			}
+		}
+		return ulLen;
+	}
+
+	// any other markup extends to the first '>' outside of quotes
+	char cQuote = '\0';
+	for (uint32 ul = 1; ul < ulLen; ul++)
+	{
+		if ('\0' != cQuote)
+		{
+			if (cQuote == pc[ul])
+			{
+				cQuote = '\0';
+			}
+		}
+		else if ('"' == pc[ul] || '\'' == pc[ul])
+		{
+			cQuote = pc[ul];
+		}
+		else if ('>' == pc[ul])
+		{
+			return ul + 1;
+		}
+	}
+	return ulLen;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CBinaryDXL::FBinaryDXL
+//
+//	@doc:
+//		Does the buffer start with a binary DXL header
+//
+//---------------------------------------------------------------------------
+bool
+CBinaryDXL::FBinaryDXL
+	(
+	const char *pc,
+	uint32 ulLen
+	)
+{
+	return BDXL_HEADER_LEN <= ulLen &&
+		0 == memcmp(pc, BDXL_MAGIC, BDXL_MAGIC_LEN);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CBinaryDXL::PcEncode
+//
+//	@doc:
+//		Encode an XML document
+//
+//---------------------------------------------------------------------------
+char *
+CBinaryDXL::PcEncode
+	(
+	const char *szXML,
+	uint32 ulXMLLen,
+	uint32 *pulLen
+	)
+{
+	Assert(NULL != szXML);
+	Assert(NULL != pulLen);
+
+	SEncodeState es;
+	initStringInfo(&es.m_str);
+	initStringInfo(&es.m_strLiterals);
+	es.m_ulEntries = 0;
+
+	HASHCTL hashctl;
+	MemSet(&hashctl, 0, sizeof(hashctl));
+	hashctl.keysize = sizeof(SDictKey);
+	hashctl.entrysize = sizeof(SDictEntry);
+	hashctl.hash = tag_hash;
+	hashctl.hcxt = CurrentMemoryContext;
+	es.m_phtab = hash_create("binary DXL dictionary", 1024, &hashctl, HASH_ELEM | HASH_FUNCTION | HASH_CONTEXT);
+
+	uint32 ulPos = 0;
+	while (ulPos < ulXMLLen)
+	{
+		const char *pc = szXML + ulPos;
+		uint32 ulRemaining = ulXMLLen - ulPos;
+		uint32 ulConsumed = 0;
+
+		if ('<' != pc[0])
+		{
+			const char *pcNext = (const char *) memchr(pc, '<', ulRemaining);
+			ulConsumed = (NULL == pcNext) ? ulRemaining : (uint32) (pcNext - pc);
+		}
+		else if (0 < UlScanTag(NULL /*pes*/, pc, ulRemaining))
+		{
+			ulPos += UlScanTag(&es, pc, ulRemaining);
+			continue;
+		}
+		else
+		{
+			ulConsumed = UlRawMarkupLength(pc, ulRemaining);
+		}
+
+		appendStringInfoCharMacro(&es.m_str, (char) EopText);
+		AppendString(&es, pc, ulConsumed);
+		ulPos += ulConsumed;
+	}
+
+	hash_destroy(es.m_phtab);
+
+	uint32 ulStructureLen = es.m_str.len;
+	appendBinaryStringInfo(&es.m_str, es.m_strLiterals.data, es.m_strLiterals.len);
+	pfree(es.m_strLiterals.data);
+
+	// compress the token stream, keeping it as is if that does not help
+	uLongf ulCompressed = compressBound(es.m_str.len);
+	char *pcResult = (char *) palloc(BDXL_HEADER_LEN + ulCompressed);
+	unsigned char flags = 0;
+
+	int iRes = compress2((Bytef *) pcResult + BDXL_HEADER_LEN, &ulCompressed,
+						 (const Bytef *) es.m_str.data, es.m_str.len, BDXL_ZLIB_LEVEL);
+	if (Z_OK == iRes && ulCompressed < (uLongf) es.m_str.len)
+	{
+		flags |= BDXL_FLAG_COMPRESSED;
+	}
+	else
+	{
+		memcpy(pcResult + BDXL_HEADER_LEN, es.m_str.data, es.m_str.len);
+		ulCompressed = es.m_str.len;
+	}
+
+	unsigned char *pcHeader = (unsigned char *) pcResult;
+	memcpy(pcHeader, BDXL_MAGIC, BDXL_MAGIC_LEN);
+	pcHeader[4] = BDXL_VERSION;
+	pcHeader[5] = flags;
+	pcHeader[6] = 0;
+	pcHeader[7] = 0;
+	StoreUint32(pcHeader + 8, es.m_str.len);
+	StoreUint32(pcHeader + 12, ulXMLLen);
+	StoreUint32(pcHeader + 16, ulStructureLen);
+
+	pfree(es.m_str.data);
+
+	*pulLen = BDXL_HEADER_LEN + (uint32) ulCompressed;
+	return pcResult;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CBinaryDXL::ReportCorrupt
+//
+//	@doc:
+//		Report a malformed binary DXL document
+//
+//---------------------------------------------------------------------------
+void
+CBinaryDXL::ReportCorrupt
+	(
+	const char *szDetail
+	)
+{
+	ereport(ERROR,
+			(errcode(ERRCODE_DATA_CORRUPTED),
+			 errmsg("invalid binary DXL document"),
+			 errdetail("%s", szDetail)));
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CBinaryDXL::UlReadVarint
+//
+//	@doc:
+//		Read an unsigned integer written by AppendVarint
+//
+//---------------------------------------------------------------------------
+uint32
+CBinaryDXL::UlReadVarint
+	(
+	SDecodeState *pds
+	)
+{
+	uint32 ul = 0;
+	for (int iShift = 0; iShift < 35; iShift += 7)
+	{
+		if (pds->m_pc >= pds->m_pcEnd)
+		{
+			ReportCorrupt("Token stream ends in the middle of an integer.");
+		}
+
+		unsigned char c = *pds->m_pc++;
+		ul |= (uint32) (c & 0x7f) << iShift;
+		if (0 == (c & 0x80))
+		{
+			return ul;
+		}
+	}
+
+	ReportCorrupt("Integer in token stream is too long.");
+	return 0;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CBinaryDXL::ReadString
+//
+//	@doc:
+//		Read a string reference, returning the string it refers to
+//
+//---------------------------------------------------------------------------
+void
+CBinaryDXL::ReadString
+	(
+	SDecodeState *pds,
+	const char **ppc,
+	uint32 *pulLen
+	)
+{
+	uint32 ulRef = UlReadVarint(pds);
+
+	if (0 < ulRef)
+	{
+		if (ulRef > pds->m_ulEntries)
+		{
+			ReportCorrupt("Reference to an undefined dictionary entry.");
+		}
+		*ppc = pds->m_rgpcDict[ulRef - 1];
+		*pulLen = pds->m_rgulLen[ulRef - 1];
+		return;
+	}
+
+	uint32 ulLen = UlReadVarint(pds);
+	if ((uint32) (pds->m_pcLiteralsEnd - pds->m_pcLiterals) < ulLen)
+	{
+		ReportCorrupt("String extends past the end of the token stream.");
+	}
+
+	const char *pc = (const char *) pds->m_pcLiterals;
+	pds->m_pcLiterals += ulLen;
+
+	if (ulLen <= BDXL_MAX_DICT_STRLEN && pds->m_ulEntries < pds->m_ulMaxEntries)
+	{
+		// dictionary entries point into the token stream, which outlives them
+		pds->m_rgpcDict[pds->m_ulEntries] = pc;
+		pds->m_rgulLen[pds->m_ulEntries] = ulLen;
+		pds->m_ulEntries++;
+	}
+
+	*ppc = pc;
+	*pulLen = ulLen;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CBinaryDXL::Walk
+//
+//	@doc:
+//		Pass the tokens of a stream to a handler, checking that the stream
+//		decodes to a document of the length recorded in the header
+//
+//---------------------------------------------------------------------------
+void
+CBinaryDXL::Walk
+	(
+	const SBinaryDXLStream *pbdxls,
+	IBinaryDXLHandler *phandler,
+	const char **rgpcDict,
+	uint32 *rgulDictLen
+	)
+{
+	SDecodeState ds;
+	ds.m_pc = (const unsigned char *) pbdxls->m_pcStream;
+	ds.m_pcEnd = ds.m_pc + pbdxls->m_ulStructureLen;
+	ds.m_pcLiterals = ds.m_pcEnd;
+	ds.m_pcLiteralsEnd = ds.m_pc + pbdxls->m_ulStreamLen;
+	ds.m_rgpcDict = rgpcDict;
+	ds.m_rgulLen = rgulDictLen;
+	ds.m_ulEntries = 0;
+	ds.m_ulMaxEntries = pbdxls->m_ulMaxEntries;
+
+	uint64 ullDecodedLen = 0;
+
+	while (ds.m_pc < ds.m_pcEnd)
+	{
+		EOpcode eop = (EOpcode) *ds.m_pc++;
+		const char *pcName = NULL;
+		const char *pcValue = NULL;
+		uint32 ulNameLen = 0;
+		uint32 ulValueLen = 0;
+
+		switch (eop)
+		{
+			case EopStartTag:
+				ReadString(&ds, &pcName, &ulNameLen);
+				ullDecodedLen += 1 + ulNameLen;
+				break;
+
+			case EopAttribute:
+				ReadString(&ds, &pcName, &ulNameLen);
+				ReadString(&ds, &pcValue, &ulValueLen);
+				ullDecodedLen += 4 + ulNameLen + ulValueLen;
+				break;
+
+			case EopStartTagClose:
+				ullDecodedLen += 1;
+				break;
+
+			case EopEmptyTagClose:
+				ullDecodedLen += 2;
+				break;
+
+			case EopEndTag:
+				ReadString(&ds, &pcName, &ulNameLen);
+				ullDecodedLen += 3 + ulNameLen;
+				break;
+
+			case EopText:
+				ReadString(&ds, &pcValue, &ulValueLen);
+				ullDecodedLen += ulValueLen;
+				break;
+
+			default:
+				ReportCorrupt("Unknown opcode in token stream.");
+		}
+
+		if (ullDecodedLen > pbdxls->m_ulXMLLen)
+		{
+			ReportCorrupt("Decoded document is longer than recorded in the header.");
+		}
+
+		switch (eop)
+		{
+			case EopStartTag:
+				phandler->StartTag(pcName, ulNameLen);
+				break;
+			case EopAttribute:
+				phandler->Attribute(pcName, ulNameLen, pcValue, ulValueLen);
+				break;
+			case EopStartTagClose:
+			case EopEmptyTagClose:
+				phandler->StartTagClose(EopEmptyTagClose == eop);
+				break;
+			case EopEndTag:
+				phandler->EndTag(pcName, ulNameLen);
+				break;
+			default:
+				phandler->Text(pcValue, ulValueLen);
+				break;
+		}
+	}
+
+	if (ullDecodedLen != pbdxls->m_ulXMLLen || ds.m_pcLiterals != ds.m_pcLiteralsEnd)
+	{
+		ReportCorrupt("Decoded document does not match the header.");
+	}
+}
+
+//---------------------------------------------------------------------------
+//	@class:
+//		CXMLWriter
+//
+//	@doc:
+//		Token handler that reproduces the original document
+//
+//---------------------------------------------------------------------------
+class CXMLWriter : public IBinaryDXLHandler
+{
+	private:
+
+		StringInfo m_str;
+
+	public:
+
+		explicit
+		CXMLWriter(StringInfo str)
+			:
+			m_str(str)
+		{}
+
+		virtual
+		void StartTag(const char *pcName, uint32 ulNameLen)
+		{
+			appendStringInfoCharMacro(m_str, '<');
+			appendBinaryStringInfo(m_str, pcName, ulNameLen);
+		}
+
+		virtual
+		void Attribute(const char *pcName, uint32 ulNameLen, const char *pcValue, uint32 ulValueLen)
+		{
+			appendStringInfoCharMacro(m_str, ' ');
+			appendBinaryStringInfo(m_str, pcName, ulNameLen);
+			appendBinaryStringInfo(m_str, "=\"", 2);
+			appendBinaryStringInfo(m_str, pcValue, ulValueLen);
+			appendStringInfoCharMacro(m_str, '"');
+		}
+
+		virtual
+		void StartTagClose(bool fEmpty)
+		{
+			if (fEmpty)
+			{
+				appendBinaryStringInfo(m_str, "/>", 2);
+			}
+			else
+			{
+				appendStringInfoCharMacro(m_str, '>');
+			}
+		}
+
+		virtual
+		void EndTag(const char *pcName, uint32 ulNameLen)
+		{
+			appendBinaryStringInfo(m_str, "</", 2);
+			appendBinaryStringInfo(m_str, pcName, ulNameLen);
+			appendStringInfoCharMacro(m_str, '>');
+		}
+
+		virtual
+		void Text(const char *pc, uint32 ulLen)
+		{
+			appendBinaryStringInfo(m_str, pc, ulLen);
+		}
+};
+
+//---------------------------------------------------------------------------
+//	@class:
+//		CReplayCheck
+//
+//	@doc:
+//		Token handler that finds out whether a document can be replayed as
+//		parser events: its elements must nest, and all markup copied
+//		verbatim must be markup the parser would skip
+//
+//---------------------------------------------------------------------------
+class CReplayCheck : public IBinaryDXLHandler
+{
+	private:
+
+		// depth of the current element
+		int64 m_lDepth;
+
+		bool m_fReplayable;
+
+	public:
+
+		CReplayCheck()
+			:
+			m_lDepth(0),
+			m_fReplayable(true)
+		{}
+
+		bool FReplayable() const
+		{
+			return m_fReplayable && 0 == m_lDepth;
+		}
+
+		virtual
+		void StartTag(const char *, uint32)
+		{}
+
+		virtual
+		void Attribute(const char *, uint32, const char *, uint32)
+		{}
+
+		virtual
+		void StartTagClose(bool fEmpty)
+		{
+			if (!fEmpty)
+			{
+				m_lDepth++;
+			}
+		}
+
+		virtual
+		void EndTag(const char *, uint32)
+		{
+			if (0 == m_lDepth--)
+			{
+				m_fReplayable = false;
+			}
+		}
+
+		virtual
+		void Text(const char *pc, uint32 ulLen)
+		{
+			if (0 < ulLen && '<' == pc[0] && !CBinaryDXL::FReplayableMarkup(pc, ulLen))
+			{
+				m_fReplayable = false;
+			}
+		}
+};
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CBinaryDXL::FReplayableMarkup
+//
+//	@doc:
+//		Markup copied verbatim that a parser consumes without reporting
+//		elements: comments, processing instructions (including the XML
+//		declaration) and CDATA sections, whose content is character data
+//
+//---------------------------------------------------------------------------
+bool
+CBinaryDXL::FReplayableMarkup
+	(
+	const char *pc,
+	uint32 ulLen
+	)
+{
+	return (7 <= ulLen && 0 == strncmp(pc, "<!--", 4) && 0 == strncmp(pc + ulLen - 3, "-->", 3)) ||
+		(4 <= ulLen && 0 == strncmp(pc, "<?", 2) && 0 == strncmp(pc + ulLen - 2, "?>", 2)) ||
+		(12 <= ulLen && 0 == strncmp(pc, "<![CDATA[", 9) && 0 == strncmp(pc + ulLen - 3, "]]>", 3));
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CBinaryDXL::PbdxlsInflate
+//
+//	@doc:
+//		Check the header of a binary DXL document, decompress its token
+//		stream and validate it. If the document cannot be replayed as
+//		parser events, it is also decoded to text.
+//
+//---------------------------------------------------------------------------
+SBinaryDXLStream *
+CBinaryDXL::PbdxlsInflate
+	(
+	const char *pc,
+	uint32 ulLen
+	)
+{
+	if (!FBinaryDXL(pc, ulLen))
+	{
+		ReportCorrupt("Missing binary DXL header.");
+	}
+
+	const unsigned char *pcHeader = (const unsigned char *) pc;
+	if (BDXL_VERSION != pcHeader[4])
+	{
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("unsupported binary DXL format version %d", (int) pcHeader[4])));
+	}
+
+	uint32 ulStreamLen = UlLoadUint32(pcHeader + 8);
+	uint32 ulXMLLen = UlLoadUint32(pcHeader + 12);
+	uint32 ulStructureLen = UlLoadUint32(pcHeader + 16);
+	if (!AllocSizeIsValid(ulStreamLen) || !AllocSizeIsValid((Size) ulXMLLen + 1) ||
+		ulStructureLen > ulStreamLen)
+	{
+		ReportCorrupt("Document length is out of range.");
+	}
+
+	const char *pcPayload = pc + BDXL_HEADER_LEN;
+	uint32 ulPayloadLen = ulLen - BDXL_HEADER_LEN;
+	char *pcStream = (char *) palloc(Max(ulStreamLen, 1));
+
+	if (pcHeader[5] & BDXL_FLAG_COMPRESSED)
+	{
+		uLongf ulDest = ulStreamLen;
+		int iRes = uncompress((Bytef *) pcStream, &ulDest, (const Bytef *) pcPayload, ulPayloadLen);
+		if (Z_OK != iRes || ulDest != ulStreamLen)
+		{
+			ReportCorrupt("Token stream could not be decompressed.");
+		}
+	}
+	else
+	{
+		if (ulPayloadLen != ulStreamLen)
+		{
+			ReportCorrupt("Token stream length does not match the header.");
+		}
+		memcpy(pcStream, pcPayload, ulStreamLen);
+	}
+
+	SBinaryDXLStream *pbdxls = (SBinaryDXLStream *) palloc(sizeof(SBinaryDXLStream));
+	pbdxls->m_pcStream = pcStream;
+	pbdxls->m_ulStreamLen = ulStreamLen;
+	pbdxls->m_ulStructureLen = ulStructureLen;
+	pbdxls->m_ulXMLLen = ulXMLLen;
+	pbdxls->m_szXML = NULL;
+
+	// every dictionary entry costs at least two bytes of the structure part
+	pbdxls->m_ulMaxEntries = Min(ulStructureLen / 2 + 1, BDXL_MAX_DICT_ENTRIES);
+
+	const char **rgpcDict = (const char **) palloc(pbdxls->m_ulMaxEntries * sizeof(char *));
+	uint32 *rgulDictLen = (uint32 *) palloc(pbdxls->m_ulMaxEntries * sizeof(uint32));
+
+	CReplayCheck replaycheck;
+	Walk(pbdxls, &replaycheck, rgpcDict, rgulDictLen);
+
+	if (!replaycheck.FReplayable())
+	{
+		StringInfoData str;
+		initStringInfo(&str);
+		enlargeStringInfo(&str, ulXMLLen);
+
+		CXMLWriter xmlwriter(&str);
+		Walk(pbdxls, &xmlwriter, rgpcDict, rgulDictLen);
+		pbdxls->m_szXML = str.data;
+	}
+
+	pfree(rgpcDict);
+	pfree(rgulDictLen);
+
+	return pbdxls;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CBinaryDXL::FreeStream
+//
+//	@doc:
+//		Free a stream returned by PbdxlsInflate
+//
+//---------------------------------------------------------------------------
+void
+CBinaryDXL::FreeStream
+	(
+	SBinaryDXLStream *pbdxls
+	)
+{
+	if (NULL != pbdxls->m_szXML)
+	{
+		pfree(pbdxls->m_szXML);
+	}
+	pfree(pbdxls->m_pcStream);
+	pfree(pbdxls);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CBinaryDXL::SzDecode
+//
+//	@doc:
+//		Decode a binary DXL document
+//
+//---------------------------------------------------------------------------
+char *
+CBinaryDXL::SzDecode
+	(
+	const char *pc,
+	uint32 ulLen
+	)
+{
+	SBinaryDXLStream *pbdxls = PbdxlsInflate(pc, ulLen);
+	char *szXML = pbdxls->m_szXML;
+
+	if (NULL == szXML)
+	{
+		StringInfoData str;
+		initStringInfo(&str);
+		enlargeStringInfo(&str, pbdxls->m_ulXMLLen);
+
+		const char **rgpcDict = (const char **) palloc(pbdxls->m_ulMaxEntries * sizeof(char *));
+		uint32 *rgulDictLen = (uint32 *) palloc(pbdxls->m_ulMaxEntries * sizeof(uint32));
+
+		CXMLWriter xmlwriter(&str);
+		Walk(pbdxls, &xmlwriter, rgpcDict, rgulDictLen);
+
+		pfree(rgpcDict);
+		pfree(rgulDictLen);
+		szXML = str.data;
+	}
+
+	pbdxls->m_szXML = NULL;
+	FreeStream(pbdxls);
+
+	return szXML;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CBinaryDXL::FBinaryDXLFile
+//
+//	@doc:
+//		Does the file start with a binary DXL header. Only the header is
+//		read.
+//
+//---------------------------------------------------------------------------
+bool
+CBinaryDXL::FBinaryDXLFile
+	(
+	const char *szFilename
+	)
+{
+	FILE *pfile = AllocateFile(szFilename, PG_BINARY_R);
+	if (NULL == pfile)
+	{
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not open file \"%s\" for reading: %m", szFilename)));
+	}
+
+	char rgch[BDXL_HEADER_LEN];
+	size_t ulRead = fread(rgch, 1, sizeof(rgch), pfile);
+
+	if (ferror(pfile))
+	{
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not read file \"%s\": %m", szFilename)));
+	}
+	FreeFile(pfile);
+
+	return FBinaryDXL(rgch, (uint32) ulRead);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CBinaryDXL::PcReadFile
+//
+//	@doc:
+//		Read a whole file into memory. The buffer is null-terminated, so a
+//		text file can be used as a string directly.
+//
+//---------------------------------------------------------------------------
+char *
+CBinaryDXL::PcReadFile
+	(
+	const char *szFilename,
+	uint32 *pulLen
+	)
+{
+	FILE *pfile = AllocateFile(szFilename, PG_BINARY_R);
+	if (NULL == pfile)
+	{
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not open file \"%s\" for reading: %m", szFilename)));
+	}
+
+	StringInfoData str;
+	initStringInfo(&str);
+
+	char rgch[8192];
+	size_t ulRead;
+	while (0 < (ulRead = fread(rgch, 1, sizeof(rgch), pfile)))
+	{
+		appendBinaryStringInfo(&str, rgch, ulRead);
+	}
+
+	if (ferror(pfile))
+	{
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not read file \"%s\": %m", szFilename)));
+	}
+	FreeFile(pfile);
+
+	*pulLen = str.len;
+	return str.data;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CBinaryDXL::WriteFile
+//
+//	@doc:
+//		Write a buffer to a file, replacing its contents
+//
+//---------------------------------------------------------------------------
+void
+CBinaryDXL::WriteFile
+	(
+	const char *szFilename,
+	const char *pc,
+	uint32 ulLen
+	)
+{
+	FILE *pfile = AllocateFile(szFilename, PG_BINARY_W);
+	if (NULL == pfile)
+	{
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not open file \"%s\" for writing: %m", szFilename)));
+	}
+
+	if (fwrite(pc, 1, ulLen, pfile) != ulLen || 0 != FreeFile(pfile))
+	{
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not write file \"%s\": %m", szFilename)));
+	}
+}
+
+// EOF
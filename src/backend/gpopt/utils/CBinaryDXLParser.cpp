@@ -0,0 +1,905 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2017 Pivotal Software, Inc.
+//
+//	@filename:
+//		CBinaryDXLParser.cpp
+//
+//	@doc:
+//		Builds DXL objects from a binary DXL document by replaying its tokens
+//		as SAX events to the DXL parse handlers
+//
+//	@test:
+//
+//
+//---------------------------------------------------------------------------
+
+#include "gpopt/utils/CBinaryDXLParser.h"
+
+#include <xercesc/sax2/Attributes.hpp>
+#include <xercesc/sax2/ContentHandler.hpp>
+#include <xercesc/sax2/XMLReaderFactory.hpp>
+#include <xercesc/util/XMLString.hpp>
+#include <xercesc/util/XMLUni.hpp>
+#include <xercesc/util/XMLUniDefs.hpp>
+
+#include "naucrates/dxl/CDXLUtils.h"
+#include "naucrates/dxl/parser/CParseHandlerFactory.h"
+#include "naucrates/dxl/parser/CParseHandlerManager.h"
+#include "naucrates/dxl/xml/CDXLMemoryManager.h"
+
+using namespace gpdxl;
+using namespace gpos;
+using namespace gpopt;
+
+// initial number of namespace declarations and attributes
+#define GPOPT_BDXL_INIT_ENTRIES	8
+
+// Unicode replacement character, for malformed UTF-8
+#define GPOPT_BDXL_REPLACEMENT_CHAR	0xFFFD
+
+//---------------------------------------------------------------------------
+//	@class:
+//		CBinaryDXLParser::CAttributes
+//
+//	@doc:
+//		Attributes of an element, as passed to ContentHandler::startElement
+//
+//---------------------------------------------------------------------------
+class CBinaryDXLParser::CAttributes : public Attributes
+{
+	private:
+
+		struct SAttr
+		{
+			XMLCh *m_xmlszQName;
+			const XMLCh *m_xmlszLocalName;
+			const XMLCh *m_xmlszURI;
+			XMLCh *m_xmlszValue;
+		};
+
+		IMemoryPool *m_pmp;
+
+		SAttr *m_rgattr;
+		XMLSize_t m_ulAttrs;
+		XMLSize_t m_ulSize;
+
+		// private copy ctor
+		CAttributes(const CAttributes &);
+
+		const SAttr *Pattr(const XMLCh *xmlszURI, const XMLCh *xmlszLocalName) const
+		{
+			for (XMLSize_t ul = 0; ul < m_ulAttrs; ul++)
+			{
+				if (XMLString::equals(xmlszURI, m_rgattr[ul].m_xmlszURI) &&
+					XMLString::equals(xmlszLocalName, m_rgattr[ul].m_xmlszLocalName))
+				{
+					return &m_rgattr[ul];
+				}
+			}
+			return NULL;
+		}
+
+		const SAttr *Pattr(const XMLCh *xmlszQName) const
+		{
+			for (XMLSize_t ul = 0; ul < m_ulAttrs; ul++)
+			{
+				if (XMLString::equals(xmlszQName, m_rgattr[ul].m_xmlszQName))
+				{
+					return &m_rgattr[ul];
+				}
+			}
+			return NULL;
+		}
+
+	public:
+
+		explicit
+		CAttributes(IMemoryPool *pmp)
+			:
+			m_pmp(pmp),
+			m_rgattr(NULL),
+			m_ulAttrs(0),
+			m_ulSize(GPOPT_BDXL_INIT_ENTRIES)
+		{
+			m_rgattr = GPOS_NEW_ARRAY(m_pmp, SAttr, m_ulSize);
+		}
+
+		virtual
+		~CAttributes()
+		{
+			Clear();
+			GPOS_DELETE_ARRAY(m_rgattr);
+		}
+
+		// add an attribute; takes ownership of the strings
+		void Add(XMLCh *xmlszQName, XMLCh *xmlszValue)
+		{
+			if (m_ulAttrs == m_ulSize)
+			{
+				SAttr *rgattr = GPOS_NEW_ARRAY(m_pmp, SAttr, m_ulSize * 2);
+				for (XMLSize_t ul = 0; ul < m_ulAttrs; ul++)
+				{
+					rgattr[ul] = m_rgattr[ul];
+				}
+				GPOS_DELETE_ARRAY(m_rgattr);
+				m_rgattr = rgattr;
+				m_ulSize *= 2;
+			}
+
+			SAttr *pattr = &m_rgattr[m_ulAttrs++];
+			pattr->m_xmlszQName = xmlszQName;
+			pattr->m_xmlszLocalName = xmlszQName;
+			pattr->m_xmlszURI = XMLUni::fgZeroLenString;
+			pattr->m_xmlszValue = xmlszValue;
+		}
+
+		// set the namespace URI and local name of an attribute
+		void Resolve(XMLSize_t ul, const XMLCh *xmlszURI, const XMLCh *xmlszLocalName)
+		{
+			GPOS_ASSERT(ul < m_ulAttrs);
+			m_rgattr[ul].m_xmlszURI = xmlszURI;
+			m_rgattr[ul].m_xmlszLocalName = xmlszLocalName;
+		}
+
+		// remove all attributes
+		void Clear()
+		{
+			for (XMLSize_t ul = 0; ul < m_ulAttrs; ul++)
+			{
+				GPOS_DELETE_ARRAY(m_rgattr[ul].m_xmlszQName);
+				GPOS_DELETE_ARRAY(m_rgattr[ul].m_xmlszValue);
+			}
+			m_ulAttrs = 0;
+		}
+
+		virtual
+		XMLSize_t getLength() const
+		{
+			return m_ulAttrs;
+		}
+
+		virtual
+		const XMLCh *getURI(const XMLSize_t index) const
+		{
+			return index < m_ulAttrs ? m_rgattr[index].m_xmlszURI : NULL;
+		}
+
+		virtual
+		const XMLCh *getLocalName(const XMLSize_t index) const
+		{
+			return index < m_ulAttrs ? m_rgattr[index].m_xmlszLocalName : NULL;
+		}
+
+		virtual
+		const XMLCh *getQName(const XMLSize_t index) const
+		{
+			return index < m_ulAttrs ? m_rgattr[index].m_xmlszQName : NULL;
+		}
+
+		virtual
+		const XMLCh *getType(const XMLSize_t index) const
+		{
+			return index < m_ulAttrs ? XMLUni::fgCDATAString : NULL;
+		}
+
+		virtual
+		const XMLCh *getValue(const XMLSize_t index) const
+		{
+			return index < m_ulAttrs ? m_rgattr[index].m_xmlszValue : NULL;
+		}
+
+		virtual
+		bool getIndex(const XMLCh *const uri, const XMLCh *const localPart, XMLSize_t &index) const
+		{
+			const SAttr *pattr = Pattr(uri, localPart);
+			if (NULL == pattr)
+			{
+				return false;
+			}
+			index = pattr - m_rgattr;
+			return true;
+		}
+
+		virtual
+		int getIndex(const XMLCh *const uri, const XMLCh *const localPart) const
+		{
+			const SAttr *pattr = Pattr(uri, localPart);
+			return NULL == pattr ? -1 : (int) (pattr - m_rgattr);
+		}
+
+		virtual
+		bool getIndex(const XMLCh *const qName, XMLSize_t &index) const
+		{
+			const SAttr *pattr = Pattr(qName);
+			if (NULL == pattr)
+			{
+				return false;
+			}
+			index = pattr - m_rgattr;
+			return true;
+		}
+
+		virtual
+		int getIndex(const XMLCh *const qName) const
+		{
+			const SAttr *pattr = Pattr(qName);
+			return NULL == pattr ? -1 : (int) (pattr - m_rgattr);
+		}
+
+		virtual
+		const XMLCh *getType(const XMLCh *const uri, const XMLCh *const localPart) const
+		{
+			return NULL == Pattr(uri, localPart) ? NULL : XMLUni::fgCDATAString;
+		}
+
+		virtual
+		const XMLCh *getType(const XMLCh *const qName) const
+		{
+			return NULL == Pattr(qName) ? NULL : XMLUni::fgCDATAString;
+		}
+
+		virtual
+		const XMLCh *getValue(const XMLCh *const uri, const XMLCh *const localPart) const
+		{
+			const SAttr *pattr = Pattr(uri, localPart);
+			return NULL == pattr ? NULL : pattr->m_xmlszValue;
+		}
+
+		virtual
+		const XMLCh *getValue(const XMLCh *const qName) const
+		{
+			const SAttr *pattr = Pattr(qName);
+			return NULL == pattr ? NULL : pattr->m_xmlszValue;
+		}
+};
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CBinaryDXLParser::CBinaryDXLParser
+//
+//	@doc:
+//		Ctor
+//
+//---------------------------------------------------------------------------
+CBinaryDXLParser::CBinaryDXLParser
+	(
+	IMemoryPool *pmp,
+	SAX2XMLReader *pxmlreader
+	)
+	:
+	m_pmp(pmp),
+	m_pxmlreader(pxmlreader),
+	m_xmlszQName(NULL),
+	m_pattrs(NULL),
+	m_rgns(NULL),
+	m_ulNamespaces(0),
+	m_ulNamespaceSize(GPOPT_BDXL_INIT_ENTRIES)
+{
+	m_pattrs = GPOS_NEW(m_pmp) CAttributes(m_pmp);
+	m_rgns = GPOS_NEW_ARRAY(m_pmp, SNamespace, m_ulNamespaceSize);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CBinaryDXLParser::~CBinaryDXLParser
+//
+//	@doc:
+//		Dtor
+//
+//---------------------------------------------------------------------------
+CBinaryDXLParser::~CBinaryDXLParser()
+{
+	for (ULONG ul = 0; ul < m_ulNamespaces; ul++)
+	{
+		GPOS_DELETE_ARRAY(m_rgns[ul].m_xmlszPrefix);
+		GPOS_DELETE_ARRAY(m_rgns[ul].m_xmlszURI);
+	}
+	GPOS_DELETE_ARRAY(m_rgns);
+	GPOS_DELETE(m_pattrs);
+
+	if (NULL != m_xmlszQName)
+	{
+		GPOS_DELETE_ARRAY(m_xmlszQName);
+	}
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CBinaryDXLParser::PxmlszTranscode
+//
+//	@doc:
+//		Convert UTF-8 to a null-terminated XMLCh string. If fUnescape, the
+//		predefined entities and character references are replaced and line
+//		breaks are normalized, and in attribute values whitespace characters
+//		are replaced by spaces, as a SAX parser does.
+//
+//---------------------------------------------------------------------------
+XMLCh *
+CBinaryDXLParser::PxmlszTranscode
+	(
+	const char *pc,
+	uint32 ulLen,
+	BOOL fUnescape,
+	BOOL fAttribute,
+	XMLSize_t *pulLen
+	)
+{
+	// no UTF-8 sequence or reference yields more code units than bytes
+	XMLCh *xmlsz = GPOS_NEW_ARRAY(m_pmp, XMLCh, ulLen + 1);
+	XMLSize_t ulOut = 0;
+	uint32 ulPos = 0;
+
+	while (ulPos < ulLen)
+	{
+		const unsigned char *puc = (const unsigned char *) pc + ulPos;
+		ULONG ulCodePoint = puc[0];
+		uint32 ulSeqLen = 1;
+
+		if (fUnescape && '&' == puc[0])
+		{
+			const char *pcSemicolon = (const char *) memchr(pc + ulPos, ';', ulLen - ulPos);
+			uint32 ulRefLen = NULL == pcSemicolon ? 0 : (uint32) (pcSemicolon - (pc + ulPos)) + 1;
+			const char *pcRef = pc + ulPos + 1;
+			BOOL fReplaced = true;
+
+			if (4 == ulRefLen && 0 == strncmp(pcRef, "lt", 2))
+			{
+				ulCodePoint = '<';
+			}
+			else if (4 == ulRefLen && 0 == strncmp(pcRef, "gt", 2))
+			{
+				ulCodePoint = '>';
+			}
+			else if (5 == ulRefLen && 0 == strncmp(pcRef, "amp", 3))
+			{
+				ulCodePoint = '&';
+			}
+			else if (6 == ulRefLen && 0 == strncmp(pcRef, "quot", 4))
+			{
+				ulCodePoint = '"';
+			}
+			else if (6 == ulRefLen && 0 == strncmp(pcRef, "apos", 4))
+			{
+				ulCodePoint = '\'';
+			}
+			else if (4 <= ulRefLen && '#' == pcRef[0])
+			{
+				BOOL fHex = ('x' == pcRef[1]);
+				ulCodePoint = 0;
+				for (uint32 ul = fHex ? 2 : 1; ul < ulRefLen - 2 && fReplaced; ul++)
+				{
+					char c = pcRef[ul];
+					ULONG ulDigit;
+					if ('0' <= c && '9' >= c)
+					{
+						ulDigit = c - '0';
+					}
+					else if (fHex && 'a' <= c && 'f' >= c)
+					{
+						ulDigit = c - 'a' + 10;
+					}
+					else if (fHex && 'A' <= c && 'F' >= c)
+					{
+						ulDigit = c - 'A' + 10;
+					}
+					else
+					{
+						ulDigit = 0;
+						fReplaced = false;
+					}
+					ulCodePoint = ulCodePoint * (fHex ? 16 : 10) + ulDigit;
+					if (0x10FFFF < ulCodePoint)
+					{
+						fReplaced = false;
+					}
+				}
+
+				if (0 == ulCodePoint)
+				{
+					// no digits, or a reference to a character XML forbids
+					fReplaced = false;
+				}
+			}
+			else
+			{
+				fReplaced = false;
+			}
+
+			if (fReplaced)
+			{
+				ulSeqLen = ulRefLen;
+			}
+			else
+			{
+				// not a reference the serializer writes; keep it as text
+				ulCodePoint = '&';
+			}
+		}
+		else if (0x80 <= puc[0])
+		{
+			// multi-byte UTF-8 sequence
+			uint32 ulExpected = (0xE0 == (puc[0] & 0xE0)) ? ((0xF0 == (puc[0] & 0xF0)) ? 4 : 3) :
+								(0xC0 == (puc[0] & 0xE0)) ? 2 : 0;
+			BOOL fValid = (0 < ulExpected && ulPos + ulExpected <= ulLen);
+
+			ulCodePoint = puc[0] & (0x7F >> ulExpected);
+			for (uint32 ul = 1; fValid && ul < ulExpected; ul++)
+			{
+				fValid = (0x80 == (puc[ul] & 0xC0));
+				ulCodePoint = (ulCodePoint << 6) | (puc[ul] & 0x3F);
+			}
+
+			if (fValid)
+			{
+				ulSeqLen = ulExpected;
+			}
+			else
+			{
+				ulCodePoint = GPOPT_BDXL_REPLACEMENT_CHAR;
+			}
+		}
+		else if (fUnescape && '\r' == puc[0])
+		{
+			// "\r\n" and "\r" become "\n"
+			ulCodePoint = '\n';
+			if (ulPos + 1 < ulLen && '\n' == puc[1])
+			{
+				ulSeqLen = 2;
+			}
+		}
+
+		if (fAttribute && '&' != puc[0] &&
+			('\n' == ulCodePoint || '\t' == ulCodePoint || '\r' == ulCodePoint))
+		{
+			ulCodePoint = ' ';
+		}
+
+		if (0x10000 <= ulCodePoint)
+		{
+			ulCodePoint -= 0x10000;
+			xmlsz[ulOut++] = (XMLCh) (0xD800 + (ulCodePoint >> 10));
+			xmlsz[ulOut++] = (XMLCh) (0xDC00 + (ulCodePoint & 0x3FF));
+		}
+		else
+		{
+			xmlsz[ulOut++] = (XMLCh) ulCodePoint;
+		}
+		ulPos += ulSeqLen;
+	}
+
+	GPOS_ASSERT(ulOut <= ulLen);
+	xmlsz[ulOut] = 0;
+
+	if (NULL != pulLen)
+	{
+		*pulLen = ulOut;
+	}
+	return xmlsz;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CBinaryDXLParser::AddNamespace
+//
+//	@doc:
+//		Remember the namespace declared by an xmlns or xmlns:prefix
+//		attribute. Declarations are not scoped; DXL documents declare their
+//		namespace once, on the root element.
+//
+//---------------------------------------------------------------------------
+void
+CBinaryDXLParser::AddNamespace
+	(
+	const XMLCh *xmlszQName,
+	XMLCh *xmlszURI
+	)
+{
+	if (m_ulNamespaces == m_ulNamespaceSize)
+	{
+		SNamespace *rgns = GPOS_NEW_ARRAY(m_pmp, SNamespace, m_ulNamespaceSize * 2);
+		for (ULONG ul = 0; ul < m_ulNamespaces; ul++)
+		{
+			rgns[ul] = m_rgns[ul];
+		}
+		GPOS_DELETE_ARRAY(m_rgns);
+		m_rgns = rgns;
+		m_ulNamespaceSize *= 2;
+	}
+
+	// prefix follows "xmlns:", or is empty for the default namespace
+	XMLSize_t ulQNameLen = XMLString::stringLen(xmlszQName);
+	XMLSize_t ulPrefixLen = 5 < ulQNameLen ? ulQNameLen - 6 : 0;
+	XMLCh *xmlszPrefix = GPOS_NEW_ARRAY(m_pmp, XMLCh, ulPrefixLen + 1);
+	for (XMLSize_t ul = 0; ul < ulPrefixLen; ul++)
+	{
+		xmlszPrefix[ul] = xmlszQName[ul + 6];
+	}
+	xmlszPrefix[ulPrefixLen] = 0;
+
+	m_rgns[m_ulNamespaces].m_xmlszPrefix = xmlszPrefix;
+	m_rgns[m_ulNamespaces].m_xmlszURI = xmlszURI;
+	m_ulNamespaces++;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CBinaryDXLParser::PxmlszURI
+//
+//	@doc:
+//		Namespace URI and local name of a qualified name. Unprefixed
+//		attributes have no namespace; unprefixed elements are in the default
+//		namespace, if one was declared.
+//
+//---------------------------------------------------------------------------
+const XMLCh *
+CBinaryDXLParser::PxmlszURI
+	(
+	const XMLCh *xmlszQName,
+	BOOL fElement,
+	const XMLCh **pxmlszLocalName
+	)
+	const
+{
+	int iColon = XMLString::indexOf(xmlszQName, chColon);
+	XMLSize_t ulPrefixLen = 0 <= iColon ? (XMLSize_t) iColon : 0;
+
+	*pxmlszLocalName = 0 <= iColon ? xmlszQName + iColon + 1 : xmlszQName;
+
+	if (0 > iColon && !fElement)
+	{
+		return XMLUni::fgZeroLenString;
+	}
+
+	// later declarations take precedence
+	for (ULONG ul = m_ulNamespaces; 0 < ul; ul--)
+	{
+		const XMLCh *xmlszPrefix = m_rgns[ul - 1].m_xmlszPrefix;
+		if (XMLString::stringLen(xmlszPrefix) == ulPrefixLen &&
+			(0 == ulPrefixLen || 0 == XMLString::compareNString(xmlszPrefix, xmlszQName, ulPrefixLen)))
+		{
+			return m_rgns[ul - 1].m_xmlszURI;
+		}
+	}
+
+	return XMLUni::fgZeroLenString;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CBinaryDXLParser::StartTag
+//
+//	@doc:
+//		Start collecting an element
+//
+//---------------------------------------------------------------------------
+void
+CBinaryDXLParser::StartTag
+	(
+	const char *pcName,
+	uint32 ulNameLen
+	)
+{
+	GPOS_ASSERT(NULL == m_xmlszQName);
+	m_xmlszQName = PxmlszTranscode(pcName, ulNameLen, false /*fUnescape*/, false /*fAttribute*/, NULL);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CBinaryDXLParser::Attribute
+//
+//	@doc:
+//		Add an attribute to the element being collected. Namespace
+//		declarations are recorded and, as with the SAX2 namespace-prefixes
+//		feature off, not reported as attributes.
+//
+//---------------------------------------------------------------------------
+void
+CBinaryDXLParser::Attribute
+	(
+	const char *pcName,
+	uint32 ulNameLen,
+	const char *pcValue,
+	uint32 ulValueLen
+	)
+{
+	XMLCh *xmlszQName = PxmlszTranscode(pcName, ulNameLen, false /*fUnescape*/, false /*fAttribute*/, NULL);
+	XMLCh *xmlszValue = PxmlszTranscode(pcValue, ulValueLen, true /*fUnescape*/, true /*fAttribute*/, NULL);
+
+	if ((5 == ulNameLen && 0 == strncmp(pcName, "xmlns", 5)) ||
+		(6 < ulNameLen && 0 == strncmp(pcName, "xmlns:", 6)))
+	{
+		AddNamespace(xmlszQName, xmlszValue);
+		GPOS_DELETE_ARRAY(xmlszQName);
+		return;
+	}
+
+	m_pattrs->Add(xmlszQName, xmlszValue);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CBinaryDXLParser::StartTagClose
+//
+//	@doc:
+//		Report the start of the collected element, and its end if the tag
+//		was empty
+//
+//---------------------------------------------------------------------------
+void
+CBinaryDXLParser::StartTagClose
+	(
+	BOOL fEmpty
+	)
+{
+	GPOS_ASSERT(NULL != m_xmlszQName);
+
+	for (XMLSize_t ul = 0; ul < m_pattrs->getLength(); ul++)
+	{
+		const XMLCh *xmlszLocalName = NULL;
+		const XMLCh *xmlszURI = PxmlszURI(m_pattrs->getQName(ul), false /*fElement*/, &xmlszLocalName);
+		m_pattrs->Resolve(ul, xmlszURI, xmlszLocalName);
+	}
+
+	const XMLCh *xmlszLocalName = NULL;
+	const XMLCh *xmlszURI = PxmlszURI(m_xmlszQName, true /*fElement*/, &xmlszLocalName);
+
+	// the parse handler manager installs the active parse handler as the
+	// reader's content handler
+	ContentHandler *pch = m_pxmlreader->getContentHandler();
+	GPOS_ASSERT(NULL != pch);
+	pch->startElement(xmlszURI, xmlszLocalName, m_xmlszQName, *m_pattrs);
+
+	m_pattrs->Clear();
+
+	if (fEmpty)
+	{
+		EndElement(m_xmlszQName);
+	}
+
+	GPOS_DELETE_ARRAY(m_xmlszQName);
+	m_xmlszQName = NULL;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CBinaryDXLParser::EndElement
+//
+//	@doc:
+//		Report the end of an element
+//
+//---------------------------------------------------------------------------
+void
+CBinaryDXLParser::EndElement
+	(
+	const XMLCh *xmlszQName
+	)
+{
+	const XMLCh *xmlszLocalName = NULL;
+	const XMLCh *xmlszURI = PxmlszURI(xmlszQName, true /*fElement*/, &xmlszLocalName);
+
+	ContentHandler *pch = m_pxmlreader->getContentHandler();
+	GPOS_ASSERT(NULL != pch);
+	pch->endElement(xmlszURI, xmlszLocalName, xmlszQName);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CBinaryDXLParser::EndTag
+//
+//	@doc:
+//		Report the end of an element
+//
+//---------------------------------------------------------------------------
+void
+CBinaryDXLParser::EndTag
+	(
+	const char *pcName,
+	uint32 ulNameLen
+	)
+{
+	XMLCh *xmlszQName = PxmlszTranscode(pcName, ulNameLen, false /*fUnescape*/, false /*fAttribute*/, NULL);
+	EndElement(xmlszQName);
+	GPOS_DELETE_ARRAY(xmlszQName);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CBinaryDXLParser::Text
+//
+//	@doc:
+//		Report character data. Comments and processing instructions are
+//		skipped, and the content of a CDATA section is reported as is.
+//		CBinaryDXL::PbdxlsInflate only lets through documents in which all
+//		markup copied verbatim is of these kinds.
+//
+//---------------------------------------------------------------------------
+void
+CBinaryDXLParser::Text
+	(
+	const char *pc,
+	uint32 ulLen
+	)
+{
+	BOOL fUnescape = true;
+
+	if (0 < ulLen && '<' == pc[0])
+	{
+		GPOS_ASSERT(CBinaryDXL::FReplayableMarkup(pc, ulLen));
+
+		if (0 != strncmp(pc, "<![CDATA[", 9))
+		{
+			return;
+		}
+
+		pc += 9;
+		ulLen -= 12;
+		fUnescape = false;
+	}
+
+	if (0 == ulLen)
+	{
+		return;
+	}
+
+	XMLSize_t ulChars = 0;
+	XMLCh *xmlsz = PxmlszTranscode(pc, ulLen, fUnescape, false /*fAttribute*/, &ulChars);
+
+	ContentHandler *pch = m_pxmlreader->getContentHandler();
+	GPOS_ASSERT(NULL != pch);
+	pch->characters(xmlsz, ulChars);
+
+	GPOS_DELETE_ARRAY(xmlsz);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CBinaryDXLParser::PphdxlParse
+//
+//	@doc:
+//		Parse a binary DXL document into a DXL parse handler, set up the way
+//		CDXLUtils::PphdxlParseDXL sets it up for XML text
+//
+//---------------------------------------------------------------------------
+CParseHandlerDXL *
+CBinaryDXLParser::PphdxlParse
+	(
+	IMemoryPool *pmp,
+	const SBinaryDXLStream *pbdxls
+	)
+{
+	GPOS_ASSERT(NULL != pbdxls);
+	GPOS_ASSERT(NULL == pbdxls->m_szXML);
+
+	CDXLMemoryManager *pmm = GPOS_NEW(pmp) CDXLMemoryManager(pmp);
+	SAX2XMLReader *pxmlreader = XMLReaderFactory::createXMLReader(pmm);
+	CParseHandlerManager *pphm = GPOS_NEW(pmp) CParseHandlerManager(pmm, pxmlreader);
+	CParseHandlerDXL *pphdxl = CParseHandlerFactory::Pphdxl(pmp, pphm);
+
+	// start with the top level element
+	pphm->ActivateParseHandler(pphdxl);
+
+	const CHAR **rgpcDict = GPOS_NEW_ARRAY(pmp, const CHAR *, pbdxls->m_ulMaxEntries);
+	uint32 *rgulDictLen = GPOS_NEW_ARRAY(pmp, uint32, pbdxls->m_ulMaxEntries);
+	CBinaryDXLParser *pbdxlp = GPOS_NEW(pmp) CBinaryDXLParser(pmp, pxmlreader);
+
+	GPOS_TRY
+	{
+		pxmlreader->getContentHandler()->startDocument();
+		CBinaryDXL::Walk(pbdxls, pbdxlp, rgpcDict, rgulDictLen);
+		pxmlreader->getContentHandler()->endDocument();
+	}
+	GPOS_CATCH_EX(ex)
+	{
+		GPOS_DELETE(pbdxlp);
+		GPOS_DELETE_ARRAY(rgpcDict);
+		GPOS_DELETE_ARRAY(rgulDictLen);
+		GPOS_DELETE(pphdxl);
+		GPOS_DELETE(pphm);
+		delete pxmlreader;
+		GPOS_DELETE(pmm);
+		GPOS_RETHROW(ex);
+	}
+	GPOS_CATCH_END;
+
+	GPOS_DELETE(pbdxlp);
+	GPOS_DELETE_ARRAY(rgpcDict);
+	GPOS_DELETE_ARRAY(rgulDictLen);
+	GPOS_DELETE(pphm);
+	delete pxmlreader;
+	GPOS_DELETE(pmm);
+
+	return pphdxl;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CBinaryDXLParser::PdxlmdLoad
+//
+//	@doc:
+//		Load a minidump from a binary DXL document, taking its parts from the
+//		parse handler as CMinidumperUtils::PdxlmdLoad does for a file.
+//		Documents that cannot be replayed were decoded to text by
+//		CBinaryDXL::PbdxlsInflate, and are parsed from memory.
+//
+//---------------------------------------------------------------------------
+CDXLMinidump *
+CBinaryDXLParser::PdxlmdLoad
+	(
+	IMemoryPool *pmp,
+	const SBinaryDXLStream *pbdxls
+	)
+{
+	CParseHandlerDXL *pphdxl = NULL;
+	if (NULL != pbdxls->m_szXML)
+	{
+		pphdxl = CDXLUtils::PphdxlParseDXL(pmp, pbdxls->m_szXML, NULL /*szXSDPath*/);
+	}
+	else
+	{
+		pphdxl = PphdxlParse(pmp, pbdxls);
+	}
+
+	CBitSet *pbs = pphdxl->Pbs();
+	COptimizerConfig *poconf = pphdxl->Poconf();
+	CDXLNode *pdxlnQuery = pphdxl->PdxlnQuery();
+	DrgPdxln *pdrgpdxlnQueryOutput = pphdxl->PdrgpdxlnOutputCols();
+	DrgPdxln *pdrgpdxlnCTE = pphdxl->PdrgpdxlnCTE();
+	DrgPimdobj *pdrgpmdobj = pphdxl->Pdrgpmdobj();
+	DrgPsysid *pdrgpsysid = pphdxl->Pdrgpsysid();
+	CDXLNode *pdxlnPlan = pphdxl->PdxlnPlan();
+	ULLONG ullPlanId = pphdxl->UllPlanId();
+	ULLONG ullPlanSpaceSize = pphdxl->UllPlanSpaceSize();
+
+	// the parse handler releases what it holds
+	if (NULL != pbs)
+	{
+		pbs->AddRef();
+	}
+	if (NULL != poconf)
+	{
+		poconf->AddRef();
+	}
+	if (NULL != pdxlnQuery)
+	{
+		pdxlnQuery->AddRef();
+	}
+	if (NULL != pdrgpdxlnQueryOutput)
+	{
+		pdrgpdxlnQueryOutput->AddRef();
+	}
+	if (NULL != pdrgpdxlnCTE)
+	{
+		pdrgpdxlnCTE->AddRef();
+	}
+	if (NULL != pdrgpmdobj)
+	{
+		pdrgpmdobj->AddRef();
+	}
+	if (NULL != pdrgpsysid)
+	{
+		pdrgpsysid->AddRef();
+	}
+	if (NULL != pdxlnPlan)
+	{
+		pdxlnPlan->AddRef();
+	}
+
+	GPOS_DELETE(pphdxl);
+
+	return GPOS_NEW(pmp) CDXLMinidump
+						(
+						pbs,
+						poconf,
+						pdxlnQuery,
+						pdrgpdxlnQueryOutput,
+						pdrgpdxlnCTE,
+						pdrgpmdobj,
+						pdrgpsysid,
+						pdxlnPlan,
+						ullPlanId,
+						ullPlanSpaceSize
+						);
+}
+
+// EOF
@@ -20,10 +20,13 @@
 
 #include "gpopt/utils/CConstExprEvaluatorProxy.h"
 
+#include "gpos/common/CAutoP.h"
+
 #include "gpopt/gpdbwrappers.h"
 #include "gpopt/translate/CTranslatorScalarToDXL.h"
 
 #include "naucrates/exception.h"
+#include "naucrates/dxl/CDXLUtils.h"
 #include "naucrates/dxl/operators/CDXLNode.h"
 
 using namespace gpdxl;
@@ -51,6 +54,80 @@ CConstExprEvaluatorProxy::CEmptyMappingColIdVar::PvarFromDXLNodeScId
 	return NULL;
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CConstExprEvaluatorProxy::UlHashDXL
+//
+//	@doc:
+//		Hash of a key of the results map
+//
+//---------------------------------------------------------------------------
+ULONG
+CConstExprEvaluatorProxy::UlHashDXL
+	(
+	const CWStringDynamic *pstr
+	)
+{
+	return gpos::UlHashByteArray((const BYTE *) pstr->Wsz(), pstr->UlLength() * GPOS_SIZEOF(WCHAR));
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CConstExprEvaluatorProxy::FEqualDXL
+//
+//	@doc:
+//		Equality of keys of the results map
+//
+//---------------------------------------------------------------------------
+BOOL
+CConstExprEvaluatorProxy::FEqualDXL
+	(
+	const CWStringDynamic *pstrA,
+	const CWStringDynamic *pstrB
+	)
+{
+	return pstrA->FEquals(pstrB);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CConstExprEvaluatorProxy::FreeConst
+//
+//	@doc:
+//		Release a value of the results map, including a by-reference datum
+//
+//---------------------------------------------------------------------------
+void
+CConstExprEvaluatorProxy::FreeConst
+	(
+	Const *pconst
+	)
+{
+	if (!pconst->constbyval && !pconst->constisnull)
+	{
+		gpdb::GPDBFree(DatumGetPointer(pconst->constvalue));
+	}
+	gpdb::GPDBFree(pconst);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CConstExprEvaluatorProxy::PdxlnConst
+//
+//	@doc:
+//		Translate a constant to a DXL scalar constant
+//
+//---------------------------------------------------------------------------
+CDXLNode *
+CConstExprEvaluatorProxy::PdxlnConst
+	(
+	Const *pconst
+	)
+{
+	CDXLDatum *pdxldatum = CTranslatorScalarToDXL::Pdxldatum(m_pmp, m_pmda, pconst);
+	return GPOS_NEW(m_pmp) CDXLNode(m_pmp, GPOS_NEW(m_pmp) CDXLScalarConstValue(m_pmp, pdxldatum));
+}
+
 //---------------------------------------------------------------------------
 //	@function:
 //		CConstExprEvaluatorProxy::EvaluateExpr
@@ -66,28 +143,54 @@ CConstExprEvaluatorProxy::PdxlnEvaluateExpr
 	const CDXLNode *pdxlnExpr
 	)
 {
+	// Reuse the result of an earlier evaluation of the same expression. DXL
+	// nodes have no hash or equality of their own, their serialization
+	// identifies the tree. Only results of expressions without volatile
+	// functions are kept, so a hit never needs translating the expression.
+	CAutoP<CWStringDynamic> a_pstrKey;
+	a_pstrKey = CDXLUtils::PstrSerializeScalarExpr(m_pmp, pdxlnExpr, false /*fSerializeHeaderFooter*/, false /*fIndent*/);
+	Const *pconstCached = m_phmstrconst->PtLookup(a_pstrKey.Pt());
+	if (NULL != pconstCached)
+	{
+		return PdxlnConst(pconstCached);
+	}
+
 	// Translate DXL -> GPDB Expr
 	Expr *pexpr = m_trdxl2scalar.PexprFromDXLNodeScalar(pdxlnExpr, &m_emptymapcidvar);
 	GPOS_ASSERT(NULL != pexpr);
 
+	BOOL fVolatile = gpdb::FContainVolatileFunctions((Node *) pexpr);
+
 	// Evaluate the expression
 	Expr *pexprResult = gpdb::PexprEvaluate(pexpr,
 						gpdb::OidExprType((Node *)pexpr),
 						gpdb::IExprTypeMod((Node *)pexpr));
+	gpdb::GPDBFree(pexpr);
 
 	if (!IsA(pexprResult, Const))
 	{
 		#ifdef GPOS_DEBUG
 		elog(NOTICE, "Expression did not evaluate to Const, but to an expression of type %d", pexprResult->type);
 		#endif
+		gpdb::GPDBFree(pexprResult);
 		GPOS_RAISE(gpdxl::ExmaConstExprEval, gpdxl::ExmiConstExprEvalNonConst);
 	}
 
 	Const *pconstResult = (Const *)pexprResult;
-	CDXLDatum *pdxldatum = CTranslatorScalarToDXL::Pdxldatum(m_pmp, m_pmda, pconstResult);
-	CDXLNode *pdxlnResult = GPOS_NEW(m_pmp) CDXLNode(m_pmp, GPOS_NEW(m_pmp) CDXLScalarConstValue(m_pmp, pdxldatum));
-	gpdb::GPDBFree(pexprResult);
-	gpdb::GPDBFree(pexpr);
+	CDXLNode *pdxlnResult = PdxlnConst(pconstResult);
+
+	if (fVolatile)
+	{
+		FreeConst(pconstResult);
+	}
+	else
+	{
+#ifdef GPOS_DEBUG
+		BOOL fInserted =
+#endif
+		m_phmstrconst->FInsert(a_pstrKey.PtReset(), pconstResult);
+		GPOS_ASSERT(fInserted);
+	}
 
 	return pdxlnResult;
 }
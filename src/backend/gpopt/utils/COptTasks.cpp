@@ -14,8 +14,11 @@
 //---------------------------------------------------------------------------
 
 #include "gpopt/utils/gpdbdefs.h"
+#include "gpopt/utils/CBinaryDXL.h"
+#include "gpopt/utils/CBinaryDXLParser.h"
 #include "gpopt/utils/CConstExprEvaluatorProxy.h"
 #include "gpopt/utils/COptTasks.h"
+#include "gpopt/utils/optstats.h"
 #include "gpopt/relcache/CMDProviderRelcache.h"
 #include "gpopt/config/CConfigParamMapping.h"
 #include "gpopt/translate/CTranslatorDXLToExpr.h"
@@ -25,10 +28,12 @@
 #include "gpopt/translate/CTranslatorDXLToPlStmt.h"
 #include "gpopt/translate/CContextDXLToPlStmt.h"
 #include "gpopt/translate/CTranslatorRelcacheToDXL.h"
+#include "gpopt/translate/CHistogramColumns.h"
 #include "gpopt/eval/CConstExprEvaluatorDXL.h"
 #include "gpopt/engine/CHint.h"
 
 #include "cdb/cdbvars.h"
+#include "portability/instr_time.h"
 #include "utils/guc.h"
 
 #include "gpos/base.h"
@@ -97,6 +102,9 @@ using namespace gpdbcost;
 // default id for the source system
 const CSystemId sysidDefault(IMDId::EmdidGPDB, GPOS_WSZ_STR_LENGTH("GPDB"));
 
+// statistics of the current optimization, set by EXPLAIN OPTIMIZER_STATS
+OptimizerStats *optimizer_stats_collector = NULL;
+
 // array of optimizer minor exception types that trigger expected fallback to the planner
 const ULONG rgulExpectedOptFallback[] =
 	{
@@ -122,6 +130,9 @@ const ULONG rgulExpectedDXLErrors[] =
 		gpdxl::ExmiQuery2DXLNotNullViolation,	// not null violation
 	};
 
+// scalar-only column statistics entries of the MD cache
+CScalarOnlyColStats COptTasks::m_scosMDCache;
+
 
 //---------------------------------------------------------------------------
 //	@function:
@@ -521,6 +532,59 @@ COptTasks::PvMDScCmp
 	return NULL;
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		COptTasks::FInitMDCache
+//
+//	@doc:
+//		Initialize the metadata cache, or purge it if needed, or change its
+//		size if requested. Returns true if the cache was initialized.
+//
+//---------------------------------------------------------------------------
+BOOL
+COptTasks::FInitMDCache
+	(
+	BOOL fReset
+	)
+{
+	if (!CMDCache::FInitialized())
+	{
+		CMDCache::Init();
+		CMDCache::SetCacheQuota(optimizer_mdcache_size * 1024L);
+		m_scosMDCache.Reset();
+
+		return true;
+	}
+
+	if (fReset)
+	{
+		CMDCache::Reset();
+		CMDCache::SetCacheQuota(optimizer_mdcache_size * 1024L);
+		m_scosMDCache.Reset();
+	}
+	else if (CMDCache::ULLGetCacheQuota() != (ULLONG) optimizer_mdcache_size * 1024L)
+	{
+		CMDCache::SetCacheQuota(optimizer_mdcache_size * 1024L);
+	}
+
+	return false;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COptTasks::ShutdownMDCache
+//
+//	@doc:
+//		Shut down the metadata cache
+//
+//---------------------------------------------------------------------------
+void
+COptTasks::ShutdownMDCache()
+{
+	CMDCache::Shutdown();
+	m_scosMDCache.Reset();
+}
+
 //---------------------------------------------------------------------------
 //	@function:
 //		COptTasks::Execute
@@ -576,7 +640,33 @@ COptTasks::LogErrorAndDelete(CHAR* err_buf) {
 
 	if ('\0' != err_buf[0])
 	{
-		elog(LOG, "%s", SzFromWsz((WCHAR *)err_buf));
+		CHAR *szLog = SzFromWsz((WCHAR *)err_buf);
+
+		elog(LOG, "%s", szLog);
+
+		// EXPLAIN OPTIMIZER_STATS shows what the optimizer logged, which
+		// includes its per-stage search statistics
+		if (NULL != optimizer_stats_collector)
+		{
+			if (NULL == optimizer_stats_collector->search_log)
+			{
+				optimizer_stats_collector->search_log = szLog;
+			}
+			else
+			{
+				CHAR *szOld = optimizer_stats_collector->search_log;
+				ULONG ulLen = strlen(szOld) + strlen(szLog) + 2;
+
+				optimizer_stats_collector->search_log = (CHAR *) palloc(ulLen);
+				snprintf(optimizer_stats_collector->search_log, ulLen, "%s\n%s", szOld, szLog);
+				pfree(szOld);
+				pfree(szLog);
+			}
+		}
+		else
+		{
+			pfree(szLog);
+		}
 	}
 
 	pfree(err_buf);
@@ -954,6 +1044,44 @@ COptTasks::Pcm
 	return pcm;
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		RecordPhaseStats
+//
+//	@doc:
+//		Record elapsed time and peak memory pool size of an optimization
+//		phase started at 'pstarttime', and restart the clock for the next phase
+//
+//---------------------------------------------------------------------------
+static void
+RecordPhaseStats
+	(
+	IMemoryPool *pmp,
+	OptStatsPhase ephase,
+	instr_time *pstarttime
+	)
+{
+	if (NULL == optimizer_stats_collector)
+	{
+		return;
+	}
+
+	instr_time endtime;
+	INSTR_TIME_SET_CURRENT(endtime);
+
+	instr_time elapsed = endtime;
+	INSTR_TIME_SUBTRACT(elapsed, *pstarttime);
+
+	optimizer_stats_collector->phase_time[ephase] += INSTR_TIME_GET_MILLISEC(elapsed);
+
+	GPOS_ASSERT(ephase == optimizer_stats_collector->current_phase);
+	OptStatsSampleMemory(optimizer_stats_collector, pmp->UllTotalAllocatedSize());
+	optimizer_stats_collector->current_phase = (OptStatsPhase) (ephase + 1);
+
+	*pstarttime = endtime;
+}
+
+
 //---------------------------------------------------------------------------
 //	@function:
 //		COptTasks::PvOptimizeTask
@@ -990,20 +1118,12 @@ COptTasks::PvOptimizeTask
 	bool reset_mdcache = gpdb::FMDCacheNeedsReset();
 
 	// initialize metadata cache, or purge if needed, or change size if requested
-	if (!CMDCache::FInitialized())
-	{
-		CMDCache::Init();
-		CMDCache::SetCacheQuota(optimizer_mdcache_size * 1024L);
-	}
-	else if (reset_mdcache)
-	{
-		CMDCache::Reset();
-		CMDCache::SetCacheQuota(optimizer_mdcache_size * 1024L);
-	}
-	else if (CMDCache::ULLGetCacheQuota() != (ULLONG) optimizer_mdcache_size * 1024L)
-	{
-		CMDCache::SetCacheQuota(optimizer_mdcache_size * 1024L);
-	}
+	(void) FInitMDCache(reset_mdcache);
+
+	// find the columns that need histograms, and evict the cached
+	// scalar-only statistics of any of them
+	CHistogramColumns histcols((Query *) poctx->m_pquery, optimizer_lazy_column_stats, &m_scosMDCache);
+	m_scosMDCache.EvictStale(pmp, &histcols);
 
 
 	// load search strategy
@@ -1024,7 +1144,7 @@ COptTasks::PvOptimizeTask
 		SetTraceflags(pmp, pbsTraceFlags, &pbsEnabled, &pbsDisabled);
 
 		// set up relcache MD provider
-		CMDProviderRelcache *pmdpRelcache = GPOS_NEW(pmp) CMDProviderRelcache(pmp);
+		CMDProviderRelcache *pmdpRelcache = GPOS_NEW(pmp) CMDProviderRelcache(pmp, &histcols);
 
 		{
 			// scope for MD accessor
@@ -1037,6 +1157,14 @@ COptTasks::PvOptimizeTask
 			// map that stores gpdb att to optimizer col mapping
 			CMappingVarColId *pmapvarcolid = GPOS_NEW(pmp) CMappingVarColId(pmp);
 
+			instr_time starttime;
+			INSTR_TIME_SET_CURRENT(starttime);
+			if (NULL != optimizer_stats_collector)
+			{
+				optimizer_stats_collector->optimizations++;
+				optimizer_stats_collector->current_phase = OPTSTATS_PHASE_QUERY_TO_DXL;
+			}
+
 			ULONG ulSegments = gpdb::UlSegmentCountGP();
 			ULONG ulSegmentsForCosting = optimizer_segments;
 			if (0 == ulSegmentsForCosting)
@@ -1067,10 +1195,19 @@ COptTasks::PvOptimizeTask
 			DrgPdxln *pdrgpdxlnCTE = ptrquerytodxl->PdrgpdxlnCTE();
 			GPOS_ASSERT(NULL != pdrgpdxlnQueryOutput);
 
+			RecordPhaseStats(pmp, OPTSTATS_PHASE_QUERY_TO_DXL, &starttime);
+
 			BOOL fMasterOnly = !optimizer_enable_motions ||
 						(!optimizer_enable_motions_masteronly_queries && !ptrquerytodxl->FHasDistributedTables());
 			CAutoTraceFlag atf(EopttraceDisableMotions, fMasterOnly);
 
+			// per-stage search statistics go to the server log
+			CAutoTraceFlag atfStats(EopttracePrintOptimizationStatistics, NULL != optimizer_stats_collector || optimizer_print_optimization_stats);
+			if (NULL != optimizer_stats_collector)
+			{
+				optimizer_stats_collector->search_stages = (NULL == pdrgpss) ? 1 : pdrgpss->UlLength();
+			}
+
 			pdxlnPlan = COptimizer::PdxlnOptimize
 									(
 									pmp,
@@ -1086,6 +1223,8 @@ COptTasks::PvOptimizeTask
 									pocconf
 									);
 
+			RecordPhaseStats(pmp, OPTSTATS_PHASE_OPTIMIZE, &starttime);
+
 			if (poctx->m_fSerializePlanDXL)
 			{
 				// serialize DXL to xml
@@ -1101,6 +1240,7 @@ COptTasks::PvOptimizeTask
 				// always use poctx->m_pquery->canSetTag as the ptrquerytodxl->Pquery() is a mutated Query object
 				// that may not have the correct canSetTag
 				poctx->m_pplstmt = (PlannedStmt *) gpdb::PvCopyObject(Pplstmt(pmp, &mda, pdxlnPlan, poctx->m_pquery->canSetTag));
+				RecordPhaseStats(pmp, OPTSTATS_PHASE_DXL_TO_PLSTMT, &starttime);
 			}
 
 			CStatisticsConfig *pstatsconf = pocconf->Pstatsconf();
@@ -1128,7 +1268,7 @@ COptTasks::PvOptimizeTask
 		CRefCount::SafeRelease(pbsDisabled);
 		CRefCount::SafeRelease(pbsTraceFlags);
 		CRefCount::SafeRelease(pdxlnPlan);
-		CMDCache::Shutdown();
+		ShutdownMDCache();
 
 		if (GPOS_MATCH_EX(ex, gpdxl::ExmaGPDB, gpdxl::ExmiGPDBError))
 		{
@@ -1154,7 +1294,7 @@ COptTasks::PvOptimizeTask
 	CRefCount::SafeRelease(pbsTraceFlags);
 	if (!optimizer_metadata_caching)
 	{
-		CMDCache::Shutdown();
+		ShutdownMDCache();
 	}
 
 	return NULL;
@@ -1270,18 +1410,38 @@ COptTasks::PvOptimizeMinidumpTask
 	COptimizerConfig *pocconf = PoconfCreate(pmp, pcm);
 	CDXLNode *pdxlnResult = NULL;
 
+	CDXLMinidump *pdxlmd = NULL;
+
 	GPOS_TRY
 	{
-		pdxlnResult = CMinidumperUtils::PdxlnExecuteMinidump(pmp, poptmdpctxt->m_szFileName, ulSegments, gp_session_id, gp_command_count, pocconf);
+		if (NULL != poptmdpctxt->m_pbdxls)
+		{
+			// a binary minidump is turned into DXL objects directly
+			pdxlmd = CBinaryDXLParser::PdxlmdLoad(pmp, poptmdpctxt->m_pbdxls);
+			pdxlnResult = CMinidumperUtils::PdxlnExecuteMinidump(pmp, pdxlmd, poptmdpctxt->m_szFileName, ulSegments, gp_session_id, gp_command_count, pocconf);
+		}
+		else
+		{
+			pdxlnResult = CMinidumperUtils::PdxlnExecuteMinidump(pmp, poptmdpctxt->m_szFileName, ulSegments, gp_session_id, gp_command_count, pocconf);
+		}
 	}
 	GPOS_CATCH_EX(ex)
 	{
 		CRefCount::SafeRelease(pdxlnResult);
 		CRefCount::SafeRelease(pocconf);
+		if (NULL != pdxlmd)
+		{
+			GPOS_DELETE(pdxlmd);
+		}
 		GPOS_RETHROW(ex);
 	}
 	GPOS_CATCH_END;
 
+	if (NULL != pdxlmd)
+	{
+		GPOS_DELETE(pdxlmd);
+	}
+
 	CWStringDynamic strDXL(pmp);
 	COstreamString oss(&strDXL);
 	CDXLUtils::SerializePlan
@@ -1562,8 +1722,6 @@ COptTasks::PvEvalExprFromDXLTask
 	GPOS_ASSERT(NULL != pdxlnInput);
 
 	CDXLNode *pdxlnResult = NULL;
-	BOOL fReleaseCache = false;
-
 	// Does the metadatacache need to be reset?
 	//
 	// On the first call, before the cache has been initialized, we
@@ -1573,21 +1731,7 @@ COptTasks::PvEvalExprFromDXLTask
 	bool reset_mdcache = gpdb::FMDCacheNeedsReset();
 
 	// initialize metadata cache, or purge if needed, or change size if requested
-	if (!CMDCache::FInitialized())
-	{
-		CMDCache::Init();
-		CMDCache::SetCacheQuota(optimizer_mdcache_size * 1024L);
-		fReleaseCache = true;
-	}
-	else if (reset_mdcache)
-	{
-		CMDCache::Reset();
-		CMDCache::SetCacheQuota(optimizer_mdcache_size * 1024L);
-	}
-	else if (CMDCache::ULLGetCacheQuota() != (ULLONG) optimizer_mdcache_size * 1024L)
-	{
-		CMDCache::SetCacheQuota(optimizer_mdcache_size * 1024L);
-	}
+	BOOL fReleaseCache = FInitMDCache(reset_mdcache);
 
 	GPOS_TRY
 	{
@@ -1607,7 +1751,7 @@ COptTasks::PvEvalExprFromDXLTask
 		CRefCount::SafeRelease(pdxlnInput);
 		if (fReleaseCache)
 		{
-			CMDCache::Shutdown();
+			ShutdownMDCache();
 		}
 		if (FErrorOut(ex))
 		{
@@ -1635,7 +1779,7 @@ COptTasks::PvEvalExprFromDXLTask
 
 	if (fReleaseCache)
 	{
-		CMDCache::Shutdown();
+		ShutdownMDCache();
 	}
 
 	return NULL;
@@ -1765,18 +1909,32 @@ COptTasks::PplstmtFromXML
 //		COptTasks::DumpMDObjs
 //
 //	@doc:
-//		Dump relcache objects into DXL file
+//		Dump relcache objects into DXL file, optionally in the compact
+//		binary encoding
 //
 //---------------------------------------------------------------------------
 void
 COptTasks::DumpMDObjs
 	(
 	List *plistOids,
-	const char *szFilename
+	const char *szFilename,
+	bool fBinary
 	)
 {
-	SContextRelcacheToDXL ctxrelcache(plistOids, ULONG_MAX /*ulCmpt*/, szFilename);
-	Execute(&PvDXLFromMDObjsTask, &ctxrelcache);
+	if (!fBinary)
+	{
+		SContextRelcacheToDXL ctxrelcache(plistOids, ULONG_MAX /*ulCmpt*/, szFilename);
+		Execute(&PvDXLFromMDObjsTask, &ctxrelcache);
+		return;
+	}
+
+	char *szDXL = SzMDObjs(plistOids);
+	uint32 ulLen = 0;
+	char *pcBinary = CBinaryDXL::PcEncode(szDXL, strlen(szDXL), &ulLen);
+	gpdb::GPDBFree(szDXL);
+
+	CBinaryDXL::WriteFile(szFilename, pcBinary, ulLen);
+	pfree(pcBinary);
 }
 
 
@@ -1963,9 +2121,28 @@ COptTasks::SzOptimizeMinidumpFromFile
 	GPOS_ASSERT(NULL != szFileName);
 	SOptimizeMinidumpContext optmdpctxt;
 	optmdpctxt.m_szFileName = szFileName;
+	optmdpctxt.m_pbdxls = NULL;
 	optmdpctxt.m_szDXLResult = NULL;
 
+	// a binary minidump is decompressed and validated here, since that
+	// reports errors with ereport, and replayed into DXL objects in the task
+	SBinaryDXLStream *pbdxls = NULL;
+	if (CBinaryDXL::FBinaryDXLFile(szFileName))
+	{
+		uint32 ulLen = 0;
+		char *pcContents = CBinaryDXL::PcReadFile(szFileName, &ulLen);
+		pbdxls = CBinaryDXL::PbdxlsInflate(pcContents, ulLen);
+		pfree(pcContents);
+		optmdpctxt.m_pbdxls = pbdxls;
+	}
+
 	Execute(&PvOptimizeMinidumpTask, &optmdpctxt);
+
+	if (NULL != pbdxls)
+	{
+		CBinaryDXL::FreeStream(pbdxls);
+	}
+
 	return optmdpctxt.m_szDXLResult;
 }
 
@@ -1163,6 +1163,9 @@ _copyMotion(Motion *from)
 	COPY_NODE_FIELD(hashExpr);
 	COPY_NODE_FIELD(hashDataTypes);
 
+	COPY_SCALAR_FIELD(skewAction);
+	COPY_NODE_FIELD(skewValues);
+
 	COPY_SCALAR_FIELD(numOutputSegs);
 	COPY_POINTER_FIELD(outputSegIdx, from->numOutputSegs * sizeof(int));
 
@@ -3877,6 +3880,7 @@ _copyExplainStmt(ExplainStmt *from)
 	COPY_NODE_FIELD(query);
 	COPY_SCALAR_FIELD(verbose);
 	COPY_SCALAR_FIELD(analyze);
+	COPY_SCALAR_FIELD(optimizer_stats);
 
 	return newnode;
 }
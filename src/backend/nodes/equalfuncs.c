@@ -1631,6 +1631,7 @@ _equalExplainStmt(ExplainStmt *a, ExplainStmt *b)
 	COMPARE_NODE_FIELD(query);
 	COMPARE_SCALAR_FIELD(verbose);
 	COMPARE_SCALAR_FIELD(analyze);
+	COMPARE_SCALAR_FIELD(optimizer_stats);
 
 	return true;
 }
@@ -508,6 +508,9 @@ _outMotion(StringInfo str, Motion *node)
 	WRITE_NODE_FIELD(hashExpr);
 	WRITE_NODE_FIELD(hashDataTypes);
 
+	WRITE_ENUM_FIELD(skewAction, MotionSkewAction);
+	WRITE_NODE_FIELD(skewValues);
+
 	WRITE_INT_FIELD(numOutputSegs);
 	WRITE_INT_ARRAY(outputSegIdx, node->numOutputSegs, int);
 
@@ -1025,6 +1025,9 @@ _outMotion(StringInfo str, Motion *node)
 	WRITE_NODE_FIELD(hashExpr);
 	WRITE_NODE_FIELD(hashDataTypes);
 
+	WRITE_ENUM_FIELD(skewAction, MotionSkewAction);
+	WRITE_NODE_FIELD(skewValues);
+
 	WRITE_INT_FIELD(numOutputSegs);
 	appendStringInfoLiteral(str, " :outputSegIdx");
 	for (i = 0; i < node->numOutputSegs; i++)
@@ -1962,6 +1965,8 @@ _outCdbMotionPath(StringInfo str, CdbMotionPath *node)
     _outPathInfo(str, &node->path);
 
     WRITE_NODE_FIELD(subpath);
+    WRITE_ENUM_FIELD(skewAction, MotionSkewAction);
+    WRITE_NODE_FIELD(skewValues);
 }
 
 #ifndef COMPILING_BINARY_FUNCS
@@ -2193,6 +2193,9 @@ _readMotion(void)
 	READ_NODE_FIELD(hashExpr);
 	READ_NODE_FIELD(hashDataTypes);
 
+	READ_ENUM_FIELD(skewAction, MotionSkewAction);
+	READ_NODE_FIELD(skewValues);
+
 	READ_INT_FIELD(numOutputSegs);
 	READ_INT_ARRAY(outputSegIdx, local_node->numOutputSegs, int);
 
@@ -338,7 +338,7 @@ static Node *makeIsNotDistinctFromNode(Node *expr, int position);
 %type <boolean> index_opt_unique opt_verbose opt_full
 %type <boolean> opt_freeze opt_default opt_ordered opt_recheck
 %type <boolean> opt_rootonly_all
-%type <boolean> opt_dxl
+%type <boolean> opt_dxl opt_optimizer_stats
 %type <boolean> codegen
 %type <defelt>	opt_binary opt_oids copy_delimiter
 
@@ -597,7 +597,7 @@ static Node *makeIsNotDistinctFromNode(Node *expr, int position);
 
 	NEWLINE NOCREATEEXTTABLE NOOVERCOMMIT
 
-	ORDERED OTHERS OVER OVERCOMMIT
+	OPTIMIZER_STATS ORDERED OTHERS OVER OVERCOMMIT
 
 	PARTITION PARTITIONS PASSING PERCENT PERCENTILE_CONT PERCENTILE_DISC
 	PRECEDING PROTOCOL
@@ -8885,11 +8885,11 @@ opt_name_list:
 /*****************************************************************************
  *
  *		QUERY:
- *				EXPLAIN [ANALYZE] [VERBOSE] query
+ *				EXPLAIN [ANALYZE] [VERBOSE] [DXL] [CODEGEN] [OPTIMIZER_STATS] query
  *
  *****************************************************************************/
 
-ExplainStmt: EXPLAIN opt_analyze opt_verbose opt_dxl opt_force codegen ExplainableStmt
+ExplainStmt: EXPLAIN opt_analyze opt_verbose opt_dxl opt_force codegen opt_optimizer_stats ExplainableStmt
 				{
 					ExplainStmt *n = makeNode(ExplainStmt);
 					n->analyze = $2;
@@ -8900,7 +8900,8 @@ ExplainStmt: EXPLAIN opt_analyze opt_verbose opt_dxl opt_force codegen Explainab
 								errmsg("cannot use force with explain statement")
 							       ));
 					n->codegen = $6;
-					n->query = $7;
+					n->optimizer_stats = $7;
+					n->query = $8;
 					$$ = (Node *)n;
 				}
 		;
@@ -8936,6 +8937,11 @@ codegen:
 			| /* EMPTY */			{ $$ = FALSE; }
 		;
 
+opt_optimizer_stats:
+			OPTIMIZER_STATS		{ $$ = TRUE; }
+			| /* EMPTY */			{ $$ = FALSE; }
+		;
+
 /*****************************************************************************
  *
  *		QUERY:
@@ -13167,6 +13173,7 @@ unreserved_keyword:
 			| OF
 			| OIDS
 			| OPERATOR
+			| OPTIMIZER_STATS
 			| OPTION
 			| OPTIONS
 			| ORDERED
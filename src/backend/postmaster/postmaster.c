@@ -105,6 +105,7 @@
 #include "catalog/pg_control.h"
 #include "catalog/pg_database.h"
 #include "cdb/cdbutil.h"
+#include "cdb/ml_ipc.h"
 #include "commands/async.h"
 #include "lib/dllist.h"
 #include "libpq/auth.h"
@@ -1287,6 +1288,7 @@ PostmasterMain(int argc, char *argv[])
 	 * Postgres processes running in this directory, so this should be safe.
 	 */
 	RemovePgTempFiles();
+	RemoveICShmRings();
 
 	/*
 	 * Establish input sockets.
@@ -2196,6 +2198,7 @@ BeginResetOfPostmasterAfterChildrenAreShutDown(void)
 	 * Postgres processes running in this directory, so this should be safe.
 	 */
 	RemovePgTempFiles();
+	RemoveICShmRings();
 
 	if (primaryMirrorPostmasterResetShouldRestartPeer())
 	{
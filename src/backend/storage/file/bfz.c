@@ -33,6 +33,12 @@ static const struct{
 {
     {{"none", "false", "no", "off", "0", 0}, bfz_nothing_init},
     {{"zlib", 0}, bfz_zlib_init},
+#ifdef HAVE_LIBZSTD
+    {{"zstd", 0}, bfz_zstd_init},
+#endif
+#ifdef HAVE_LIBLZ4
+    {{"lz4", 0}, bfz_lz4_init},
+#endif
     {{0}}
 };
 
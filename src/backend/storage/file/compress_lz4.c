@@ -0,0 +1,264 @@
+/* compress_lz4.c */
+#include "postgres.h"
+
+#ifdef HAVE_LIBLZ4
+
+#include <lz4frame.h>
+
+#include "storage/bfz.h"
+#include "utils/memutils.h"
+
+#define COMPRESSION_BUFFER_SIZE		(1<<14)
+
+struct bfz_lz4_freeable_stuff
+{
+	struct bfz_freeable_stuff super;
+
+	/* true if compressing, false if decompressing */
+	bool		compressing;
+
+	bool		eof_in;
+
+	/* last return value of LZ4F_decompress; 0 at the end of a frame */
+	size_t		frame_left;
+
+	LZ4F_compressionContext_t cctx;
+	LZ4F_decompressionContext_t dctx;
+
+	/*
+	 * Compressed data: the output of the compressor, big enough for
+	 * COMPRESSION_BUFFER_SIZE bytes of input, or the input of the
+	 * decompressor.
+	 */
+	char	   *buf;
+	size_t		buf_size;
+	size_t		in_pos;
+	size_t		in_size;
+};
+
+/* This file implements bfz compression algorithm "lz4". */
+
+/*
+ * Write out the first len bytes of the compressed data buffer.
+ */
+static void
+bfz_lz4_flush(bfz_t *thiz, size_t len)
+{
+	struct bfz_lz4_freeable_stuff *fs = (void *) thiz->freeable_stuff;
+	int			written = 0;
+
+	while (written < len)
+	{
+		int			n = FileWrite(thiz->file, fs->buf + written, len - written);
+
+		if (n < 0)
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not write to temporary file: %m")));
+		written += n;
+	}
+}
+
+/*
+ * bfz_lz4_close_ex
+ *	Close buffers etc. Does not close the underlying file!
+ */
+static void
+bfz_lz4_close_ex(bfz_t *thiz)
+{
+	struct bfz_lz4_freeable_stuff *fs = (void *) thiz->freeable_stuff;
+
+	if (NULL != fs)
+	{
+		if (fs->compressing)
+		{
+			/* Flush all remaining output to the underlying file */
+			size_t		len = LZ4F_compressEnd(fs->cctx, fs->buf, fs->buf_size, NULL);
+
+			if (LZ4F_isError(len))
+				ereport(ERROR,
+						(errmsg("lz4 compression failed"),
+						 errdetail("%s", LZ4F_getErrorName(len))));
+			bfz_lz4_flush(thiz, len);
+
+			LZ4F_freeCompressionContext(fs->cctx);
+		}
+		else
+			LZ4F_freeDecompressionContext(fs->dctx);
+
+		pfree(fs->buf);
+		pfree(fs);
+		thiz->freeable_stuff = NULL;
+	}
+}
+
+/*
+ * bfz_lz4_write_ex
+ *	 Write data to an opened compressed file.
+ *	 An exception is thrown if the data cannot be written for any reason.
+ */
+static void
+bfz_lz4_write_ex(bfz_t *thiz, const char *buffer, int size)
+{
+	struct bfz_lz4_freeable_stuff *fs = (void *) thiz->freeable_stuff;
+
+	/* Compress at most COMPRESSION_BUFFER_SIZE bytes at a time */
+	while (size > 0)
+	{
+		int			chunk = Min(size, COMPRESSION_BUFFER_SIZE);
+		size_t		len;
+
+		len = LZ4F_compressUpdate(fs->cctx, fs->buf, fs->buf_size,
+								  buffer, chunk, NULL);
+		if (LZ4F_isError(len))
+			ereport(ERROR,
+					(errmsg("lz4 compression failed"),
+					 errdetail("%s", LZ4F_getErrorName(len))));
+		bfz_lz4_flush(thiz, len);
+
+		buffer += chunk;
+		size -= chunk;
+	}
+}
+
+/*
+ * bfz_lz4_read_ex
+ *	Read data from an already opened compressed file.
+ *
+ *	The buffer pointer must be valid and have at least size bytes.
+ *	An exception is thrown if the data cannot be read for any reason.
+ *
+ * The buffer is filled completely.
+ */
+static int
+bfz_lz4_read_ex(bfz_t *thiz, char *buffer, int size)
+{
+	struct bfz_lz4_freeable_stuff *fs = (void *) thiz->freeable_stuff;
+	size_t		out_pos = 0;
+
+	while (out_pos < size)
+	{
+		size_t		src_len;
+		size_t		dst_len;
+
+		/*
+		 * Fill up our input buffer from the input file.
+		 */
+		if (fs->in_pos == fs->in_size && !fs->eof_in)
+		{
+			int			s = FileRead(thiz->file, fs->buf, fs->buf_size);
+
+			if (s < 0)
+				ereport(ERROR,
+						(errcode_for_file_access(),
+						 errmsg("could not read from temporary file: %m")));
+			if (s == 0)
+			{
+				/* no more data to read */
+				fs->eof_in = true;
+			}
+
+			fs->in_pos = 0;
+			fs->in_size = s;
+		}
+
+		/* decompress */
+		src_len = fs->in_size - fs->in_pos;
+		dst_len = size - out_pos;
+		fs->frame_left = LZ4F_decompress(fs->dctx, buffer + out_pos, &dst_len,
+										 fs->buf + fs->in_pos, &src_len,
+										 NULL);
+		if (LZ4F_isError(fs->frame_left))
+			ereport(ERROR,
+					(errmsg("could not uncompress data from temporary file"),
+					 errdetail("%s", LZ4F_getErrorName(fs->frame_left))));
+
+		fs->in_pos += src_len;
+		out_pos += dst_len;
+
+		if (dst_len == 0 && fs->in_pos == fs->in_size && fs->eof_in)
+		{
+			if (fs->frame_left != 0)
+			{
+				/* No more input, but lz4 thinks there should be more */
+				ereport(ERROR,
+						(errcode_for_file_access(),
+						 errmsg("unexpected end of temporary file")));
+			}
+
+			/*
+			 * end of input file, and buffers are empty, and lz4 agrees that
+			 * we're at end of a frame.
+			 */
+			break;
+		}
+	}
+
+	return out_pos;
+}
+
+/*
+ * bfz_lz4_init
+ *	Initialize the lz4 subsystem for a file.
+ *
+ *	The underlying file descriptor fd should already be opened
+ *	and valid. Memory is allocated in the current memory context.
+ */
+void
+bfz_lz4_init(bfz_t *thiz)
+{
+	struct bfz_lz4_freeable_stuff *fs = palloc0(sizeof *fs);
+	LZ4F_errorCode_t err;
+
+	fs->eof_in = false;
+	fs->frame_left = 0;
+	fs->compressing = (thiz->mode == BFZ_MODE_APPEND);
+
+	if (fs->compressing)
+	{
+		/*
+		 * writing a compressed file
+		 */
+		size_t		len;
+
+		err = LZ4F_createCompressionContext(&fs->cctx, LZ4F_VERSION);
+		if (LZ4F_isError(err))
+			ereport(ERROR,
+					(errmsg("lz4 LZ4F_createCompressionContext failed"),
+					 errdetail("%s", LZ4F_getErrorName(err))));
+
+		fs->buf_size = Max(LZ4F_compressBound(COMPRESSION_BUFFER_SIZE, NULL),
+						   LZ4F_HEADER_SIZE_MAX);
+		fs->buf = palloc(fs->buf_size);
+
+		/* The frame header goes first */
+		len = LZ4F_compressBegin(fs->cctx, fs->buf, fs->buf_size, NULL);
+		if (LZ4F_isError(len))
+			ereport(ERROR,
+					(errmsg("lz4 LZ4F_compressBegin failed"),
+					 errdetail("%s", LZ4F_getErrorName(len))));
+		thiz->freeable_stuff = &fs->super;
+		bfz_lz4_flush(thiz, len);
+	}
+	else
+	{
+		/*
+		 * reading a compressed file
+		 */
+		err = LZ4F_createDecompressionContext(&fs->dctx, LZ4F_VERSION);
+		if (LZ4F_isError(err))
+			ereport(ERROR,
+					(errmsg("lz4 LZ4F_createDecompressionContext failed"),
+					 errdetail("%s", LZ4F_getErrorName(err))));
+
+		fs->buf_size = COMPRESSION_BUFFER_SIZE;
+		fs->buf = palloc(fs->buf_size);
+	}
+
+	thiz->freeable_stuff = &fs->super;
+	fs->super.read_ex = bfz_lz4_read_ex;
+	fs->super.write_ex = bfz_lz4_write_ex;
+	fs->super.close_ex = bfz_lz4_close_ex;
+}
+
+#endif   /* HAVE_LIBLZ4 */
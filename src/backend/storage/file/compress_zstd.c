@@ -0,0 +1,272 @@
+/* compress_zstd.c */
+#include "postgres.h"
+
+#ifdef HAVE_LIBZSTD
+
+#define ZSTD_STATIC_LINKING_ONLY	/* for ZSTD_customMem */
+#include <zstd.h>
+
+#include "storage/bfz.h"
+#include "utils/memutils.h"
+
+#define COMPRESSION_BUFFER_SIZE		(1<<14)
+
+/*
+ * Workfiles are written once and read back soon after, so the fastest
+ * level is the right one.
+ */
+#define ZSTD_WORKFILE_LEVEL			1
+
+struct bfz_zstd_freeable_stuff
+{
+	struct bfz_freeable_stuff super;
+
+	/* true if compressing, false if decompressing */
+	bool		compressing;
+
+	bool		eof_in;
+
+	/* last return value of ZSTD_decompressStream; 0 at the end of a frame */
+	size_t		frame_left;
+
+	ZSTD_CStream *cstream;
+	ZSTD_DStream *dstream;
+
+	ZSTD_inBuffer in;
+	char		buf[COMPRESSION_BUFFER_SIZE];
+};
+
+/* This file implements bfz compression algorithm "zstd". */
+
+/*
+ * zstd's working memory comes from the memory context the file was opened
+ * in, like zlib's, so that it goes away with the context on error.
+ */
+static void *
+zstd_alloc(void *opaque, size_t size)
+{
+	return MemoryContextAlloc((MemoryContext) opaque, size);
+}
+
+static void
+zstd_free(void *opaque, void *address)
+{
+	if (address != NULL)
+		pfree(address);
+}
+
+/*
+ * Write out the compressed data in the output buffer.
+ */
+static void
+bfz_zstd_flush(bfz_t *thiz, ZSTD_outBuffer *out)
+{
+	int			written = 0;
+
+	while (written < out->pos)
+	{
+		int			n = FileWrite(thiz->file, (char *) out->dst + written,
+								  out->pos - written);
+
+		if (n < 0)
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not write to temporary file: %m")));
+		written += n;
+	}
+}
+
+/*
+ * bfz_zstd_close_ex
+ *	Close buffers etc. Does not close the underlying file!
+ */
+static void
+bfz_zstd_close_ex(bfz_t *thiz)
+{
+	struct bfz_zstd_freeable_stuff *fs = (void *) thiz->freeable_stuff;
+
+	if (NULL != fs)
+	{
+		if (fs->compressing)
+		{
+			size_t		left;
+
+			/* Flush all remaining output to the underlying file */
+			do
+			{
+				ZSTD_outBuffer out = {fs->buf, COMPRESSION_BUFFER_SIZE, 0};
+
+				left = ZSTD_endStream(fs->cstream, &out);
+				if (ZSTD_isError(left))
+					ereport(ERROR,
+							(errmsg("zstd compression failed"),
+							 errdetail("%s", ZSTD_getErrorName(left))));
+
+				bfz_zstd_flush(thiz, &out);
+			} while (left > 0);
+
+			ZSTD_freeCStream(fs->cstream);
+		}
+		else
+			ZSTD_freeDStream(fs->dstream);
+
+		pfree(fs);
+		thiz->freeable_stuff = NULL;
+	}
+}
+
+/*
+ * bfz_zstd_write_ex
+ *	 Write data to an opened compressed file.
+ *	 An exception is thrown if the data cannot be written for any reason.
+ */
+static void
+bfz_zstd_write_ex(bfz_t *thiz, const char *buffer, int size)
+{
+	struct bfz_zstd_freeable_stuff *fs = (void *) thiz->freeable_stuff;
+	ZSTD_inBuffer in = {buffer, size, 0};
+
+	/* Compress until the input buffer is empty */
+	while (in.pos < in.size)
+	{
+		ZSTD_outBuffer out = {fs->buf, COMPRESSION_BUFFER_SIZE, 0};
+		size_t		ret;
+
+		ret = ZSTD_compressStream(fs->cstream, &out, &in);
+		if (ZSTD_isError(ret))
+			ereport(ERROR,
+					(errmsg("zstd compression failed"),
+					 errdetail("%s", ZSTD_getErrorName(ret))));
+
+		bfz_zstd_flush(thiz, &out);
+	}
+}
+
+/*
+ * bfz_zstd_read_ex
+ *	Read data from an already opened compressed file.
+ *
+ *	The buffer pointer must be valid and have at least size bytes.
+ *	An exception is thrown if the data cannot be read for any reason.
+ *
+ * The buffer is filled completely.
+ */
+static int
+bfz_zstd_read_ex(bfz_t *thiz, char *buffer, int size)
+{
+	struct bfz_zstd_freeable_stuff *fs = (void *) thiz->freeable_stuff;
+	ZSTD_outBuffer out = {buffer, size, 0};
+
+	while (out.pos < out.size)
+	{
+		size_t		produced = out.pos;
+
+		/*
+		 * Fill up our input buffer from the input file.
+		 */
+		if (fs->in.pos == fs->in.size && !fs->eof_in)
+		{
+			int			s = FileRead(thiz->file, fs->buf, COMPRESSION_BUFFER_SIZE);
+
+			if (s < 0)
+				ereport(ERROR,
+						(errcode_for_file_access(),
+						 errmsg("could not read from temporary file: %m")));
+			if (s == 0)
+			{
+				/* no more data to read */
+				fs->eof_in = true;
+			}
+
+			fs->in.src = fs->buf;
+			fs->in.size = s;
+			fs->in.pos = 0;
+		}
+
+		/* decompress */
+		fs->frame_left = ZSTD_decompressStream(fs->dstream, &out, &fs->in);
+		if (ZSTD_isError(fs->frame_left))
+			ereport(ERROR,
+					(errmsg("could not uncompress data from temporary file"),
+					 errdetail("%s", ZSTD_getErrorName(fs->frame_left))));
+
+		if (out.pos == produced && fs->in.pos == fs->in.size && fs->eof_in)
+		{
+			if (fs->frame_left != 0)
+			{
+				/* No more input, but zstd thinks there should be more */
+				ereport(ERROR,
+						(errcode_for_file_access(),
+						 errmsg("unexpected end of temporary file")));
+			}
+
+			/*
+			 * end of input file, and buffers are empty, and zstd agrees that
+			 * we're at end of a frame.
+			 */
+			break;
+		}
+	}
+
+	return out.pos;
+}
+
+/*
+ * bfz_zstd_init
+ *	Initialize the zstd subsystem for a file.
+ *
+ *	The underlying file descriptor fd should already be opened
+ *	and valid. Memory is allocated in the current memory context.
+ */
+void
+bfz_zstd_init(bfz_t *thiz)
+{
+	struct bfz_zstd_freeable_stuff *fs = palloc0(sizeof *fs);
+	ZSTD_customMem mem = {zstd_alloc, zstd_free, CurrentMemoryContext};
+
+	fs->eof_in = false;
+	fs->frame_left = 0;
+	fs->compressing = (thiz->mode == BFZ_MODE_APPEND);
+
+	if (fs->compressing)
+	{
+		/*
+		 * writing a compressed file
+		 */
+		size_t		ret;
+
+		fs->cstream = ZSTD_createCStream_advanced(mem);
+		if (fs->cstream == NULL)
+			ereport(ERROR,
+					(errmsg("zstd ZSTD_createCStream failed")));
+		ret = ZSTD_initCStream(fs->cstream, ZSTD_WORKFILE_LEVEL);
+		if (ZSTD_isError(ret))
+			ereport(ERROR,
+					(errmsg("zstd ZSTD_initCStream failed"),
+					 errdetail("%s", ZSTD_getErrorName(ret))));
+	}
+	else
+	{
+		/*
+		 * reading a compressed file
+		 */
+		size_t		ret;
+
+		fs->dstream = ZSTD_createDStream_advanced(mem);
+		if (fs->dstream == NULL)
+			ereport(ERROR,
+					(errmsg("zstd ZSTD_createDStream failed")));
+		ret = ZSTD_initDStream(fs->dstream);
+		if (ZSTD_isError(ret))
+			ereport(ERROR,
+					(errmsg("zstd ZSTD_initDStream failed"),
+					 errdetail("%s", ZSTD_getErrorName(ret))));
+	}
+
+	thiz->freeable_stuff = &fs->super;
+	fs->super.read_ex = bfz_zstd_read_ex;
+	fs->super.write_ex = bfz_zstd_write_ex;
+	fs->super.close_ex = bfz_zstd_close_ex;
+}
+
+#endif   /* HAVE_LIBZSTD */
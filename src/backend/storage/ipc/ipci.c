@@ -37,6 +37,7 @@
 #include "cdb/cdbpersistentcheck.h"
 #include "cdb/cdbresynchronizechangetracking.h"
 #include "cdb/cdbvars.h"
+#include "cdb/ml_ipc.h"
 #include "miscadmin.h"
 #include "pgstat.h"
 #include "postmaster/autovacuum.h"
@@ -172,6 +173,7 @@ CreateSharedMemoryAndSemaphores(bool makePrivate, int port)
 		size = add_size(size, FtsShmemSize());
 		size = add_size(size, tmShmemSize());
 		size = add_size(size, SeqServerShmemSize());
+		size = add_size(size, ICPeerStatsShmemSize());
 		size = add_size(size, PersistentFileSysObj_ShmemSize());
 		size = add_size(size, PersistentFilespace_ShmemSize());
 		size = add_size(size, PersistentTablespace_ShmemSize());
@@ -373,6 +375,7 @@ CreateSharedMemoryAndSemaphores(bool makePrivate, int port)
 	WalRcvShmemInit();
 	//AutoVacuumShmemInit();
 	SeqServerShmemInit();
+	ICPeerStatsShmemInit();
 
 	if (GPAreFileReplicationStructuresRequired()) {
 	
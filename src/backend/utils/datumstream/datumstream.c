@@ -12,6 +12,7 @@
 #include <unistd.h>
 #include <fcntl.h>
 
+#include "access/appendonly_zonemap.h"
 #include "access/tupmacs.h"
 #include "access/tuptoaster.h"
 
@@ -294,7 +295,14 @@ datumstreamwrite_put(
 					 bool null,
 					 void **toFree)
 {
-	return DatumStreamBlockWrite_Put(&acc->blockWrite, d, null, toFree);
+	int			result;
+
+	result = DatumStreamBlockWrite_Put(&acc->blockWrite, d, null, toFree);
+
+	if (result >= 0 && acc->zoneCmp != NULL)
+		AppendOnlyZone_AddValue(&acc->zone, acc->zoneCmp, d, null);
+
+	return result;
 }
 
 int
@@ -346,6 +354,7 @@ init_datumstream_info(
 					  DatumStreamVersion * datumStreamVersion, //OUTPUT
 					  bool *rle_compression, //OUTPUT
 					  bool *delta_compression, //OUTPUT
+					  bool *dict_compression, //OUTPUT
 					  AppendOnlyStorageAttributes *ao_attr, //OUTPUT
 					  int32 * maxAoBlockSize, //OUTPUT
 					  char *compName,
@@ -369,6 +378,7 @@ init_datumstream_info(
 	 */
 	*rle_compression = false;
 	*delta_compression = false;
+	*dict_compression = false;
 
 	ao_attr->compress = false;
 	ao_attr->compressType = NULL;
@@ -438,6 +448,11 @@ init_datumstream_info(
 		 */
 		*delta_compression = is_deltarange_compression_supported(attr);
 
+		/*
+		 * Blocks of variable-length items with few distinct values are
+		 * dictionary encoded.
+		 */
+		*dict_compression = (gp_aocs_dictionary_encoding && attr->attlen == -1);
 	}
 	else if (compName == NULL || pg_strcasecmp(compName, "none") == 0)
 	{
@@ -501,6 +516,7 @@ create_datumstreamwrite(
 						  &acc->datumStreamVersion,
 						  &acc->rle_want_compression,
 						  &acc->delta_want_compression,
+						  &acc->dict_want_compression,
 						  &acc->ao_attr,
 						  &acc->maxAoBlockSize,
 						  compName,
@@ -605,6 +621,7 @@ create_datumstreamwrite(
 							   acc->datumStreamVersion,
 							   acc->rle_want_compression,
 							   acc->delta_want_compression,
+							   acc->dict_want_compression,
 							   initialMaxDatumPerBlock,
 							   maxDatumPerBlock,
 							   acc->maxAoBlockSize - acc->maxAoHeaderSize,
@@ -639,6 +656,7 @@ create_datumstreamread(
 						  &acc->datumStreamVersion,
 						  &acc->rle_can_have_compression,
 						  &acc->delta_can_have_compression,
+						  &acc->dict_can_have_compression,
 						  &acc->ao_attr,
 						  &acc->maxAoBlockSize,
 						  compName,
@@ -870,6 +888,13 @@ datumstreamread_open_file(DatumStreamRead * ds, char *fn, int64 eof, int64 eofUn
 	if (ds->need_close_file)
 		datumstreamread_close_file(ds);
 
+	/*
+	 * Forget any rows left unread in the last block of the previous file, so
+	 * that the first advance asks for a block of this one.
+	 */
+	DatumStreamBlockRead_Reset(&ds->blockRead);
+	ds->largeObjectState = DatumStreamLargeObjectState_None;
+
 	AppendOnlyStorageRead_OpenFile(&ds->ao_read, fn, version, ds->eof);
 
 	ds->need_close_file = true;
@@ -1030,13 +1055,25 @@ datumstreamwrite_block(DatumStreamWrite *acc,
 	}
 
 	/* Insert an entry to the block directory */
-	AppendOnlyBlockDirectory_InsertEntry(
-		blockDirectory,
-		columnGroupNo,
-		acc->blockFirstRowNum,
-		AppendOnlyStorageWrite_LogicalBlockStartOffset(&acc->ao_write),
-		itemCount,
-		addColAction);
+	if (acc->zoneCmp != NULL && !addColAction)
+	{
+		AppendOnlyBlockDirectory_InsertEntryWithZones(
+			blockDirectory,
+			columnGroupNo,
+			acc->blockFirstRowNum,
+			AppendOnlyStorageWrite_LogicalBlockStartOffset(&acc->ao_write),
+			itemCount,
+			&acc->zone);
+		AppendOnlyZone_Reset(&acc->zone);
+	}
+	else
+		AppendOnlyBlockDirectory_InsertEntry(
+			blockDirectory,
+			columnGroupNo,
+			acc->blockFirstRowNum,
+			AppendOnlyStorageWrite_LogicalBlockStartOffset(&acc->ao_write),
+			itemCount,
+			addColAction);
 
 	return writesz;
 }
@@ -1451,6 +1488,101 @@ datumstreamread_find(DatumStreamRead * datumStream,
 	Assert(rowNumInBlock == DatumStreamBlockRead_Nth(&datumStream->blockRead));
 }
 
+/*
+ * Position the datum stream so that the next datumstreamread_advance returns
+ * the row targetRowNum, skipping over the blocks before it without reading
+ * their content.
+ *
+ * Blocks written before 4.0 have no first row number in their header; their
+ * rows are numbered by counting, as when reading them one by one.  The row
+ * the next datumstreamread_advance returns is set in *rowNum: targetRowNum,
+ * unless the stream was already past the start of its block.
+ *
+ * Returns the number of blocks skipped, or -1 at the end of the file.
+ */
+int
+datumstreamread_skip_to(DatumStreamRead * acc,
+						int64 targetRowNum,
+						int64 *rowNum)
+{
+	int			skipped = 0;
+	bool		haveBlock;
+
+	/* No block of the current file has been read until one has rows */
+	haveBlock = (acc->largeObjectState != DatumStreamLargeObjectState_None ||
+				 acc->blockRead.logical_row_count > 0);
+
+	if (haveBlock &&
+		targetRowNum < acc->blockFirstRowNum + acc->blockRowCount)
+	{
+		if (targetRowNum > acc->blockFirstRowNum)
+		{
+			datumstreamread_find(acc, targetRowNum - acc->blockFirstRowNum - 1);
+			*rowNum = targetRowNum;
+		}
+		else
+			*rowNum = acc->blockFirstRowNum +
+				DatumStreamBlockRead_Nth(&acc->blockRead) + 1;
+		return 0;
+	}
+
+	while (true)
+	{
+		acc->blockFirstRowNum += acc->blockRowCount;
+
+		if (!AppendOnlyStorageRead_GetBlockInfo(&acc->ao_read,
+												&acc->getBlockInfo.contentLen,
+											&acc->getBlockInfo.execBlockKind,
+												&acc->getBlockInfo.firstRow,
+												&acc->getBlockInfo.rowCnt,
+												&acc->getBlockInfo.isLarge,
+											&acc->getBlockInfo.isCompressed))
+			return -1;
+
+		if (acc->getBlockInfo.firstRow >= 0)
+			acc->blockFirstRowNum = acc->getBlockInfo.firstRow;
+		acc->blockFileOffset = acc->ao_read.current.headerOffsetInFile;
+		acc->blockRowCount = acc->getBlockInfo.rowCnt;
+
+		if (acc->blockFirstRowNum + acc->blockRowCount > targetRowNum)
+			break;
+
+		AppendOnlyStorageRead_SkipCurrentBlock(&acc->ao_read);
+		skipped++;
+	}
+
+	datumstreamread_block_content(acc);
+
+	if (targetRowNum > acc->blockFirstRowNum)
+	{
+		datumstreamread_find(acc, targetRowNum - acc->blockFirstRowNum - 1);
+		*rowNum = targetRowNum;
+	}
+	else
+		*rowNum = acc->blockFirstRowNum;
+
+	return skipped;
+}
+
+/*
+ * Look up an item, given by its data without the varlena header, in the
+ * dictionary of the current block.
+ *
+ * Returns false if the block has no dictionary.  Otherwise *code is set to
+ * the dictionary code of the item, or -1 if no row of the block has it.
+ */
+bool
+datumstreamread_dict_lookup(DatumStreamRead * acc,
+							const char *data, int len, int *code)
+{
+	if (acc->largeObjectState != DatumStreamLargeObjectState_None ||
+		!acc->blockRead.dict_block_was_compressed)
+		return false;
+
+	*code = DatumStreamBlockRead_DictLookup(&acc->blockRead, data, len);
+	return true;
+}
+
 /*
  * Find the block that contains the given row.
  */
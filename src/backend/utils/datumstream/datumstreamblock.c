@@ -5,6 +5,7 @@
  */
 
 #include "postgres.h"
+#include "access/hash.h"
 #include "access/tupmacs.h"
 #include "access/tuptoaster.h"
 #include "utils/datumstreamblock.h"
@@ -376,13 +377,20 @@ DatumStreamBlockRead_Init(
 	Assert(dsr->delta_block_was_compressed == false);
 	Assert(dsr->delta_item == false);
 
+	Assert(dsr->dict_block_was_compressed == false);
+	Assert(dsr->dict_entries == NULL);
 }
 
 void
 DatumStreamBlockRead_Finish(
 							DatumStreamBlockRead * dsr)
 {
-	/* Place holder. */
+	if (dsr->dict_entries != NULL)
+	{
+		pfree(dsr->dict_entries);
+		dsr->dict_entries = NULL;
+		dsr->dict_entries_maxcount = 0;
+	}
 }
 
 /*
@@ -587,6 +595,88 @@ DatumStreamBlockRead_ResetDense(DatumStreamBlockRead * dsr)
 
 	dsr->delta_block_was_compressed = false;
 	dsr->delta_item = false;
+
+	dsr->dict_block_was_compressed = false;
+	dsr->dict_codesp = NULL;
+	dsr->dict_code_width = 0;
+	dsr->dict_code = -1;
+	dsr->dict_entry_count = 0;
+}
+
+/*
+ * Find the items of the dictionary of a block in its datum area.
+ */
+static void
+DatumStreamBlockRead_DictGetReady(DatumStreamBlockRead * dsr)
+{
+	uint8	   *item;
+	int32		i;
+
+	if (dsr->dict_entry_count > dsr->dict_entries_maxcount)
+	{
+		if (dsr->dict_entries != NULL)
+			pfree(dsr->dict_entries);
+		dsr->dict_entries_maxcount = dsr->dict_entry_count;
+		dsr->dict_entries =
+			MemoryContextAlloc(dsr->memctxt,
+							   dsr->dict_entries_maxcount * sizeof(uint8 *));
+	}
+
+	/*
+	 * The items are laid out like the datums of a block without a
+	 * dictionary.
+	 */
+	item = dsr->datum_beginp;
+	for (i = 0; i < dsr->dict_entry_count; i++)
+	{
+		if (item < dsr->datum_afterp && *item == 0)
+			item = (uint8 *) att_align_nominal(item, dsr->typeInfo.align);
+
+		if (item >= dsr->datum_afterp ||
+			item + VARSIZE_ANY(item) > dsr->datum_afterp)
+		{
+			ereport(ERROR,
+					(errmsg("Datum stream block read dictionary item %d of %d goes beyond end of block "
+							"(physical data size %d)",
+							i,
+							dsr->dict_entry_count,
+							dsr->physical_data_size),
+					 errdetail_datumstreamblockread(dsr),
+					 errcontext_datumstreamblockread(dsr)));
+		}
+
+		dsr->dict_entries[i] = item;
+		item += VARSIZE_ANY(item);
+	}
+}
+
+/*
+ * Look up an item in the dictionary of the current block, by the data of
+ * the item without its varlena header.
+ *
+ * Returns the code of the item, or -1 if it is not in the dictionary, and
+ * so in no row of the block.
+ */
+int32
+DatumStreamBlockRead_DictLookup(
+								DatumStreamBlockRead * dsr,
+								const char *data,
+								int32 len)
+{
+	int32		i;
+
+	Assert(dsr->dict_block_was_compressed);
+
+	for (i = 0; i < dsr->dict_entry_count; i++)
+	{
+		uint8	   *item = dsr->dict_entries[i];
+
+		if (VARSIZE_ANY_EXHDR(item) == len &&
+			memcmp(VARDATA_ANY(item), data, len) == 0)
+			return i;
+	}
+
+	return -1;
 }
 
 void
@@ -920,6 +1010,73 @@ DatumStreamBlockRead_GetReadyDense(
 					 errcontext_datumstreamblockread(dsr)));
 		}
 	}
+
+	dsr->dict_block_was_compressed = ((blockDense->orig_4_bytes.flags & DSB_HAS_DICT_COMPRESSION) != 0);
+	if (dsr->dict_block_was_compressed)
+	{
+		DatumStreamBlock_Dict_Extension dictExtension;
+
+		/*
+		 * Dictionary compression was used for this block.  The extension
+		 * follows the other metadata, and may not be aligned.
+		 */
+		memcpy(&dictExtension, p, sizeof(DatumStreamBlock_Dict_Extension));
+		p += sizeof(DatumStreamBlock_Dict_Extension);
+
+		dsr->dict_entry_count = dictExtension.entry_count;
+		dsr->dict_code_width = DatumStreamBlock_DictCodeWidth(dictExtension.entry_count);
+		dsr->dict_codesp = p;
+		p += dictExtension.codes_size;
+
+		unalignedHeaderSize = p - dsr->buffer_beginp;
+		alignedHeaderSize = MAXALIGN(unalignedHeaderSize);
+
+		/*
+		 * Skip over alignment padding.
+		 */
+		dsr->datum_beginp = dsr->buffer_beginp + alignedHeaderSize;
+		dsr->datum_afterp = dsr->datum_beginp + dsr->physical_data_size;
+
+		DatumStreamBlockRead_DictGetReady(dsr);
+
+		if (Debug_appendonly_print_scan)
+		{
+			ereport(LOG,
+					(errmsg("Datum stream block read unpack Dense with DICTIONARY compression "
+							"(logical row count %d, physical datum count %d, physical data size = %d, "
+							"dictionary entry count %d, codes size %d, "
+						 "unaligned header size %d, aligned header size %d, "
+							"datum begin %p, datum after %p)",
+							dsr->logical_row_count,
+							dsr->physical_datum_count,
+							dsr->physical_data_size,
+							dictExtension.entry_count,
+							dictExtension.codes_size,
+							unalignedHeaderSize,
+							alignedHeaderSize,
+							dsr->datum_beginp,
+							dsr->datum_afterp),
+					 errdetail_datumstreamblockread(dsr),
+					 errcontext_datumstreamblockread(dsr)));
+		}
+
+		/*
+		 * Pre-position on the first item, like the datum pointer is for
+		 * blocks without a dictionary.
+		 */
+		if (dsr->physical_datum_count > 0)
+		{
+			dsr->dict_code = DatumStreamBlockRead_DictCode(dsr, 0);
+			dsr->datump = dsr->dict_entries[dsr->dict_code];
+		}
+		else
+		{
+			dsr->dict_code = -1;
+			dsr->datump = dsr->datum_beginp;
+		}
+		return;
+	}
+
 	dsr->datump = dsr->datum_beginp;
 }
 
@@ -3736,6 +3893,127 @@ DatumStreamBlockWrite_BlockOrig(
 	return writesz;
 }
 
+/*
+ * Build a dictionary of the variable-length items of the block.
+ *
+ * Returns the size the items of the dictionary take in the datum area, with
+ * the number of entries in *entryCount, or -1 if the block would not be
+ * smaller with a dictionary.  dsw->dict_codes then holds the code of each
+ * physical datum, and dsw->dict_entry_offsets the offset of each entry in
+ * the datum buffer.
+ */
+static int32
+DatumStreamBlockWrite_DictBuild(
+								DatumStreamBlockWrite * dsw,
+								int32 * entryCount)
+{
+	int32		physicalDataSize = dsw->datump - dsw->datum_buffer;
+	int32		count = dsw->physical_datum_count;
+	int32		maxEntries = Min(count, DSB_DICT_MAX_ENTRIES);
+	int32		hashSize;
+	int32		entries = 0;
+	int32		dictSize = 0;
+	uint8	   *item;
+	int32		i;
+
+	Assert(dsw->typeInfo->datumlen == -1);
+	Assert(count > 0);
+
+	/*
+	 * Make room for the codes, the entries, and a hash table at most half
+	 * full.
+	 */
+	hashSize = 64;
+	while (hashSize < 2 * maxEntries)
+		hashSize *= 2;
+
+	if (count > dsw->dict_codes_maxcount)
+	{
+		if (dsw->dict_codes != NULL)
+			pfree(dsw->dict_codes);
+		dsw->dict_codes_maxcount = count;
+		dsw->dict_codes = MemoryContextAlloc(dsw->memctxt, count * sizeof(uint16));
+	}
+	if (maxEntries > dsw->dict_entries_maxcount)
+	{
+		if (dsw->dict_entry_offsets != NULL)
+			pfree(dsw->dict_entry_offsets);
+		dsw->dict_entries_maxcount = maxEntries;
+		dsw->dict_entry_offsets = MemoryContextAlloc(dsw->memctxt, maxEntries * sizeof(int32));
+	}
+	if (hashSize > dsw->dict_hash_size)
+	{
+		if (dsw->dict_hash != NULL)
+			pfree(dsw->dict_hash);
+		dsw->dict_hash_size = hashSize;
+		dsw->dict_hash = MemoryContextAlloc(dsw->memctxt, hashSize * sizeof(int32));
+	}
+	memset(dsw->dict_hash, -1, hashSize * sizeof(int32));
+
+	item = dsw->datum_buffer;
+	for (i = 0; i < count; i++)
+	{
+		int32		size;
+		uint32		slot;
+		int32		code;
+
+		/*
+		 * Skip any possible zero paddings before the item, like the reader
+		 * does.
+		 */
+		if (*item == 0)
+			item = (uint8 *) att_align_nominal(item, dsw->typeInfo->align);
+		Assert(item < dsw->datump);
+
+		/*
+		 * Items are stored de-toasted; equality of the bytes is then what
+		 * lookups of the dictionary rely on.
+		 */
+		if (VARATT_IS_EXTENDED(item) && !VARATT_IS_SHORT(item))
+			return -1;
+
+		size = VARSIZE_ANY(item);
+		slot = DatumGetUInt32(hash_any(item, size)) & (hashSize - 1);
+		while ((code = dsw->dict_hash[slot]) >= 0)
+		{
+			uint8	   *entry = dsw->datum_buffer + dsw->dict_entry_offsets[code];
+
+			if (VARSIZE_ANY(entry) == size && memcmp(entry, item, size) == 0)
+				break;
+			slot = (slot + 1) & (hashSize - 1);
+		}
+
+		if (code < 0)
+		{
+			if (entries >= maxEntries)
+				return -1;
+
+			code = entries++;
+			dsw->dict_hash[slot] = code;
+			dsw->dict_entry_offsets[code] = item - dsw->datum_buffer;
+
+			if (!VARATT_IS_SHORT(item))
+				dictSize = att_align_nominal(dictSize, dsw->typeInfo->align);
+			dictSize += size;
+
+			/* Too many distinct items to pay off? */
+			if (dictSize >= physicalDataSize)
+				return -1;
+		}
+
+		dsw->dict_codes[i] = (uint16) code;
+		item += size;
+	}
+
+	if (dictSize + sizeof(DatumStreamBlock_Dict_Extension) +
+		count * DatumStreamBlock_DictCodeWidth(entries) + MAXIMUM_ALIGNOF >=
+		physicalDataSize)
+		return -1;
+
+	*entryCount = entries;
+	return dictSize;
+}
+
 static int64
 DatumStreamBlockWrite_BlockDense(
 								 DatumStreamBlockWrite * dsw,
@@ -3746,10 +4024,13 @@ DatumStreamBlockWrite_BlockDense(
 	DatumStreamBlock_Dense dense;
 	DatumStreamBlock_Rle_Extension rle_extension;
 	DatumStreamBlock_Delta_Extension delta_extension;
+	DatumStreamBlock_Dict_Extension dict_extension;
 	int32		headerSize;
 	int32		nullSize;
 	int32		rleSize;
 	int32		deltaSize;
+	int32		dictSize;
+	int32		dictDataSize;
 	int32		metadataSize;
 	int32		metadataMaxAlignSize;
 	int32		nullPadSize;
@@ -3791,6 +4072,38 @@ DatumStreamBlockWrite_BlockDense(
 	dense.physical_datum_count = dsw->physical_datum_count;
 	dense.physical_data_size = dsw->datump - dsw->datum_buffer;
 
+	/*
+	 * Store variable-length items with few distinct values once, and a code
+	 * for each physical datum.
+	 */
+	dictDataSize = -1;
+	if (dsw->dict_want_compression &&
+		dsw->typeInfo->datumlen == -1 &&
+		dsw->physical_datum_count > 0)
+	{
+		dictDataSize = DatumStreamBlockWrite_DictBuild(dsw, &dict_extension.entry_count);
+	}
+	if (dictDataSize >= 0)
+	{
+		dense.orig_4_bytes.flags |= DSB_HAS_DICT_COMPRESSION;
+
+		dict_extension.codes_size =
+			dsw->physical_datum_count *
+			DatumStreamBlock_DictCodeWidth(dict_extension.entry_count);
+		dictSize = sizeof(DatumStreamBlock_Dict_Extension) + dict_extension.codes_size;
+
+		/*
+		 * We charge the dictionary metadata size against the savings.
+		 */
+		dsw->savings += dense.physical_data_size - dictDataSize - dictSize;
+
+		dense.physical_data_size = dictDataSize;
+	}
+	else
+	{
+		dictSize = 0;
+	}
+
 	headerSize = sizeof(DatumStreamBlock_Dense);
 
 	/*
@@ -3891,7 +4204,7 @@ DatumStreamBlockWrite_BlockDense(
 	/*
 	 * Align headers and meta-data (e.g. NULL bit-maps, etc).
 	 */
-	metadataSize = headerSize + nullSize + rleSize + deltaSize;
+	metadataSize = headerSize + nullSize + rleSize + deltaSize + dictSize;
 	metadataMaxAlignSize = MAXALIGN(metadataSize);
 
 	memcpy(p, &dense, sizeof(DatumStreamBlock_Dense));
@@ -3972,6 +4285,29 @@ DatumStreamBlockWrite_BlockDense(
 		}
 	}
 
+	/* Add the dictionary extension and codes, after all other metadata */
+	if (dictSize > 0)
+	{
+		int			i;
+
+		memcpy(p, &dict_extension, sizeof(DatumStreamBlock_Dict_Extension));
+		p += sizeof(DatumStreamBlock_Dict_Extension);
+
+		if (DatumStreamBlock_DictCodeWidth(dict_extension.entry_count) == 1)
+		{
+			for (i = 0; i < dsw->physical_datum_count; i++)
+				*(p++) = (uint8) dsw->dict_codes[i];
+		}
+		else
+		{
+			for (i = 0; i < dsw->physical_datum_count; i++)
+			{
+				*(p++) = (uint8) (dsw->dict_codes[i] & 0xFF);
+				*(p++) = (uint8) (dsw->dict_codes[i] >> 8);
+			}
+		}
+	}
+
 	/*
 	 * Were our meta-data size calculations correct?
 	 */
@@ -4013,8 +4349,39 @@ DatumStreamBlockWrite_BlockDense(
 				 errcontext_datumstreamblockwrite(dsw)));
 	}
 
-	memcpy(p, dsw->datum_buffer, dense.physical_data_size);
-	p += dense.physical_data_size;
+	if (dictSize > 0)
+	{
+		uint8	   *datum_beginp = p;
+		int			i;
+
+		/*
+		 * Lay out the dictionary items like the datum buffer does: aligned
+		 * and zero padded, unless they have a short varlena header.
+		 */
+		for (i = 0; i < dict_extension.entry_count; i++)
+		{
+			uint8	   *entry = dsw->datum_buffer + dsw->dict_entry_offsets[i];
+			int32		size = VARSIZE_ANY(entry);
+
+			if (!VARATT_IS_SHORT(entry))
+			{
+				int32		offset = p - datum_beginp;
+
+				for (pad = att_align_nominal(offset, dsw->typeInfo->align) - offset; pad > 0; pad--)
+					*(p++) = 0;
+			}
+
+			memcpy(p, entry, size);
+			p += size;
+		}
+
+		Assert(p - datum_beginp == dense.physical_data_size);
+	}
+	else
+	{
+		memcpy(p, dsw->datum_buffer, dense.physical_data_size);
+		p += dense.physical_data_size;
+	}
 
 	/* Calculate write size. */
 	writesz = p - buffer;
@@ -4147,6 +4514,21 @@ DatumStreamBlockWrite_BlockDense(
 					 errdetail_datumstreamblockwrite(dsw),
 					 errcontext_datumstreamblockwrite(dsw)));
 		}
+
+		if (dictSize > 0)
+		{
+			ereport(LOG,
+					(errmsg("Datum stream write Dense block formatted with DICTIONARY compression "
+							"(physical datum count %d, dictionary entry count %d, codes size %d, "
+							"dictionary data size %d, datum buffer size %d)",
+							dsw->physical_datum_count,
+							dict_extension.entry_count,
+							dict_extension.codes_size,
+							dense.physical_data_size,
+							(int32) (dsw->datump - dsw->datum_buffer)),
+					 errdetail_datumstreamblockwrite(dsw),
+					 errcontext_datumstreamblockwrite(dsw)));
+		}
 	}
 
 #ifdef USE_ASSERT_CHECKING
@@ -4207,6 +4589,7 @@ DatumStreamBlockWrite_Init(
 						   DatumStreamVersion datumStreamVersion,
 						   bool rle_want_compression,
 						   bool delta_want_compression,
+						   bool dict_want_compression,
 						   int32 initialMaxDatumPerBlock,
 						   int32 maxDatumPerBlock,
 						   int32 maxDataBlockSize,
@@ -4223,6 +4606,7 @@ DatumStreamBlockWrite_Init(
 
 	dsw->rle_want_compression = rle_want_compression;
 	dsw->delta_want_compression = delta_want_compression;
+	dsw->dict_want_compression = dict_want_compression;
 
 	dsw->initialMaxDatumPerBlock = initialMaxDatumPerBlock;
 	dsw->maxDatumPerBlock = maxDatumPerBlock;
@@ -4433,6 +4817,15 @@ DatumStreamBlockWrite_Finish(
 	if (dsw->delta_sign != NULL)
 		pfree(dsw->delta_sign);
 
+	if (dsw->dict_hash != NULL)
+		pfree(dsw->dict_hash);
+
+	if (dsw->dict_entry_offsets != NULL)
+		pfree(dsw->dict_entry_offsets);
+
+	if (dsw->dict_codes != NULL)
+		pfree(dsw->dict_codes);
+
 	MemoryContextSwitchTo(oldCtxt);
 }
 
@@ -4871,6 +5264,7 @@ DatumStreamBlock_IntegrityCheckDense(
 	bool		hasNull;
 	bool		hasRleCompression;
 	bool		hasDeltaCompression;
+	bool		hasDictCompression;
 
 	int32		alignedHeaderSize;
 	int32		deltaOnCount;
@@ -4917,6 +5311,7 @@ DatumStreamBlock_IntegrityCheckDense(
 	hasNull = ((blockDense->orig_4_bytes.flags & DSB_HAS_NULLBITMAP) != 0);
 	hasRleCompression = ((blockDense->orig_4_bytes.flags & DSB_HAS_RLE_COMPRESSION) != 0);
 	hasDeltaCompression = ((blockDense->orig_4_bytes.flags & DSB_HAS_DELTA_COMPRESSION) != 0);
+	hasDictCompression = ((blockDense->orig_4_bytes.flags & DSB_HAS_DICT_COMPRESSION) != 0);
 
 	/*
 	 * Verify logical row count.
@@ -4993,8 +5388,11 @@ DatumStreamBlock_IntegrityCheckDense(
 
 		/*
 		 * This check will make it safer to do multiplication of datum count and datum length.
+		 *
+		 * With a dictionary, the datum area holds each distinct item only once.
 		 */
-		if (blockDense->physical_datum_count > blockDense->physical_data_size)
+		if (!hasDictCompression &&
+			blockDense->physical_datum_count > blockDense->physical_data_size)
 		{
 			ereport(ERROR,
 					(errmsg("More physical items %d than physical bytes %d",
@@ -5405,6 +5803,98 @@ DatumStreamBlock_IntegrityCheckDense(
 												  errcontextArg);
 	}
 
+	if (hasDictCompression)
+	{
+		DatumStreamBlock_Dict_Extension dictExtension;
+		int32		codeWidth;
+		int			i;
+
+		if (hasDeltaCompression || typeInfo->datumlen != -1)
+		{
+			ereport(ERROR,
+					(errmsg("DICTIONARY compression is only expected for variable-length items without DELTA compression "
+							"(datum length %d, has DELTA compression %s)",
+							typeInfo->datumlen,
+							(hasDeltaCompression ? "true" : "false")),
+					 errdetailCallback(errdetailArg),
+					 errcontextCallback(errcontextArg)));
+		}
+
+		headerSize += sizeof(DatumStreamBlock_Dict_Extension);
+
+		if (bufferSize < headerSize)
+		{
+			ereport(ERROR,
+					(errmsg("Bad datum stream DICTIONARY block header extension size. Found %d and expected the size to be at least %d",
+							bufferSize,
+							headerSize),
+					 errdetailCallback(errdetailArg),
+					 errcontextCallback(errcontextArg)));
+		}
+
+		memcpy(&dictExtension, p, sizeof(DatumStreamBlock_Dict_Extension));
+		p += sizeof(DatumStreamBlock_Dict_Extension);
+
+		if (dictExtension.entry_count <= 0 ||
+			dictExtension.entry_count > DSB_DICT_MAX_ENTRIES ||
+			dictExtension.entry_count > blockDense->physical_datum_count)
+		{
+			ereport(ERROR,
+					(errmsg("DICTIONARY entry count %d is expected to be greater than 0 and at most %d and the physical datum count %d",
+							dictExtension.entry_count,
+							DSB_DICT_MAX_ENTRIES,
+							blockDense->physical_datum_count),
+					 errdetailCallback(errdetailArg),
+					 errcontextCallback(errcontextArg)));
+		}
+
+		codeWidth = DatumStreamBlock_DictCodeWidth(dictExtension.entry_count);
+		if (dictExtension.codes_size != blockDense->physical_datum_count * codeWidth)
+		{
+			ereport(ERROR,
+					(errmsg("Bad DICTIONARY codes size.  Found %d, expected %d",
+							dictExtension.codes_size,
+							blockDense->physical_datum_count * codeWidth),
+					 errdetailCallback(errdetailArg),
+					 errcontextCallback(errcontextArg)));
+		}
+
+		headerSize += dictExtension.codes_size;
+		alignedHeaderSize = MAXALIGN(headerSize);
+
+		if (bufferSize < alignedHeaderSize + blockDense->physical_data_size)
+		{
+			ereport(ERROR,
+					(errmsg("Expected DICTIONARY header size %d including codes and data size %d is larger than buffer size %d",
+							alignedHeaderSize,
+							blockDense->physical_data_size,
+							bufferSize),
+					 errdetailCallback(errdetailArg),
+					 errcontextCallback(errcontextArg)));
+		}
+
+		for (i = 0; i < blockDense->physical_datum_count; i++)
+		{
+			int32		code;
+
+			if (codeWidth == 1)
+				code = p[i];
+			else
+				code = p[2 * i] | (p[2 * i + 1] << 8);
+
+			if (code >= dictExtension.entry_count)
+			{
+				ereport(ERROR,
+						(errmsg("DICTIONARY code %d of physical datum %d is out of range (entry count %d)",
+								code,
+								i,
+								dictExtension.entry_count),
+						 errdetailCallback(errdetailArg),
+						 errcontextCallback(errcontextArg)));
+			}
+		}
+	}
+
 	if (typeInfo->datumlen == -1)
 	{
 		/*
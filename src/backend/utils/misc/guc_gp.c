@@ -180,7 +180,14 @@ bool		gp_appendonly_verify_block_checksums = true;
 bool		gp_appendonly_verify_write_block = false;
 bool		gp_appendonly_verify_eof = true;
 bool		gp_appendonly_compaction = true;
+bool		gp_appendonly_zone_maps = false;
+int			gp_aocs_scan_batch_size = 1024;
+bool		gp_aocs_late_materialization = true;
+bool		gp_aocs_dictionary_encoding = false;
+bool		gp_appendonly_visimap_preload = true;
 int			gp_appendonly_compaction_threshold = 0;
+int			gp_appendonly_compaction_budget = 0;
+int			gp_appendonly_readahead_large_reads = 4;
 bool		gp_heap_verify_checksums_on_mirror = false;
 bool		gp_heap_require_relhasoids_match = true;
 bool		Debug_appendonly_rezero_quicklz_compress_scratch = false;
@@ -332,6 +339,7 @@ static char *gp_log_fts_str;
 static char *gp_log_interconnect_str;
 static char *gp_interconnect_type_str;
 static char *gp_interconnect_fc_method_str;
+static char *gp_interconnect_compression_method_str;
 static char *gp_resource_manager_str;
 
 /*
@@ -538,6 +546,7 @@ double		optimizer_damping_factor_join;
 double		optimizer_damping_factor_groupby;
 bool		optimizer_dpe_stats;
 bool		optimizer_enable_derive_stats_all_groups;
+bool		optimizer_lazy_column_stats;
 
 /* Costing related GUCs used by the Optimizer */
 int			optimizer_segments;
@@ -967,6 +976,18 @@ struct config_bool ConfigureNamesBool_gp[] =
 		true, NULL, NULL
 	},
 
+	{
+		{"gp_enable_motion_loser_tree", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enable loser tree merge in sorted motion recv."),
+			gettext_noop("Sort keys are extracted once per received tuple, and a sender "
+						 "that keeps winning is drained with one comparison per tuple. "
+						 "Takes precedence over gp_enable_motion_mk_sort."),
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_enable_motion_loser_tree,
+		true, NULL, NULL
+	},
+
 
 #ifdef USE_ASSERT_CHECKING
 	{
@@ -1000,6 +1021,28 @@ struct config_bool ConfigureNamesBool_gp[] =
 		false, NULL, NULL
 	},
 
+	{
+		{"gp_enable_motion_skew", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enables the planner's handling of skewed join keys in redistribute motions."),
+			gettext_noop("Rows with a common join key value are spread over all segments, "
+						 "and the matching rows of the other join input are broadcast."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_enable_motion_skew,
+		false, NULL, NULL
+	},
+
+	{
+		{"gp_enable_runtime_filter", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enables runtime filters from hash joins to the senders of their outer redistribute motion."),
+			gettext_noop("Rows that cannot match the inner side of the join on their "
+						 "target segment are dropped before they are sent."),
+			GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_enable_runtime_filter,
+		false, NULL, NULL
+	},
+
 	{
 		{"gp_adjust_selectivity_for_outerjoins", PGC_USERSET, QUERY_TUNING_METHOD,
 			gettext_noop("Adjust selectivity of null tests over outer joins."),
@@ -1158,6 +1201,43 @@ struct config_bool ConfigureNamesBool_gp[] =
 		true, NULL, NULL
 	},
 
+	{
+		{"gp_appendonly_zone_maps", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Keep per-block value ranges of append-only tables in the block directory, and use them to skip blocks in scans."),
+			gettext_noop("Only blocks written while this is on have ranges. A block directory is needed, which any index on the table creates.")
+		},
+		&gp_appendonly_zone_maps,
+		false, NULL, NULL
+	},
+
+	{
+		{"gp_aocs_late_materialization", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Read the columns a column-oriented table scan's filter does not reference only for the rows that pass the filter."),
+			gettext_noop("Takes effect only when gp_aocs_scan_batch_size is not 0.")
+		},
+		&gp_aocs_late_materialization,
+		true, NULL, NULL
+	},
+
+	{
+		{"gp_aocs_dictionary_encoding", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Store the values of variable-length RLE_TYPE columns of column-oriented tables in a dictionary per block, when they have few distinct values."),
+			gettext_noop("Affects only the blocks written while it is on. Scans compare such columns to constants on the dictionary codes. "
+						 "Servers without dictionary support misread such blocks, so it is off by default.")
+		},
+		&gp_aocs_dictionary_encoding,
+		false, NULL, NULL
+	},
+
+	{
+		{"gp_appendonly_visimap_preload", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Load the visibility map of a whole segment file when an append-only table scan opens it."),
+			gettext_noop("Visibility checks then test one bit in memory. Segment files whose hidden rows exceed work_mem are checked as before.")
+		},
+		&gp_appendonly_visimap_preload,
+		true, NULL, NULL
+	},
+
 	{
 		{"gp_heap_verify_checksums_on_mirror", PGC_USERSET, DEVELOPER_OPTIONS,
 		 gettext_noop("Verify the heap checksums on mirror after receiving block from primary before writing to disk."),
@@ -1304,6 +1384,46 @@ struct config_bool ConfigureNamesBool_gp[] =
 		false, NULL, NULL
 	},
 
+	{
+		{"gp_interconnect_batch_io", PGC_USERSET, QUERY_TUNING_OTHER,
+			gettext_noop("Send and receive interconnect packets in batches, where the platform supports it."),
+			NULL,
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_interconnect_batch_io,
+		true, NULL, NULL
+	},
+
+	{
+		{"gp_interconnect_compression", PGC_USERSET, QUERY_TUNING_OTHER,
+			gettext_noop("Compress the tuple data sent by motions."),
+			gettext_noop("Only motions whose estimated output reaches gp_interconnect_compression_threshold are compressed."),
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_interconnect_compression,
+		false, NULL, NULL
+	},
+
+	{
+		{"gp_interconnect_adaptive_cwnd", PGC_USERSET, QUERY_TUNING_OTHER,
+			gettext_noop("Limits the packets in flight on each interconnect connection by an adaptive congestion window."),
+			gettext_noop("Only applies to the \"loss\" flow control method."),
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_interconnect_adaptive_cwnd,
+		false, NULL, NULL
+	},
+
+	{
+		{"gp_interconnect_local_shm", PGC_USERSET, QUERY_TUNING_OTHER,
+			gettext_noop("Passes motion packets between processes on the same host through shared memory."),
+			gettext_noop("Only applies to the UDP interconnect. Routes to other hosts still use the network."),
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_interconnect_local_shm,
+		false, NULL, NULL
+	},
+
 	{
 		{"gp_interconnect_log_stats", PGC_USERSET, QUERY_TUNING_OTHER,
 			gettext_noop("Emit statistics from the UDP-IC at the end of every statement."),
@@ -2879,6 +2999,16 @@ struct config_bool ConfigureNamesBool_gp[] =
 		false, NULL, NULL
 	},
 
+	{
+		{"optimizer_lazy_column_stats", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Translate histograms only for columns referenced in predicates."),
+			gettext_noop("Other columns get width, null fraction and number of distinct values only."),
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE
+		},
+		&optimizer_lazy_column_stats,
+		false, NULL, NULL
+	},
+
 	{
 		{"optimizer_force_multistage_agg", PGC_USERSET, QUERY_TUNING_METHOD,
 			gettext_noop("Force optimizer to always pick multistage aggregates when such a plan alternative is generated."),
@@ -3510,6 +3640,16 @@ struct config_int ConfigureNamesInt_gp[] =
 		10, 0, 100, NULL, NULL
 	},
 
+	{
+		{"gp_appendonly_compaction_budget", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Maximum amount of live data lazy vacuum moves out of one append-only segment file per run."),
+			gettext_noop("A segment file with more live data is compacted over several vacuums. Zero compacts whole segment files."),
+			GUC_UNIT_KB
+		},
+		&gp_appendonly_compaction_budget,
+		0, 0, INT_MAX, NULL, NULL
+	},
+
 	{
 		{"gp_workfile_max_entries", PGC_POSTMASTER, RESOURCES,
 			gettext_noop("Sets the maximum number of entries that can be stored in the workfile directory"),
@@ -3892,6 +4032,38 @@ struct config_int ConfigureNamesInt_gp[] =
 		2, 1, 256, NULL, NULL
 	},
 
+	{
+		{"gp_interconnect_compression_threshold", PGC_USERSET, QUERY_TUNING_OTHER,
+			gettext_noop("Sets the minimum estimated output of a motion for which gp_interconnect_compression applies."),
+			gettext_noop("Zero compresses all motions."),
+			GUC_UNIT_KB | GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_interconnect_compression_threshold,
+		0, 0, INT_MAX, NULL, NULL
+	},
+
+	{
+		{"gp_interconnect_cwnd_target_delay", PGC_USERSET, QUERY_TUNING_OTHER,
+			gettext_noop("Sets the ack delay (in ms) above the smallest seen that makes gp_interconnect_adaptive_cwnd shrink the congestion window."),
+			NULL,
+			GUC_UNIT_MS | GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_interconnect_cwnd_target_delay,
+		5, 1, 1000, NULL, NULL
+	},
+
+	{
+		{"gp_motion_batch_tuples", PGC_USERSET, QUERY_TUNING_OTHER,
+			gettext_noop("Sets the maximum number of tuples a motion sends in one tuple-chunk."),
+			gettext_noop("Only tuples whose attributes are all fixed-width are batched. "
+						 "Motions received by the query dispatcher are never batched. "
+						 "Zero or one sends each tuple in chunks of its own."),
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_motion_batch_tuples,
+		0, 0, 1024, NULL, NULL
+	},
+
 	{
 		{"gp_command_count", PGC_INTERNAL, CLIENT_CONN_OTHER,
 			gettext_noop("Shows the number of commands received from the client in this session."),
@@ -4433,6 +4605,24 @@ struct config_int ConfigureNamesInt_gp[] =
 		NUM_MINIPAGE_ENTRIES, 1, NUM_MINIPAGE_ENTRIES, NULL, NULL
 	},
 
+	{
+		{"gp_aocs_scan_batch_size", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Maximum number of rows a scan of a column-oriented table decodes at a time, one column after the other."),
+			gettext_noop("Zero decodes one row at a time.")
+		},
+		&gp_aocs_scan_batch_size,
+		1024, 0, 65536, NULL, NULL
+	},
+
+	{
+		{"gp_appendonly_readahead_large_reads", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Number of large reads an append-only table scan asks the kernel to read ahead of the current one, per segment file."),
+			gettext_noop("Zero disables read-ahead hints.")
+		},
+		&gp_appendonly_readahead_large_reads,
+		4, 0, 64, NULL, NULL
+	},
+
 
 	{
 		{"gp_segworker_relative_priority", PGC_POSTMASTER, RESOURCES_MGM,
@@ -4787,6 +4977,16 @@ struct config_real ConfigureNamesReal_gp[] =
 		0.25, 0, 1.0, NULL, NULL
 	},
 
+	{
+		{"gp_motion_skew_threshold", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Sets the frequency from which a join key value is treated as skewed."),
+			gettext_noop("Only applies when gp_enable_motion_skew is on."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_motion_skew_threshold,
+		0.1, 0.0, 1.0, NULL, NULL
+	},
+
 	{
 		{"gp_selectivity_damping_factor", PGC_USERSET, QUERY_TUNING_METHOD,
 			gettext_noop("Factor used in selectivity damping."),
@@ -4924,7 +5124,7 @@ struct config_string ConfigureNamesString_gp[] =
 	{
 		{"gp_workfile_compress_algorithm", PGC_USERSET, DEVELOPER_OPTIONS,
 			gettext_noop("Specify the compression algorithm that work files in the query executor use."),
-			gettext_noop("Valid values are \"NONE\", \"ZLIB\"."),
+			gettext_noop("Valid values are \"NONE\", \"ZLIB\", and \"ZSTD\" or \"LZ4\" when built with them."),
 			GUC_GPDB_ADDOPT
 		},
 		&gp_workfile_compress_algorithm_str,
@@ -5172,6 +5372,16 @@ struct config_string ConfigureNamesString_gp[] =
 		"loss", gpvars_assign_gp_interconnect_fc_method, gpvars_show_gp_interconnect_fc_method
 	},
 
+	{
+		{"gp_interconnect_compression_method", PGC_USERSET, QUERY_TUNING_OTHER,
+			gettext_noop("Sets the compression method used by gp_interconnect_compression."),
+			gettext_noop("Valid values are \"zlib\", and \"lz4\" when built with it."),
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_interconnect_compression_method_str,
+		INTERCONNECT_COMPRESSION_DEFAULT_STR, gpvars_assign_gp_interconnect_compression_method, gpvars_show_gp_interconnect_compression_method
+	},
+
 	{
 		{"gp_qd_hostname", PGC_BACKEND, GP_WORKER_IDENTITY,
 			gettext_noop("Shows the QD Hostname. Blank when run on the QD"),
@@ -29,6 +29,12 @@ extern bool AppendOnlyCompaction_ShouldCompact(
 	int segno,
 	int64 segmentTotalTupcount,
 	bool isFull);
+extern int64 AppendOnlyCompaction_GetMaxMovedTuples(
+	Relation aoRelation,
+	int segno,
+	int64 segmentTotalTupcount,
+	int64 segmentTotalBytes,
+	bool isFull);
 extern void AppendOnlyThrowAwayTuple(Relation rel, MemTuple tuple,
 		TupleTableSlot	*slot, MemTupleBinding *mt_bind);
 extern void AppendOnlyTruncateToEOF(Relation aorel);
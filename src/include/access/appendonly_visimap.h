@@ -57,6 +57,17 @@ typedef struct AppendOnlyVisimap
 	 */ 
 	AppendOnlyVisimapStore visimapStore;	
 
+	/*
+	 * Hidden rows of one whole segment file, loaded up front by a
+	 * sequential scan (see AppendOnlyVisimap_LoadSegmentFile).
+	 * hiddenRanges[i] holds the hidden rows of the i'th range of
+	 * APPENDONLY_VISIMAP_MAX_RANGE row numbers, or NULL if all rows of
+	 * the range are visible.  loadedSegno is -1 when nothing is loaded.
+	 */
+	int32 loadedSegno;
+	int numHiddenRanges;
+	Bitmapset **hiddenRanges;
+
 } AppendOnlyVisimap;
 
 /*
@@ -113,6 +124,16 @@ void AppendOnlyVisimap_Finish(
 	AppendOnlyVisimap *visiMap,
 	LOCKMODE lockmode);
 
+void AppendOnlyVisimap_LoadSegmentFile(
+	AppendOnlyVisimap *visiMap,
+	int segno);
+
+bool AppendOnlyVisimap_IsRangeVisible(
+	AppendOnlyVisimap *visiMap,
+	int segno,
+	int64 firstRowNum,
+	int64 rowCount);
+
 void AppendOnlyVisimap_DeleteSegmentFile(
 	AppendOnlyVisimap *visiMap,
 	int segno);
@@ -121,6 +142,10 @@ int64 AppendOnlyVisimap_GetSegmentFileHiddenTupleCount(
 	AppendOnlyVisimap *visiMap,
 	int segno);
 
+int64 AppendOnlyVisimap_GetFirstUnhiddenRowNum(
+	AppendOnlyVisimap *visiMap,
+	int segno);
+
 int64 AppendOnlyVisimap_GetRelationHiddenTupleCount(
 	AppendOnlyVisimap *visiMap);
 
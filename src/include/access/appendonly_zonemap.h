@@ -0,0 +1,96 @@
+/*------------------------------------------------------------------------------
+ *
+ * appendonly_zonemap
+ *   per-block value ranges of append-only tables.
+ *
+ * With gp_appendonly_zone_maps on, the writers of append-only tables keep
+ * the smallest and largest value and the number of NULLs of every
+ * fixed-width, by-value column for each block they write, and store them
+ * as zones next to the block directory entries (see
+ * cdbappendonlyblockdirectory.h).
+ *
+ * Scans use a zone filter built from the simple "column op constant" and
+ * NULL test quals of the scan to find the rows of a segment file whose
+ * zones refute a qual, and skip the blocks holding only such rows without
+ * decompressing them.
+ *
+ * Copyright (c) 2017, Pivotal.
+ *
+ *------------------------------------------------------------------------------
+*/
+#ifndef APPENDONLY_ZONEMAP_H
+#define APPENDONLY_ZONEMAP_H
+
+#include "access/aocssegfiles.h"
+#include "access/skey.h"
+#include "access/tupdesc.h"
+#include "cdb/cdbappendonlyblockdirectory.h"
+#include "fmgr.h"
+#include "nodes/pg_list.h"
+#include "nodes/primnodes.h"
+#include "utils/rel.h"
+
+/*
+ * A qual of a scan that can refute zones.
+ */
+typedef struct AppendOnlyZoneQual
+{
+	AttrNumber	attno;
+
+	/*
+	 * The btree strategy of "column op constValue", or InvalidStrategy for
+	 * a NULL test.
+	 */
+	StrategyNumber strategy;
+	NullTestType nulltesttype;
+	Datum		constValue;
+
+	/* btree support function comparing the column to constValue */
+	FmgrInfo	cmp;
+} AppendOnlyZoneQual;
+
+/*
+ * A range of rows refuted by the zones of a segment file.
+ */
+typedef struct AppendOnlyZoneRange
+{
+	int64		firstRowNum;
+	int64		lastRowNum;
+} AppendOnlyZoneRange;
+
+typedef struct AppendOnlyZoneFilter
+{
+	MemoryContext memoryContext;
+
+	int			numQuals;
+	AppendOnlyZoneQual *quals;
+
+	/*
+	 * Sorted, non-adjacent ranges of the rows of the current segment file
+	 * that no qual-satisfying row can be in, and the first range not yet
+	 * passed by the scan.
+	 */
+	int			numRanges;
+	int			maxRanges;
+	AppendOnlyZoneRange *ranges;
+	int			nextRange;
+
+	/* Number of blocks the scan skipped so far */
+	int64		blocksSkipped;
+} AppendOnlyZoneFilter;
+
+extern bool AppendOnlyZone_ColumnWanted(Form_pg_attribute attr, FmgrInfo **cmp);
+extern void AppendOnlyZone_Reset(MinipageZone *zone);
+extern void AppendOnlyZone_AddValue(MinipageZone *zone, FmgrInfo *cmp,
+									Datum value, bool isnull);
+
+extern AppendOnlyZoneFilter *AppendOnlyZoneFilter_Create(Relation rel,
+							List *qual, Index scanrelid);
+extern void AppendOnlyZoneFilter_BeginSegment(AppendOnlyZoneFilter *filter,
+							Relation rel, Snapshot appendOnlyMetaDataSnapshot,
+							int segno, int64 eof, AOCSVPInfo *vpinfo);
+extern int64 AppendOnlyZoneFilter_NextLiveRow(AppendOnlyZoneFilter *filter,
+							int64 rowNum);
+extern void AppendOnlyZoneFilter_Free(AppendOnlyZoneFilter *filter);
+
+#endif   /* APPENDONLY_ZONEMAP_H */
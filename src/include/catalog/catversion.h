@@ -57,6 +57,6 @@
 
 /*							3yyymmddN */
 
-#define CATALOG_VERSION_NO	301705051
+#define CATALOG_VERSION_NO	302610192
 
 #endif
@@ -1648,6 +1648,26 @@ CREATE FUNCTION gp_nondbspecific_ptcat_verification() RETURNS bool LANGUAGE inte
 
  CREATE FUNCTION gp_zlib_validator(internal) RETURNS void LANGUAGE internal IMMUTABLE AS 'zlib_validator' WITH(OID=9924, DESCRIPTION="zlib compression validator");
 
+ CREATE FUNCTION gp_zstd_constructor(internal, internal, bool) RETURNS internal LANGUAGE internal VOLATILE AS 'zstd_constructor' WITH (OID=3072, DESCRIPTION="zstd constructor");
+
+ CREATE FUNCTION gp_zstd_destructor(internal) RETURNS void LANGUAGE internal VOLATILE AS 'zstd_destructor' WITH(OID=3073, DESCRIPTION="zstd destructor");
+
+ CREATE FUNCTION gp_zstd_compress(internal, int4, internal, int4, internal, internal) RETURNS void LANGUAGE internal IMMUTABLE AS 'zstd_compress' WITH(OID=3074, DESCRIPTION="zstd compressor");
+
+ CREATE FUNCTION gp_zstd_decompress(internal, int4, internal, int4, internal, internal) RETURNS void LANGUAGE internal IMMUTABLE AS 'zstd_decompress' WITH(OID=3075, DESCRIPTION="zstd decompressor");
+
+ CREATE FUNCTION gp_zstd_validator(internal) RETURNS void LANGUAGE internal IMMUTABLE AS 'zstd_validator' WITH(OID=3076, DESCRIPTION="zstd compression validator");
+
+ CREATE FUNCTION gp_lz4_constructor(internal, internal, bool) RETURNS internal LANGUAGE internal VOLATILE AS 'lz4_constructor' WITH (OID=3087, DESCRIPTION="lz4 constructor");
+
+ CREATE FUNCTION gp_lz4_destructor(internal) RETURNS void LANGUAGE internal VOLATILE AS 'lz4_destructor' WITH(OID=3088, DESCRIPTION="lz4 destructor");
+
+ CREATE FUNCTION gp_lz4_compress(internal, int4, internal, int4, internal, internal) RETURNS void LANGUAGE internal IMMUTABLE AS 'lz4_compress' WITH(OID=3089, DESCRIPTION="lz4 compressor");
+
+ CREATE FUNCTION gp_lz4_decompress(internal, int4, internal, int4, internal, internal) RETURNS void LANGUAGE internal IMMUTABLE AS 'lz4_decompress' WITH(OID=3090, DESCRIPTION="lz4 decompressor");
+
+ CREATE FUNCTION gp_lz4_validator(internal) RETURNS void LANGUAGE internal IMMUTABLE AS 'lz4_validator' WITH(OID=3091, DESCRIPTION="lz4 compression validator");
+
  CREATE FUNCTION gp_rle_type_constructor(internal, internal, bool) RETURNS internal LANGUAGE internal VOLATILE AS 'rle_type_constructor' WITH (OID=9914, DESCRIPTION="Type specific RLE constructor");
 
  CREATE FUNCTION gp_rle_type_destructor(internal) RETURNS void LANGUAGE internal VOLATILE AS 'rle_type_destructor' WITH(OID=9915, DESCRIPTION="Type specific RLE destructor");
@@ -1668,6 +1688,8 @@ CREATE FUNCTION gp_nondbspecific_ptcat_verification() RETURNS bool LANGUAGE inte
 
  CREATE FUNCTION gp_dummy_compression_validator(internal) RETURNS internal LANGUAGE internal VOLATILE AS 'dummy_compression_validator' WITH (OID=3068, DESCRIPTION="Dummy compression validator");
 
+ CREATE FUNCTION gp_compression_benchmark(IN rel regclass, OUT compresstype text, OUT compresslevel int4, OUT blocks int8, OUT rawbytes int8, OUT compressedbytes int8, OUT compress_ms float8, OUT decompress_ms float8) RETURNS SETOF pg_catalog.record LANGUAGE internal VOLATILE STRICT AS 'gp_compression_benchmark' WITH (OID=3092, DESCRIPTION="recompress the blocks of an append-only table with each available compresstype");
+
  CREATE FUNCTION linear_interpolate( anyelement, anyelement, int8, anyelement, int8 ) RETURNS int8 LANGUAGE internal IMMUTABLE STRICT AS 'linterp_int64' WITH (OID=6072, DESCRIPTION="linear interpolation: x, x0,y0, x1,y1"); 
 
  CREATE FUNCTION linear_interpolate( anyelement, anyelement, int4, anyelement, int4 ) RETURNS int4 LANGUAGE internal IMMUTABLE STRICT AS 'linterp_int32' WITH (OID=6073, DESCRIPTION="linear interpolation: x, x0,y0, x1,y1"); 
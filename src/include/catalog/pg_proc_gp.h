@@ -22,7 +22,7 @@
 
    WARNING: DO NOT MODIFY THE FOLLOWING SECTION: 
    Generated by catullus.pl version 8
-   on Wed Jul  5 11:25:29 2017
+   on Mon Oct 19 02:13:53 2026
 
    Please make your changes in pg_proc.sql
 */
@@ -2711,6 +2711,46 @@ DESCR("zlib decompressor");
 DATA(insert OID = 9924 ( gp_zlib_validator  PGNSP PGUID 12 1 0 0 f f f f i 1 0 2278 f "2281" _null_ _null_ _null_ _null_ zlib_validator _null_ _null_ _null_ n ));
 DESCR("zlib compression validator");
 
+/* gp_zstd_constructor(internal, internal, bool) => internal */ 
+DATA(insert OID = 3072 ( gp_zstd_constructor  PGNSP PGUID 12 1 0 0 f f f f v 3 0 2281 f "2281 2281 16" _null_ _null_ _null_ _null_ zstd_constructor _null_ _null_ _null_ n ));
+DESCR("zstd constructor");
+
+/* gp_zstd_destructor(internal) => void */ 
+DATA(insert OID = 3073 ( gp_zstd_destructor  PGNSP PGUID 12 1 0 0 f f f f v 1 0 2278 f "2281" _null_ _null_ _null_ _null_ zstd_destructor _null_ _null_ _null_ n ));
+DESCR("zstd destructor");
+
+/* gp_zstd_compress(internal, int4, internal, int4, internal, internal) => void */ 
+DATA(insert OID = 3074 ( gp_zstd_compress  PGNSP PGUID 12 1 0 0 f f f f i 6 0 2278 f "2281 23 2281 23 2281 2281" _null_ _null_ _null_ _null_ zstd_compress _null_ _null_ _null_ n ));
+DESCR("zstd compressor");
+
+/* gp_zstd_decompress(internal, int4, internal, int4, internal, internal) => void */ 
+DATA(insert OID = 3075 ( gp_zstd_decompress  PGNSP PGUID 12 1 0 0 f f f f i 6 0 2278 f "2281 23 2281 23 2281 2281" _null_ _null_ _null_ _null_ zstd_decompress _null_ _null_ _null_ n ));
+DESCR("zstd decompressor");
+
+/* gp_zstd_validator(internal) => void */ 
+DATA(insert OID = 3076 ( gp_zstd_validator  PGNSP PGUID 12 1 0 0 f f f f i 1 0 2278 f "2281" _null_ _null_ _null_ _null_ zstd_validator _null_ _null_ _null_ n ));
+DESCR("zstd compression validator");
+
+/* gp_lz4_constructor(internal, internal, bool) => internal */ 
+DATA(insert OID = 3087 ( gp_lz4_constructor  PGNSP PGUID 12 1 0 0 f f f f v 3 0 2281 f "2281 2281 16" _null_ _null_ _null_ _null_ lz4_constructor _null_ _null_ _null_ n ));
+DESCR("lz4 constructor");
+
+/* gp_lz4_destructor(internal) => void */ 
+DATA(insert OID = 3088 ( gp_lz4_destructor  PGNSP PGUID 12 1 0 0 f f f f v 1 0 2278 f "2281" _null_ _null_ _null_ _null_ lz4_destructor _null_ _null_ _null_ n ));
+DESCR("lz4 destructor");
+
+/* gp_lz4_compress(internal, int4, internal, int4, internal, internal) => void */ 
+DATA(insert OID = 3089 ( gp_lz4_compress  PGNSP PGUID 12 1 0 0 f f f f i 6 0 2278 f "2281 23 2281 23 2281 2281" _null_ _null_ _null_ _null_ lz4_compress _null_ _null_ _null_ n ));
+DESCR("lz4 compressor");
+
+/* gp_lz4_decompress(internal, int4, internal, int4, internal, internal) => void */ 
+DATA(insert OID = 3090 ( gp_lz4_decompress  PGNSP PGUID 12 1 0 0 f f f f i 6 0 2278 f "2281 23 2281 23 2281 2281" _null_ _null_ _null_ _null_ lz4_decompress _null_ _null_ _null_ n ));
+DESCR("lz4 decompressor");
+
+/* gp_lz4_validator(internal) => void */ 
+DATA(insert OID = 3091 ( gp_lz4_validator  PGNSP PGUID 12 1 0 0 f f f f i 1 0 2278 f "2281" _null_ _null_ _null_ _null_ lz4_validator _null_ _null_ _null_ n ));
+DESCR("lz4 compression validator");
+
 /* gp_rle_type_constructor(internal, internal, bool) => internal */ 
 DATA(insert OID = 9914 ( gp_rle_type_constructor  PGNSP PGUID 12 1 0 0 f f f f v 3 0 2281 f "2281 2281 16" _null_ _null_ _null_ _null_ rle_type_constructor _null_ _null_ _null_ n ));
 DESCR("Type specific RLE constructor");
@@ -2751,6 +2791,10 @@ DESCR("Dummy compression decompressor");
 DATA(insert OID = 3068 ( gp_dummy_compression_validator  PGNSP PGUID 12 1 0 0 f f f f v 1 0 2281 f "2281" _null_ _null_ _null_ _null_ dummy_compression_validator _null_ _null_ _null_ n ));
 DESCR("Dummy compression validator");
 
+/* gp_compression_benchmark(IN rel regclass, OUT compresstype text, OUT compresslevel int4, OUT blocks int8, OUT rawbytes int8, OUT compressedbytes int8, OUT compress_ms float8, OUT decompress_ms float8) => SETOF pg_catalog.record */ 
+DATA(insert OID = 3092 ( gp_compression_benchmark  PGNSP PGUID 12 1 1000 0 f f t t v 1 0 2249 f "2205" "{2205,25,23,20,20,20,701,701}" "{i,o,o,o,o,o,o,o}" "{rel,compresstype,compresslevel,blocks,rawbytes,compressedbytes,compress_ms,decompress_ms}" _null_ gp_compression_benchmark _null_ _null_ _null_ n ));
+DESCR("recompress the blocks of an append-only table with each available compresstype");
+
 /* linear_interpolate( anyelement, anyelement, int8, anyelement, int8) => int8 */ 
 DATA(insert OID = 6072 ( linear_interpolate  PGNSP PGUID 12 1 0 0 f f t f i 5 0 20 f "2283 2283 20 2283 20" _null_ _null_ _null_ _null_ linterp_int64 _null_ _null_ _null_ n ));
 DESCR("linear interpolation: x, x0,y0, x1,y1");
@@ -70,6 +70,26 @@ typedef AOCSInsertDescData *AOCSInsertDesc;
 /*
  * used for scan of append only relations using BufferedRead and VarBlocks
  */
+/*
+ * A "column = constant" clause of a scan's qual that the scan checks
+ * itself, for a column whose equality is equality of the bytes (text,
+ * varchar, bytea).  In blocks stored with a dictionary, the constant is
+ * looked up once per block and rows are compared on their dictionary codes,
+ * without looking at the values.
+ */
+typedef struct AOCSEqualityFilter
+{
+	int			attno;			/* column number, starting from 0 */
+	char	   *data;			/* the constant, without varlena header */
+	int			len;
+
+	/* Code of the constant in the dictionary of the last block looked at */
+	int			blockSeg;
+	int64		blockFileOffset;
+	bool		blockHasDict;
+	int			blockCode;
+} AOCSEqualityFilter;
+
 typedef struct AOCSScanDescData
 {
 	/* scan parameters */
@@ -122,10 +142,80 @@ typedef struct AOCSScanDescData
 
 	AppendOnlyVisimap visibilityMap;
 
+	/*
+	 * The zone filter of the scan's quals, if any, and the number of the
+	 * next row of the current segment file to check against it and
+	 * startRowNum.  Zero if neither is used for the segment file.
+	 */
+	struct AppendOnlyZoneFilter *zoneFilter;
+	int64 zoneNextRowNum;
+
+	/*
+	 * Rows before this row number are skipped without reading their
+	 * blocks.  Set by compaction to pass over the rows it has moved
+	 * already; zero otherwise.
+	 */
+	int64 startRowNum;
+
+	/*
+	 * Equality clauses checked by aocs_getnextbatch; see
+	 * aocs_add_equality_filter.  eqFilterCols marks their columns.
+	 */
+	AOCSEqualityFilter *eqFilters;
+	int			numEqFilters;
+	bool	   *eqFilterCols;
+
 }	AOCSScanDescData;
 
 typedef AOCSScanDescData *AOCSScanDesc;
 
+/*
+ * A batch of rows of an AOCS scan, decoded one column at a time by
+ * aocs_getnextbatch.
+ *
+ * The values of projected column attno (starting from 0) are in
+ * values[attno] and nulls[attno].  By-reference values point into the
+ * column's current block, and stay valid until the next batch is read.
+ * sel lists the rows visible to the scan's snapshot.
+ *
+ * Projected columns marked in lazy are not decoded with the batch.  The
+ * caller first drops the rows it does not keep from sel, and then asks for
+ * the lazy columns of the remaining ones with aocs_batch_materialize.  The
+ * datum streams of lazy columns move straight to those rows, so their
+ * blocks without any such row are never decompressed.
+ * Segment files whose blocks have no row numbers are decoded eagerly.
+ */
+typedef struct AOCSBatchData
+{
+	int			maxRows;
+
+	bool	   *lazy;			/* NULL if no column is lazy */
+	bool		lazySeg;		/* lazy columns deferred in this segment file? */
+
+	int			segno;
+	int			nrows;			/* number of rows decoded */
+	int			nsel;			/* number of visible rows, listed in sel */
+	int			next;			/* next entry of sel aocs_batch_next returns */
+	int			current;		/* row last returned by aocs_batch_next */
+
+	int		   *sel;
+	int64	   *rowNums;
+	Datum	  **values;
+	bool	  **nulls;
+
+	/*
+	 * For each lazy column, the number of entries of sel whose values have
+	 * been read into values and nulls.
+	 */
+	int		   *lazyNext;
+
+	/* Rows refuted by the equality filters of the scan, if it has any */
+	bool	   *refuted;
+	int		   *codes;
+} AOCSBatchData;
+
+typedef AOCSBatchData *AOCSBatch;
+
 /*
  * Used for fetch individual tuples from specified by TID of append only relations
  * using the AO Block Directory.
@@ -208,8 +298,17 @@ extern void aocs_rescan(AOCSScanDesc scan);
 extern void aocs_endscan(AOCSScanDesc scan);
 
 extern void aocs_getnext(AOCSScanDesc scan, ScanDirection direction, TupleTableSlot *slot);
+extern bool aocs_add_equality_filter(AOCSScanDesc scan, Node *clause, Index scanrelid);
+extern AOCSBatch aocs_create_batch(AOCSScanDesc scan, int maxRows, bool *lazy);
+extern void aocs_destroy_batch(AOCSScanDesc scan, AOCSBatch batch);
+extern bool aocs_getnextbatch(AOCSScanDesc scan, AOCSBatch batch);
+extern bool aocs_batch_next(AOCSScanDesc scan, AOCSBatch batch, TupleTableSlot *slot);
+extern void aocs_batch_materialize(AOCSScanDesc scan, AOCSBatch batch, TupleTableSlot *slot);
 extern AOCSInsertDesc aocs_insert_init(Relation rel, int segno, bool update_mode);
 extern Oid aocs_insert_values(AOCSInsertDesc idesc, Datum *d, bool *null, AOTupleId *aoTupleId);
+extern void aocs_insert_values_batch(AOCSInsertDesc idesc, int nrows,
+									 Datum **values, bool **nulls,
+									 AOTupleId *aoTupleIds);
 static inline Oid aocs_insert(AOCSInsertDesc idesc, TupleTableSlot *slot)
 {
 	Oid oid;
@@ -103,6 +103,14 @@ typedef struct AppendOnlyInsertDescData
 	/* The block directory for the appendonly relation. */
 	AppendOnlyBlockDirectory blockDirectory;
 
+	/*
+	 * Zones of the rows in the current VarBlock, kept when the block
+	 * directory wants them, and the comparison function of each column
+	 * (NULL for columns without zones).
+	 */
+	MinipageZone	*zones;
+	FmgrInfo		**zoneCmps;
+
 	bool update_mode;
 } AppendOnlyInsertDescData;
 
@@ -218,6 +226,18 @@ typedef struct AppendOnlyScanDescData
 	 */ 
 	AppendOnlyVisimap visibilityMap;
 
+	/*
+	 * The zone filter of the scan's quals, if any.  Set by the executor.
+	 */
+	struct AppendOnlyZoneFilter *zoneFilter;
+
+	/*
+	 * Blocks holding only rows before this row number are skipped without
+	 * reading them.  Set by compaction to pass over the rows it has moved
+	 * already; zero otherwise.
+	 */
+	int64		startRowNum;
+
 }	AppendOnlyScanDescData;
 
 typedef AppendOnlyScanDescData *AppendOnlyScanDesc;
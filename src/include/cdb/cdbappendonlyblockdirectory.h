@@ -43,6 +43,31 @@ typedef struct MinipageEntry
 	int64 rowCount;
 } MinipageEntry;
 
+/*
+ * The min/max summary ("zone map") of one column over the rows of a
+ * minipage entry, kept only for fixed-length pass-by-value types.
+ *
+ * rowCount is the number of rows summarized, counting from the entry's
+ * firstRowNum; it can be less than the entry's rowCount, which also spans
+ * row number gaps.  A zone with rowCount 0 summarizes nothing.
+ */
+typedef struct MinipageZone
+{
+	int64 minValue;
+	int64 maxValue;
+	int32 rowCount;
+	int32 nullCount;
+} MinipageZone;
+
+/*
+ * Minipage format versions.  A MINIPAGE_VERSION_ZONES minipage is followed
+ * by nEntry arrays of zones, one zone per summarized column (one for a
+ * column group of a column-oriented table, one per attribute of a row-
+ * oriented table).
+ */
+#define MINIPAGE_VERSION_ORIGINAL	0
+#define MINIPAGE_VERSION_ZONES		1
+
 /*
  * Define a varlena type for a minipage.
  */
@@ -66,6 +91,12 @@ typedef struct MinipagePerColumnGroup
 	Minipage *minipage;
 	uint32 numMinipageEntries;
 	ItemPointerData tupleTid;
+
+	/*
+	 * Zones of the entries, numZoneColumns per entry, or NULL if the
+	 * block directory does not keep zone maps.
+	 */
+	MinipageZone *zones;
 } MinipagePerColumnGroup;
 
 /*
@@ -75,6 +106,15 @@ typedef struct MinipagePerColumnGroup
 #define NUM_MINIPAGE_ENTRIES (((MaxHeapTupleSize)/8 - sizeof(HeapTupleHeaderData) - 64 * 3)\
 							  / sizeof(MinipageEntry))
 
+/*
+ * A minipage with zone maps is allowed to use up to half of a heap page.
+ * Zone maps are not kept at all if that leaves room for fewer than
+ * MIN_ZONED_MINIPAGE_ENTRIES entries, which happens for row-oriented
+ * tables with many columns.
+ */
+#define MINIPAGE_ZONE_BUDGET ((MaxHeapTupleSize)/2 - sizeof(HeapTupleHeaderData) - 64 * 3)
+#define MIN_ZONED_MINIPAGE_ENTRIES 16
+
 /*
  * Define a structure for the append-only relation block directory.
  */
@@ -104,6 +144,14 @@ typedef struct AppendOnlyBlockDirectory
 	 */
 	MinipagePerColumnGroup *minipages;
 
+	/*
+	 * Number of columns summarized by the zones of each minipage entry, and
+	 * the most entries a minipage with zones can hold.  numZoneColumns is 0
+	 * when zone maps are not kept.
+	 */
+	int numZoneColumns;
+	uint32 maxZonedEntries;
+
 	/*
 	 * Some temporary space to help form tuples to be inserted into
 	 * the block directory, and to help the index scan.
@@ -194,6 +242,13 @@ extern bool AppendOnlyBlockDirectory_InsertEntry(
 	int64 fileOffset,
 	int64 rowCount,
 	bool addColAction);
+extern bool AppendOnlyBlockDirectory_InsertEntryWithZones(
+	AppendOnlyBlockDirectory *blockDirectory,
+	int columnGroupNo,
+	int64 firstRowNum,
+	int64 fileOffset,
+	int64 rowCount,
+	MinipageZone *zones);
 extern bool AppendOnlyBlockDirectory_addCol_InsertEntry(
 	AppendOnlyBlockDirectory *blockDirectory,
 	int columnGroupNo,
@@ -218,4 +273,18 @@ extern void AppendOnlyBlockDirectory_DeleteSegmentFile(
 		Snapshot snapshot,
 		int segno,
 		int columnGroupNo);
+
+typedef void (*AppendOnlyBlockDirectoryZoneCallback) (
+	void *arg,
+	MinipageEntry *entry,
+	MinipageZone *zone);
+extern void AppendOnlyBlockDirectory_ScanZones(
+	Relation aoRel,
+	Snapshot appendOnlyMetaDataSnapshot,
+	int segno,
+	int columnGroupNo,
+	int zoneColumnNo,
+	int64 eof,
+	AppendOnlyBlockDirectoryZoneCallback callback,
+	void *arg);
 #endif
@@ -66,6 +66,13 @@ typedef struct BufferedRead
     char				 *filePathName;
     int64                fileLen;
 
+	int64				 prefetchPosition;
+							/*
+							 * End of the file range already handed to the kernel
+							 * as read-ahead (see gp_appendonly_readahead_large_reads).
+							 * Zero when nothing beyond the current read was hinted.
+							 */
+
 	/*
 	 * Temporary limit support for random reading.
 	 */
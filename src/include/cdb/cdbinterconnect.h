@@ -207,6 +207,23 @@ struct MotionConn
 	uint64 dev;
 	uint64 deadlockCheckBeginTime;
 
+	/*
+	 * Per-connection congestion control state, used by the sender when
+	 * gp_interconnect_adaptive_cwnd is on.  See adjustConnCwndOnAck().
+	 *
+	 * cwnd     - number of packets allowed in the unack queue
+	 * ssthresh - slow start threshold
+	 * minRtt   - smallest ack time seen, the no-queueing baseline
+	 * measuredMinRtt - smallest ack time seen on this connection itself,
+	 *            where minRtt may come from earlier connections
+	 * lastCwndCutTime - when cwnd was last decreased
+	 */
+	float cwnd;
+	float ssthresh;
+	uint64 minRtt;
+	uint64 measuredMinRtt;
+	uint64 lastCwndCutTime;
+
 
 	ICBuffer *curBuff;
 
@@ -238,6 +255,28 @@ struct MotionConn
 	bool		stillActive;
 	bool		stopRequested;
 
+	/* compress the payload of outgoing packets */
+	bool		compress;
+
+	/*
+	 * Shared memory ring used instead of the network for a peer on the same
+	 * host, see ic_udpifc.c.  localPeer is set at setup for such peers;
+	 * shmRing is mapped by the receiver at setup and by the sender once the
+	 * connection is started.  shmPulled counts the packets the receiver has
+	 * moved from the ring into its packet queue.
+	 */
+	bool		localPeer;
+	struct ICShmRing *shmRing;
+	uint32		shmPulled;
+
+	/*
+	 * Runtime filter of the rows sent on this connection, see
+	 * cdbruntimefilter.c.  A sender applies the one its receiver sent it;
+	 * a receiver keeps it here until it knows the sender's address.
+	 */
+	uint8	   *rtFilter;
+	int			rtFilterBits;
+
     MotionConnState state;
 
 	uint64		wakeup_ms;
@@ -269,6 +308,9 @@ struct MotionConn
 	uint64 stat_count_resent;
 	uint64 stat_max_resent;
 	uint64 stat_count_dropped;
+	uint64 stat_count_sent;
+	uint64 stat_count_loss;
+	uint64 stat_count_cwnd_cut;
 
 	/*
 	 * used by the sender.
@@ -326,6 +368,9 @@ typedef struct ChunkTransportStateEntry
 
 	bool		sendingEos;
 
+	/* number of connections receiving through a shared memory ring */
+	int			numShmConns;
+
 	/* Statistics info for this motion on the interconnect level */
 	uint64 stat_total_ack_time;
 	uint64 stat_count_acks;
@@ -408,6 +453,14 @@ typedef struct MotionNodeEntry
 	 */
 	SerTupInfo      ser_tup_info;
 
+	/*
+	 * Route-based array of batches of tuples waiting to be sent, when
+	 * gp_motion_batch_tuples is in effect.  NULL if tuples are sent one
+	 * at a time.
+	 */
+	TupleBatch    **send_batches;
+	int             num_send_batches;
+
 	/*
 	 * If preserve_order is false, this is used to hold completed tuples that
 	 * have not yet been consumed.  If preserve_order is true, this is NULL.
@@ -524,6 +577,7 @@ typedef struct ChunkTransportState
 	TupleChunkListItem (*RecvTupleChunkFrom)(struct ChunkTransportState *transportStates, int16 motNodeID, int16 srcRoute);
 	TupleChunkListItem (*RecvTupleChunkFromAny)(MotionLayerState *mlStates, struct ChunkTransportState *transportStates, int16 motNodeID, int16 *srcRoute);
 	void (*doSendStopMessage)(struct ChunkTransportState *transportStates, int16 motNodeID);
+	void (*doSendRuntimeFilter)(struct ChunkTransportState *transportStates, int16 motNodeID, const uint8 *bits, int nbytes);
 	void (*SendEos)(MotionLayerState *mlStates, struct ChunkTransportState *transportStates, int motNodeID, TupleChunkListItem tcItem);
 } ChunkTransportState;
 
@@ -138,6 +138,22 @@ extern void SendStopMessage(MotionLayerState *mlStates,
 							ChunkTransportState *transportStates,
 							int16 motNodeID);
 
+/*
+ * Runtime filters (see cdbruntimefilter.c): a receiver sends the filter of
+ * the rows it can use to all senders of a Redistribute Motion, and a sender
+ * asks whether a row with the given cdbhash value, routed to targetRoute,
+ * may be dropped.  Only the UDP interconnect carries them.
+ */
+extern void SendRuntimeFilter(MotionLayerState *mlStates,
+							  ChunkTransportState *transportStates,
+							  int16 motNodeID,
+							  const uint8 *bits, int nbytes);
+
+extern bool RuntimeFilterRejects(ChunkTransportState *transportStates,
+								 int16 motNodeID,
+								 int16 targetRoute,
+								 uint32 hash);
+
 /* used by ml_ipc to set the number of receivers that the motion node is expecting.
  * This is used by cdbmotion to keep track of when its seen enough EndOfStream
  * messages.
@@ -0,0 +1,61 @@
+/*--------------------------------------------------------------------------
+ *
+ * cdbruntimefilter.h
+ *	  Bloom filters over cdbhash values, built from the inner side of a hash
+ *	  join and applied by the senders of its outer Redistribute Motion.
+ *
+ * Copyright (c) 2017, Pivotal Inc.
+ *
+ *--------------------------------------------------------------------------
+ */
+#ifndef CDBRUNTIMEFILTER_H
+#define CDBRUNTIMEFILTER_H
+
+/*
+ * The filter is a power-of-two sized bit array, probed at two positions
+ * taken from the two halves of the mixed 32-bit cdbhash value.  The raw
+ * cdbhash value can't be used directly: all keys sent to one segment agree
+ * on it modulo the number of segments.
+ */
+#define RUNTIME_FILTER_MIN_BITS		512
+#define RUNTIME_FILTER_MAX_BITS		65536
+
+typedef struct RuntimeFilter
+{
+	uint8	   *bits;
+	int			nbits;			/* power of two */
+	double		nkeys;			/* number of keys added */
+} RuntimeFilter;
+
+static inline uint32
+RuntimeFilterMix(uint32 hash)
+{
+	hash ^= hash >> 16;
+	hash *= 0x85ebca6b;
+	hash ^= hash >> 13;
+	hash *= 0xc2b2ae35;
+	hash ^= hash >> 16;
+	return hash;
+}
+
+/*
+ * Might a key with this cdbhash value be in the filter?  nbits must be a
+ * power of two.
+ */
+static inline bool
+RuntimeFilterProbe(const uint8 *bits, int nbits, uint32 hash)
+{
+	uint32		m = RuntimeFilterMix(hash);
+	uint32		h1 = m & (nbits - 1);
+	uint32		h2 = (m >> 16) & (nbits - 1);
+
+	return (bits[h1 >> 3] & (1 << (h1 & 7))) != 0 &&
+		(bits[h2 >> 3] & (1 << (h2 & 7))) != 0;
+}
+
+extern RuntimeFilter *RuntimeFilterCreate(int maxbytes);
+extern void RuntimeFilterAdd(RuntimeFilter *filter, uint32 hash);
+extern int	RuntimeFilterFinish(RuntimeFilter *filter);
+extern void RuntimeFilterDestroy(RuntimeFilter *filter);
+
+#endif   /* CDBRUNTIMEFILTER_H */
@@ -471,6 +471,74 @@ extern bool gp_interconnect_aggressive_retry; /* fast-track app-level retry */
  */
 extern bool gp_interconnect_full_crc;
 
+/*
+ * Parameter gp_interconnect_batch_io
+ *
+ * Send and receive UDP-packets in batches with sendmmsg()/recvmmsg(), where
+ * the platform has them.
+ */
+extern bool gp_interconnect_batch_io;
+
+/*
+ * Parameters gp_interconnect_compression,
+ * gp_interconnect_compression_threshold and
+ * gp_interconnect_compression_method
+ *
+ * Compress the payload of the packets sent by motions whose estimated
+ * output is at least gp_interconnect_compression_threshold kB, with LZ4
+ * or zlib. LZ4 is the default when the build supports it.
+ */
+extern bool gp_interconnect_compression;
+extern int	gp_interconnect_compression_threshold;
+
+#define INTERCONNECT_COMPRESSION_ZLIB	(0)
+#define INTERCONNECT_COMPRESSION_LZ4	(1)
+
+#ifdef HAVE_LIBLZ4
+#define INTERCONNECT_COMPRESSION_DEFAULT		INTERCONNECT_COMPRESSION_LZ4
+#define INTERCONNECT_COMPRESSION_DEFAULT_STR	"lz4"
+#else
+#define INTERCONNECT_COMPRESSION_DEFAULT		INTERCONNECT_COMPRESSION_ZLIB
+#define INTERCONNECT_COMPRESSION_DEFAULT_STR	"zlib"
+#endif
+
+extern int	gp_interconnect_compression_method;
+
+extern const char *gpvars_assign_gp_interconnect_compression_method(const char *newval, bool doit, GucSource source __attribute__((unused)) );
+extern const char *gpvars_show_gp_interconnect_compression_method(void);
+
+/*
+ * Parameters gp_interconnect_adaptive_cwnd and
+ * gp_interconnect_cwnd_target_delay
+ *
+ * With the "loss" flow control method, also limit the packets in flight on
+ * each connection by a congestion window of its own.  The window grows
+ * while acks arrive within gp_interconnect_cwnd_target_delay of the
+ * smallest ack time seen on the connection, and is halved when they take
+ * longer or packets are lost.
+ */
+extern bool gp_interconnect_adaptive_cwnd;
+extern int	gp_interconnect_cwnd_target_delay;
+
+/*
+ * Parameter gp_interconnect_local_shm
+ *
+ * With the UDP interconnect, pass the packets of a motion between two
+ * processes on the same host through a shared memory ring instead of the
+ * network stack.  Connection setup and routes to other hosts still use UDP.
+ */
+extern bool gp_interconnect_local_shm;
+
+/*
+ * Parameter gp_motion_batch_tuples
+ *
+ * Maximum number of tuples a motion packs into one tuple-chunk, when all
+ * attributes are fixed-width.  Motions received by the QD are never
+ * batched, so as not to delay the first rows of a result.  0 (the default)
+ * or 1 sends every tuple in chunks of its own.
+ */
+extern int	gp_motion_batch_tuples;
+
 /*
  * Parameter gp_interconnect_log_stats
  *
@@ -633,6 +701,27 @@ extern bool gp_enable_multiphase_agg;
  */
 extern bool gp_enable_motion_deadlock_sanity;
 
+/*
+ * "gp_enable_motion_skew" and "gp_motion_skew_threshold"
+ *
+ * When redistributing both inputs of a join on a single key, treat the most
+ * common key values of one input whose frequency is at least
+ * gp_motion_skew_threshold as skewed: those rows are spread over all
+ * segments, and the matching rows of the other input are broadcast.
+ */
+extern bool gp_enable_motion_skew;
+extern double gp_motion_skew_threshold;
+
+/*
+ * "gp_enable_runtime_filter"
+ *
+ * When the outer side of an inner or semi hash join comes through a
+ * Redistribute Motion on the join keys, send a bloom filter of each
+ * segment's inner keys back to the senders, which then drop the rows that
+ * can't find a match.  UDP interconnect only.
+ */
+extern bool gp_enable_runtime_filter;
+
 /*
  * Adjust selectivity for nulltests atop of outer joins;
  * Special casing prominent use case to work around lack of (NOT) IN subqueries
@@ -810,6 +899,15 @@ extern bool gp_enable_sort_distinct;
 extern bool gp_enable_mk_sort;
 extern bool gp_enable_motion_mk_sort;
 
+/*
+ * gp_enable_motion_loser_tree
+ *
+ * Merge the sorted streams of a Merge Receive motion with a loser tree over
+ * pre-extracted sort keys, instead of a heap.  Takes precedence over
+ * gp_enable_motion_mk_sort.
+ */
+extern bool gp_enable_motion_loser_tree;
+
 #ifdef USE_ASSERT_CHECKING
 extern bool gp_mk_sort_check;
 #endif
@@ -13,6 +13,7 @@
 #include "cdb/cdbmotion.h"
 #include "cdb/cdbvars.h"
 #include "cdb/cdbgang.h"
+#include "utils/timestamp.h"
 
 struct SliceTable;                          /* #include "nodes/execnodes.h" */
 struct EState;                              /* #include "nodes/execnodes.h" */
@@ -46,6 +47,18 @@ typedef struct RegisterMessage
  */
 #define PACKET_HEADER_SIZE 4
 
+/*
+ * Compressed packets are marked by the high bit of the packet header with
+ * the TCP interconnect, and by a flag of icpkthdr with UDPIFC. A second
+ * bit or flag tells that the payload is compressed with LZ4 rather than
+ * zlib. See compressPacket().
+ */
+#define PACKET_HEADER_COMPRESSED	0x80000000
+#define PACKET_HEADER_COMPRESSED_LZ4	0x40000000
+#define PACKET_HEADER_FLAGS			(PACKET_HEADER_COMPRESSED | PACKET_HEADER_COMPRESSED_LZ4)
+#define UDPIC_FLAGS_COMPRESSED		(256)
+#define UDPIC_FLAGS_COMPRESSED_LZ4	(2048)
+
 /* Performs initialization of the MotionLayerIPC.  This should be called before
  * any work is performed through functions here.  Generally, this should only
  * need to be called only once during process startup.
@@ -311,6 +324,10 @@ extern void forceEosToPeers(MotionLayerState       *mlStates,
 
 extern TupleChunkListItem RecvTupleChunk(MotionConn *conn, ChunkTransportState *transportStates);
 
+extern void setupMotionCompression(struct EState *estate, ChunkTransportStateEntry *pEntry);
+extern int	compressPacket(uint8 *msg, int msgSize, int hdrSize, int *pMethod);
+extern uint8 *decompressPacket(uint8 *msg, int msgSize, int hdrSize, int method, int *pMsgSize);
+
 extern void InitMotionTCP(int *listenerSocketFd, uint16 *listenerPort);
 extern void InitMotionUDPIFC(int *listenerSocketFd, uint16 *listenerPort);
 extern void markUDPConnInactiveIFC(MotionConn *conn);
@@ -329,4 +346,54 @@ extern void TeardownUDPIFCInterconnect(ChunkTransportState *transportStates,
 extern uint32 getActiveMotionConns(void);
 extern void adjustMasterRouting(Slice *recvSlice);
 
+/*
+ * Congestion control state and counters of the UDPIFC connections this
+ * segment has sent to one peer (a receiving segment, or the QD), kept in
+ * shared memory.  The state of a connection is recorded when it is torn
+ * down, and seeds new connections to the same peer when
+ * gp_interconnect_adaptive_cwnd is on.
+ */
+typedef struct ICPeerStats
+{
+	int32		contentId;		/* remote content id, UNDEF_SEGMENT if unused */
+	float		cwnd;			/* average at teardown of recent connections */
+	float		ssthresh;		/* average at teardown of recent connections */
+	uint64		rtt;			/* average smoothed rtt of recent connections (us) */
+	uint64		minRtt;			/* smallest ack time seen recently (us) */
+	TimestampTz	minRttTime;		/* when minRtt was seen */
+
+	/* totals over all recorded connections */
+	uint64		numConns;
+	uint64		pktsSent;
+	uint64		acks;
+	uint64		resent;
+	uint64		losses;
+	uint64		cwndCuts;
+
+	TimestampTz	lastUpdate;
+} ICPeerStats;
+
+/* peers are indexed by content id + 1 */
+#define IC_PEER_STATS_SLOTS (1024)
+
+extern Size ICPeerStatsShmemSize(void);
+extern void ICPeerStatsShmemInit(void);
+extern int	getICPeerStats(ICPeerStats *stats, int maxStats);
+
+extern void RemoveICShmRings(void);
+
+/*
+ * Steps of the per-packet CPU work of the UDPIFC interconnect, as timed by
+ * benchmarkICPacketPath().
+ */
+typedef enum ICBenchStep
+{
+	IC_BENCH_FILL,			/* copy header and payload into the packet */
+	IC_BENCH_ADD_CRC,		/* sender side of gp_interconnect_full_crc */
+	IC_BENCH_CHECK_CRC,		/* receiver side of gp_interconnect_full_crc */
+	IC_BENCH_NUM_STEPS
+} ICBenchStep;
+
+extern void benchmarkICPacketPath(int packetSize, int numPackets, uint64 *usecs);
+
 #endif   /* ML_IPC_H */
@@ -10,6 +10,7 @@
 
 
 #include "access/heapam.h"
+#include "access/memtup.h"
 #include "cdb/tupchunklist.h"
 #include "lib/stringinfo.h"
 #include "utils/lsyscache.h"
@@ -82,8 +83,41 @@ typedef struct SerTupInfo
 
 	/* true if tupdesc contains record types */
 	bool		has_record_types;
+
+	/*
+	 * Width of a tuple's attribute values, if all attributes are fixed-width
+	 * so that tuples can be sent in TC_BATCH chunks; 0 otherwise.
+	 */
+	int			batch_width;
+
+	/* Offset of each attribute in the data area of a tuple without nulls. */
+	int		   *batch_attoff;
+
+	/* For deforming memtuples into a batch. */
+	MemTupleBinding *batch_mt_bind;
 }	SerTupInfo;
 
+/*
+ * A batch of tuples waiting to be sent as a single TC_BATCH chunk.
+ *
+ * The chunk has a short header with the number of tuples, followed by one
+ * null bitmap per attribute (only if some value in the batch is null) and
+ * then the attribute values, column by column: the values of each attribute
+ * are laid out contiguously, batch_width bytes per tuple in all.  While the
+ * batch is being filled, each column has room for 'capacity' values.
+ */
+typedef struct TupleBatch
+{
+	int			ntuples;		/* tuples in the batch */
+	int			capacity;		/* tuples that fit in one chunk */
+	bool		hasnulls;		/* any null values in the batch? */
+	char	   *values;			/* column-major attribute values */
+	bits8	   *nulls;			/* per-attribute bitmaps, bit set = null */
+}	TupleBatch;
+
+#define TUPLE_BATCH_HEADER_SIZE		4
+#define TUPLE_BATCH_MAX_TUPLES		1024
+
 /*
  * forward declaration to avoid #including cdbmotion.h here, which would create a circular
  * dependency
@@ -109,6 +143,21 @@ extern void SerializeTupleIntoChunks(HeapTuple tuple, SerTupInfo *pSerInfo, Tupl
 /* Convert a HeapTuple into chunks directly in a set of transport buffers */
 extern int SerializeTupleDirect(HeapTuple tuple, SerTupInfo *pSerInfo, struct directTransportBuffer *b);
 
+/* Set up a batch of tuples to send in TC_BATCH chunks, or return NULL */
+extern TupleBatch *CreateTupleBatch(SerTupInfo *pSerInfo, int maxTuples);
+
+/* Add a tuple to a batch that is not full */
+extern void AddTupleToBatch(HeapTuple tuple, SerTupInfo *pSerInfo, TupleBatch *batch);
+
+/* Size of the TC_BATCH chunk, including its header, for a batch */
+extern int TupleBatchChunkSize(SerTupInfo *pSerInfo, TupleBatch *batch);
+
+/* Write a batch out as a TC_BATCH chunk, and empty it */
+extern int SerializeTupleBatch(SerTupInfo *pSerInfo, TupleBatch *batch, char *dest);
+
+/* Convert a TC_BATCH chunk into an array of HeapTuples */
+extern HeapTuple *DeserializeTupleBatch(SerTupInfo *pSerInfo, TupleChunkListItem tcItem, int *ntuples);
+
 /* Deserialize a HeapTuple's data from a byte-array. */
 extern HeapTuple DeserializeTuple(SerTupInfo * pSerInfo, StringInfo serialTup);
 
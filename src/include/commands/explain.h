@@ -41,4 +41,10 @@ extern void ExplainOneUtility(Node *utilityStmt, ExplainStmt *stmt,
 extern void ExplainOnePlan(PlannedStmt *plannedstmt, ParamListInfo params,
 			   ExplainStmt *stmt, const char *queryString, TupOutputState *tstate);
 
+#ifdef USE_ORCA
+struct OptimizerStats;
+extern void ExplainOptimizerStats(struct OptimizerStats *optstats,
+					  PlannedStmt *plan, TupOutputState *tstate);
+#endif
+
 #endif   /* EXPLAIN_H */
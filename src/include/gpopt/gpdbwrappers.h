@@ -137,6 +137,12 @@ namespace gpdb {
 	// add member to Bitmapset
 	Bitmapset *PbmsAddMember(Bitmapset *a, int x);
 
+	// is the given integer a member of the Bitmapset
+	bool FBmsIsMember(int x, const Bitmapset *a);
+
+	// do the two Bitmapsets have a common member
+	bool FBmsOverlap(const Bitmapset *a, const Bitmapset *b);
+
 	// create a copy of an object
 	void *PvCopyObject(void *from);
 
@@ -603,6 +609,9 @@ namespace gpdb {
 	// returns the result of evaluating 'pexpr' as an Expr. Caller keeps ownership of 'pexpr'
 	// and takes ownership of the result 
 	Expr *PexprEvaluate(Expr *pexpr, Oid oidResultType, int32 iTypeMod);
+
+	// does the expression contain calls to volatile functions
+	bool FContainVolatileFunctions(Node *pnode);
 	
 	// interpret the value of "With oids" option from a list of defelems
 	bool FInterpretOidsOption(List *plOptions);
@@ -25,12 +25,19 @@
 #include "naucrates/md/IMDId.h"
 #include "naucrates/md/IMDProvider.h"
 
+#include "gpopt/utils/optstats.h"
+
 // fwd decl
 namespace gpopt
 {
 	class CMDAccessor;
 }
 
+namespace gpdxl
+{
+	class CHistogramColumns;
+}
+
 namespace gpmd
 {
 	using namespace gpos;
@@ -49,13 +56,20 @@ namespace gpmd
 			// memory pool
 			IMemoryPool *m_pmp;
 
+			// columns that need histograms, NULL if all do
+			gpdxl::CHistogramColumns *m_phistcols;
+
 			// private copy ctor
 			CMDProviderRelcache(const CMDProviderRelcache&);
 
+			// request kind of the given mdid, as reported in optimizer statistics
+			static
+			OptStatsMDKind EmdkindStats(IMDId *pmdid);
+
 		public:
 			// ctor/dtor
 			explicit
-			CMDProviderRelcache(IMemoryPool *pmp);
+			CMDProviderRelcache(IMemoryPool *pmp, gpdxl::CHistogramColumns *phistcols = NULL);
 
 			~CMDProviderRelcache()
 			{
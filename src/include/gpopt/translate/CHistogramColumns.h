@@ -0,0 +1,154 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2017 Pivotal Software, Inc.
+//
+//	@filename:
+//		CHistogramColumns.h
+//
+//	@doc:
+//		Set of base table columns for which the optimizer needs histograms
+//		when optimizing the current query.
+//
+//		ORCA requests column statistics both for columns it estimates
+//		predicates on and for columns whose width it needs, i.e. for every
+//		output column of a scan. Translating MCVs and histograms of the
+//		latter is wasted work, which is considerable on wide tables. With
+//		optimizer_lazy_column_stats, the relcache translator gives full
+//		statistics only to columns referenced in predicates, and scalar
+//		statistics (width, null fraction, NDV) to all others.
+//
+//		Column statistics outlive the query in the MD cache, under a key
+//		made of the relation mdid and the column position only, so the key
+//		cannot tell scalar-only statistics apart. The cache keys of the
+//		scalar-only entries are recorded instead, and before a later query
+//		that needs histograms for any of those columns just these entries
+//		are evicted.
+//
+//	@test:
+//
+//---------------------------------------------------------------------------
+
+#ifndef GPDXL_CHistogramColumns_H
+#define GPDXL_CHistogramColumns_H
+
+#include "gpos/base.h"
+#include "naucrates/dxl/gpdb_types.h"
+
+// fwd declarations
+struct Query;
+struct Node;
+struct List;
+struct Var;
+
+namespace gpdxl
+{
+	using namespace gpos;
+
+	class CHistogramColumns;
+
+	//---------------------------------------------------------------------------
+	//	@class:
+	//		CScalarOnlyColStats
+	//
+	//	@doc:
+	//		Column statistics entries of the MD cache that were translated
+	//		without MCVs and histogram. The record describes the contents of
+	//		the MD cache, so it is owned by whoever owns the cache and must be
+	//		reset along with it; entries are kept in TopMemoryContext.
+	//
+	//---------------------------------------------------------------------------
+	class CScalarOnlyColStats
+	{
+		private:
+
+			// recorded entries
+			List *m_plColumns;
+
+			// private copy ctor
+			CScalarOnlyColStats(const CScalarOnlyColStats &);
+
+		public:
+
+			// ctor
+			CScalarOnlyColStats();
+
+			// record the statistics entry of a column
+			void Add(OID oidRel, INT iAttno, ULONG ulPos);
+
+			// evict the entries of columns that need histograms in the given
+			// optimization from the MD cache, and forget them
+			void EvictStale(IMemoryPool *pmp, const CHistogramColumns *phistcols);
+
+			// the MD cache has been emptied
+			void Reset();
+	};
+
+	//---------------------------------------------------------------------------
+	//	@class:
+	//		CHistogramColumns
+	//
+	//	@doc:
+	//		Columns that need histograms in one optimization. Owned by the
+	//		optimization task and handed to the relcache translator through
+	//		the MD provider.
+	//
+	//---------------------------------------------------------------------------
+	class CHistogramColumns
+	{
+		private:
+
+			// stack of query levels, innermost first
+			struct SQueryLevel;
+
+			// walker context
+			struct SCollectContext;
+
+			// is lazy translation active
+			BOOL m_fActive;
+
+			// columns referenced in predicates of the query
+			List *m_plRelColumns;
+
+			// record of scalar-only entries in the MD cache
+			CScalarOnlyColStats *m_pscos;
+
+			// private copy ctor
+			CHistogramColumns(const CHistogramColumns &);
+
+			// collect predicate columns of a query level
+			static
+			void CollectQuery(Query *pquery, SQueryLevel *pqlParent, SCollectContext *pctx);
+
+			// collect base table columns an output column of a query depends on
+			static
+			void CollectOutputColumn(Query *pquery, SQueryLevel *pqlParent, INT iAttno, SCollectContext *pctx);
+
+			// collect base table columns a variable depends on
+			static
+			void CollectVar(Var *pvar, SQueryLevel *pql, SCollectContext *pctx);
+
+			// walker for predicates
+			static
+			BOOL FPredicateWalker(Node *pnode, void *pvCtx);
+
+			// walker finding subqueries in expressions that are not predicates
+			static
+			BOOL FSubqueryWalker(Node *pnode, void *pvCtx);
+
+		public:
+
+			// ctor; computes the histogram columns of a query
+			CHistogramColumns(Query *pquery, BOOL fLazy, CScalarOnlyColStats *pscos);
+
+			// is the column one that needs a histogram
+			BOOL FHistogramColumn(OID oidRel, INT iAttno) const;
+
+			// does the column need a histogram; when not, its statistics
+			// entry is recorded as scalar-only
+			BOOL FNeedsHistogram(OID oidRel, INT iAttno, ULONG ulPos);
+	};
+}
+
+#endif // !GPDXL_CHistogramColumns_H
+
+// EOF
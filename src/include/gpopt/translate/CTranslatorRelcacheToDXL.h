@@ -23,6 +23,7 @@
 #include "postgres.h"
 #include "access/tupdesc.h"
 #include "catalog/gp_policy.h"
+#include "catalog/pg_statistic.h"
 
 #include "naucrates/dxl/gpdb_types.h"
 #include "naucrates/dxl/operators/CDXLColDescr.h"
@@ -54,6 +55,9 @@ namespace gpdxl
 	using namespace gpos;
 	using namespace gpmd;
 
+	// fwd decl
+	class CHistogramColumns;
+
 	//---------------------------------------------------------------------------
 	//	@class:
 	//		CTranslatorRelcacheToDXL
@@ -199,7 +203,7 @@ namespace gpdxl
 
 			// retrieve column stats object from the relcache
 			static
-			IMDCacheObject *PimdobjColStats(IMemoryPool *pmp, CMDAccessor *pmda, IMDId *pmdid);
+			IMDCacheObject *PimdobjColStats(IMemoryPool *pmp, CMDAccessor *pmda, IMDId *pmdid, CHistogramColumns *phistcols);
 
 			// retrieve cast object from the relcache
 			static
@@ -386,6 +390,18 @@ namespace gpdxl
             static
             ULONG UlTableCount(OID oidRelation);
 
+			// generate bucket-free statistics from a pg_statistic entry
+			static
+			CDXLColStats *PdxlcolstatsScalar
+							(
+							IMemoryPool *pmp,
+							CMDIdColStats *pmdidColStats,
+							CMDName *pmdnameCol,
+							Form_pg_statistic fpsStats,
+							DrgPdxlbucket *pdrgpdxlbucket,
+							CDouble dRows
+							);
+
             // generate statistics for the system level columns
             static
             CDXLColStats *PdxlcolstatsSystemColumn
@@ -400,9 +416,10 @@ namespace gpdxl
                               CDouble dRows
                               );
 		public:
-			// retrieve a metadata object from the relcache
+			// retrieve a metadata object from the relcache; column statistics
+			// get histograms only for the given columns, if any
 			static
-			IMDCacheObject *Pimdobj(IMemoryPool *pmp, CMDAccessor *pmda, IMDId *pmdid);
+			IMDCacheObject *Pimdobj(IMemoryPool *pmp, CMDAccessor *pmda, IMDId *pmdid, CHistogramColumns *phistcols = NULL);
 
 			// retrieve a relation from the relcache
 			static
@@ -0,0 +1,210 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2017 Pivotal Software, Inc.
+//
+//	@filename:
+//		CBinaryDXL.h
+//
+//	@doc:
+//		Compact binary encoding of DXL documents, used for minidumps and
+//		metadata dumps.
+//
+//		The encoding is a token stream of start tags, attributes, end tags
+//		and text, in which tag names, attribute names and short values are
+//		replaced by indexes into a dictionary that is built on the fly. The
+//		stream is then compressed with zlib. Markup that is not in the form
+//		produced by the DXL serializer (comments, processing instructions,
+//		unusual spacing) is kept as text, so decoding always reproduces the
+//		original document byte for byte.
+//
+//		All routines use palloc'd memory and report errors with ereport;
+//		they must not be called from within a GPOS task, except Walk() on a
+//		stream that PbdxlsInflate() has already validated.
+//
+//		Minidumps captured by the optimizer (optimizer_minidump) are still
+//		written as XML: the optimizer library serializes them and writes
+//		them to a file it names itself, so the document never passes
+//		through GPDB. gpoptutils.EncodeDXLFile() converts them afterwards.
+//
+//	@test:
+//
+//
+//---------------------------------------------------------------------------
+
+#ifndef CBinaryDXL_H
+#define CBinaryDXL_H
+
+#include "gpdbdefs.h"
+
+// magic bytes at the start of a binary DXL document
+#define BDXL_MAGIC			"BDXL"
+#define BDXL_MAGIC_LEN		4
+
+// current format version
+#define BDXL_VERSION		1
+
+// size of the fixed header preceding the token stream
+#define BDXL_HEADER_LEN		20
+
+//---------------------------------------------------------------------------
+//	@class:
+//		IBinaryDXLHandler
+//
+//	@doc:
+//		Receives the tokens of a binary DXL document from CBinaryDXL::Walk().
+//		Strings are not null-terminated and are valid only during the call.
+//
+//---------------------------------------------------------------------------
+class IBinaryDXLHandler
+{
+	public:
+
+		virtual
+		~IBinaryDXLHandler() {}
+
+		// '<' name
+		virtual
+		void StartTag(const char *pcName, uint32 ulNameLen) = 0;
+
+		// ' ' name '="' value '"', value still escaped
+		virtual
+		void Attribute(const char *pcName, uint32 ulNameLen, const char *pcValue, uint32 ulValueLen) = 0;
+
+		// '>', or '/>' if fEmpty
+		virtual
+		void StartTagClose(bool fEmpty) = 0;
+
+		// '</' name '>'
+		virtual
+		void EndTag(const char *pcName, uint32 ulNameLen) = 0;
+
+		// character data, or markup that was copied verbatim
+		virtual
+		void Text(const char *pc, uint32 ulLen) = 0;
+};
+
+//---------------------------------------------------------------------------
+//	@struct:
+//		SBinaryDXLStream
+//
+//	@doc:
+//		Decompressed and validated token stream of a binary DXL document
+//
+//---------------------------------------------------------------------------
+struct SBinaryDXLStream
+{
+	// token stream: structure part followed by literal part
+	char *m_pcStream;
+	uint32 m_ulStreamLen;
+	uint32 m_ulStructureLen;
+
+	// length of the decoded document
+	uint32 m_ulXMLLen;
+
+	// upper bound on the number of dictionary entries, for Walk()
+	uint32 m_ulMaxEntries;
+
+	// the decoded document, if the stream holds markup that cannot be
+	// replayed as parser events (see CBinaryDXL::FReplayableMarkup);
+	// NULL otherwise
+	char *m_szXML;
+};
+
+class CBinaryDXL
+{
+	private:
+
+		// token stream opcodes
+		enum EOpcode
+		{
+			EopStartTag = 1,	// '<' name
+			EopAttribute,		// ' ' name '="' value '"'
+			EopStartTagClose,	// '>'
+			EopEmptyTagClose,	// '/>'
+			EopEndTag,			// '</' name '>'
+			EopText,			// character data or non-canonical markup
+			EopSentinel
+		};
+
+		// encoder state
+		struct SEncodeState;
+
+		// decoder state
+		struct SDecodeState;
+
+		// append an unsigned varint to the token stream
+		static
+		void AppendVarint(StringInfo str, uint32 ul);
+
+		// append a dictionary reference or literal for the given string
+		static
+		void AppendString(SEncodeState *pes, const char *pc, uint32 ulLen);
+
+		// scan a canonical tag, emitting its tokens if pes is not NULL;
+		// returns the number of bytes consumed, or 0 if the tag is not canonical
+		static
+		uint32 UlScanTag(SEncodeState *pes, const char *pc, uint32 ulLen);
+
+		// length of the markup starting at pc when copied verbatim
+		static
+		uint32 UlRawMarkupLength(const char *pc, uint32 ulLen);
+
+		// read an unsigned varint from the token stream
+		static
+		uint32 UlReadVarint(SDecodeState *pds);
+
+		// read a dictionary reference or literal
+		static
+		void ReadString(SDecodeState *pds, const char **ppc, uint32 *pulLen);
+
+		// report corrupt input
+		static
+		void ReportCorrupt(const char *szDetail);
+
+	public:
+
+		// does the buffer start with a binary DXL header
+		static
+		bool FBinaryDXL(const char *pc, uint32 ulLen);
+
+		// does the file start with a binary DXL header; reads the header only
+		static
+		bool FBinaryDXLFile(const char *szFilename);
+
+		// can markup copied verbatim be skipped when replaying parser events
+		static
+		bool FReplayableMarkup(const char *pc, uint32 ulLen);
+
+		// encode an XML document; returns a palloc'd buffer of *pulLen bytes
+		static
+		char *PcEncode(const char *szXML, uint32 ulXMLLen, uint32 *pulLen);
+
+		// decompress and validate a binary DXL document
+		static
+		SBinaryDXLStream *PbdxlsInflate(const char *pc, uint32 ulLen);
+
+		// free a stream returned by PbdxlsInflate
+		static
+		void FreeStream(SBinaryDXLStream *pbdxls);
+
+		// pass the tokens of a stream to a handler; rgpcDict and rgulDictLen
+		// must have room for pbdxls->m_ulMaxEntries entries
+		static
+		void Walk(const SBinaryDXLStream *pbdxls, IBinaryDXLHandler *phandler, const char **rgpcDict, uint32 *rgulDictLen);
+
+		// decode a binary DXL document into a palloc'd, null-terminated string
+		static
+		char *SzDecode(const char *pc, uint32 ulLen);
+
+		// read a whole file into a palloc'd buffer
+		static
+		char *PcReadFile(const char *szFilename, uint32 *pulLen);
+
+		// write a buffer to a file, replacing its contents
+		static
+		void WriteFile(const char *szFilename, const char *pc, uint32 ulLen);
+};
+
+#endif // CBinaryDXL_H
+
+// EOF
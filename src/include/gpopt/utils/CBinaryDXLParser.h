@@ -0,0 +1,136 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2017 Pivotal Software, Inc.
+//
+//	@filename:
+//		CBinaryDXLParser.h
+//
+//	@doc:
+//		Builds DXL objects from a binary DXL document by replaying its tokens
+//		as SAX events to the DXL parse handlers, without producing and
+//		parsing the XML text
+//
+//	@test:
+//
+//
+//---------------------------------------------------------------------------
+
+#ifndef GPDXL_CBinaryDXLParser_H
+#define GPDXL_CBinaryDXLParser_H
+
+#include "gpopt/utils/CBinaryDXL.h"
+
+#include "gpos/base.h"
+
+#include <xercesc/sax2/SAX2XMLReader.hpp>
+
+#include "gpopt/minidump/CDXLMinidump.h"
+#include "naucrates/dxl/parser/CParseHandlerDXL.h"
+
+namespace gpdxl
+{
+	using namespace gpos;
+	using namespace gpopt;
+
+	XERCES_CPP_NAMESPACE_USE
+
+	//---------------------------------------------------------------------------
+	//	@class:
+	//		CBinaryDXLParser
+	//
+	//	@doc:
+	//		Turns the tokens of a binary DXL document into the events a SAX
+	//		parser would report for its XML text. The events go to the content
+	//		handler currently installed in the reader, which the parse handler
+	//		manager switches as parse handlers are activated, exactly as during
+	//		a Xerces parse.
+	//
+	//		Runs within a GPOS task, on a stream validated by
+	//		CBinaryDXL::PbdxlsInflate().
+	//
+	//---------------------------------------------------------------------------
+	class CBinaryDXLParser : public IBinaryDXLHandler
+	{
+		private:
+
+			// attributes of the element being started
+			class CAttributes;
+
+			// namespace declaration
+			struct SNamespace
+			{
+				XMLCh *m_xmlszPrefix;
+				XMLCh *m_xmlszURI;
+			};
+
+			// memory pool
+			IMemoryPool *m_pmp;
+
+			// reader holding the current content handler
+			SAX2XMLReader *m_pxmlreader;
+
+			// qualified name of the element being started
+			XMLCh *m_xmlszQName;
+
+			// attributes of the element being started
+			CAttributes *m_pattrs;
+
+			// namespace declarations seen so far
+			SNamespace *m_rgns;
+			ULONG m_ulNamespaces;
+			ULONG m_ulNamespaceSize;
+
+			// private copy ctor
+			CBinaryDXLParser(const CBinaryDXLParser &);
+
+			// convert UTF-8 to a null-terminated XMLCh string, replacing
+			// character and entity references if fUnescape
+			XMLCh *PxmlszTranscode(const char *pc, uint32 ulLen, BOOL fUnescape, BOOL fAttribute, XMLSize_t *pulLen);
+
+			// namespace URI and local name of a qualified name
+			const XMLCh *PxmlszURI(const XMLCh *xmlszQName, BOOL fElement, const XMLCh **pxmlszLocalName) const;
+
+			// remember a namespace declaration
+			void AddNamespace(const XMLCh *xmlszQName, XMLCh *xmlszURI);
+
+			// report the end of an element
+			void EndElement(const XMLCh *xmlszQName);
+
+		public:
+
+			// ctor
+			CBinaryDXLParser(IMemoryPool *pmp, SAX2XMLReader *pxmlreader);
+
+			// dtor
+			virtual
+			~CBinaryDXLParser();
+
+			// IBinaryDXLHandler interface
+			virtual
+			void StartTag(const char *pcName, uint32 ulNameLen);
+
+			virtual
+			void Attribute(const char *pcName, uint32 ulNameLen, const char *pcValue, uint32 ulValueLen);
+
+			virtual
+			void StartTagClose(BOOL fEmpty);
+
+			virtual
+			void EndTag(const char *pcName, uint32 ulNameLen);
+
+			virtual
+			void Text(const char *pc, uint32 ulLen);
+
+			// parse a binary DXL document into a DXL parse handler
+			static
+			CParseHandlerDXL *PphdxlParse(IMemoryPool *pmp, const SBinaryDXLStream *pbdxls);
+
+			// load a minidump from a binary DXL document
+			static
+			CDXLMinidump *PdxlmdLoad(IMemoryPool *pmp, const SBinaryDXLStream *pbdxls);
+	};
+}
+
+#endif // !GPDXL_CBinaryDXLParser_H
+
+// EOF
@@ -16,6 +16,8 @@
 #define GPDXL_CConstExprEvaluator_H
 
 #include "gpos/base.h"
+#include "gpos/common/CHashMap.h"
+#include "gpos/string/CWStringDynamic.h"
 
 #include "gpopt/eval/IConstDXLNodeEvaluator.h"
 #include "gpopt/mdcache/CMDAccessor.h"
@@ -74,6 +76,22 @@ namespace gpdxl
 
 			};
 
+			// hash of a key of the results map
+			static
+			ULONG UlHashDXL(const CWStringDynamic *pstr);
+
+			// equality of keys of the results map
+			static
+			BOOL FEqualDXL(const CWStringDynamic *pstrA, const CWStringDynamic *pstrB);
+
+			// release a value of the results map
+			static
+			void FreeConst(Const *pconst);
+
+			// map from the serialized DXL of an expression to its value
+			typedef CHashMap<CWStringDynamic, Const, UlHashDXL, FEqualDXL,
+							CleanupDelete<CWStringDynamic>, FreeConst> HMStrConst;
+
 			// memory pool, not owned
 			IMemoryPool *m_pmp;
 
@@ -86,6 +104,14 @@ namespace gpdxl
 			// translator for the DXL input -> GPDB Expr
 			CTranslatorDXLToScalar m_trdxl2scalar;
 
+			// results of the expressions evaluated so far, as the optimizer
+			// asks for the same expression many times, e.g. during partition
+			// elimination
+			HMStrConst *m_phmstrconst;
+
+			// translate a constant to DXL
+			CDXLNode *PdxlnConst(Const *pconst);
+
 		public:
 			// ctor
 			CConstExprEvaluatorProxy
@@ -97,14 +123,17 @@ namespace gpdxl
 				m_pmp(pmp),
 				m_emptymapcidvar(m_pmp),
 				m_pmda(pmda),
-				m_trdxl2scalar(m_pmp, m_pmda, 0)
+				m_trdxl2scalar(m_pmp, m_pmda, 0),
+				m_phmstrconst(NULL)
 			{
+				m_phmstrconst = GPOS_NEW(m_pmp) HMStrConst(m_pmp);
 			}
 
 			// dtor
 			virtual
 			~CConstExprEvaluatorProxy()
 			{
+				m_phmstrconst->Release();
 			}
 
 			// evaluate given constant expressionand return the DXL representation of the result.
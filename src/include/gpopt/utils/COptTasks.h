@@ -32,6 +32,7 @@ namespace gpos
 namespace gpdxl
 {
 	class CDXLNode;
+	class CScalarOnlyColStats;
 }
 
 namespace gpopt
@@ -47,6 +48,7 @@ struct PlannedStmt;
 struct Query;
 struct List;
 struct MemoryContextData;
+struct SBinaryDXLStream;
 
 using namespace gpos;
 using namespace gpdxl;
@@ -157,6 +159,9 @@ class COptTasks
 			// the name of the file containing the minidump
 			char *m_szFileName;
 
+			// the minidump, if the file holds a binary minidump
+			const SBinaryDXLStream *m_pbdxls;
+
 			// the result of optimizing the minidump
 			char *m_szDXLResult;
 
@@ -165,10 +170,24 @@ class COptTasks
 			SOptimizeMinidumpContext *PoptmdpConvert(void *pv);
 		};
 
+		// column statistics entries of the MD cache that were translated
+		// without histograms; reset along with the cache
+		static
+		CScalarOnlyColStats m_scosMDCache;
+
 		// execute a task given the argument
 		static
 		void Execute ( void *(*pfunc) (void *), void *pfuncArg);
 
+		// initialize the MD cache, or purge it if needed, and apply the
+		// configured size; returns true if the cache was initialized
+		static
+		BOOL FInitMDCache(BOOL fReset);
+
+		// shut down the MD cache
+		static
+		void ShutdownMDCache();
+
 		// print error and delete the given error buffer
 		static
 		void LogErrorAndDelete(CHAR* err_buf);
@@ -276,9 +295,10 @@ class COptTasks
 		static
 		PlannedStmt *PplstmtFromXML(char *szXmlString);
 
-		// dump metadata objects from relcache to file in DXL format
+		// dump metadata objects from relcache to file in DXL format, or in
+		// the compact binary encoding of DXL
 		static
-		void DumpMDObjs(List *oids, const char *szFilename);
+		void DumpMDObjs(List *oids, const char *szFilename, bool fBinary = false);
 
 		// dump metadata objects from relcache to a string in DXL format
 		static
@@ -0,0 +1,95 @@
+/*-------------------------------------------------------------------------
+ *
+ * optstats.h
+ *	  Planning-time statistics collected by GPORCA for EXPLAIN OPTIMIZER_STATS
+ *
+ * The structure is filled in by COptTasks and CMDProviderRelcache while a
+ * query is optimized, as long as optimizer_stats_collector points to it.
+ *
+ * Copyright (c) 2017, Pivotal Software, Inc.
+ *
+ * src/include/gpopt/utils/optstats.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef OPTSTATS_H
+#define OPTSTATS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* phases of a single optimizer invocation */
+typedef enum OptStatsPhase
+{
+	OPTSTATS_PHASE_QUERY_TO_DXL,	/* Query -> DXL translation */
+	OPTSTATS_PHASE_OPTIMIZE,		/* preprocessing and search */
+	OPTSTATS_PHASE_DXL_TO_PLSTMT,	/* DXL -> PlannedStmt translation */
+	OPTSTATS_NUM_PHASES
+} OptStatsPhase;
+
+/* kinds of metadata requests served by the relcache provider */
+typedef enum OptStatsMDKind
+{
+	OPTSTATS_MD_OBJECT,				/* relations, types, operators, functions... */
+	OPTSTATS_MD_RELSTATS,			/* relation statistics */
+	OPTSTATS_MD_COLSTATS,			/* column statistics */
+	OPTSTATS_MD_CAST,				/* cast functions */
+	OPTSTATS_MD_SCCMP,				/* scalar comparison operators */
+	OPTSTATS_NUM_MD_KINDS
+} OptStatsMDKind;
+
+typedef struct OptimizerStats
+{
+	/* elapsed time of each phase, in milliseconds */
+	double		phase_time[OPTSTATS_NUM_PHASES];
+
+	/*
+	 * Highest number of bytes allocated in the optimizer's memory pool seen
+	 * during each phase.  The pool is sampled at the end of each phase and
+	 * whenever the optimizer fetches metadata from the relcache.
+	 */
+	uint64		phase_peak_memory[OPTSTATS_NUM_PHASES];
+
+	/* phase in progress, for sampling the memory pool */
+	OptStatsPhase current_phase;
+
+	/* number of optimizer invocations that filled in these statistics */
+	int			optimizations;
+
+	/* number of search stages in the search strategy */
+	int			search_stages;
+
+	/*
+	 * Statistics the optimizer prints per search stage, as captured from its
+	 * log, or NULL.  palloc'd.
+	 */
+	char	   *search_log;
+
+	/*
+	 * Objects fetched from the relcache, i.e. lookups that missed both the
+	 * MD accessor and the MD cache.
+	 */
+	uint64		md_fetches[OPTSTATS_NUM_MD_KINDS];
+
+	/* time spent fetching metadata from the relcache, in milliseconds */
+	double		md_fetch_time[OPTSTATS_NUM_MD_KINDS];
+} OptimizerStats;
+
+/* statistics of the current optimization, or NULL when not collecting */
+extern OptimizerStats *optimizer_stats_collector;
+
+/* remember 'bytes' if it is the most memory seen in the current phase */
+static inline void
+OptStatsSampleMemory(OptimizerStats *optstats, uint64 bytes)
+{
+	if (optstats->current_phase < OPTSTATS_NUM_PHASES &&
+		bytes > optstats->phase_peak_memory[optstats->current_phase])
+		optstats->phase_peak_memory[optstats->current_phase] = bytes;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif   /* OPTSTATS_H */
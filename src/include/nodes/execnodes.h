@@ -1628,6 +1628,12 @@ typedef struct ScanState
 
 	/* The type of the table that is being scanned */
 	TableType	tableType;
+
+	/*
+	 * The qual, when the access method of the table checks it itself
+	 * instead of ExecScan; ps.qual is then NIL.  See ExecAssignScanQual.
+	 */
+	List	   *ss_accessQual;
 } ScanState;
 
 /*
@@ -2025,6 +2031,26 @@ typedef struct AOCSScanOpaqueData
 	int			ncol;
 
 	struct AOCSScanDescData *scandesc;
+
+	/*
+	 * The batch the rows are returned from, or NULL to read one row at a
+	 * time.
+	 */
+	struct AOCSBatchData *batch;
+
+	/*
+	 * The part of the qual of the scan (ss_accessQual) that is left to
+	 * check on each row, without the clauses the batch checks as equality
+	 * filters.
+	 */
+	List	   *qual;
+
+	/*
+	 * Check qual on each row as the scan returns it, rather than on all rows
+	 * of a batch ahead of time.  Set if the qual has volatile functions,
+	 * which must not run on rows the consumer of the scan never asks for.
+	 */
+	bool		qualPerRow;
 } AOCSScanOpaqueData;
 
 /* -----------------------------------------------
@@ -2521,6 +2547,22 @@ typedef struct HashState
 	bool		hs_quit_if_hashkeys_null;	/* quit building hash table if hashkeys are all null */
 	bool		hs_hashkeys_null;	/* found an instance wherein hashkeys are all null */
 	/* hashkeys is same as parent's hj_InnerHashKeys */
+
+	/*
+	 * Runtime filter of the inner keys, for the senders of the outer
+	 * Redistribute Motion (see cdbruntimefilter.c).  rtfilterKeys are the
+	 * positions in hashkeys of the inner keys matching the motion's hash
+	 * keys, in the same order.  While the filter is built,
+	 * ExecHashGetHashValue() leaves the values of the inner keys of each
+	 * tuple in rtfilterValues and rtfilterNulls.
+	 */
+	List	   *hs_rtfilterKeys;	/* integer list, or NIL */
+	List	   *hs_rtfilterTypes;	/* the motion's hashDataTypes */
+	int			hs_rtfilterMotionId;
+	struct CdbHash *hs_rtfilterHash;
+	struct RuntimeFilter *hs_rtfilter;	/* being built */
+	Datum	   *hs_rtfilterValues;
+	bool	   *hs_rtfilterNulls;
 } HashState;
 
 /* ----------------
@@ -2647,6 +2689,13 @@ typedef enum MotionStateType
 	MOTIONSTATE_RECV,			/* The motion is recver */
 } MotionStateType;
 
+typedef enum MotionMergeType
+{
+	MOTIONMERGE_CDBHEAP,		/* CdbHeap of CdbTupleHeapInfo */
+	MOTIONMERGE_MKHEAP,			/* MKHeap, gp_enable_motion_mk_sort */
+	MOTIONMERGE_LOSERTREE,		/* loser tree, gp_enable_motion_loser_tree */
+} MotionMergeType;
+
 /* ----------------
  *         MotionState information
  * ----------------
@@ -2661,9 +2710,13 @@ typedef struct MotionState
 	bool		sentEndOfStream;	/* set when end-of-stream has successfully been sent */
 	List	   *hashExpr;		/* state struct used for evaluating the hash expressions */
 	struct CdbHash *cdbhash;	/* hash api object */
+	uint32	   *skewHashes;		/* hash values of the motion's skewValues */
+	int			numSkewHashes;
+	int			skewNextRoute;	/* next route for MOTIONSKEW_SPREAD */
 
 	/* For Motion recv */
 	void	   *tupleheap;		/* data structure for match merge in sorted motion node */
+	MotionMergeType mergeType;	/* which kind of structure tupleheap is */
 	int			routeIdNext;	/* for a sorted motion node, the routeId to get next (same as
 								 * the routeId last returned ) */
 	bool		tupleheapReady; /* for a sorted motion node, false until we have a tuple from 
@@ -2609,6 +2609,7 @@ typedef struct ExplainStmt
 	bool		analyze;		/* get statistics by executing plan */
 	bool		dxl;			/* display plan in dxl format */
 	bool		codegen;		/* display generated IR codegen */
+	bool		optimizer_stats;	/* display optimizer phase statistics */
 } ExplainStmt;
 
 /* ----------------------
@@ -1090,6 +1090,17 @@ typedef enum MotionType
 	MOTIONTYPE_EXPLICIT		/* Send tuples to the segment explicitly specified in their segid column */
 } MotionType;
 
+/*
+ * What a Hash motion does with tuples whose hash key is one of its
+ * skewValues, instead of sending them where the key hashes to.
+ */
+typedef enum MotionSkewAction
+{
+	MOTIONSKEW_NONE,		/* no skew handling */
+	MOTIONSKEW_SPREAD,		/* send to each segment in turn */
+	MOTIONSKEW_BROADCAST	/* send to all segments */
+} MotionSkewAction;
+
 /*
  * Motion Node
  *
@@ -1106,6 +1117,10 @@ typedef struct Motion
 	List		*hashExpr;			/* list of hash expressions */
 	List		*hashDataTypes;	    /* list of hash expr data type oids */
 
+	/* For skew handling in Hash motions with a single hash key */
+	MotionSkewAction skewAction;
+	List		*skewValues;		/* list of Consts: the skewed key values */
+
 	/* Output segments */
 	int 	  	numOutputSegs;		/* number of seg indexes in outputSegIdx array, 0 for broadcast */
 	int 	 	*outputSegIdx; 	 	/* array of output segindexes */
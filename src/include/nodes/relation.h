@@ -1034,6 +1034,10 @@ typedef struct CdbMotionPath
 {
 	Path		path;
     Path	   *subpath;
+
+	/* skew handling of a hashed motion; see cdbpath_motion_for_join() */
+	MotionSkewAction skewAction;
+	List	   *skewValues;		/* list of Consts */
 } CdbMotionPath;
 
 /*
@@ -82,6 +82,7 @@ extern int	FileWrite(File file, char *buffer, int amount);
 extern int	FileSync(File file);
 extern int64 FileSeek(File file, int64 offset, int whence);
 extern int64 FileNonVirtualCurSeek(File file);
+extern int	FilePrefetch(File file, int64 offset, int amount);
 extern int	FileTruncate(File file, int64 offset);
 extern int64 FileDiskSize(File file);
 
@@ -1182,6 +1182,21 @@ extern Datum zlib_compress(PG_FUNCTION_ARGS);
 extern Datum zlib_decompress(PG_FUNCTION_ARGS);
 extern Datum zlib_validator(PG_FUNCTION_ARGS);
 
+extern Datum zstd_constructor(PG_FUNCTION_ARGS);
+extern Datum zstd_destructor(PG_FUNCTION_ARGS);
+extern Datum zstd_compress(PG_FUNCTION_ARGS);
+extern Datum zstd_decompress(PG_FUNCTION_ARGS);
+extern Datum zstd_validator(PG_FUNCTION_ARGS);
+
+extern Datum lz4_constructor(PG_FUNCTION_ARGS);
+extern Datum lz4_destructor(PG_FUNCTION_ARGS);
+extern Datum lz4_compress(PG_FUNCTION_ARGS);
+extern Datum lz4_decompress(PG_FUNCTION_ARGS);
+extern Datum lz4_validator(PG_FUNCTION_ARGS);
+
+/* appendonly_compress_bench.c */
+extern Datum gp_compression_benchmark(PG_FUNCTION_ARGS);
+
 extern Datum rle_type_constructor(PG_FUNCTION_ARGS);
 extern Datum rle_type_destructor(PG_FUNCTION_ARGS);
 extern Datum rle_type_compress(PG_FUNCTION_ARGS);
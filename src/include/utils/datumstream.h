@@ -7,6 +7,7 @@
 #define DATUM_STREAM_H
 
 #include "catalog/pg_attribute.h"
+#include "cdb/cdbappendonlyblockdirectory.h"
 #include "utils/datumstreamblock.h"
 
 /*
@@ -41,6 +42,7 @@ typedef struct DatumStreamWrite
 
 	bool		rle_want_compression;
 	bool		delta_want_compression;
+	bool		dict_want_compression;
 
 	int32		maxAoBlockSize;
 	int32		maxAoHeaderSize;
@@ -56,6 +58,13 @@ typedef struct DatumStreamWrite
 
 	DatumStreamBlockWrite blockWrite;
 
+	/*
+	 * Zone of the values put in the current block, kept for the block
+	 * directory when zoneCmp is set.
+	 */
+	FmgrInfo   *zoneCmp;
+	MinipageZone zone;
+
 	/*
 	 * EOFs of current segment file.
 	 */
@@ -134,6 +143,7 @@ typedef struct DatumStreamRead
 
 	bool		rle_can_have_compression;
 	bool		delta_can_have_compression;
+	bool		dict_can_have_compression;
 
 	int32		maxAoBlockSize;
 	int32		maxDataBlockSize;
@@ -219,6 +229,44 @@ datumstreamread_nth(DatumStreamRead * acc)
 	}
 }
 
+/*
+ * Number of rows of the current block not yet returned by
+ * datumstreamread_advance.
+ */
+inline static int
+datumstreamread_rows_left(DatumStreamRead * acc)
+{
+	if (acc->largeObjectState == DatumStreamLargeObjectState_None)
+	{
+		int			left;
+
+		left = acc->blockRead.logical_row_count - 1 - acc->blockRead.nth;
+		return (left > 0 ? left : 0);
+	}
+	else
+	{
+		return (acc->largeObjectState == DatumStreamLargeObjectState_HaveAoContent ? 1 : 0);
+	}
+}
+
+/*
+ * Dictionary code of the current item, when the current block stores its
+ * items in a dictionary.  Returns -1 otherwise.  The code is meaningless if
+ * the current item is NULL.
+ */
+inline static int
+datumstreamread_dict_code(DatumStreamRead * acc)
+{
+	if (acc->largeObjectState != DatumStreamLargeObjectState_None ||
+		!acc->blockRead.dict_block_was_compressed)
+		return -1;
+
+	return acc->blockRead.dict_code;
+}
+
+extern bool datumstreamread_dict_lookup(DatumStreamRead * acc,
+							const char *data, int len, int *code);
+
 /* ------------------------------------------------------------------------------ */
 
 extern int datumstreamwrite_put(
@@ -287,6 +335,8 @@ extern int	datumstreamread_block(DatumStreamRead * ds,
 								  int colGroupNo);
 extern void datumstreamread_find(DatumStreamRead * datumStream,
 					 int32 rowNumInBlock);
+extern int	datumstreamread_skip_to(DatumStreamRead * datumStream,
+						int64 targetRowNum, int64 *rowNum);
 extern void datumstreamread_rewind_block(DatumStreamRead * datumStream);
 extern bool datumstreamread_find_block(DatumStreamRead * datumStream,
 						   DatumStreamFetchDesc datumStreamFetchDesc,
@@ -187,6 +187,34 @@ typedef struct DatumStreamBlock_Delta_Extension
 	 */
 }	DatumStreamBlock_Delta_Extension;
 
+/*
+ * Datum Stream Block extension with a dictionary for variable-length items.
+ * 8 bytes more.
+ *
+ * Unlike the other extensions, it comes after all the other metadata (NULL
+ * bit-map, compress bit-map, repeat counts), and may not be aligned.  It is
+ * followed by the codes array: one code per physical datum, 1 byte each if
+ * there are at most 256 entries and 2 bytes (low byte first) otherwise.  The
+ * datum area then holds the distinct items, each stored once in code order,
+ * and physical_data_size is the size of the dictionary.
+ */
+typedef struct DatumStreamBlock_Dict_Extension
+{
+	int32		entry_count;
+	/*
+	 * Number of distinct items in the dictionary.
+	 */
+
+	int32		codes_size;
+	/*
+	 * Total size of the codes array.
+	 */
+}	DatumStreamBlock_Dict_Extension;
+
+#define DSB_DICT_MAX_ENTRIES 65536
+
+#define DatumStreamBlock_DictCodeWidth(entryCount) ((entryCount) <= 256 ? 1 : 2)
+
 
 /* Flags */
 enum
@@ -194,6 +222,7 @@ enum
 	DSB_HAS_NULLBITMAP = 0x1,
 	DSB_HAS_RLE_COMPRESSION = 0x2,
 	DSB_HAS_DELTA_COMPRESSION = 0x4,
+	DSB_HAS_DICT_COMPRESSION = 0x8,
 };
 
 typedef struct DatumStreamBitMapWrite
@@ -999,6 +1028,7 @@ typedef struct DatumStreamBlockWrite
 
 	bool		rle_want_compression;
 	bool		delta_want_compression;
+	bool		dict_want_compression;
 
 	int32		initialMaxDatumPerBlock;
 	int32		maxDatumPerBlock;
@@ -1073,6 +1103,16 @@ typedef struct DatumStreamBlockWrite
 	bool	   *delta_sign;
 	int32		deltas_maxcount;
 
+	/* Dictionary buffers, filled in when the block is formatted */
+	int32	   *dict_hash;
+	int32		dict_hash_size;
+
+	int32	   *dict_entry_offsets;
+	int32		dict_entries_maxcount;
+
+	uint16	   *dict_codes;
+	int32		dict_codes_maxcount;
+
 	/* EOF of current file */
 	int64		savings;
 	int64		remember_savings;
@@ -1155,6 +1195,15 @@ typedef struct DatumStreamBlockRead
 	bool		delta_block_was_compressed;
 	DatumStreamBitMapRead delta_bitmap;
 
+	/* Dictionary variables */
+	bool		dict_block_was_compressed;
+	uint8	   *dict_codesp;
+	int32		dict_code_width;
+	int32		dict_code;		/* code of the current physical datum */
+	int32		dict_entry_count;
+	uint8	  **dict_entries;	/* pointers to the items in the datum area */
+	int32		dict_entries_maxcount;
+
 	/*
 	 * Keep less frequently accessed fields down here for possible better CPU data cache
 	 * performance.
@@ -1709,6 +1758,22 @@ DatumStreamBlockRead_AdvanceDenseDelta(DatumStreamBlockRead * dsr)
 	return DELTA_COMPRESSION_OK;
 }
 
+inline static int32
+DatumStreamBlockRead_DictCode(DatumStreamBlockRead * dsr, int32 physical_datum_index)
+{
+	uint8	   *codep;
+
+	Assert(dsr->dict_block_was_compressed);
+	Assert(physical_datum_index >= 0 &&
+		   physical_datum_index < dsr->physical_datum_count);
+
+	if (dsr->dict_code_width == 1)
+		return dsr->dict_codesp[physical_datum_index];
+
+	codep = dsr->dict_codesp + 2 * physical_datum_index;
+	return codep[0] | (codep[1] << 8);
+}
+
 inline static int
 DatumStreamBlockRead_AdvanceDense(DatumStreamBlockRead * dsr)
 {
@@ -1953,7 +2018,16 @@ DatumStreamBlockRead_AdvanceDense(DatumStreamBlockRead * dsr)
 		/*
 		 * Advance the item pointer.
 		 */
-		if (dsr->typeInfo.datumlen == -1)
+		if (dsr->dict_block_was_compressed)
+		{
+			/*
+			 * The items are not stored in order; look the next one up in
+			 * the dictionary.
+			 */
+			dsr->dict_code = DatumStreamBlockRead_DictCode(dsr, dsr->physical_datum_index);
+			dsr->datump = dsr->dict_entries[dsr->dict_code];
+		}
+		else if (dsr->typeInfo.datumlen == -1)
 		{
 			struct varlena *s;
 
@@ -2106,6 +2180,11 @@ DatumStreamBlockRead_GetReady(
 	}
 }
 
+extern int32 DatumStreamBlockRead_DictLookup(
+								DatumStreamBlockRead * dsr,
+								const char *data,
+								int32 len);
+
 extern void DatumStreamBlockRead_ResetOrig(DatumStreamBlockRead * dsr);
 extern void DatumStreamBlockRead_ResetDense(DatumStreamBlockRead * dsr);
 
@@ -2143,6 +2222,7 @@ extern void DatumStreamBlockWrite_Init(
 						   DatumStreamVersion datumStreamVersion,
 						   bool rle_want_compression,
 						   bool delta_want_compression,
+						   bool dict_want_compression,
 						   int32 initialMaxDatumPerBlock,
 						   int32 maxDatumPerBlock,
 						   int32 maxDataBlockSize,
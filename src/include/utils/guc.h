@@ -184,6 +184,11 @@ extern bool gp_appendonly_verify_block_checksums;
 extern bool gp_appendonly_verify_write_block;
 extern bool gp_appendonly_verify_eof;
 extern bool gp_appendonly_compaction;
+extern bool gp_appendonly_zone_maps;
+extern int  gp_aocs_scan_batch_size;
+extern bool gp_aocs_late_materialization;
+extern bool gp_aocs_dictionary_encoding;
+extern bool gp_appendonly_visimap_preload;
 
 /*
  * Threshold of the ratio of dirty data in a segment file
@@ -194,6 +199,18 @@ extern bool gp_appendonly_compaction;
  * 10% of the tuples are hidden.
  */ 
 extern int  gp_appendonly_compaction_threshold;
+
+/*
+ * Maximum amount of live data (in kB) lazy vacuum moves out of one
+ * segment file per run.  0 compacts whole segment files.
+ */
+extern int  gp_appendonly_compaction_budget;
+
+/*
+ * Number of large reads kept hinted (posix_fadvise WILLNEED) ahead of the
+ * current one while reading an append-only segment file.  0 disables.
+ */
+extern int  gp_appendonly_readahead_large_reads;
 extern bool gp_heap_verify_checksums_on_mirror;
 extern bool gp_heap_require_relhasoids_match;
 extern bool	Debug_appendonly_rezero_quicklz_compress_scratch;
@@ -459,6 +476,7 @@ extern double optimizer_damping_factor_join;
 extern double optimizer_damping_factor_groupby;
 extern bool optimizer_dpe_stats;
 extern bool optimizer_enable_derive_stats_all_groups;
+extern bool optimizer_lazy_column_stats;
 
 /* Costing or tuning related GUCs used by the Optimizer */
 extern int optimizer_segments;
@@ -0,0 +1,89 @@
+--
+-- Dictionary encoding of the blocks of rle_type columns
+-- (gp_aocs_dictionary_encoding)
+--
+-- The blocks written while it is on hold 1-byte codes when they have at
+-- most 256 distinct values and 2-byte codes up to 65536, and none at all
+-- when a dictionary would not make them smaller.  Equality filters on such
+-- columns are evaluated on the codes, and must give the same answer as the
+-- row-at-a-time path.
+--
+set optimizer = off;
+
+create table aocs_dict (a int, b text, c text, d text, e text)
+  with (appendonly = true, orientation = column, compresstype = rle_type,
+        blocksize = 1048576) distributed by (a);
+-- b has 10 distinct values and some nulls, c has 1000, d comes in runs of
+-- 50 repeats, and e has no value twice
+set gp_aocs_dictionary_encoding = on;
+insert into aocs_dict
+  select i,
+         case when i % 7 = 0 then null else 'v' || (i % 10) end,
+         'value-number-' || (i % 1000),
+         'r' || (i / 50),
+         md5(i::text)
+  from generate_series(1, 100000) i;
+-- blocks without a dictionary after those with one
+set gp_aocs_dictionary_encoding = off;
+insert into aocs_dict
+  select i,
+         case when i % 7 = 0 then null else 'v' || (i % 10) end,
+         'value-number-' || (i % 1000),
+         'r' || (i / 50),
+         md5(i::text)
+  from generate_series(100001, 120000) i;
+
+create view aocs_dict_summary as
+  select count(*), count(b) as count_b, count(distinct b) as distinct_b,
+         sum(length(b)) as len_b, count(distinct c) as distinct_c,
+         sum(length(c)) as len_c, count(distinct d) as distinct_d,
+         sum(length(d)) as len_d, count(distinct e) as distinct_e
+  from aocs_dict;
+create view aocs_dict_filters as
+  select (select count(*) from aocs_dict where b = 'v3') as b_present,
+         (select count(*) from aocs_dict where b = 'missing') as b_missing,
+         (select count(*) from aocs_dict where b is null) as b_null,
+         (select count(*) from aocs_dict where b = null::text) as b_eq_null,
+         (select count(*) from aocs_dict where c = 'value-number-999') as c_present,
+         (select count(*) from aocs_dict where c = 'value-number-1000') as c_missing,
+         (select count(*) from aocs_dict where d = 'r10') as d_run,
+         (select count(*) from aocs_dict where d = 'r2100') as d_undict_run,
+         (select count(*) from aocs_dict where e = md5('12345')) as e_present,
+         (select count(*) from aocs_dict where e = md5('110000')) as e_undict;
+
+set gp_aocs_scan_batch_size = 0;
+select * from aocs_dict_summary;
+select * from aocs_dict_filters;
+select a, b, c, d from aocs_dict where b = 'v3' and c = 'value-number-3' order by a limit 5;
+select a, b, c, d from aocs_dict where c = 'value-number-3' and b is null order by a limit 5;
+
+reset gp_aocs_scan_batch_size;
+select * from aocs_dict_summary;
+select * from aocs_dict_filters;
+select a, b, c, d from aocs_dict where b = 'v3' and c = 'value-number-3' order by a limit 5;
+select a, b, c, d from aocs_dict where c = 'value-number-3' and b is null order by a limit 5;
+
+-- smaller batches than blocks
+set gp_aocs_scan_batch_size = 7;
+select * from aocs_dict_filters;
+reset gp_aocs_scan_batch_size;
+
+-- the dictionary makes the blocks of c smaller
+set gp_aocs_dictionary_encoding = on;
+create table aocs_dict_on (a int, c text encoding (compresstype = rle_type))
+  with (appendonly = true, orientation = column, blocksize = 1048576) distributed by (a);
+insert into aocs_dict_on select i, 'value-number-' || (i % 1000) from generate_series(1, 100000) i;
+set gp_aocs_dictionary_encoding = off;
+create table aocs_dict_off (a int, c text encoding (compresstype = rle_type))
+  with (appendonly = true, orientation = column, blocksize = 1048576) distributed by (a);
+insert into aocs_dict_off select i, 'value-number-' || (i % 1000) from generate_series(1, 100000) i;
+select pg_relation_size('aocs_dict_on') < pg_relation_size('aocs_dict_off') as smaller;
+select count(*), count(distinct c) from aocs_dict_on;
+
+reset gp_aocs_dictionary_encoding;
+drop view aocs_dict_summary;
+drop view aocs_dict_filters;
+drop table aocs_dict;
+drop table aocs_dict_on;
+drop table aocs_dict_off;
+reset optimizer;
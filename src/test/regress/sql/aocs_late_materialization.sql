@@ -0,0 +1,106 @@
+--
+-- Late materialization of AOCS scans (gp_aocs_late_materialization)
+--
+-- The columns the qual of the scan does not reference are read only for
+-- the rows that satisfy it.  Every query is run with and without that, and
+-- must give the same answer.
+--
+set optimizer = off;
+
+create table aocs_late (a int, b int, c text, d int encoding (compresstype=rle_type), e text)
+  with (appendonly = true, orientation = column, blocksize = 8192) distributed by (a);
+-- c and e fill their blocks at different rates, d is run-length encoded,
+-- and some values of e are larger than a block
+insert into aocs_late
+  select i, i % 1000,
+         repeat(chr(97 + i % 26), i % 60),
+         i / 100,
+         case when i % 5000 = 17 then repeat('x', 20000) else i::text end
+  from generate_series(1, 40000) i;
+delete from aocs_late where a % 11 = 0;
+
+create view aocs_late_b7 as
+  select count(*), sum(length(c)) as len_c, sum(d) as sum_d, sum(length(e)) as len_e
+  from aocs_late where b = 7;
+create view aocs_late_b17 as
+  select count(*), sum(length(c)) as len_c, sum(d) as sum_d, sum(length(e)) as len_e
+  from aocs_late where b = 17;
+create view aocs_late_two as
+  select count(*), sum(length(c)) as len_c, sum(d) as sum_d
+  from aocs_late where b < 3 and a % 2 = 0;
+create view aocs_late_c as
+  select count(*), sum(b) as sum_b, sum(d) as sum_d
+  from aocs_late where length(c) = 5;
+
+set gp_aocs_late_materialization = off;
+select * from aocs_late_b7;
+select * from aocs_late_b17;
+select * from aocs_late_two;
+select * from aocs_late_c;
+select a, d, e from aocs_late where b = 7 order by a limit 5;
+
+set gp_aocs_late_materialization = on;
+select * from aocs_late_b7;
+select * from aocs_late_b17;
+select * from aocs_late_two;
+select * from aocs_late_c;
+select a, d, e from aocs_late where b = 7 order by a limit 5;
+
+-- stopping in the middle of a batch
+select count(*) from (select a, e from aocs_late where b = 7 limit 3) s;
+
+-- smaller batches than blocks
+set gp_aocs_scan_batch_size = 7;
+select * from aocs_late_b7;
+select * from aocs_late_b17;
+select * from aocs_late_c;
+
+-- row at a time
+set gp_aocs_scan_batch_size = 0;
+select * from aocs_late_b7;
+select * from aocs_late_c;
+reset gp_aocs_scan_batch_size;
+
+-- rescans of an inner scan with a qual of its own
+create table aocs_late_outer (k int, lo int) distributed by (k);
+insert into aocs_late_outer values (0, 100), (1, 5000), (2, 12000), (3, 19990);
+create table aocs_late_inner (k int, b int, c text)
+  with (appendonly = true, orientation = column, blocksize = 8192) distributed by (k);
+insert into aocs_late_inner select i % 4, i, i::text from generate_series(1, 20000) i;
+
+set enable_hashjoin = off;
+set enable_mergejoin = off;
+set gp_aocs_late_materialization = off;
+select o.k, o.lo, count(t.b), sum(t.b)
+  from aocs_late_outer o join aocs_late_inner t
+    on t.k = o.k and t.b between o.lo and o.lo + 999 and t.c like '1%'
+  group by 1, 2 order by 1, 2;
+set gp_aocs_late_materialization = on;
+select o.k, o.lo, count(t.b), sum(t.b)
+  from aocs_late_outer o join aocs_late_inner t
+    on t.k = o.k and t.b between o.lo and o.lo + 999 and t.c like '1%'
+  group by 1, 2 order by 1, 2;
+reset enable_hashjoin;
+reset enable_mergejoin;
+
+-- a volatile qual runs only on the rows the scan returns, one at a time;
+-- all rows are on one segment, so the limit stops the scan after one row
+create table aocs_late_vol (k int, a int, c text)
+  with (appendonly = true, orientation = column) distributed by (k);
+insert into aocs_late_vol select 1, i, i::text from generate_series(1, 5000) i;
+create sequence aocs_late_seq;
+select count(c) from (select c from aocs_late_vol
+  where a > 0 and nextval('aocs_late_seq') > 0 limit 1) s;
+select last_value from aocs_late_seq;
+drop sequence aocs_late_seq;
+drop table aocs_late_vol;
+
+reset gp_aocs_late_materialization;
+drop view aocs_late_b7;
+drop view aocs_late_b17;
+drop view aocs_late_two;
+drop view aocs_late_c;
+drop table aocs_late;
+drop table aocs_late_outer;
+drop table aocs_late_inner;
+reset optimizer;
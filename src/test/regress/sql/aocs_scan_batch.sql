@@ -0,0 +1,135 @@
+--
+-- Decoding AOCS scans a batch of rows at a time (gp_aocs_scan_batch_size)
+--
+-- Every query is run with the row-at-a-time path (0) and with batch sizes
+-- that do and do not line up with the blocks, and must give the same
+-- answer each time.
+--
+set optimizer = off;
+
+create table aocs_batch (a int, b int, c text, d numeric(10, 2))
+  with (appendonly = true, orientation = column, blocksize = 8192) distributed by (a);
+insert into aocs_batch
+  select i, i,
+         case when i % 7 = 0 then null else repeat(chr(97 + i % 26), i % 40) end,
+         (i % 100) / 4.0
+  from generate_series(1, 20000) i;
+
+-- deleted rows in the first segment file, and compacting them moves the
+-- rest to another one
+delete from aocs_batch where a % 5 = 0;
+vacuum aocs_batch;
+insert into aocs_batch
+  select i, i,
+         case when i % 7 = 0 then null else repeat(chr(97 + i % 26), i % 40) end,
+         (i % 100) / 4.0
+  from generate_series(20001, 30000) i;
+delete from aocs_batch where a between 25000 and 25100;
+
+create view aocs_batch_summary as
+  select count(*), sum(b) as sum_b, count(c) as count_c,
+         sum(length(c)) as len_c, sum(d) as sum_d
+  from aocs_batch;
+create view aocs_batch_filtered as
+  select count(*), sum(b) as sum_b, sum(length(c)) as len_c
+  from aocs_batch where b % 1000 < 3;
+
+set gp_aocs_scan_batch_size = 0;
+select * from aocs_batch_summary;
+select * from aocs_batch_filtered;
+set gp_aocs_scan_batch_size = 1;
+select * from aocs_batch_summary;
+select * from aocs_batch_filtered;
+set gp_aocs_scan_batch_size = 7;
+select * from aocs_batch_summary;
+select * from aocs_batch_filtered;
+set gp_aocs_scan_batch_size = 1024;
+select * from aocs_batch_summary;
+select * from aocs_batch_filtered;
+set gp_aocs_scan_batch_size = 65536;
+select * from aocs_batch_summary;
+select * from aocs_batch_filtered;
+
+-- only some of the columns
+select count(*), sum(d) from aocs_batch where c is null;
+
+-- rescans, both of scans that ran to the end and of scans stopped in the
+-- middle of a batch
+create table aocs_batch_inner (k int, b int, c text)
+  with (appendonly = true, orientation = column, blocksize = 8192) distributed by (k);
+insert into aocs_batch_inner select i % 4, i, i::text from generate_series(1, 20000) i;
+create table aocs_batch_outer (k int, lo int) distributed by (k);
+insert into aocs_batch_outer values
+  (0, 100), (1, 5000), (2, 12000), (3, 19990), (0, 19999), (1, 30000);
+
+set enable_hashjoin = off;
+set enable_mergejoin = off;
+
+create or replace function aocs_batch_rescanned(query text) returns bool as
+$$
+declare
+  plan text := '';
+  explainrow text;
+begin
+  for explainrow in execute 'EXPLAIN ' || query
+  loop
+    plan := plan || explainrow || E'\n';
+  end loop;
+  return plan like '%Nested Loop%' and plan not like '%Materialize%';
+end;
+$$ language plpgsql;
+
+select aocs_batch_rescanned('select * from aocs_batch_outer o join aocs_batch_inner t on t.k = o.k and t.b between o.lo and o.lo + 99');
+
+set gp_aocs_scan_batch_size = 0;
+select o.k, o.lo, count(t.b), sum(t.b), sum(length(t.c))
+  from aocs_batch_outer o join aocs_batch_inner t
+    on t.k = o.k and t.b between o.lo and o.lo + 99
+  group by 1, 2 order by 1, 2;
+select o.k, o.lo from aocs_batch_outer o
+  where exists (select 1 from aocs_batch_inner t where t.k = o.k and t.b > o.lo)
+  order by 1, 2;
+set gp_aocs_scan_batch_size = 7;
+select o.k, o.lo, count(t.b), sum(t.b), sum(length(t.c))
+  from aocs_batch_outer o join aocs_batch_inner t
+    on t.k = o.k and t.b between o.lo and o.lo + 99
+  group by 1, 2 order by 1, 2;
+select o.k, o.lo from aocs_batch_outer o
+  where exists (select 1 from aocs_batch_inner t where t.k = o.k and t.b > o.lo)
+  order by 1, 2;
+set gp_aocs_scan_batch_size = 1024;
+select o.k, o.lo, count(t.b), sum(t.b), sum(length(t.c))
+  from aocs_batch_outer o join aocs_batch_inner t
+    on t.k = o.k and t.b between o.lo and o.lo + 99
+  group by 1, 2 order by 1, 2;
+select o.k, o.lo from aocs_batch_outer o
+  where exists (select 1 from aocs_batch_inner t where t.k = o.k and t.b > o.lo)
+  order by 1, 2;
+
+reset enable_hashjoin;
+reset enable_mergejoin;
+
+-- deleted rows are returned under SnapshotAny
+delete from aocs_batch_inner where b % 3 = 0;
+set gp_aocs_scan_batch_size = 0;
+select count(*), sum(b) from aocs_batch_inner;
+set gp_select_invisible = true;
+select count(*), sum(b) from aocs_batch_inner;
+set gp_aocs_scan_batch_size = 7;
+select count(*), sum(b) from aocs_batch_inner;
+set gp_select_invisible = false;
+select count(*), sum(b) from aocs_batch_inner;
+set gp_aocs_scan_batch_size = 1024;
+set gp_select_invisible = true;
+select count(*), sum(b) from aocs_batch_inner;
+set gp_select_invisible = false;
+select count(*), sum(b) from aocs_batch_inner;
+
+reset gp_aocs_scan_batch_size;
+drop view aocs_batch_summary;
+drop view aocs_batch_filtered;
+drop table aocs_batch;
+drop table aocs_batch_inner;
+drop table aocs_batch_outer;
+drop function aocs_batch_rescanned(text);
+reset optimizer;
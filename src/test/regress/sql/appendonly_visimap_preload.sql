@@ -0,0 +1,66 @@
+--
+-- Loading the hidden rows of a whole segment file at once
+-- (gp_appendonly_visimap_preload)
+--
+-- Every query is run with and without the preload, and must give the same
+-- answer.  All rows go to one segment file, so that row number i holds
+-- a = i and the visimap ranges are 32768 values of a wide.
+--
+set optimizer = off;
+
+create table visimap_ao (k int, a int, b text)
+  with (appendonly = true) distributed by (k);
+insert into visimap_ao select 1, i, i::text from generate_series(1, 600000) i;
+create table visimap_co (k int, a int, b text)
+  with (appendonly = true, orientation = column) distributed by (k);
+insert into visimap_co select 1, i, i::text from generate_series(1, 600000) i;
+
+-- deletes in ranges 0, 1, 3 and 4, around the boundaries between 0 and 1
+-- and between 3 and 4, and none in range 2 and from range 5 on
+delete from visimap_ao
+  where a between 100 and 199 or a % 50000 = 7 and a < 200000
+     or a between 32760 and 32775 or a between 131070 and 131080;
+delete from visimap_co
+  where a between 100 and 199 or a % 50000 = 7 and a < 200000
+     or a between 32760 and 32775 or a between 131070 and 131080;
+
+create view visimap_ao_summary as
+  select count(*), sum(a) as sum_a, sum(length(b)) as len_b from visimap_ao;
+create view visimap_co_summary as
+  select count(*), sum(a) as sum_a, sum(length(b)) as len_b from visimap_co;
+
+set gp_appendonly_visimap_preload = off;
+select * from visimap_ao_summary;
+select * from visimap_co_summary;
+select a from visimap_ao where a between 32758 and 32777 order by a;
+select a from visimap_co where a between 131068 and 131082 order by a;
+
+set gp_appendonly_visimap_preload = on;
+select * from visimap_ao_summary;
+select * from visimap_co_summary;
+select a from visimap_ao where a between 32758 and 32777 order by a;
+select a from visimap_co where a between 131068 and 131082 order by a;
+set gp_aocs_scan_batch_size = 0;
+select * from visimap_co_summary;
+reset gp_aocs_scan_batch_size;
+
+-- hidden rows in every range take more than work_mem, and are looked up
+-- one visimap entry at a time instead
+delete from visimap_ao where a % 2 = 0;
+delete from visimap_co where a % 2 = 0;
+set work_mem = '64kB';
+select * from visimap_ao_summary;
+select * from visimap_co_summary;
+reset work_mem;
+select * from visimap_ao_summary;
+select * from visimap_co_summary;
+set gp_appendonly_visimap_preload = off;
+select * from visimap_ao_summary;
+select * from visimap_co_summary;
+
+reset gp_appendonly_visimap_preload;
+drop view visimap_ao_summary;
+drop view visimap_co_summary;
+drop table visimap_ao;
+drop table visimap_co;
+reset optimizer;
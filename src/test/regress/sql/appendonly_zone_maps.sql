@@ -0,0 +1,107 @@
+--
+-- Skipping blocks of append-only tables by their zones (gp_appendonly_zone_maps)
+--
+-- Zones are kept next to the block directory entries, so only tables with
+-- a block directory (any index creates one) have them.
+--
+set optimizer = off;
+set enable_indexscan = off;
+set enable_bitmapscan = off;
+set gp_appendonly_zone_maps = on;
+
+-- does the scan skip any block
+create or replace function zone_maps_skipped(query text) returns bool as
+$$
+declare
+  explainrow text;
+begin
+  for explainrow in execute 'EXPLAIN ANALYZE ' || query
+  loop
+    if explainrow like '%Blocks skipped by zone maps%' then
+      return true;
+    end if;
+  end loop;
+  return false;
+end;
+$$ language plpgsql;
+
+create table zone_maps_co (a int, b int, c text)
+  with (appendonly = true, orientation = column, blocksize = 8192) distributed by (a);
+create index zone_maps_co_b on zone_maps_co (b);
+insert into zone_maps_co select i, i, i::text from generate_series(1, 100000) i;
+insert into zone_maps_co select i, null, i::text from generate_series(1, 10) i;
+
+select count(*), sum(b) from zone_maps_co where b between 500 and 600;
+select count(*), sum(b) from zone_maps_co where b > 99990;
+select count(*) from zone_maps_co where b is null;
+select c from zone_maps_co where b = 777;
+select zone_maps_skipped('select count(*) from zone_maps_co where b between 500 and 600');
+select zone_maps_skipped('select count(*) from zone_maps_co where b is null');
+
+-- row-oriented
+create table zone_maps_ao (a int, b int, c text)
+  with (appendonly = true, blocksize = 8192) distributed by (a);
+create index zone_maps_ao_b on zone_maps_ao (b);
+insert into zone_maps_ao select i, i, i::text from generate_series(1, 100000) i;
+
+select count(*), sum(b) from zone_maps_ao where b between 500 and 600;
+select c from zone_maps_ao where b = 777;
+select zone_maps_skipped('select count(*) from zone_maps_ao where b between 500 and 600');
+
+-- no block directory, no zones
+create table zone_maps_noblkdir (a int, b int, c text)
+  with (appendonly = true, orientation = column, blocksize = 8192) distributed by (a);
+insert into zone_maps_noblkdir select i, i, i::text from generate_series(1, 100000) i;
+
+select count(*), sum(b) from zone_maps_noblkdir where b between 500 and 600;
+select zone_maps_skipped('select count(*) from zone_maps_noblkdir where b between 500 and 600');
+
+-- minipages written without zones and with them in the same segment files
+create table zone_maps_mixed (a int, b int, c text)
+  with (appendonly = true, orientation = column, blocksize = 8192) distributed by (a);
+create index zone_maps_mixed_b on zone_maps_mixed (b);
+set gp_appendonly_zone_maps = off;
+insert into zone_maps_mixed select i, i, i::text from generate_series(1, 50000) i;
+set gp_appendonly_zone_maps = on;
+insert into zone_maps_mixed select i, i, i::text from generate_series(50001, 100000) i;
+
+select count(*), sum(b) from zone_maps_mixed where b between 500 and 600;
+select count(*), sum(b) from zone_maps_mixed where b between 60000 and 60100;
+select count(*), sum(b) from zone_maps_mixed where b between 49990 and 50010;
+select c from zone_maps_mixed where b = 777;
+select c from zone_maps_mixed where b = 77777;
+-- blocks written with zones are skipped, the others are read
+select zone_maps_skipped('select count(*) from zone_maps_mixed where b between 500 and 600');
+select zone_maps_skipped('select count(*) from zone_maps_mixed where b between 60000 and 60100');
+
+-- a minipage with zones extended without them, and again with them
+create table zone_maps_mixed2 (a int, b int)
+  with (appendonly = true, orientation = column, blocksize = 8192) distributed by (a);
+create index zone_maps_mixed2_b on zone_maps_mixed2 (b);
+insert into zone_maps_mixed2 select i, i from generate_series(1, 30000) i;
+set gp_appendonly_zone_maps = off;
+insert into zone_maps_mixed2 select i, i from generate_series(30001, 60000) i;
+set gp_appendonly_zone_maps = on;
+insert into zone_maps_mixed2 select i, i from generate_series(60001, 90000) i;
+
+select count(*), sum(b) from zone_maps_mixed2 where b between 100 and 200;
+select count(*), sum(b) from zone_maps_mixed2 where b between 29990 and 30010;
+select count(*), sum(b) from zone_maps_mixed2 where b between 59990 and 60010;
+select count(*), sum(b) from zone_maps_mixed2 where b > 89990;
+
+-- same results without zones
+set gp_appendonly_zone_maps = off;
+select count(*), sum(b) from zone_maps_co where b between 500 and 600;
+select count(*), sum(b) from zone_maps_mixed where b between 49990 and 50010;
+select zone_maps_skipped('select count(*) from zone_maps_co where b between 500 and 600');
+
+reset gp_appendonly_zone_maps;
+reset enable_bitmapscan;
+reset enable_indexscan;
+drop table zone_maps_co;
+drop table zone_maps_ao;
+drop table zone_maps_noblkdir;
+drop table zone_maps_mixed;
+drop table zone_maps_mixed2;
+drop function zone_maps_skipped(text);
+reset optimizer;
@@ -0,0 +1,73 @@
+--
+-- zstd and lz4 compresstypes for append-only tables
+--
+-- Both are only available in builds configured --with-zstd and --with-lz4;
+-- compression_zstd_lz4_1.out is the output of a build without them.
+--
+create table compress_src (a int, b text) distributed by (a);
+insert into compress_src select i, repeat('abc', i % 50) from generate_series(1, 10000) i;
+
+-- zstd, row and column oriented
+create table zstd_ao (a int, b text)
+  with (appendonly = true, compresstype = zstd, compresslevel = 1) distributed by (a);
+insert into zstd_ao select * from compress_src;
+select count(*), sum(length(b)) from zstd_ao;
+
+create table zstd_co (a int, b text encoding (compresstype = zstd, compresslevel = 19))
+  with (appendonly = true, orientation = column) distributed by (a);
+insert into zstd_co select * from compress_src;
+select count(*), sum(length(b)) from zstd_co;
+
+-- compresslevel goes from 1 to 19
+create table zstd_bad (a int)
+  with (appendonly = true, compresstype = zstd, compresslevel = 20) distributed by (a);
+create table zstd_bad (a int)
+  with (appendonly = true, compresstype = zstd, compresslevel = 0) distributed by (a);
+
+-- lz4, row and column oriented
+create table lz4_ao (a int, b text)
+  with (appendonly = true, compresstype = lz4) distributed by (a);
+insert into lz4_ao select * from compress_src;
+select count(*), sum(length(b)) from lz4_ao;
+
+create table lz4_co (a int, b text encoding (compresstype = lz4, compresslevel = 1))
+  with (appendonly = true, orientation = column) distributed by (a);
+insert into lz4_co select * from compress_src;
+select count(*), sum(length(b)) from lz4_co;
+
+-- lz4 has a single compresslevel, 1
+create table lz4_bad (a int)
+  with (appendonly = true, compresstype = lz4, compresslevel = 2) distributed by (a);
+
+-- gp_compression_benchmark, on the segments that hold the data
+create table compress_bench_ao (a int, b text)
+  with (appendonly = true, compresstype = zlib) distributed by (a);
+insert into compress_bench_ao select * from compress_src;
+create table compress_bench_co (a int, b text)
+  with (appendonly = true, orientation = column) distributed by (a);
+insert into compress_bench_co select * from compress_src;
+
+select (r).compresstype, (r).compresslevel,
+       sum((r).blocks) > 0 as blocks, sum((r).rawbytes) > 0 as rawbytes,
+       sum((r).compressedbytes) between 1 and sum((r).rawbytes) as compressed
+  from (select gp_compression_benchmark('compress_bench_ao') as r
+        from gp_dist_random('gp_id')) s
+  group by 1, 2 order by 1, 2;
+select (r).compresstype, (r).compresslevel,
+       sum((r).blocks) > 0 as blocks, sum((r).rawbytes) > 0 as rawbytes,
+       sum((r).compressedbytes) between 1 and sum((r).rawbytes) as compressed
+  from (select gp_compression_benchmark('compress_bench_co') as r
+        from gp_dist_random('gp_id')) s
+  group by 1, 2 order by 1, 2;
+
+create table compress_bench_heap (a int) distributed by (a);
+select * from gp_compression_benchmark('compress_bench_heap');
+
+drop table zstd_ao;
+drop table zstd_co;
+drop table lz4_ao;
+drop table lz4_co;
+drop table compress_bench_ao;
+drop table compress_bench_co;
+drop table compress_bench_heap;
+drop table compress_src;
@@ -0,0 +1,82 @@
+--
+-- COPY into column-oriented tables a batch of rows at a time
+--
+-- COPY buffers the rows for a column-oriented table without indexes,
+-- triggers or partitions, up to 1000 rows or about 1MB of values, and
+-- stores them column by column.  An index makes it store them one at a
+-- time; both must give every row the same row number.
+--
+set optimizer = off;
+
+-- some nulls, and every 997th value of d is larger than a block
+create table copy_aocs_src (a int, b text, c int, d text, e numeric(10, 2)) distributed by (a);
+insert into copy_aocs_src
+  select i,
+         case when i % 13 = 0 then null else repeat(chr(97 + i % 26), i % 100) end,
+         case when i % 7 = 0 then null else i * 3 end,
+         case when i % 997 = 0 then repeat('L', 20000 + i) else 'd' || i end,
+         (i % 1000) / 4.0
+  from generate_series(1, 5000) i;
+copy copy_aocs_src to '/tmp/copy_aocs_batch.data';
+
+-- x is dropped before the COPY
+create table copy_aocs_batched (a int, b text, x int, c int, d text, e numeric(10, 2))
+  with (appendonly = true, orientation = column, blocksize = 8192) distributed by (a);
+alter table copy_aocs_batched drop column x;
+create table copy_aocs_rows (a int, b text, x int, c int, d text, e numeric(10, 2))
+  with (appendonly = true, orientation = column, blocksize = 8192) distributed by (a);
+alter table copy_aocs_rows drop column x;
+create index copy_aocs_rows_a on copy_aocs_rows (a);
+
+copy copy_aocs_batched from '/tmp/copy_aocs_batch.data';
+copy copy_aocs_rows from '/tmp/copy_aocs_batch.data';
+
+select count(*), count(b), sum(length(b)) as len_b, count(c), sum(c),
+       sum(length(d)) as len_d, sum(e)
+  from copy_aocs_batched;
+select count(*), count(b), sum(length(b)) as len_b, count(c), sum(c),
+       sum(length(d)) as len_d, sum(e)
+  from copy_aocs_rows;
+select a, length(d), substr(d, 1, 3) from copy_aocs_batched where a % 997 = 0 order by a;
+
+-- the same rows at the same row numbers, and the same tuple counts
+select count(*) from copy_aocs_batched t1 join copy_aocs_rows t2
+  on t1.gp_segment_id = t2.gp_segment_id and t1.ctid::text = t2.ctid::text
+  and t1.a = t2.a and t1.b is not distinct from t2.b
+  and t1.c is not distinct from t2.c and t1.d = t2.d and t1.e = t2.e;
+select distinct segno, tupcount from gp_toolkit.__gp_aocsseg_name('copy_aocs_batched');
+select distinct segno, tupcount from gp_toolkit.__gp_aocsseg_name('copy_aocs_rows');
+
+-- a second COPY continues after the rows of the first
+copy copy_aocs_batched from '/tmp/copy_aocs_batch.data';
+copy copy_aocs_rows from '/tmp/copy_aocs_batch.data';
+select count(*) from copy_aocs_batched t1 join copy_aocs_rows t2
+  on t1.gp_segment_id = t2.gp_segment_id and t1.ctid::text = t2.ctid::text
+  and t1.a = t2.a;
+select distinct segno, tupcount from gp_toolkit.__gp_aocsseg_name('copy_aocs_batched');
+select distinct segno, tupcount from gp_toolkit.__gp_aocsseg_name('copy_aocs_rows');
+
+-- rows of 2000 bytes fill 1MB before 1000 rows
+create table copy_aocs_wide_src (a int, b text) distributed by (a);
+insert into copy_aocs_wide_src select i, repeat(chr(97 + i % 26), 2000) from generate_series(1, 6000) i;
+copy copy_aocs_wide_src to '/tmp/copy_aocs_batch_wide.data';
+create table copy_aocs_wide_batched (a int, b text)
+  with (appendonly = true, orientation = column) distributed by (a);
+create table copy_aocs_wide_rows (a int, b text)
+  with (appendonly = true, orientation = column) distributed by (a);
+create index copy_aocs_wide_rows_a on copy_aocs_wide_rows (a);
+copy copy_aocs_wide_batched from '/tmp/copy_aocs_batch_wide.data';
+copy copy_aocs_wide_rows from '/tmp/copy_aocs_batch_wide.data';
+select count(*), sum(a), sum(length(b)) from copy_aocs_wide_batched;
+select count(*) from copy_aocs_wide_batched t1 join copy_aocs_wide_rows t2
+  on t1.gp_segment_id = t2.gp_segment_id and t1.ctid::text = t2.ctid::text
+  and t1.a = t2.a and t1.b = t2.b;
+select distinct segno, tupcount from gp_toolkit.__gp_aocsseg_name('copy_aocs_wide_batched');
+
+drop table copy_aocs_src;
+drop table copy_aocs_batched;
+drop table copy_aocs_rows;
+drop table copy_aocs_wide_src;
+drop table copy_aocs_wide_batched;
+drop table copy_aocs_wide_rows;
+reset optimizer;
@@ -105,3 +105,38 @@ SELECT * from
 get_explain_output($$
 	select * from (values (1)) as f(a) join (values(2)) b(b) on a = b$$) as et
 WHERE et like '%Hash Cond:%';
+
+--
+-- EXPLAIN OPTIMIZER_STATS. Timings and memory vary from run to run, so the
+-- numbers are masked. The per-kind metadata fetch counts and the search log
+-- depend on the state of the metadata cache, so only the per-phase lines are
+-- kept.
+--
+create or replace function get_optimizer_stats(explain_query text) returns setof text as
+$$
+declare
+  explainrow text;
+  in_stats bool := false;
+begin
+  for explainrow in execute 'EXPLAIN OPTIMIZER_STATS ' || explain_query
+  loop
+    if explainrow like 'Optimizer statistics%' then
+      in_stats := true;
+    end if;
+    if in_stats and explainrow !~ '^    ' and explainrow !~ '^  Search statistics' then
+      return next regexp_replace(explainrow, '[0-9]+(\.[0-9]+)?', 'N', 'g');
+    end if;
+  end loop;
+end;
+$$ language plpgsql;
+
+select * from get_optimizer_stats($$ select * from foo where a = 1 $$);
+
+-- EXPLAIN EXECUTE reports the statistics when the statement is replanned for
+-- the given parameters, and says so when the cached plan is reused.
+prepare optstats_param(int) as select * from foo where a = $1;
+select * from get_optimizer_stats($$ execute optstats_param(1) $$);
+prepare optstats_noparam as select * from foo where a = 1;
+select * from get_optimizer_stats($$ execute optstats_noparam $$);
+deallocate optstats_param;
+deallocate optstats_noparam;
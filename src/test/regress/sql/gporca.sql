@@ -525,6 +525,16 @@ reset optimizer_enable_space_pruning;
 set optimizer_enumerate_plans=off;
 set optimizer_enable_constant_expression_evaluation=off;
 
+-- constant expressions are evaluated once per optimization; repeated ones
+-- must give the same result as the first evaluation, and volatile ones are
+-- evaluated every time
+set optimizer_enable_constant_expression_evaluation=on;
+select count(*) from orca.t_text where tag1 = 'go' || 'od' and user_id between 1 + 1 and 10 - 1;
+select count(*) from orca.t_text where tag1 = 'go' || 'od' or tag1 = 'go' || 'od';
+select count(*) from orca.t_text where tag1 = 'ba' || 'd' union all select count(*) from orca.t_text where tag1 = 'ba' || 'd';
+select count(*) from orca.t_text where user_id < (random() * 0)::int + 3;
+set optimizer_enable_constant_expression_evaluation=off;
+
 -- create a user defined type and only define equality on it
 -- the type can be used in the partitioning list, but Orca is not able to pick a heterogenous index
 -- because constraint derivation needs all comparison operators
@@ -0,0 +1,35 @@
+--
+-- Compression of the packets sent by motions (gp_interconnect_compression)
+--
+-- The header of a compressed packet names the method it was compressed
+-- with, and receivers decode it by that, whatever their own setting.
+--
+create table ic_compress (a int, b int, c text) distributed by (a);
+insert into ic_compress
+  select i, i % 7, repeat('abcdefgh', 100) || i from generate_series(1, 2000) i;
+
+set gp_interconnect_compression = on;
+set gp_interconnect_compression_threshold = 0;
+
+set gp_interconnect_compression_method = zlib;
+show gp_interconnect_compression_method;
+set gp_interconnect_compression_method = snappy;
+
+-- redistribute on b, then gather
+select b, count(*), sum(length(c)) from ic_compress group by b order by b;
+-- redistribute both sides of the join
+select count(*) from ic_compress t1 join ic_compress t2 on t1.c = t2.c;
+
+-- lz4 is not available in builds without it, then zlib is used again
+set gp_interconnect_compression_method = lz4;
+select b, count(*), sum(length(c)) from ic_compress group by b order by b;
+select count(*) from ic_compress t1 join ic_compress t2 on t1.c = t2.c;
+
+-- nothing is compressed below the threshold
+set gp_interconnect_compression_threshold = 1000000;
+select count(*) from ic_compress t1 join ic_compress t2 on t1.c = t2.c;
+
+reset gp_interconnect_compression_method;
+reset gp_interconnect_compression_threshold;
+reset gp_interconnect_compression;
+drop table ic_compress;
@@ -0,0 +1,38 @@
+--
+-- Motions between processes on the same host through shared memory rings
+-- (gp_interconnect_local_shm)
+--
+-- In a single-host cluster every peer is local, so all connections between
+-- segments go through rings.  Results must not depend on it.
+--
+create table ic_local_shm (a int, b int, c text) distributed by (a);
+insert into ic_local_shm
+  select i, i % 10, repeat('x', i % 100) from generate_series(1, 20000) i;
+
+set gp_interconnect_local_shm = on;
+
+-- redistribute, then gather
+select b, count(*), sum(length(c)) from ic_local_shm group by b order by b;
+-- redistribute both sides of the join
+select count(*) from ic_local_shm t1 join ic_local_shm t2 on t1.a = t2.b + 1;
+-- broadcast
+select count(*) from ic_local_shm t1, (select * from ic_local_shm where a <= 3) t2 where t1.b = t2.a;
+-- the receiver stops early
+select * from (select b from ic_local_shm group by b) s order by b limit 2;
+
+-- a ring per connection of each statement, torn down at its end
+begin;
+declare ic_local_shm_cur cursor for select b, count(*) from ic_local_shm group by b order by b;
+fetch 3 from ic_local_shm_cur;
+select count(*) from ic_local_shm t1 join ic_local_shm t2 on t1.a = t2.b + 1;
+fetch 3 from ic_local_shm_cur;
+close ic_local_shm_cur;
+commit;
+
+-- same results over the network
+set gp_interconnect_local_shm = off;
+select b, count(*), sum(length(c)) from ic_local_shm group by b order by b;
+select count(*) from ic_local_shm t1 join ic_local_shm t2 on t1.a = t2.b + 1;
+
+reset gp_interconnect_local_shm;
+drop table ic_local_shm;
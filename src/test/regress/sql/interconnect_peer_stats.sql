@@ -0,0 +1,35 @@
+--
+-- Per-peer statistics of the UDP interconnect (gp_interconnect_peer_stats)
+--
+-- Every outgoing connection adds its counters to the statistics of its
+-- peer when it is torn down; window, slow start threshold and rtt are
+-- averaged over the recent connections.
+--
+create table ic_peer_stats (a int, b int) distributed by (a);
+insert into ic_peer_stats select i, i % 1000 from generate_series(1, 10000) i;
+
+create table ic_peer_stats_before as
+  select coalesce(sum(conns), 0) as conns from gp_toolkit.gp_interconnect_peer_stats
+  distributed randomly;
+
+-- redistribute on b, then gather
+select count(*) from ic_peer_stats t1 join ic_peer_stats t2 on t1.a = t2.b;
+
+select (select sum(conns) from gp_toolkit.gp_interconnect_peer_stats) >
+       (select conns from ic_peer_stats_before) as recorded;
+select bool_and(peer_segid >= -1) as peer_ok,
+       bool_and(conns > 0 and pkts_sent >= 0 and losses >= 0) as counters_ok,
+       bool_and(cwnd >= 1 and ssthresh >= 1) as cwnd_ok,
+       bool_and(min_rtt_us is null or min_rtt_us > 0) as min_rtt_ok
+  from gp_toolkit.gp_interconnect_peer_stats;
+
+-- with adaptive windows, the averages stay within the queue depth
+set gp_interconnect_adaptive_cwnd = on;
+select count(*) from ic_peer_stats t1 join ic_peer_stats t2 on t1.a = t2.b;
+select bool_and(cwnd >= 1 and cwnd <= current_setting('gp_interconnect_queue_depth')::int) as cwnd_ok,
+       bool_and(ssthresh >= 1 and ssthresh <= current_setting('gp_interconnect_queue_depth')::int) as ssthresh_ok
+  from gp_toolkit.gp_interconnect_peer_stats;
+reset gp_interconnect_adaptive_cwnd;
+
+drop table ic_peer_stats_before;
+drop table ic_peer_stats;
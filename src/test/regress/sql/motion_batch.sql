@@ -0,0 +1,41 @@
+--
+-- Batching of narrow tuples in motions (gp_motion_batch_tuples)
+--
+-- Batching is off by default.  When on, motions between segments send up
+-- to that many fixed-width tuples in one chunk; motions received by the QD
+-- are still sent a tuple at a time, so cursors and LIMIT see their rows
+-- without waiting for a batch to fill.
+--
+show gp_motion_batch_tuples;
+
+create table motion_batch (a int, b int, c int8) distributed by (a);
+insert into motion_batch select i, i % 100 + 1, i * 2 from generate_series(1, 10000) i;
+
+set gp_motion_batch_tuples = 128;
+
+-- redistribute one side of the join
+select count(*), sum(t1.c) from motion_batch t1 join motion_batch t2 on t1.b = t2.a;
+-- redistribute for the aggregate, batches shorter than 128 at the end
+select count(*), sum(cnt) from (select b, count(*) as cnt from motion_batch group by b) s;
+-- a batch of one
+select count(*) from motion_batch t1 join motion_batch t2 on t1.b = t2.a where t1.a = 42;
+-- variable-width tuples are not batched
+select count(*) from motion_batch t1 join motion_batch t2 on t1.b::text = t2.a::text;
+
+-- the QD gets the rows of a cursor one at a time
+begin;
+declare motion_batch_cur cursor for select a, c from motion_batch where a <= 5 order by a;
+fetch 2 from motion_batch_cur;
+fetch 3 from motion_batch_cur;
+close motion_batch_cur;
+commit;
+
+select a from motion_batch order by a limit 3;
+
+-- same results without batching
+set gp_motion_batch_tuples = 0;
+select count(*), sum(t1.c) from motion_batch t1 join motion_batch t2 on t1.b = t2.a;
+select count(*), sum(cnt) from (select b, count(*) as cnt from motion_batch group by b) s;
+
+reset gp_motion_batch_tuples;
+drop table motion_batch;
@@ -0,0 +1,61 @@
+--
+-- Redistribute motions of a join on a skewed key (gp_enable_motion_skew)
+--
+-- The rows of the input with a very common key value are spread over all
+-- segments, and the matching rows of the other input are broadcast.  Only
+-- the legacy planner produces these plans.
+--
+set optimizer = off;
+
+create table motion_skew_fact (id int, k int) distributed by (id);
+create table motion_skew_dim (id int, k int) distributed by (id);
+-- every even row of the fact table has k = 1
+insert into motion_skew_fact
+  select i, case when i % 2 = 0 then 1 else i end from generate_series(1, 30000) i;
+insert into motion_skew_dim select i, i from generate_series(1, 20000) i;
+analyze motion_skew_fact;
+analyze motion_skew_dim;
+
+-- the motions of a plan, and how they handle skewed keys
+create or replace function motion_skew_plan(explain_query text) returns setof text as
+$$
+declare
+  explainrow text;
+begin
+  for explainrow in execute 'EXPLAIN ' || explain_query
+  loop
+    if explainrow ~ 'Redistribute Motion|Broadcast Motion|Skewed Keys' then
+      return next regexp_replace(explainrow, E'^ *(-> *)?([A-Za-z ]+(Motion|: [0-9]+ \\([a-z]+\\))).*$', E'\\2');
+    end if;
+  end loop;
+end;
+$$ language plpgsql;
+
+set gp_enable_motion_skew = on;
+
+select * from motion_skew_plan('select count(*) from motion_skew_fact f join motion_skew_dim d on f.k = d.k') p order by 1;
+select count(*), sum(f.id) from motion_skew_fact f join motion_skew_dim d on f.k = d.k;
+select count(*), count(d.id) from motion_skew_fact f left join motion_skew_dim d on f.k = d.k;
+
+-- broadcast rows are sent after the batched rows ahead of them
+set gp_motion_batch_tuples = 128;
+select count(*), sum(f.id) from motion_skew_fact f join motion_skew_dim d on f.k = d.k;
+select count(*), count(d.id) from motion_skew_fact f left join motion_skew_dim d on f.k = d.k;
+reset gp_motion_batch_tuples;
+
+-- no value is common enough
+set gp_motion_skew_threshold = 0.9;
+select * from motion_skew_plan('select count(*) from motion_skew_fact f join motion_skew_dim d on f.k = d.k') p order by 1;
+reset gp_motion_skew_threshold;
+
+-- same results without skew handling
+set gp_enable_motion_skew = off;
+select * from motion_skew_plan('select count(*) from motion_skew_fact f join motion_skew_dim d on f.k = d.k') p order by 1;
+select count(*), sum(f.id) from motion_skew_fact f join motion_skew_dim d on f.k = d.k;
+select count(*), count(d.id) from motion_skew_fact f left join motion_skew_dim d on f.k = d.k;
+
+reset gp_enable_motion_skew;
+drop function motion_skew_plan(text);
+drop table motion_skew_fact;
+drop table motion_skew_dim;
+reset optimizer;
@@ -0,0 +1,50 @@
+--
+-- Runtime filters from hash joins to the senders of their outer
+-- Redistribute Motion (gp_enable_runtime_filter)
+--
+-- Outer rows are dropped by the senders only if they can't match, so
+-- results must be the same with and without the filter.
+--
+create table runtime_filter_outer (a int, b int, c int, v varchar(10)) distributed by (a);
+create table runtime_filter_inner (a int, b int, c int, t text) distributed by (b);
+insert into runtime_filter_outer select i, i, i % 7, i::text from generate_series(1, 50000) i;
+insert into runtime_filter_outer select 50000 + i, null, null, null from generate_series(1, 100) i;
+insert into runtime_filter_inner
+  select i, i % 100 + 1, i % 7, (i % 100 + 1)::text from generate_series(1, 20000) i;
+insert into runtime_filter_inner select 20000 + i, null, null, null from generate_series(1, 50) i;
+analyze runtime_filter_outer;
+analyze runtime_filter_inner;
+
+set gp_enable_runtime_filter = on;
+
+select count(*), sum(o.a) from runtime_filter_outer o join runtime_filter_inner i on o.b = i.b;
+-- two keys
+select count(*) from runtime_filter_outer o join runtime_filter_inner i on o.b = i.b and o.c = i.c;
+-- an expression as the key
+select count(*) from runtime_filter_outer o join runtime_filter_inner i on o.b + 1 = i.b;
+-- keys of different types
+select count(*) from runtime_filter_outer o join runtime_filter_inner i on o.v = i.t;
+-- semi-join
+select count(*) from runtime_filter_outer o where o.b in (select b from runtime_filter_inner);
+-- outer joins keep the rows that don't match, and get no filter
+select count(*), count(i.a) from runtime_filter_outer o left join runtime_filter_inner i on o.b = i.b;
+
+-- the filter is built once, rescans of the inner side don't add to it
+select count(*) from runtime_filter_outer o
+  where o.a <= 3 and exists (select 1 from runtime_filter_outer o2 join runtime_filter_inner i on o2.b = i.b
+                             where o2.c = o.a);
+
+-- same results without the filter
+set gp_enable_runtime_filter = off;
+select count(*), sum(o.a) from runtime_filter_outer o join runtime_filter_inner i on o.b = i.b;
+select count(*) from runtime_filter_outer o join runtime_filter_inner i on o.b = i.b and o.c = i.c;
+select count(*) from runtime_filter_outer o join runtime_filter_inner i on o.b + 1 = i.b;
+select count(*) from runtime_filter_outer o join runtime_filter_inner i on o.v = i.t;
+
+-- the TCP interconnect can't send filters, the join just gets all rows
+\! PGOPTIONS='-c gp_interconnect_type=tcp -c gp_enable_runtime_filter=on' psql -X -q -t -A -d regression -c 'select count(*), sum(o.a) from runtime_filter_outer o join runtime_filter_inner i on o.b = i.b'
+\! PGOPTIONS='-c gp_interconnect_type=tcp -c gp_enable_runtime_filter=on' psql -X -q -t -A -d regression -c 'select count(*) from runtime_filter_outer o join runtime_filter_inner i on o.b = i.b and o.c = i.c'
+
+reset gp_enable_runtime_filter;
+drop table runtime_filter_outer;
+drop table runtime_filter_inner;
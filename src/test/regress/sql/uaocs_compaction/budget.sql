@@ -0,0 +1,41 @@
+-- @Description Tests lazy vacuum compacting a segment file over several runs under gp_appendonly_compaction_budget.
+CREATE TABLE uaocs_budget (a INT, b INT) WITH (appendonly=true, orientation=column) distributed by (b);
+CREATE INDEX uaocs_budget_index ON uaocs_budget(a);
+INSERT INTO uaocs_budget SELECT i, 1 FROM generate_series(1, 10000) AS i;
+DELETE FROM uaocs_budget WHERE a % 5 = 0;
+SET gp_appendonly_compaction_budget = 32;
+
+-- moves a part of the live tuples and hides them, keeping segment file 1
+VACUUM uaocs_budget;
+SELECT COUNT(*), SUM(a) FROM uaocs_budget;
+SELECT DISTINCT segno, tupcount = 10000 AS kept, state FROM gp_toolkit.__gp_aocsseg_name('uaocs_budget') WHERE segno = 1;
+SELECT DISTINCT segno, tupcount BETWEEN 1 AND 7999 AS moved_some, state FROM gp_toolkit.__gp_aocsseg_name('uaocs_budget') WHERE segno = 2;
+
+-- the next run continues after the tuples moved already
+VACUUM uaocs_budget;
+SELECT COUNT(*), SUM(a) FROM uaocs_budget;
+SELECT DISTINCT segno, tupcount BETWEEN 2 AND 7999 AS moved_more, state FROM gp_toolkit.__gp_aocsseg_name('uaocs_budget') WHERE segno = 2;
+
+-- delete a moved tuple and one that was not moved yet
+DELETE FROM uaocs_budget WHERE a IN (1, 9999);
+SELECT COUNT(*), SUM(a) FROM uaocs_budget;
+
+-- until the rest fits into the budget, and the segment file is dropped
+VACUUM uaocs_budget;
+VACUUM uaocs_budget;
+VACUUM uaocs_budget;
+VACUUM uaocs_budget;
+VACUUM uaocs_budget;
+VACUUM uaocs_budget;
+VACUUM uaocs_budget;
+VACUUM uaocs_budget;
+VACUUM uaocs_budget;
+VACUUM uaocs_budget;
+SELECT COUNT(*), SUM(a) FROM uaocs_budget;
+SELECT DISTINCT segno, tupcount, state FROM gp_toolkit.__gp_aocsseg_name('uaocs_budget') ORDER BY segno;
+SET enable_seqscan = off;
+SELECT COUNT(*), SUM(a) FROM uaocs_budget WHERE a BETWEEN 1 AND 100;
+RESET enable_seqscan;
+
+RESET gp_appendonly_compaction_budget;
+DROP TABLE uaocs_budget;